@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/thread_safe_list.h"
+#include "mir/recursive_read_write_mutex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct Observer
+{
+    void frame_posted() { ++frames; }
+    std::atomic<unsigned long> frames{0};
+};
+
+using Element = std::shared_ptr<Observer>;
+
+/*
+ * What ThreadSafeList used to do: a RecursiveReadWriteMutex per element,
+ * read locked while walking and write locked to reuse or clear a slot.
+ * Kept here for comparison.
+ */
+class PerElementLockedList
+{
+public:
+    void add(Element const& element)
+    {
+        for (auto& item : items)
+        {
+            mir::RecursiveWriteLock lock{item.mutex};
+            if (!item.element)
+            {
+                item.element = element;
+                used = std::max<size_t>(used, &item - items.data() + 1);
+                return;
+            }
+        }
+    }
+
+    void remove(Element const& element)
+    {
+        for (size_t i = 0; i != used; ++i)
+        {
+            mir::RecursiveWriteLock lock{items[i].mutex};
+            if (items[i].element == element)
+            {
+                items[i].element.reset();
+                return;
+            }
+        }
+    }
+
+    void for_each(std::function<void(Element const& element)> const& f)
+    {
+        for (size_t i = 0; i != used; ++i)
+        {
+            mir::RecursiveReadLock lock{items[i].mutex};
+            if (auto const copy_of_element = items[i].element) f(copy_of_element);
+        }
+    }
+
+private:
+    struct Item
+    {
+        Element element;
+        mir::RecursiveReadWriteMutex mutex;
+    };
+
+    std::vector<Item> items{1024};
+    std::atomic<size_t> used{0};
+};
+
+template<typename List>
+std::chrono::nanoseconds time_notifications(int thread_count, int iterations, int observer_count)
+{
+    List list;
+    std::vector<Element> observers;
+    for (int i = 0; i != observer_count; ++i)
+    {
+        observers.push_back(std::make_shared<Observer>());
+        list.add(observers.back());
+    }
+
+    // Observers come and go (surfaces are created, sessions connect) while notifications happen
+    std::atomic<bool> done{false};
+    std::thread churn{[&]
+        {
+            while (!done)
+            {
+                auto const transient = std::make_shared<Observer>();
+                list.add(transient);
+                std::this_thread::sleep_for(std::chrono::microseconds{100});
+                list.remove(transient);
+            }
+        }};
+
+    auto const start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> notifiers;
+    for (int i = 0; i != thread_count; ++i)
+    {
+        notifiers.emplace_back([&]
+            {
+                for (int j = 0; j != iterations; ++j)
+                    list.for_each([](Element const& observer) { observer->frame_posted(); });
+            });
+    }
+
+    for (auto& notifier : notifiers)
+        notifier.join();
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    done = true;
+    churn.join();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+}
+
+template<typename List>
+void report(char const* name, int thread_count, int iterations, int observer_count)
+{
+    auto const duration = time_notifications<List>(thread_count, iterations, observer_count);
+    auto const notifications = static_cast<double>(thread_count) * iterations * observer_count;
+
+    std::cout << name << ": " << thread_count << " threads notifying " << observer_count
+              << " observers " << iterations << " times took " << duration.count() << "ns ("
+              << duration.count() / notifications << "ns per notification)" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of threads> <iterations per thread> [<number of observers>]"<<std::endl;
+        exit(1);
+    }
+
+    int const thread_count = std::atoi(argv[1]);
+    int const iterations = std::atoi(argv[2]);
+    int const observer_count = argc > 3 ? std::atoi(argv[3]) : 4;
+
+    report<PerElementLockedList>("Per-element locks", thread_count, iterations, observer_count);
+    report<mir::ThreadSafeList<Element>>("ThreadSafeList", thread_count, iterations, observer_count);
+
+    exit(0);
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/sw/renderer.h"
+#include "src/renderers/sw/blend.h"
+
+#include "mir/graphics/buffer_basic.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/renderable.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+geom::Size const output_size{1920, 1080};
+
+class MemoryBuffer : public mg::BufferBasic, public mg::NativeBufferBase, public mrs::PixelSource
+{
+public:
+    MemoryBuffer(geom::Size size, uint32_t pixel)
+        : size_{size},
+          pixels(size.width.as_int() * size.height.as_int(), pixel)
+    {
+    }
+
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override { return nullptr; }
+    geom::Size size() const override { return size_; }
+    MirPixelFormat pixel_format() const override { return mir_pixel_format_abgr_8888; }
+    NativeBufferBase* native_buffer_base() override { return this; }
+
+    void write(unsigned char const*, size_t) override {}
+    void read(std::function<void(unsigned char const*)> const& do_with_pixels) override
+    {
+        do_with_pixels(reinterpret_cast<unsigned char const*>(pixels.data()));
+    }
+    geom::Stride stride() const override { return geom::Stride{size_.width.as_int() * 4}; }
+
+private:
+    geom::Size const size_;
+    std::vector<uint32_t> pixels;
+};
+
+class Window : public mg::Renderable
+{
+public:
+    Window(geom::Rectangle const& position, uint32_t pixel, float alpha, bool shaped)
+        : buffer_{std::make_shared<MemoryBuffer>(position.size, pixel)},
+          position{position},
+          alpha_{alpha},
+          shaped_{shaped}
+    {
+    }
+
+    ID id() const override { return this; }
+    std::shared_ptr<mg::Buffer> buffer() const override { return buffer_; }
+    geom::Rectangle screen_position() const override { return position; }
+    float alpha() const override { return alpha_; }
+    glm::mat4 transformation() const override { return glm::mat4{1.0f}; }
+    bool shaped() const override { return shaped_; }
+    unsigned int swap_interval() const override { return 1; }
+
+private:
+    std::shared_ptr<MemoryBuffer> const buffer_;
+    geom::Rectangle const position;
+    float const alpha_;
+    bool const shaped_;
+};
+
+class Output : public mg::DisplayBuffer, public mg::NativeDisplayBuffer, public mrs::RenderTarget
+{
+public:
+    Output() : pixels(output_size.width.as_int() * output_size.height.as_int()) {}
+
+    geom::Rectangle view_area() const override { return {{0, 0}, output_size}; }
+    bool overlay(mg::RenderableList const&) override { return false; }
+    glm::mat2 transformation() const override { return glm::mat2{1.0f}; }
+    NativeDisplayBuffer* native_display_buffer() override { return this; }
+
+    mrs::WritableFrame map_back_buffer() override
+    {
+        return {reinterpret_cast<unsigned char*>(pixels.data()), output_size,
+                geom::Stride{output_size.width.as_int() * 4}, mir_pixel_format_xbgr_8888};
+    }
+    void swap_buffers() override {}
+
+private:
+    std::vector<uint32_t> pixels;
+};
+
+// A wallpaper, a maximized window, and a couple of translucent ones on top
+mg::RenderableList desktop()
+{
+    return {
+        std::make_shared<Window>(geom::Rectangle{{0, 0}, output_size}, 0xff204060, 1.0f, false),
+        std::make_shared<Window>(geom::Rectangle{{0, 32}, {1920, 1048}}, 0xffe0e0e0, 1.0f, false),
+        std::make_shared<Window>(geom::Rectangle{{300, 200}, {800, 600}}, 0xc0303030, 1.0f, true),
+        std::make_shared<Window>(geom::Rectangle{{900, 400}, {640, 480}}, 0xff806040, 0.8f, false)};
+}
+
+void time_frames(unsigned int bands, int frames)
+{
+    Output output;
+    mrs::Renderer renderer{output, bands};
+    auto const renderables = desktop();
+
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i != frames; ++i)
+        renderer.render(renderables);
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    std::cout << bands << " band(s): "
+              << std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / frames
+              << "us per 1080p frame" << std::endl;
+}
+
+template<typename Blend>
+void time_blend(char const* name, Blend blend, mrs::BlendMode mode, int rows)
+{
+    std::vector<uint32_t> src(1920, 0xc0303030);
+    std::vector<uint32_t> dst(1920, 0xffe0e0e0);
+
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i != rows; ++i)
+        blend(dst.data(), src.data(), src.size(), mode, 200);
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ": " << rows * src.size() * 1000.0 / std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()
+              << " Mpixels/s" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" [<frames>]"<<std::endl;
+        exit(1);
+    }
+
+    int const frames = argc > 1 ? std::atoi(argv[1]) : 100;
+
+    for (auto bands = 1u; bands <= std::max(std::thread::hardware_concurrency(), 1u); bands *= 2)
+        time_frames(bands, frames);
+
+    int const rows = frames * 1080;
+    time_blend("over, portable", mrs::blend_row_generic, mrs::BlendMode::over, rows);
+    time_blend("over", mrs::blend_row, mrs::BlendMode::over, rows);
+    time_blend("fade, portable", mrs::blend_row_generic, mrs::BlendMode::fade, rows);
+    time_blend("fade", mrs::blend_row, mrs::BlendMode::fade, rows);
+
+    exit(0);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "compositor_timings.h"
+
+#include <cstdlib>
+#include <new>
+
+// Replacing the global allocation functions in the executable also catches
+// allocations made from inside libmirserver, so we can attribute heap traffic
+// to the compositor stages that cause it.
+
+namespace
+{
+thread_local uint64_t allocation_count{0};
+
+void* counted_allocation(std::size_t size)
+{
+    ++allocation_count;
+
+    if (auto const p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc{};
+}
+}
+
+uint64_t allocations_on_this_thread()
+{
+    return allocation_count;
+}
+
+void* operator new(std::size_t size)
+{
+    return counted_allocation(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return counted_allocation(size);
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+    ++allocation_count;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept
+{
+    ++allocation_count;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "buffer_submitting_client.h"
+
+#include "mir_toolkit/mir_client_library.h"
+
+#include <stdexcept>
+#include <thread>
+
+namespace mt = mir::test;
+
+namespace
+{
+void null_lifecycle_callback(MirConnection*, MirLifecycleState, void*)
+{
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+MirWindow* create_window(MirConnection* connection, mir::geometry::Size size)
+{
+    MirPixelFormat pixel_format;
+    unsigned int valid_formats;
+    mir_connection_get_available_surface_formats(connection, &pixel_format, 1, &valid_formats);
+
+    auto const spec = mir_create_normal_window_spec(
+        connection, size.width.as_int(), size.height.as_int());
+    mir_window_spec_set_pixel_format(spec, pixel_format);
+    mir_window_spec_set_name(spec, "compositor-throughput");
+    mir_window_spec_set_buffer_usage(spec, mir_buffer_usage_software);
+
+    auto const window = mir_create_window_sync(spec);
+    mir_window_spec_release(spec);
+
+    if (!mir_window_is_valid(window))
+        throw std::runtime_error{std::string{"Window creation failed: "} + mir_window_get_error_message(window)};
+
+    return window;
+}
+
+MirBufferStream* buffer_stream_of(MirWindow* window)
+{
+    return mir_window_get_buffer_stream(window);
+}
+#pragma GCC diagnostic pop
+}
+
+BufferSubmittingClient::BufferSubmittingClient(
+    BufferSubmittingClientParameters const& parameters,
+    mt::Barrier& clients_ready) :
+    parameters(parameters),
+    clients_ready(clients_ready)
+{
+}
+
+void BufferSubmittingClient::run(std::string const& connect_string)
+{
+    auto const connection = mir_connect_sync(connect_string.c_str(), "compositor-throughput");
+    if (!mir_connection_is_valid(connection))
+        throw std::runtime_error{std::string{"Connection failed: "} + mir_connection_get_error_message(connection)};
+
+    /*
+     * Set a null callback to avoid killing the process
+     * (default callback raises SIGHUP).
+     */
+    mir_connection_set_lifecycle_event_callback(connection, null_lifecycle_callback, nullptr);
+
+    auto const window = create_window(connection, parameters.window_size);
+    auto const stream = buffer_stream_of(window);
+
+    clients_ready.ready();
+
+    using clock = std::chrono::steady_clock;
+    auto const frame_interval = parameters.frames_per_second ?
+        std::chrono::duration_cast<clock::duration>(std::chrono::seconds{1}) / parameters.frames_per_second :
+        clock::duration::zero();
+
+    auto const end_time = clock::now() + parameters.duration;
+    auto next_frame = clock::now();
+
+    while (clock::now() < end_time)
+    {
+        auto const submitted = clock::now();
+        mir_buffer_stream_swap_buffers_sync(stream);
+        round_trips_.push_back(clock::now() - submitted);
+
+        if (frame_interval != clock::duration::zero())
+        {
+            next_frame += frame_interval;
+            std::this_thread::sleep_until(next_frame);
+        }
+    }
+
+    mir_window_release_sync(window);
+    mir_connection_release(connection);
+}
+
+std::vector<std::chrono::nanoseconds> const& BufferSubmittingClient::round_trips() const
+{
+    return round_trips_;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BUFFER_SUBMITTING_CLIENT_H_
+#define BUFFER_SUBMITTING_CLIENT_H_
+
+#include "mir/geometry/size.h"
+#include "mir/test/barrier.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct BufferSubmittingClientParameters
+{
+    mir::geometry::Size window_size;
+    /// Target rate of buffer submissions; zero submits as fast as the server returns buffers
+    unsigned int frames_per_second;
+    std::chrono::milliseconds duration;
+};
+
+/// A client that repeatedly swaps the buffers of a single window and times each round trip
+class BufferSubmittingClient
+{
+public:
+    BufferSubmittingClient(BufferSubmittingClientParameters const& parameters, mir::test::Barrier& clients_ready);
+
+    void run(std::string const& connect_string);
+
+    /// Time from submitting a buffer to holding the next one, for every frame submitted
+    std::vector<std::chrono::nanoseconds> const& round_trips() const;
+
+private:
+    BufferSubmittingClientParameters const parameters;
+    mir::test::Barrier& clients_ready;
+    std::vector<std::chrono::nanoseconds> round_trips_;
+};
+
+#endif // BUFFER_SUBMITTING_CLIENT_H_
@@ -0,0 +1,44 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "compositor_timings.h"
+
+#include <time.h>
+
+std::chrono::nanoseconds thread_cpu_time()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+StageTimer::StageTimer(StageTimings& stage) :
+    stage(stage),
+    cpu_start{thread_cpu_time()},
+    allocations_start{allocations_on_this_thread()}
+{
+}
+
+StageTimer::~StageTimer()
+{
+    auto const allocations = allocations_on_this_thread() - allocations_start;
+    auto const cpu = thread_cpu_time() - cpu_start;
+
+    stage.calls.fetch_add(1, std::memory_order_relaxed);
+    stage.cpu_ns.fetch_add(cpu.count(), std::memory_order_relaxed);
+    stage.allocations.fetch_add(allocations, std::memory_order_relaxed);
+}
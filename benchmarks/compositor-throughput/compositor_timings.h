@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef COMPOSITOR_TIMINGS_H_
+#define COMPOSITOR_TIMINGS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/// Accumulated cost of one stage of the compositing pipeline, summed over all compositor threads
+struct StageTimings
+{
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> cpu_ns{0};
+    std::atomic<uint64_t> allocations{0};
+};
+
+struct CompositorTimings
+{
+    StageTimings scene_elements_for;
+    StageTimings composite;
+    StageTimings render;
+    /// Occlusion filtering, timed separately on a copy of each frame's scene elements
+    StageTimings occlusion;
+
+    std::atomic<uint64_t> renderables{0};
+};
+
+/// Charges the CPU time and heap allocations of the calling thread over its lifetime to a stage
+class StageTimer
+{
+public:
+    explicit StageTimer(StageTimings& stage);
+    ~StageTimer();
+
+private:
+    StageTimer(StageTimer const&) = delete;
+    StageTimer& operator=(StageTimer const&) = delete;
+
+    StageTimings& stage;
+    std::chrono::nanoseconds const cpu_start;
+    uint64_t const allocations_start;
+};
+
+std::chrono::nanoseconds thread_cpu_time();
+
+/// Count of operator new calls made by the calling thread (see allocation_counter.cpp)
+uint64_t allocations_on_this_thread();
+
+#endif // COMPOSITOR_TIMINGS_H_
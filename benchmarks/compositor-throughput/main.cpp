@@ -0,0 +1,254 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "buffer_submitting_client.h"
+#include "compositor_timings.h"
+#include "throughput_measuring_server.h"
+
+#include "mir_test_framework/executable_path.h"
+#include "mir_test_framework/server_runner.h"
+#include "mir/test/barrier.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace geom = mir::geometry;
+namespace mtf = mir_test_framework;
+namespace mt = mir::test;
+
+namespace
+{
+/*
+ * Parameters are read from the environment so that the same binary can be
+ * driven from a CI script, e.g.
+ *   COMPOSITOR_THROUGHPUT_CLIENTS=16 COMPOSITOR_THROUGHPUT_FPS=0 mir_compositor_throughput_benchmark
+ * Results are written as a single JSON object to COMPOSITOR_THROUGHPUT_OUTPUT
+ * (or stdout if that is unset) for tracking regressions between commits.
+ */
+unsigned int parameter(char const* name, unsigned int default_value)
+{
+    if (auto const value = getenv(name))
+        return std::stoul(value);
+    return default_value;
+}
+
+struct StageSnapshot
+{
+    StageSnapshot(StageTimings const& stage) :
+        calls{stage.calls.load()},
+        cpu_ns{stage.cpu_ns.load()},
+        allocations{stage.allocations.load()}
+    {
+    }
+
+    StageSnapshot(uint64_t calls, uint64_t cpu_ns, uint64_t allocations) :
+        calls{calls}, cpu_ns{cpu_ns}, allocations{allocations}
+    {
+    }
+
+    StageSnapshot operator-(StageSnapshot const& rhs) const
+    {
+        return {calls - rhs.calls, cpu_ns - rhs.cpu_ns, allocations - rhs.allocations};
+    }
+
+    uint64_t calls;
+    uint64_t cpu_ns;
+    uint64_t allocations;
+};
+
+struct TimingsSnapshot
+{
+    TimingsSnapshot(CompositorTimings const& timings) :
+        scene_elements_for{timings.scene_elements_for},
+        composite{timings.composite},
+        render{timings.render},
+        occlusion{timings.occlusion},
+        renderables{timings.renderables.load()}
+    {
+    }
+
+    StageSnapshot scene_elements_for;
+    StageSnapshot composite;
+    StageSnapshot render;
+    StageSnapshot occlusion;
+    uint64_t renderables;
+};
+
+double per(uint64_t value, uint64_t count)
+{
+    return count ? static_cast<double>(value) / count : 0.0;
+}
+
+std::chrono::nanoseconds percentile(std::vector<std::chrono::nanoseconds> const& sorted, double p)
+{
+    if (sorted.empty())
+        return std::chrono::nanoseconds::zero();
+
+    auto const index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void write_stage(std::ostream& out, char const* name, StageSnapshot const& stage, uint64_t frames)
+{
+    out << "    \"" << name << "\": {"
+        << "\"calls\": " << stage.calls
+        << ", \"cpu_us_per_frame\": " << per(stage.cpu_ns, frames) / 1000.0
+        << ", \"allocations_per_frame\": " << per(stage.allocations, frames)
+        << "}";
+}
+
+struct CompositorThroughput : testing::Test, mtf::ServerRunner
+{
+    CompositorThroughput() :
+        clients{parameter("COMPOSITOR_THROUGHPUT_CLIENTS", 4)},
+        outputs{parameter("COMPOSITOR_THROUGHPUT_OUTPUTS", 1)},
+        client_parameters{
+            {static_cast<int>(parameter("COMPOSITOR_THROUGHPUT_WIDTH", 640)),
+             static_cast<int>(parameter("COMPOSITOR_THROUGHPUT_HEIGHT", 480))},
+            parameter("COMPOSITOR_THROUGHPUT_FPS", 0),
+            std::chrono::milliseconds{parameter("COMPOSITOR_THROUGHPUT_DURATION_MS", 5000)}},
+        server_configuration{display_rects(outputs), timings}
+    {
+        // Ensure we load the correct platform libraries
+        setenv("MIR_CLIENT_PLATFORM_PATH",
+               (mtf::library_path() + "/client-modules").c_str(),
+               true);
+    }
+
+    static std::vector<geom::Rectangle> display_rects(unsigned int outputs)
+    {
+        std::vector<geom::Rectangle> rects;
+        for (auto i = 0; i != static_cast<int>(outputs); ++i)
+            rects.push_back({{1920 * i, 0}, {1920, 1080}});
+        return rects;
+    }
+
+    mir::DefaultServerConfiguration& server_config() override
+    {
+        return server_configuration;
+    }
+
+    unsigned int const clients;
+    unsigned int const outputs;
+    BufferSubmittingClientParameters const client_parameters;
+    std::shared_ptr<CompositorTimings> const timings{std::make_shared<CompositorTimings>()};
+    ThroughputMeasuringServer server_configuration;
+};
+}
+
+TEST_F(CompositorThroughput, frames_composited_per_second)
+{
+    start_server();
+
+    mt::Barrier clients_ready{clients + 1};
+    std::vector<std::unique_ptr<BufferSubmittingClient>> client_list;
+    std::vector<std::exception_ptr> failures(clients);
+    std::vector<std::thread> client_threads;
+
+    for (auto i = 0u; i != clients; ++i)
+    {
+        client_list.push_back(std::make_unique<BufferSubmittingClient>(client_parameters, clients_ready));
+        client_threads.emplace_back(
+            [&client_list, &failures, i, connect_string = new_connection()]
+            {
+                try
+                {
+                    client_list[i]->run(connect_string);
+                }
+                catch (...)
+                {
+                    failures[i] = std::current_exception();
+                }
+            });
+    }
+
+    clients_ready.ready();
+
+    // Only the steady state interests us: discard server start-up and window creation
+    TimingsSnapshot const before{*timings};
+    auto const start = std::chrono::steady_clock::now();
+
+    for (auto& thread : client_threads)
+        thread.join();
+
+    TimingsSnapshot const after{*timings};
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    stop_server();
+
+    for (auto const& failure : failures)
+        if (failure) std::rethrow_exception(failure);
+
+    std::vector<std::chrono::nanoseconds> round_trips;
+    for (auto const& client : client_list)
+        round_trips.insert(round_trips.end(), client->round_trips().begin(), client->round_trips().end());
+    std::sort(round_trips.begin(), round_trips.end());
+
+    auto const scene_elements_for = after.scene_elements_for - before.scene_elements_for;
+    auto const composite = after.composite - before.composite;
+    auto const render = after.render - before.render;
+    auto const occlusion = after.occlusion - before.occlusion;
+    // Everything composite() does besides render(): occlusion filtering, overlay
+    // selection and posting the frame
+    StageSnapshot const composite_overhead{
+        composite.calls,
+        composite.cpu_ns - std::min(composite.cpu_ns, render.cpu_ns),
+        composite.allocations - std::min(composite.allocations, render.allocations)};
+    auto const frames = composite.calls;
+    auto const seconds = std::chrono::duration<double>(elapsed).count();
+
+    std::ofstream file;
+    if (auto const path = getenv("COMPOSITOR_THROUGHPUT_OUTPUT"))
+        file.open(path);
+    std::ostream& out = file.is_open() ? file : std::cout;
+
+    out << "{\n"
+        << "  \"clients\": " << clients << ",\n"
+        << "  \"outputs\": " << outputs << ",\n"
+        << "  \"window_width\": " << client_parameters.window_size.width.as_int() << ",\n"
+        << "  \"window_height\": " << client_parameters.window_size.height.as_int() << ",\n"
+        << "  \"client_fps\": " << client_parameters.frames_per_second << ",\n"
+        << "  \"duration_s\": " << seconds << ",\n"
+        << "  \"frames_composited\": " << frames << ",\n"
+        << "  \"frames_composited_per_second\": " << frames / seconds << ",\n"
+        << "  \"frames_submitted\": " << round_trips.size() << ",\n"
+        << "  \"renderables_per_frame\": " << per(after.renderables - before.renderables, frames) << ",\n"
+        << "  \"stages\": {\n";
+    write_stage(out, "scene_elements_for", scene_elements_for, frames);
+    out << ",\n";
+    write_stage(out, "occlusion", occlusion, frames);
+    out << ",\n";
+    write_stage(out, "render", render, frames);
+    out << ",\n";
+    write_stage(out, "composite_overhead", composite_overhead, frames);
+    out << "\n  },\n"
+        << "  \"buffer_round_trip_us\": {"
+        << "\"p50\": " << percentile(round_trips, 50).count() / 1000.0
+        << ", \"p90\": " << percentile(round_trips, 90).count() / 1000.0
+        << ", \"p99\": " << percentile(round_trips, 99).count() / 1000.0
+        << ", \"max\": " << percentile(round_trips, 100).count() / 1000.0
+        << "}\n"
+        << "}" << std::endl;
+
+    EXPECT_GT(frames, 0u);
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "throughput_measuring_server.h"
+
+#include "mir/compositor/display_buffer_compositor.h"
+#include "mir/compositor/display_buffer_compositor_factory.h"
+#include "mir/compositor/scene.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/renderer/renderer.h"
+#include "mir/renderer/renderer_factory.h"
+#include "src/server/compositor/occlusion.h"
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mr = mir::renderer;
+namespace geom = mir::geometry;
+namespace mtf = mir_test_framework;
+
+namespace
+{
+class TimingScene : public mc::Scene
+{
+public:
+    TimingScene(std::shared_ptr<mc::Scene> const& wrapped, std::shared_ptr<CompositorTimings> const& timings) :
+        wrapped{wrapped},
+        timings{timings}
+    {
+    }
+
+    mc::SceneElementSequence scene_elements_for(mc::CompositorID id) override
+    {
+        StageTimer timer{timings->scene_elements_for};
+        return wrapped->scene_elements_for(id);
+    }
+
+    int frames_pending(mc::CompositorID id) const override
+    {
+        return wrapped->frames_pending(id);
+    }
+
+    void register_compositor(mc::CompositorID id) override
+    {
+        wrapped->register_compositor(id);
+    }
+
+    void unregister_compositor(mc::CompositorID id) override
+    {
+        wrapped->unregister_compositor(id);
+    }
+
+    void add_observer(std::shared_ptr<mir::scene::Observer> const& observer) override
+    {
+        wrapped->add_observer(observer);
+    }
+
+    void remove_observer(std::weak_ptr<mir::scene::Observer> const& observer) override
+    {
+        wrapped->remove_observer(observer);
+    }
+
+private:
+    std::shared_ptr<mc::Scene> const wrapped;
+    std::shared_ptr<CompositorTimings> const timings;
+};
+
+class TimingRenderer : public mr::Renderer
+{
+public:
+    TimingRenderer(std::unique_ptr<mr::Renderer> wrapped, std::shared_ptr<CompositorTimings> const& timings) :
+        wrapped{std::move(wrapped)},
+        timings{timings}
+    {
+    }
+
+    void set_viewport(geom::Rectangle const& rect) override
+    {
+        wrapped->set_viewport(rect);
+    }
+
+    void set_output_transform(glm::mat2 const& transform) override
+    {
+        wrapped->set_output_transform(transform);
+    }
+
+    void render(mg::RenderableList const& renderables) const override
+    {
+        StageTimer timer{timings->render};
+        timings->renderables.fetch_add(renderables.size(), std::memory_order_relaxed);
+        wrapped->render(renderables);
+    }
+
+    void suspend() override
+    {
+        wrapped->suspend();
+    }
+
+private:
+    std::unique_ptr<mr::Renderer> const wrapped;
+    std::shared_ptr<CompositorTimings> const timings;
+};
+
+class TimingRendererFactory : public mr::RendererFactory
+{
+public:
+    TimingRendererFactory(
+        std::shared_ptr<mr::RendererFactory> const& wrapped,
+        std::shared_ptr<CompositorTimings> const& timings) :
+        wrapped{wrapped},
+        timings{timings}
+    {
+    }
+
+    std::unique_ptr<mr::Renderer> create_renderer_for(mg::DisplayBuffer& display_buffer) override
+    {
+        return std::make_unique<TimingRenderer>(wrapped->create_renderer_for(display_buffer), timings);
+    }
+
+private:
+    std::shared_ptr<mr::RendererFactory> const wrapped;
+    std::shared_ptr<CompositorTimings> const timings;
+};
+
+class TimingDisplayBufferCompositor : public mc::DisplayBufferCompositor
+{
+public:
+    TimingDisplayBufferCompositor(
+        std::unique_ptr<mc::DisplayBufferCompositor> wrapped,
+        mg::DisplayBuffer& display_buffer,
+        std::shared_ptr<CompositorTimings> const& timings) :
+        wrapped{std::move(wrapped)},
+        display_buffer(display_buffer),
+        timings{timings}
+    {
+    }
+
+    void composite(mc::SceneElementSequence&& scene_sequence) override
+    {
+        // The wrapped compositor filters its own sequence where we can't see
+        // it, so run the same filter over a copy to cost it on its own
+        {
+            StageTimer timer{timings->occlusion};
+            occlusion_probe.assign(scene_sequence.begin(), scene_sequence.end());
+            mc::filter_occlusions_from(occlusion_probe, display_buffer.view_area());
+        }
+        occlusion_probe.clear();
+
+        StageTimer timer{timings->composite};
+        wrapped->composite(std::move(scene_sequence));
+    }
+
+private:
+    std::unique_ptr<mc::DisplayBufferCompositor> const wrapped;
+    mg::DisplayBuffer& display_buffer;
+    std::shared_ptr<CompositorTimings> const timings;
+    mc::SceneElementSequence occlusion_probe;
+};
+
+class TimingDisplayBufferCompositorFactory : public mc::DisplayBufferCompositorFactory
+{
+public:
+    TimingDisplayBufferCompositorFactory(
+        std::shared_ptr<mc::DisplayBufferCompositorFactory> const& wrapped,
+        std::shared_ptr<CompositorTimings> const& timings) :
+        wrapped{wrapped},
+        timings{timings}
+    {
+    }
+
+    std::unique_ptr<mc::DisplayBufferCompositor> create_compositor_for(mg::DisplayBuffer& display_buffer) override
+    {
+        return std::make_unique<TimingDisplayBufferCompositor>(
+            wrapped->create_compositor_for(display_buffer), display_buffer, timings);
+    }
+
+private:
+    std::shared_ptr<mc::DisplayBufferCompositorFactory> const wrapped;
+    std::shared_ptr<CompositorTimings> const timings;
+};
+}
+
+ThroughputMeasuringServer::ThroughputMeasuringServer(
+    std::vector<geom::Rectangle> const& display_rects,
+    std::shared_ptr<CompositorTimings> const& timings) :
+    TestingServerConfiguration{display_rects},
+    timings{timings}
+{
+}
+
+std::shared_ptr<mc::Scene> ThroughputMeasuringServer::the_scene()
+{
+    return timing_scene(
+        [this]
+        {
+            return std::make_shared<TimingScene>(TestingServerConfiguration::the_scene(), timings);
+        });
+}
+
+std::shared_ptr<mr::RendererFactory> ThroughputMeasuringServer::the_renderer_factory()
+{
+    return timing_renderer_factory(
+        [this]
+        {
+            return std::make_shared<TimingRendererFactory>(
+                TestingServerConfiguration::the_renderer_factory(), timings);
+        });
+}
+
+std::shared_ptr<mc::DisplayBufferCompositorFactory>
+ThroughputMeasuringServer::wrap_display_buffer_compositor_factory(
+    std::shared_ptr<mc::DisplayBufferCompositorFactory> const& wrapped)
+{
+    return std::make_shared<TimingDisplayBufferCompositorFactory>(wrapped, timings);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef THROUGHPUT_MEASURING_SERVER_H_
+#define THROUGHPUT_MEASURING_SERVER_H_
+
+#include "compositor_timings.h"
+
+#include "mir_test_framework/testing_server_configuration.h"
+#include "mir/cached_ptr.h"
+
+/**
+ * A headless server (stub graphics platform and renderer) whose scene,
+ * display buffer compositors and renderers are wrapped to charge the CPU
+ * time and heap allocations of each compositing stage to CompositorTimings.
+ */
+class ThroughputMeasuringServer : public mir_test_framework::TestingServerConfiguration
+{
+public:
+    ThroughputMeasuringServer(
+        std::vector<mir::geometry::Rectangle> const& display_rects,
+        std::shared_ptr<CompositorTimings> const& timings);
+
+    std::shared_ptr<mir::compositor::Scene> the_scene() override;
+    std::shared_ptr<mir::renderer::RendererFactory> the_renderer_factory() override;
+    std::shared_ptr<mir::compositor::DisplayBufferCompositorFactory> wrap_display_buffer_compositor_factory(
+        std::shared_ptr<mir::compositor::DisplayBufferCompositorFactory> const& wrapped) override;
+
+private:
+    std::shared_ptr<CompositorTimings> const timings;
+    mir::CachedPtr<mir::compositor::Scene> timing_scene;
+    mir::CachedPtr<mir::renderer::RendererFactory> timing_renderer_factory;
+};
+
+#endif // THROUGHPUT_MEASURING_SERVER_H_
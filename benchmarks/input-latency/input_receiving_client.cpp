@@ -0,0 +1,127 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "input_receiving_client.h"
+
+#include "mir_toolkit/mir_client_library.h"
+
+#include <stdexcept>
+
+namespace mt = mir::test;
+
+namespace
+{
+void null_lifecycle_callback(MirConnection*, MirLifecycleState, void*)
+{
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+MirWindow* create_window(MirConnection* connection, mir::geometry::Size size)
+{
+    MirPixelFormat pixel_format;
+    unsigned int valid_formats;
+    mir_connection_get_available_surface_formats(connection, &pixel_format, 1, &valid_formats);
+
+    auto const spec = mir_create_normal_window_spec(
+        connection, size.width.as_int(), size.height.as_int());
+    mir_window_spec_set_pixel_format(spec, pixel_format);
+    mir_window_spec_set_name(spec, "input-latency");
+
+    auto const window = mir_create_window_sync(spec);
+    mir_window_spec_release(spec);
+
+    if (!mir_window_is_valid(window))
+        throw std::runtime_error{std::string{"Window creation failed: "} + mir_window_get_error_message(window)};
+
+    return window;
+}
+
+void post_first_buffer(MirWindow* window)
+{
+    // Windows are only visible, and hence focusable, once they have content
+    mir_buffer_stream_swap_buffers_sync(mir_window_get_buffer_stream(window));
+}
+#pragma GCC diagnostic pop
+}
+
+InputReceivingClient::InputReceivingClient(
+    mir::geometry::Size window_size,
+    std::shared_ptr<LatencyRecorder> const& recorder,
+    mt::Barrier& client_ready) :
+    window_size{window_size},
+    recorder{recorder},
+    client_ready(client_ready)
+{
+}
+
+void InputReceivingClient::run(std::string const& connect_string)
+{
+    auto const connection = mir_connect_sync(connect_string.c_str(), "input-latency");
+    if (!mir_connection_is_valid(connection))
+        throw std::runtime_error{std::string{"Connection failed: "} + mir_connection_get_error_message(connection)};
+
+    /*
+     * Set a null callback to avoid killing the process
+     * (default callback raises SIGHUP).
+     */
+    mir_connection_set_lifecycle_event_callback(connection, null_lifecycle_callback, nullptr);
+
+    auto const window = create_window(connection, window_size);
+    mir_window_set_event_handler(window, &InputReceivingClient::handle_event, this);
+    post_first_buffer(window);
+
+    if (!focused.wait_for(std::chrono::seconds{10}))
+        throw std::runtime_error{"Timed out waiting for input focus"};
+
+    client_ready.ready();
+    stopped.wait();
+
+    mir_window_release_sync(window);
+    mir_connection_release(connection);
+}
+
+void InputReceivingClient::stop()
+{
+    stopped.raise();
+}
+
+void InputReceivingClient::handle_event(MirWindow*, MirEvent const* event, void* context)
+{
+    auto const self = static_cast<InputReceivingClient*>(context);
+
+    switch (mir_event_get_type(event))
+    {
+    case mir_event_type_input:
+        self->recorder->record(LatencyRecorder::Stage::client, *event);
+        break;
+
+    case mir_event_type_window:
+    {
+        auto const window_event = mir_event_get_window_event(event);
+        if (mir_window_event_get_attribute(window_event) == mir_window_attrib_focus &&
+            mir_window_event_get_attribute_value(window_event) == mir_window_focus_state_focused)
+        {
+            self->focused.raise();
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INPUT_RECEIVING_CLIENT_H_
+#define INPUT_RECEIVING_CLIENT_H_
+
+#include "latency_recorder.h"
+
+#include "mir_toolkit/client_types.h"
+#include "mir/geometry/size.h"
+#include "mir/test/barrier.h"
+#include "mir/test/signal.h"
+
+#include <memory>
+#include <string>
+
+/// A client with a single focused window covering the output that records the latency of every input event
+class InputReceivingClient
+{
+public:
+    InputReceivingClient(
+        mir::geometry::Size window_size,
+        std::shared_ptr<LatencyRecorder> const& recorder,
+        mir::test::Barrier& client_ready);
+
+    /// Runs until stop() is called
+    void run(std::string const& connect_string);
+    void stop();
+
+private:
+    static void handle_event(MirWindow* window, MirEvent const* event, void* context);
+
+    mir::geometry::Size const window_size;
+    std::shared_ptr<LatencyRecorder> const recorder;
+    mir::test::Barrier& client_ready;
+    mir::test::Signal focused;
+    mir::test::Signal stopped;
+};
+
+#endif // INPUT_RECEIVING_CLIENT_H_
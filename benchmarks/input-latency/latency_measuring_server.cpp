@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "latency_measuring_server.h"
+
+#include "mir/input/composite_event_filter.h"
+#include "mir/input/event_filter.h"
+#include "mir/input/input_dispatcher.h"
+#include "mir/scene/null_session_listener.h"
+#include "mir/scene/null_surface_observer.h"
+#include "mir/scene/surface.h"
+
+namespace mi = mir::input;
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+namespace mtf = mir_test_framework;
+
+using Stage = LatencyRecorder::Stage;
+
+namespace
+{
+// Sits between the Seat and the KeyRepeatDispatcher
+class TimingInputDispatcher : public mi::InputDispatcher
+{
+public:
+    TimingInputDispatcher(
+        std::shared_ptr<mi::InputDispatcher> const& wrapped,
+        std::shared_ptr<LatencyRecorder> const& recorder) :
+        wrapped{wrapped},
+        recorder{recorder}
+    {
+    }
+
+    bool dispatch(MirEvent const& event) override
+    {
+        recorder->record(Stage::input_dispatcher, event);
+        return wrapped->dispatch(event);
+    }
+
+    void start() override
+    {
+        wrapped->start();
+    }
+
+    void stop() override
+    {
+        wrapped->stop();
+    }
+
+private:
+    std::shared_ptr<mi::InputDispatcher> const wrapped;
+    std::shared_ptr<LatencyRecorder> const recorder;
+};
+
+// Appended to the filter chain, so it sees the event last before the SurfaceInputDispatcher
+class TimingEventFilter : public mi::EventFilter
+{
+public:
+    explicit TimingEventFilter(std::shared_ptr<LatencyRecorder> const& recorder) :
+        recorder{recorder}
+    {
+    }
+
+    bool handle(MirEvent const& event) override
+    {
+        recorder->record(Stage::surface_input_dispatcher, event);
+        return false;
+    }
+
+private:
+    std::shared_ptr<LatencyRecorder> const recorder;
+};
+
+// Added after the session's SurfaceEventSource, so it is notified once the
+// EventSender has serialized the event and written it to the client socket
+class TimingSurfaceObserver : public ms::NullSurfaceObserver
+{
+public:
+    explicit TimingSurfaceObserver(std::shared_ptr<LatencyRecorder> const& recorder) :
+        recorder{recorder}
+    {
+    }
+
+    void input_consumed(MirEvent const* event) override
+    {
+        recorder->record(Stage::event_sender, *event);
+    }
+
+private:
+    std::shared_ptr<LatencyRecorder> const recorder;
+};
+
+class TimingSessionListener : public ms::NullSessionListener
+{
+public:
+    explicit TimingSessionListener(std::shared_ptr<LatencyRecorder> const& recorder) :
+        observer{std::make_shared<TimingSurfaceObserver>(recorder)}
+    {
+    }
+
+    void surface_created(ms::Session&, std::shared_ptr<ms::Surface> const& surface) override
+    {
+        surface->add_observer(observer);
+    }
+
+    void destroying_surface(ms::Session&, std::shared_ptr<ms::Surface> const& surface) override
+    {
+        surface->remove_observer(observer);
+    }
+
+private:
+    std::shared_ptr<TimingSurfaceObserver> const observer;
+};
+}
+
+LatencyMeasuringServer::LatencyMeasuringServer(
+    std::vector<geom::Rectangle> const& display_rects,
+    std::shared_ptr<LatencyRecorder> const& recorder) :
+    FakeInputServerConfiguration{display_rects},
+    recorder{recorder},
+    timing_filter{std::make_shared<TimingEventFilter>(recorder)}
+{
+}
+
+std::shared_ptr<mi::InputDispatcher> LatencyMeasuringServer::the_input_dispatcher()
+{
+    return timing_input_dispatcher(
+        [this]
+        {
+            return std::make_shared<TimingInputDispatcher>(
+                FakeInputServerConfiguration::the_input_dispatcher(), recorder);
+        });
+}
+
+std::shared_ptr<ms::SessionListener> LatencyMeasuringServer::the_session_listener()
+{
+    return timing_session_listener(
+        [this]
+        {
+            return std::make_shared<TimingSessionListener>(recorder);
+        });
+}
+
+void LatencyMeasuringServer::tap_surface_input_dispatcher()
+{
+    the_composite_event_filter()->append(timing_filter);
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LATENCY_MEASURING_SERVER_H_
+#define LATENCY_MEASURING_SERVER_H_
+
+#include "latency_recorder.h"
+
+#include "mir_test_framework/fake_input_server_configuration.h"
+#include "mir/cached_ptr.h"
+
+/**
+ * A headless server with the stub input platform whose input pipeline is
+ * tapped at each stage to feed a LatencyRecorder.
+ */
+class LatencyMeasuringServer : public mir_test_framework::FakeInputServerConfiguration
+{
+public:
+    LatencyMeasuringServer(
+        std::vector<mir::geometry::Rectangle> const& display_rects,
+        std::shared_ptr<LatencyRecorder> const& recorder);
+
+    std::shared_ptr<mir::input::InputDispatcher> the_input_dispatcher() override;
+    std::shared_ptr<mir::scene::SessionListener> the_session_listener() override;
+
+    /// Installs the filter timing arrival at the SurfaceInputDispatcher (call once the shell exists)
+    void tap_surface_input_dispatcher();
+
+private:
+    std::shared_ptr<LatencyRecorder> const recorder;
+    mir::CachedPtr<mir::input::InputDispatcher> timing_input_dispatcher;
+    mir::CachedPtr<mir::scene::SessionListener> timing_session_listener;
+    std::shared_ptr<mir::input::EventFilter> timing_filter;
+};
+
+#endif // LATENCY_MEASURING_SERVER_H_
@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "latency_recorder.h"
+
+#include <algorithm>
+
+namespace
+{
+bool is_injected(MirEvent const& event)
+{
+    if (mir_event_get_type(&event) != mir_event_type_input)
+        return false;
+
+    auto const input_event = mir_event_get_input_event(&event);
+
+    switch (mir_input_event_get_type(input_event))
+    {
+    case mir_input_event_type_key:
+    case mir_input_event_type_touch:
+        return true;
+
+    case mir_input_event_type_pointer:
+    {
+        // Enter and leave events are synthesized by the dispatcher, not the device
+        auto const action = mir_pointer_event_action(mir_input_event_get_pointer_event(input_event));
+        return action != mir_pointer_action_enter && action != mir_pointer_action_leave;
+    }
+
+    default:
+        return false;
+    }
+}
+}
+
+char const* LatencyRecorder::name_of(Stage stage)
+{
+    switch (stage)
+    {
+    case Stage::input_dispatcher: return "input_dispatcher";
+    case Stage::surface_input_dispatcher: return "surface_input_dispatcher";
+    case Stage::event_sender: return "event_sender";
+    case Stage::client: return "client";
+    default: return "unknown";
+    }
+}
+
+LatencyRecorder::LatencyRecorder(size_t expected_events)
+{
+    for (auto& samples : stages)
+        samples.latencies.reserve(expected_events);
+}
+
+void LatencyRecorder::record(Stage stage, MirEvent const& event)
+{
+    if (!is_injected(event))
+        return;
+
+    auto const now = std::chrono::steady_clock::now().time_since_epoch();
+    std::chrono::nanoseconds const event_time{
+        mir_input_event_get_event_time(mir_event_get_input_event(&event))};
+
+    auto& samples = stages[static_cast<size_t>(stage)];
+    std::lock_guard<std::mutex> lock{samples.mutex};
+    samples.latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now) - event_time);
+}
+
+size_t LatencyRecorder::count(Stage stage) const
+{
+    auto& samples = stages[static_cast<size_t>(stage)];
+    std::lock_guard<std::mutex> lock{samples.mutex};
+    return samples.latencies.size();
+}
+
+std::vector<std::chrono::nanoseconds> LatencyRecorder::sorted_latencies(Stage stage) const
+{
+    auto& samples = stages[static_cast<size_t>(stage)];
+    std::unique_lock<std::mutex> lock{samples.mutex};
+    auto result = samples.latencies;
+    lock.unlock();
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
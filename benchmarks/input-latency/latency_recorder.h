@@ -0,0 +1,71 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LATENCY_RECORDER_H_
+#define LATENCY_RECORDER_H_
+
+#include "mir_toolkit/event.h"
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+/**
+ * Collects, for every injected input event, the time since the fake device
+ * stamped it as it passes each stage of the input pipeline.
+ *
+ * The event timestamp is taken from std::chrono::steady_clock by the fake
+ * input device, so the server and the (in-process) client can measure
+ * latency without correlating individual events.
+ */
+class LatencyRecorder
+{
+public:
+    enum class Stage
+    {
+        input_dispatcher,           ///< DefaultInputDeviceHub and Seat have processed the event
+        surface_input_dispatcher,   ///< Filters and key repeat passed, about to pick a target surface
+        event_sender,               ///< EventSender has written the event to the client socket
+        client,                     ///< Client event handler invoked
+        count
+    };
+
+    static char const* name_of(Stage stage);
+
+    explicit LatencyRecorder(size_t expected_events);
+
+    /// Records the latency of event at stage if it is one that was injected by the benchmark
+    void record(Stage stage, MirEvent const& event);
+
+    /// Number of events that have reached stage
+    size_t count(Stage stage) const;
+
+    /// Latencies recorded for stage, sorted ascending
+    std::vector<std::chrono::nanoseconds> sorted_latencies(Stage stage) const;
+
+private:
+    struct Samples
+    {
+        std::mutex mutex;
+        std::vector<std::chrono::nanoseconds> latencies;
+    };
+
+    std::array<Samples, static_cast<size_t>(Stage::count)> mutable stages;
+};
+
+#endif // LATENCY_RECORDER_H_
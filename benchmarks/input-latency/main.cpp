@@ -0,0 +1,263 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "input_receiving_client.h"
+#include "latency_measuring_server.h"
+#include "latency_recorder.h"
+
+#include "mir_test_framework/executable_path.h"
+#include "mir_test_framework/fake_input_device.h"
+#include "mir_test_framework/server_runner.h"
+#include "mir_test_framework/stub_server_platform_factory.h"
+#include "mir_test_framework/temporary_environment_value.h"
+#include "mir/input/input_device_info.h"
+#include "mir/test/barrier.h"
+#include "mir/test/event_factory.h"
+
+#include <gtest/gtest.h>
+
+#include <linux/input.h>
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace geom = mir::geometry;
+namespace mi = mir::input;
+namespace mis = mir::input::synthesis;
+namespace mtf = mir_test_framework;
+namespace mt = mir::test;
+
+namespace
+{
+/*
+ * Parameters are read from the environment so that the same binary can be
+ * driven from a CI script, e.g.
+ *   INPUT_LATENCY_RATE=0 INPUT_LATENCY_EVENTS=20000 mir_input_latency_benchmark
+ * INPUT_LATENCY_RATE is in events per second; zero injects as fast as
+ * possible to find the throughput ceiling of the input path.
+ * Each test appends one JSON object per line to INPUT_LATENCY_OUTPUT (or
+ * writes it to stdout if that is unset).
+ */
+unsigned int parameter(char const* name, unsigned int default_value)
+{
+    if (auto const value = getenv(name))
+        return std::stoul(value);
+    return default_value;
+}
+
+std::chrono::nanoseconds percentile(std::vector<std::chrono::nanoseconds> const& sorted, double p)
+{
+    if (sorted.empty())
+        return std::chrono::nanoseconds::zero();
+
+    auto const index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+double in_us(std::chrono::nanoseconds value)
+{
+    return value.count() / 1000.0;
+}
+
+geom::Size const display_size{1024, 768};
+
+struct InputLatency : testing::Test, mtf::ServerRunner
+{
+    InputLatency() :
+        events{parameter("INPUT_LATENCY_EVENTS", 2000)},
+        rate{parameter("INPUT_LATENCY_RATE", 1000)},
+        recorder{std::make_shared<LatencyRecorder>(events)},
+        server_configuration{{{{0, 0}, display_size}}, recorder},
+        client{display_size, recorder, client_ready}
+    {
+        // Ensure we load the correct platform libraries
+        setenv("MIR_CLIENT_PLATFORM_PATH",
+               (mtf::library_path() + "/client-modules").c_str(),
+               true);
+    }
+
+    mir::DefaultServerConfiguration& server_config() override
+    {
+        return server_configuration;
+    }
+
+    void SetUp() override
+    {
+        start_server();
+        server_configuration.tap_surface_input_dispatcher();
+
+        client_thread = std::thread{
+            [this, connect_string = new_connection()]
+            {
+                try
+                {
+                    client.run(connect_string);
+                }
+                catch (...)
+                {
+                    client_failure = std::current_exception();
+                    client_ready.ready();
+                }
+            }};
+
+        client_ready.ready();
+        if (client_failure)
+            std::rethrow_exception(client_failure);
+    }
+
+    void TearDown() override
+    {
+        client.stop();
+        if (client_thread.joinable())
+            client_thread.join();
+
+        stop_server();
+    }
+
+    /// Injects events at the configured rate, then reports once the client has seen them all
+    void measure(char const* kind, std::function<void(unsigned int)> const& inject)
+    {
+        using clock = std::chrono::steady_clock;
+        auto const interval = rate ?
+            std::chrono::duration_cast<clock::duration>(std::chrono::seconds{1}) / rate :
+            clock::duration::zero();
+
+        auto const start = clock::now();
+        auto next_event = start;
+
+        for (auto i = 0u; i != events; ++i)
+        {
+            inject(i);
+
+            if (interval != clock::duration::zero())
+            {
+                next_event += interval;
+                std::this_thread::sleep_until(next_event);
+            }
+        }
+        auto const injected = clock::now();
+
+        auto const deadline = injected + std::chrono::seconds{10};
+        while (recorder->count(LatencyRecorder::Stage::client) < events && clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        auto const delivered = clock::now();
+
+        report(kind,
+            std::chrono::duration<double>(injected - start).count(),
+            std::chrono::duration<double>(delivered - start).count());
+
+        EXPECT_GE(recorder->count(LatencyRecorder::Stage::client), events);
+    }
+
+    void report(char const* kind, double injection_seconds, double delivery_seconds)
+    {
+        std::ofstream file;
+        if (auto const path = getenv("INPUT_LATENCY_OUTPUT"))
+            file.open(path, std::ios::app);
+        std::ostream& out = file.is_open() ? file : std::cout;
+
+        auto const delivered = recorder->count(LatencyRecorder::Stage::client);
+
+        out << "{\"kind\": \"" << kind << "\""
+            << ", \"events\": " << events
+            << ", \"rate\": " << rate
+            << ", \"injected_per_second\": " << events / injection_seconds
+            << ", \"delivered_per_second\": " << delivered / delivery_seconds
+            << ", \"latency_us\": {";
+
+        for (auto i = 0u; i != static_cast<unsigned>(LatencyRecorder::Stage::count); ++i)
+        {
+            auto const stage = static_cast<LatencyRecorder::Stage>(i);
+            auto const latencies = recorder->sorted_latencies(stage);
+
+            out << (i ? ", " : "")
+                << "\"" << LatencyRecorder::name_of(stage) << "\": {"
+                << "\"count\": " << latencies.size()
+                << ", \"p50\": " << in_us(percentile(latencies, 50))
+                << ", \"p90\": " << in_us(percentile(latencies, 90))
+                << ", \"p99\": " << in_us(percentile(latencies, 99))
+                << ", \"max\": " << in_us(percentile(latencies, 100))
+                << "}";
+        }
+
+        out << "}}" << std::endl;
+    }
+
+    unsigned int const events;
+    unsigned int const rate;
+    std::shared_ptr<LatencyRecorder> const recorder;
+
+    // Key repeat would add events we did not inject
+    mtf::TemporaryEnvironmentValue const disable_key_repeat{"MIR_SERVER_ENABLE_KEY_REPEAT", "false"};
+    LatencyMeasuringServer server_configuration;
+
+    mt::Barrier client_ready{2};
+    InputReceivingClient client;
+    std::thread client_thread;
+    std::exception_ptr client_failure;
+};
+}
+
+TEST_F(InputLatency, key_events)
+{
+    auto const keyboard = mtf::add_fake_input_device(
+        mi::InputDeviceInfo{"keyboard", "keyboard-uid", mi::DeviceCapability::keyboard});
+
+    measure("key",
+        [&](unsigned int i)
+        {
+            keyboard->emit_event(mis::a_key_down_event()
+                .of_scancode(KEY_A)
+                .with_action(i % 2 ? mis::EventAction::Up : mis::EventAction::Down));
+        });
+}
+
+TEST_F(InputLatency, pointer_events)
+{
+    auto const mouse = mtf::add_fake_input_device(
+        mi::InputDeviceInfo{"mouse", "mouse-uid", mi::DeviceCapability::pointer});
+
+    measure("pointer",
+        [&](unsigned int i)
+        {
+            mouse->emit_event(mis::a_pointer_event().with_movement(i % 2 ? -1 : 1, 0));
+        });
+}
+
+TEST_F(InputLatency, touch_events)
+{
+    auto const touch_screen = mtf::add_fake_input_device(
+        mi::InputDeviceInfo{"touch screen", "touch-screen-uid",
+            mi::DeviceCapability::touchscreen | mi::DeviceCapability::multitouch});
+
+    auto const last = events - 1;
+    measure("touch",
+        [&](unsigned int i)
+        {
+            auto const action = i == 0 ? mis::TouchParameters::Action::Tap :
+                                i == last ? mis::TouchParameters::Action::Release :
+                                mis::TouchParameters::Action::Move;
+
+            touch_screen->emit_event(mis::a_touch_event()
+                .with_action(action)
+                .at_position({100 + static_cast<int>(i % 2), 100}));
+        });
+}
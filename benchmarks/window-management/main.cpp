@@ -0,0 +1,323 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test_window_manager_tools.h"
+
+#include <miral/workspace_policy.h>
+#include <miral/window_manager_tools.h>
+
+#include <mir/events/event_builders.h>
+#include <mir/geometry/rectangle.h>
+#include <mir_toolkit/events/event.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+using namespace mir::geometry;
+using namespace std::chrono_literals;
+using miral::WindowManagerTools;
+
+namespace
+{
+/*
+ * Parameters are read from the environment, e.g.
+ *   WINDOW_MANAGEMENT_WINDOWS=5000 mir_window_management_benchmark
+ * Each test appends one JSON object per line to WINDOW_MANAGEMENT_OUTPUT
+ * (or writes it to stdout if that is unset).
+ */
+unsigned int parameter(char const* name, unsigned int default_value)
+{
+    if (auto const value = getenv(name))
+        return std::stoul(value);
+    return default_value;
+}
+
+using Durations = std::vector<std::chrono::nanoseconds>;
+
+std::chrono::nanoseconds percentile(Durations sorted, double p)
+{
+    if (sorted.empty())
+        return std::chrono::nanoseconds::zero();
+
+    std::sort(sorted.begin(), sorted.end());
+    auto const index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+double in_us(std::chrono::nanoseconds value)
+{
+    return value.count() / 1000.0;
+}
+
+template<typename Operation>
+std::chrono::nanoseconds time(Operation const& operation)
+{
+    auto const start = std::chrono::steady_clock::now();
+    operation();
+    return std::chrono::steady_clock::now() - start;
+}
+
+Rectangle const display_area{{0, 0}, {1920, 1080}};
+Size const window_size{400, 300};
+
+/// Stands in for the scene: keeps the surfaces in z-order for hit testing
+struct StackingFocusController : StubFocusController
+{
+    void add(std::shared_ptr<mir::scene::Surface> const& surface)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stack.push_back(surface);
+    }
+
+    void raise(mir::shell::SurfaceSet const& surfaces) override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        std::stable_partition(begin(stack), end(stack),
+            [&](std::weak_ptr<mir::scene::Surface> const& surface) { return !surfaces.count(surface); });
+    }
+
+    auto surface_at(Point cursor) const -> std::shared_ptr<mir::scene::Surface> override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto i = stack.rbegin(); i != stack.rend(); ++i)
+        {
+            if (auto const surface = i->lock())
+            {
+                if (Rectangle{surface->top_left(), surface->size()}.contains(cursor))
+                    return surface;
+            }
+        }
+        return {};
+    }
+
+    std::mutex mutable mutex;
+    std::vector<std::weak_ptr<mir::scene::Surface>> stack;
+};
+
+/// Click to focus, with new windows dealt round the workspaces and tiled over the display
+struct BenchmarkPolicy : miral::CanonicalWindowManagerPolicy, miral::WorkspacePolicy
+{
+    BenchmarkPolicy(WindowManagerTools const& tools, unsigned int workspace_count) :
+        CanonicalWindowManagerPolicy{tools},
+        workspace_count{workspace_count}
+    {
+    }
+
+    auto place_new_window(miral::ApplicationInfo const& app_info, miral::WindowSpecification const& request)
+    -> miral::WindowSpecification override
+    {
+        auto result = CanonicalWindowManagerPolicy::place_new_window(app_info, request);
+
+        auto const n = windows_placed++;
+        result.top_left() = Point{(n * 97) % (display_area.size.width.as_int() - 100),
+                                  (n * 61) % (display_area.size.height.as_int() - 100)};
+        return result;
+    }
+
+    void advise_new_window(miral::WindowInfo const& window_info) override
+    {
+        while (workspaces.size() < workspace_count)
+            workspaces.push_back(tools.create_workspace());
+
+        tools.add_tree_to_workspace(window_info.window(), workspaces[windows_added++ % workspace_count]);
+    }
+
+    bool handle_pointer_event(MirPointerEvent const* event) override
+    {
+        Point const cursor{
+            mir_pointer_event_axis_value(event, mir_pointer_axis_x),
+            mir_pointer_event_axis_value(event, mir_pointer_axis_y)};
+
+        auto const window = tools.window_at(cursor);
+
+        if (mir_pointer_event_action(event) == mir_pointer_action_button_down && window)
+            tools.select_active_window(window);
+
+        return false;
+    }
+
+    bool handle_keyboard_event(MirKeyboardEvent const*) override { return false; }
+    bool handle_touch_event(MirTouchEvent const*) override { return false; }
+
+    unsigned int const workspace_count;
+    std::vector<std::shared_ptr<miral::Workspace>> workspaces;
+    int windows_placed{0};
+    unsigned int windows_added{0};
+};
+
+struct WindowManagement : testing::Test
+{
+    WindowManagement()
+    {
+        for (auto i = 0u; i != application_count; ++i)
+            sessions.push_back(std::make_shared<StubStubSession>());
+    }
+
+    void SetUp() override
+    {
+        window_manager.add_display_for_testing(display_area);
+
+        for (auto const& session : sessions)
+            window_manager.add_session(session);
+    }
+
+    /// Adds a window, taking build_delay to create the surface as allocating buffers would
+    void add_window(std::chrono::microseconds build_delay = 0us)
+    {
+        auto const& session = sessions[windows_created++ % sessions.size()];
+
+        mir::scene::SurfaceCreationParameters params;
+        params.type = mir_window_type_normal;
+        params.size = window_size;
+
+        window_manager.add_surface(session, params,
+            [&](std::shared_ptr<mir::scene::Session> const& session, mir::scene::SurfaceCreationParameters const& params)
+            {
+                if (build_delay != 0us)
+                    std::this_thread::sleep_for(build_delay);
+
+                auto const id = TestWindowManagerTools::create_surface(session, params);
+                focus_controller.add(session->surface(id));
+                return id;
+            });
+    }
+
+    void pointer_event(Point position, MirPointerAction action)
+    {
+        static std::vector<uint8_t> const no_cookie;
+        auto const event = mir::events::make_event(
+            MirInputDeviceId{0}, std::chrono::steady_clock::now().time_since_epoch(), no_cookie,
+            mir_input_event_modifier_none, action,
+            action == mir_pointer_action_button_down ? MirPointerButtons{mir_pointer_button_primary} : MirPointerButtons{0},
+            position.x.as_int(), position.y.as_int(), 0, 0, 0, 0);
+
+        window_manager.handle_pointer_event(
+            mir_input_event_get_pointer_event(mir_event_get_input_event(event.get())));
+    }
+
+    /// Moves the pointer to random places, clicking on one event in ten
+    auto pointer_events(unsigned int count) -> Durations
+    {
+        std::uniform_int_distribution<int> x{0, display_area.size.width.as_int() - 1};
+        std::uniform_int_distribution<int> y{0, display_area.size.height.as_int() - 1};
+
+        Durations result;
+        result.reserve(count);
+
+        for (auto i = 0u; i != count; ++i)
+        {
+            Point const position{x(random), y(random)};
+            auto const action = i % 10 ? mir_pointer_action_motion : mir_pointer_action_button_down;
+            result.push_back(time([&]{ pointer_event(position, action); }));
+        }
+
+        return result;
+    }
+
+    void report(char const* kind, std::vector<std::pair<char const*, Durations>> const& measurements)
+    {
+        std::ofstream file;
+        if (auto const path = getenv("WINDOW_MANAGEMENT_OUTPUT"))
+            file.open(path, std::ios::app);
+        std::ostream& out = file.is_open() ? file : std::cout;
+
+        out << "{\"kind\": \"" << kind << "\""
+            << ", \"windows\": " << window_count
+            << ", \"workspaces\": " << workspace_count
+            << ", \"applications\": " << application_count
+            << ", \"latency_us\": {";
+
+        auto first = true;
+        for (auto const& measurement : measurements)
+        {
+            out << (first ? "" : ", ")
+                << "\"" << measurement.first << "\": {"
+                << "\"count\": " << measurement.second.size()
+                << ", \"p50\": " << in_us(percentile(measurement.second, 50))
+                << ", \"p99\": " << in_us(percentile(measurement.second, 99))
+                << ", \"max\": " << in_us(percentile(measurement.second, 100))
+                << "}";
+            first = false;
+        }
+
+        out << "}}" << std::endl;
+    }
+
+    unsigned int const window_count{parameter("WINDOW_MANAGEMENT_WINDOWS", 1000)};
+    unsigned int const workspace_count{parameter("WINDOW_MANAGEMENT_WORKSPACES", 20)};
+    unsigned int const application_count{parameter("WINDOW_MANAGEMENT_APPLICATIONS", 50)};
+    unsigned int const event_count{parameter("WINDOW_MANAGEMENT_EVENTS", 10000)};
+
+    StackingFocusController focus_controller;
+    StubDisplayLayout display_layout;
+    StubPersistentSurfaceStore persistent_surface_store;
+    StubDisplayConfigurationObserver display_configuration_observer;
+    std::vector<std::shared_ptr<StubStubSession>> sessions;
+    unsigned int windows_created{0};
+    std::mt19937 random{42};
+
+    miral::BasicWindowManager window_manager{
+        &focus_controller,
+        mir::test::fake_shared(display_layout),
+        mir::test::fake_shared(persistent_surface_store),
+        display_configuration_observer,
+        [this](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
+            { return std::make_unique<BenchmarkPolicy>(tools, workspace_count); }};
+};
+}
+
+TEST_F(WindowManagement, window_creation_and_pointer_events)
+{
+    Durations creation;
+    for (auto i = 0u; i != window_count; ++i)
+        creation.push_back(time([&]{ add_window(); }));
+
+    auto const pointer = pointer_events(event_count);
+
+    report("steady_state", {{"add_surface", creation}, {"pointer_event", pointer}});
+}
+
+TEST_F(WindowManagement, pointer_events_during_window_creation_storm)
+{
+    for (auto i = 0u; i != window_count; ++i)
+        add_window();
+
+    // Session restore: a burst of clients each creating windows (with buffers to allocate)
+    std::atomic<bool> done{false};
+    Durations creation;
+    std::thread storm{[&]
+        {
+            while (!done)
+                creation.push_back(time([&]{ add_window(200us); }));
+        }};
+
+    auto const pointer = pointer_events(event_count);
+
+    done = true;
+    storm.join();
+
+    report("creation_storm", {{"add_surface", creation}, {"pointer_event", pointer}});
+}
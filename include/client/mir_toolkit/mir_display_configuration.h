@@ -618,6 +618,46 @@ uint8_t const* mir_output_get_edid(MirOutput const* output);
  */
 size_t mir_output_get_edid_size(MirOutput const* output);
 
+/**
+ * Determine whether the output supports Adaptive Sync (also known as
+ * variable refresh rate, FreeSync or G-Sync): showing each frame as soon as
+ * it is posted, within the range of mir_output_get_adaptive_sync_range().
+ *
+ * \param [in]  output  The MirOutput to query
+ * \returns     Whether the output supports Adaptive Sync
+ */
+bool mir_output_is_adaptive_sync_supported(MirOutput const* output);
+
+/**
+ * Get the range of refresh rates, in Hz, that Adaptive Sync can vary
+ * between on the output.
+ *
+ * When Adaptive Sync is enabled the refresh rate reported to windows on the
+ * output is the top of this range, so clients render as fast as it allows.
+ *
+ * \param [in]  output  The MirOutput to query
+ * \param [out] min_hz  The lowest refresh rate, or 0 if unsupported
+ * \param [out] max_hz  The highest refresh rate, or 0 if unsupported
+ */
+void mir_output_get_adaptive_sync_range(MirOutput const* output, double* min_hz, double* max_hz);
+
+/**
+ * Determine whether Adaptive Sync is enabled on the output.
+ *
+ * \param [in]  output  The MirOutput to query
+ * \returns     Whether Adaptive Sync is enabled (and supported)
+ */
+bool mir_output_is_adaptive_sync_enabled(MirOutput const* output);
+
+/**
+ * Enable or disable Adaptive Sync on the output. This has no effect on
+ * outputs that don't support it.
+ *
+ * \param [in] output   The output to modify
+ * \param [in] enabled  Whether to enable Adaptive Sync
+ */
+void mir_output_set_adaptive_sync(MirOutput* output, bool enabled);
+
 /**
  * Get the width, in pixels, of a MirOutputMode
  *
@@ -23,6 +23,8 @@
 #include "mir/mir_render_surface.h"
 #include "mir/geometry/size.h"
 
+#include <string>
+
 namespace mir
 {
 namespace client
@@ -45,6 +47,8 @@ public:
         mir::geometry::Size size, uint32_t native_format, uint32_t native_flags,
         MirBufferCallback callback, void* context) = 0;
     virtual void release_buffer(mir::client::MirBuffer* buffer) = 0;
+    /// The client platform module the server named for its platform, or ""
+    virtual std::string client_platform_module() = 0;
 
 protected:
     ClientContext() = default;
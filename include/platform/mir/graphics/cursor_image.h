@@ -23,6 +23,8 @@
 #include "mir/geometry/size.h"
 #include "mir/geometry/displacement.h"
 
+#include <chrono>
+
 namespace mir
 {
 namespace graphics
@@ -39,7 +41,13 @@ public:
     // which should be placed at the onscreen
     // location of the pointer.
     virtual geometry::Displacement hotspot() const = 0;
-    
+
+    // Animated cursors have several frames, each shown for its delay()
+    // before moving on to the next (and back to the first after the last).
+    // Frame 0 is this image; a cursor that isn't animated has only that.
+    virtual unsigned int frame_count() const { return 1; }
+    virtual CursorImage const& frame(unsigned int /*index*/) const { return *this; }
+    virtual std::chrono::milliseconds delay(unsigned int /*index*/) const { return std::chrono::milliseconds{0}; }
 
 protected:
     CursorImage() = default;
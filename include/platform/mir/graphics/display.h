@@ -71,6 +71,8 @@ public:
     /** Post the content of the DisplayBuffers associated with this DisplaySyncGroup.
      *  The content of all the DisplayBuffers in this DisplaySyncGroup are guaranteed to be onscreen
      *  in the near future. On some platforms, this may wait a potentially long time for vsync. 
+     *  DisplayBuffers the compositor had no need to render since the last post() keep
+     *  their previous content.
     **/
     virtual void post() = 0;
 
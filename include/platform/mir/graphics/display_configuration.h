@@ -135,6 +135,19 @@ struct DisplayConfigurationOutput
 
     mir::optional_value<geometry::Size> custom_logical_size;
 
+    /** Whether the output can vary its refresh to match when frames are
+        posted (adaptive sync / VRR), within [min_vrr_hz, max_vrr_hz] */
+    bool vrr_capable = false;
+    double min_vrr_hz = 0.0;
+    double max_vrr_hz = 0.0;
+    /** Whether adaptive sync is in use; only honoured if vrr_capable */
+    bool vrr_enabled = false;
+
+    /** The refresh range frames may be presented at: the adaptive sync range
+        if that is in use, otherwise just the current mode's refresh rate */
+    double min_refresh_hz() const;
+    double max_refresh_hz() const;
+
     /** The logical rectangle occupied by the output, based on its position,
         current mode and orientation (rotation) */
     geometry::Rectangle extents() const;
@@ -178,6 +191,10 @@ struct UserDisplayConfigurationOutput
     MirOutputGammaSupported const& gamma_supported;
     std::vector<uint8_t const> const& edid;
     mir::optional_value<geometry::Size>& custom_logical_size;
+    bool const& vrr_capable;
+    double const& min_vrr_hz;
+    double const& max_vrr_hz;
+    bool& vrr_enabled;
 
     UserDisplayConfigurationOutput(DisplayConfigurationOutput& master);
     geometry::Rectangle extents() const;
@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_OVERLAY_PLANES_H_
+#define MIR_GRAPHICS_OVERLAY_PLANES_H_
+
+#include <mir/graphics/renderable.h>
+
+namespace mir
+{
+namespace graphics
+{
+
+/**
+ * Optional interface of a NativeDisplayBuffer whose hardware can scan some
+ * renderables out on planes of their own, leaving the rest to be rendered.
+ */
+class OverlayPlanes
+{
+public:
+    /**
+     * A finer grained DisplayBuffer::overlay(): the hardware may take on
+     * just part of renderlist.
+     *  \param [in] renderlist
+     *      The renderables that should appear on the screen.
+     *  \param [out] remainder
+     *      The renderables, in their original order, that the caller must
+     *      still render using a graphics library. The hardware shows
+     *      everything else above the rendered result.
+     *  \returns
+     *      True if the hardware has taken on the whole list, and nothing
+     *      needs rendering (as for DisplayBuffer::overlay());
+     *      False if remainder must be rendered.
+     */
+    virtual bool overlay(RenderableList const& renderlist, RenderableList& remainder) = 0;
+
+protected:
+    OverlayPlanes() = default;
+    virtual ~OverlayPlanes() = default;
+    OverlayPlanes(OverlayPlanes const&) = delete;
+    OverlayPlanes& operator=(OverlayPlanes const&) = delete;
+};
+
+}
+}
+
+#endif /* MIR_GRAPHICS_OVERLAY_PLANES_H_ */
@@ -41,6 +41,11 @@ struct PlatformIPCPackage
     std::vector<int32_t> ipc_fds;
 
     ModuleProperties const* graphics_module;
+
+    /// The client platform module that understands this package, named as
+    /// its file is without the ".so" suffix (e.g. "mesa"). Clients load it
+    /// directly instead of probing every module. May be null.
+    char const* client_module{nullptr};
 };
 
 }
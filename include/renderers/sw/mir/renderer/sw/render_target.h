@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDER_TARGET_H_
+#define MIR_RENDERER_SW_RENDER_TARGET_H_
+
+#include "mir/geometry/size.h"
+#include "mir/geometry/dimensions.h"
+#include "mir_toolkit/common.h"
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/** A frame buffer mapped for CPU writes */
+struct WritableFrame
+{
+    unsigned char* pixels;
+    geometry::Size size;
+    geometry::Stride stride;
+    MirPixelFormat format;
+};
+
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() = default;
+
+    /**
+     * Maps the buffer that the next frame is to be drawn into.
+     * The mapping remains valid until swap_buffers() is called.
+     */
+    virtual WritableFrame map_back_buffer() = 0;
+    /**
+     * Finishes the frame drawn into the buffer returned by map_back_buffer(),
+     * making it the one the next post() shows.
+     */
+    virtual void swap_buffers() = 0;
+
+protected:
+    RenderTarget() = default;
+    RenderTarget(RenderTarget const&) = delete;
+    RenderTarget& operator=(RenderTarget const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_RENDER_TARGET_H_ */
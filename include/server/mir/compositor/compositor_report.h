@@ -21,6 +21,8 @@
 
 #include "mir/graphics/renderable.h"
 
+#include <cstddef>
+
 namespace mir
 {
 namespace compositor
@@ -35,6 +37,12 @@ public:
     virtual void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) = 0;
     virtual void rendered_frame(SubCompositorId id) = 0;
     virtual void finished_frame(SubCompositorId id) = 0;
+    /// Frame arena usage: bytes allocated, and how many blocks that took from the heap
+    /// (optional, so that existing reports needn't implement it)
+    virtual void allocations_in_frame(SubCompositorId /*id*/, size_t /*arena_bytes*/, size_t /*heap_allocations*/) {}
+    /// The deepest buffer queue among the surfaces a display buffer shows, after each post
+    /// (optional, as above)
+    virtual void frames_pending(SubCompositorId /*id*/, int /*pending*/) {}
     virtual void started() = 0;
     virtual void stopped() = 0;
     virtual void scheduled() = 0;
@@ -72,6 +72,7 @@ class SeatObserver;
 class Fd;
 class MainLoop;
 class ServerStatusListener;
+class ThreadScheduler;
 
 enum class OptionType
 {
@@ -304,6 +305,10 @@ public:
     /// Sets an override functor for creating the persistent_surface_store
     void override_the_persistent_surface_store(Builder<shell::PersistentSurfaceStore> const& persistent_surface_store);
 
+    /// Sets an override functor for creating the thread scheduler.
+    /// (This controls the priority and CPU affinity of compositor and input threads.)
+    void override_the_thread_scheduler(Builder<ThreadScheduler> const& thread_scheduler_builder);
+
     /// Each of the wrap functions takes a wrapper functor of the same form
     template<typename T> using Wrapper = std::function<std::shared_ptr<T>(std::shared_ptr<T> const&)>;
 
@@ -417,6 +422,9 @@ public:
     /// \return the persistent surface store
     auto the_persistent_surface_store() const -> std::shared_ptr<shell::PersistentSurfaceStore>;
 
+    /// \return the thread scheduler
+    auto the_thread_scheduler() const -> std::shared_ptr<ThreadScheduler>;
+
     /// \return a registrar to add and remove DisplayConfigurationChangeObservers
     auto the_display_configuration_observer_registrar() const ->
         std::shared_ptr<ObserverRegistrar<graphics::DisplayConfigurationObserver>>;
@@ -0,0 +1,47 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_THREAD_SCHEDULER_H_
+#define MIR_THREAD_SCHEDULER_H_
+
+#include <string>
+
+namespace mir
+{
+
+/// Sets the scheduling class, priority and CPU affinity of Mir's latency
+/// sensitive threads. Each function is called on the thread concerned as it
+/// starts, so the implementation may act on the calling thread.
+class ThreadScheduler
+{
+public:
+    /// A compositing thread is starting for output (named as in "HDMI-1", "eDP-1"...)
+    virtual void compositor_thread_started(std::string const& output) = 0;
+
+    /// The input reading thread is starting
+    virtual void input_thread_started() = 0;
+
+protected:
+    ThreadScheduler() = default;
+    virtual ~ThreadScheduler() = default;
+    ThreadScheduler(ThreadScheduler const&) = delete;
+    ThreadScheduler& operator=(ThreadScheduler const&) = delete;
+};
+
+}
+
+#endif /* MIR_THREAD_SCHEDULER_H_ */
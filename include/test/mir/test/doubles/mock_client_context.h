@@ -37,6 +37,7 @@ struct MockClientContext : public client::ClientContext
         using namespace testing;
 
         EXPECT_CALL(*this, populate_server_package(_)).Times(AtLeast(0));
+        EXPECT_CALL(*this, client_platform_module()).Times(AtLeast(0));
     }
 
     MOCK_METHOD1(populate_server_package, void(MirPlatformPackage&));
@@ -46,6 +47,7 @@ struct MockClientContext : public client::ClientContext
     MOCK_METHOD4(allocate_buffer, void(geometry::Size, MirPixelFormat, MirBufferCallback, void*));
     MOCK_METHOD5(allocate_buffer, void(geometry::Size, uint32_t, uint32_t, MirBufferCallback, void*));
     MOCK_METHOD1(release_buffer, void(mir::client::MirBuffer*));
+    MOCK_METHOD0(client_platform_module, std::string());
 };
 
 }
@@ -435,3 +435,24 @@ size_t mir_output_get_edid_size(MirOutput const* output)
     }
     return 0;
 }
+
+bool mir_output_is_adaptive_sync_supported(MirOutput const* output)
+{
+    return output->vrr_capable();
+}
+
+void mir_output_get_adaptive_sync_range(MirOutput const* output, double* min_hz, double* max_hz)
+{
+    *min_hz = output->vrr_capable() ? output->min_vrr_hz() : 0.0;
+    *max_hz = output->vrr_capable() ? output->max_vrr_hz() : 0.0;
+}
+
+bool mir_output_is_adaptive_sync_enabled(MirOutput const* output)
+{
+    return output->vrr_capable() && output->vrr_enabled();
+}
+
+void mir_output_set_adaptive_sync(MirOutput* output, bool enabled)
+{
+    output->set_vrr_enabled(enabled);
+}
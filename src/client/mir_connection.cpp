@@ -834,6 +834,20 @@ void MirConnection::populate_graphics_module(MirModuleProperties& properties)
     }
 }
 
+std::string MirConnection::client_platform_module()
+{
+    // connect_result is write-once: once it's valid, we don't need to lock
+    // to use it.
+    if (connect_done &&
+        !connect_result->has_error() &&
+        connect_result->has_platform())
+    {
+        return connect_result->platform().client_module();
+    }
+
+    return {};
+}
+
 MirDisplayConfiguration* MirConnection::create_copy_of_display_config()
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
@@ -135,6 +135,7 @@ public:
 
     void populate(MirPlatformPackage& platform_package);
     void populate_graphics_module(MirModuleProperties& properties) override;
+    std::string client_platform_module() override;
     MirDisplayConfiguration* create_copy_of_display_config();
     std::unique_ptr<mir::protobuf::DisplayConfiguration> snapshot_display_configuration() const;
     void available_surface_formats(MirPixelFormat* formats,
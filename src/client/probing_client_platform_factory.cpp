@@ -1,14 +1,39 @@
 #include "probing_client_platform_factory.h"
 #include "mir/client/client_platform.h"
+#include "mir/client/client_context.h"
 #include "mir/shared_library.h"
 #include "mir/shared_library_prober.h"
 #include "mir/shared_library_prober_report.h"
 
 #include <boost/exception/all.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
 #include <stdexcept>
 
 namespace mcl = mir::client;
 
+namespace
+{
+// The files in path that are versions of the module called name (as
+// "name.so" or "name.so.<ABI>"), newest first.
+std::vector<boost::filesystem::path> module_files_named(std::string const& path, std::string const& name)
+{
+    std::vector<boost::filesystem::path> result;
+
+    boost::system::error_code ec;
+    for (boost::filesystem::directory_iterator i{path, ec}, end; !ec && i != end; i.increment(ec))
+    {
+        auto const filename = i->path().filename().string();
+        if (filename == name + ".so" || filename.compare(0, name.size() + 4, name + ".so.") == 0)
+            result.push_back(i->path());
+    }
+
+    std::sort(result.begin(), result.end(), std::greater<boost::filesystem::path>{});
+    return result;
+}
+}
+
 mcl::ProbingClientPlatformFactory::ProbingClientPlatformFactory(
     std::shared_ptr<mir::SharedLibraryProberReport> const& rep,
     StringList const& force_libs,
@@ -64,8 +89,37 @@ mcl::ProbingClientPlatformFactory::create_client_platform(mcl::ClientContext* co
     }
     else
     {
-        for (auto const& path : platform_paths)
-            select_libraries_for_path(path, module_selector, *shared_library_prober_report);
+        // The server usually names the module for its platform: loading that
+        // first saves loading and probing every module on the path. If it's
+        // missing, or doesn't accept the connection, fall back to probing.
+        auto const named_module = context->client_platform_module();
+        if (!named_module.empty() && named_module.find('/') == std::string::npos)
+        {
+            for (auto const& path : platform_paths)
+            {
+                for (auto const& file : module_files_named(path, named_module))
+                {
+                    if (!platform_modules.empty())
+                        break;
+
+                    try
+                    {
+                        shared_library_prober_report->loading_library(file);
+                        module_selector(std::make_shared<mir::SharedLibrary>(file.string()));
+                    }
+                    catch (std::runtime_error const& err)
+                    {
+                        shared_library_prober_report->loading_failed(file, err);
+                    }
+                }
+            }
+        }
+
+        if (platform_modules.empty())
+        {
+            for (auto const& path : platform_paths)
+                select_libraries_for_path(path, module_selector, *shared_library_prober_report);
+        }
     }
 
     for (auto& module : platform_modules)
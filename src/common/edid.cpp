@@ -49,6 +49,23 @@ uint16_t Edid::product_code() const
     return le16toh(product_code_le);
 }
 
+bool Edid::get_refresh_range(unsigned& min_hz, unsigned& max_hz) const
+{
+    for (int d = 0; d < 4; ++d)
+    {
+        auto& desc = descriptor[d];
+        if (!desc.other.zero0 && desc.other.type == range_limits_descriptor)
+        {
+            // EDID 1.4 borrows the low bits of byte 4 to offset rates >255Hz
+            auto const offsets = desc.other.zero4;
+            min_hz = desc.other.text[0] + ((offsets & 0x3) == 0x3 ? 255 : 0);
+            max_hz = desc.other.text[1] + ((offsets & 0x2) ? 255 : 0);
+            return min_hz && min_hz <= max_hz;
+        }
+    }
+    return false;
+}
+
 size_t Edid::get_string(StringDescriptorType type, char str[14]) const
 {
     size_t len = 0;
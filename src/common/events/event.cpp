@@ -39,11 +39,31 @@
 
 namespace ml = mir::logging;
 
+namespace
+{
+/*
+ * Input events are copied for every surface they're delivered to, and are
+ * only a few dozen words: sizing the copy's first segment to fit (plus the
+ * root pointer) makes that one small allocation rather than a zeroed
+ * SUGGESTED_FIRST_SEGMENT_WORDS one. Anything added later (such as a drag
+ * and drop handle) just goes in a further segment.
+ */
+unsigned segment_words_for(mir::capnp::Event::Reader const& event)
+{
+    return static_cast<unsigned>(event.totalSize().wordCount) + 1;
+}
+
+mir::capnp::Event::Builder copy_root(::capnp::MessageBuilder& message, mir::capnp::Event::Reader const& event)
+{
+    message.setRoot(event);
+    return message.getRoot<mir::capnp::Event>();
+}
+}
+
 MirEvent::MirEvent(MirEvent const& e)
+    : message{segment_words_for(e.event.asReader())},
+      event{copy_root(message, e.event.asReader())}
 {
-    auto reader = e.event.asReader();
-    message.setRoot(reader);
-    event = message.getRoot<mir::capnp::Event>();
 }
 
 MirEvent& MirEvent::operator=(MirEvent const& e)
@@ -69,10 +89,14 @@ mir::EventUPtr MirEvent::deserialize(std::string const& bytes)
 
 std::string MirEvent::serialize(MirEvent const* event)
 {
-    std::string output;
-    auto flat_event = ::capnp::messageToFlatArray(const_cast<MirEvent*>(event)->message);
+    auto& message = const_cast<MirEvent*>(event)->message;
+
+    // Write straight into the result, rather than into a flat array to copy
+    std::string output(::capnp::computeSerializedSizeInWords(message) * sizeof(::capnp::word), '\0');
+    kj::ArrayOutputStream stream{kj::arrayPtr(reinterpret_cast<kj::byte*>(&output[0]), output.size())};
+    ::capnp::writeMessage(stream, message);
 
-    return {reinterpret_cast<char*>(flat_event.asBytes().begin()), flat_event.asBytes().size()};
+    return output;
 }
 
 MirEventType MirEvent::type() const
@@ -37,6 +37,8 @@ struct Edid
     size_t get_monitor_name(MonitorName str) const;
     size_t get_manufacturer(Manufacturer str) const;
     uint16_t product_code() const;
+    /* Vertical refresh range from the display range limits descriptor */
+    bool get_refresh_range(unsigned& min_hz, unsigned& max_hz) const;
 
 private:
     /* Pretty much every field in an EDID requires some kind of conversion
@@ -49,6 +51,8 @@ private:
         string_monitor_name = 0xfc,
     };
 
+    enum { range_limits_descriptor = 0xfd };
+
     size_t get_string(StringDescriptorType type, char str[14]) const;
 
     union Descriptor
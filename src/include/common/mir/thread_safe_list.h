@@ -20,35 +20,45 @@
 #ifndef MIR_THREAD_SAFE_LIST_H_
 #define MIR_THREAD_SAFE_LIST_H_
 
-#include "mir/recursive_read_write_mutex.h"
-
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace mir
 {
+namespace detail
+{
+/// Items whose callbacks are running on this thread (so that removing an item
+/// from its own callback doesn't wait for itself)
+inline std::vector<void const*>& thread_safe_list_items_in_use()
+{
+    static thread_local std::vector<void const*> items;
+    return items;
+}
+}
 
-/*
- * Requirements for type 'Element'
- *  - for_each():
- *    - copy-assignable
- *  - add():
- *    - copy-assignable
- *    - conversion to bool: indicates whether this is a valid element
- *  - remove(), remove_all():
- *    - copy-assignable
- *    - Element{}: default construction should create an invalid element
- *    - bool operator==: equality of elements
- *    - bool operator!=: inequality of elements
- *  - clear():
- *    - copy-assignable
- *    - Element{}: value initialization should create an invalid element
+/**
+ * A list that may be iterated while other threads add and remove elements.
+ *
+ * for_each() walks an immutable snapshot of the list and never waits for a
+ * lock: add() and remove() publish a new snapshot instead of changing the one
+ * being walked. Elements are skipped if they are null or removed.
+ *
+ * As with a locked list, once remove() returns the element is not in use
+ * on any other thread and will not be passed to f() again. An element may
+ * remove itself (or anything else) from within f().
  */
-
 template<class Element>
 class ThreadSafeList
 {
 public:
+    ThreadSafeList() = default;
+    ~ThreadSafeList();
+
     void add(Element const& element);
     void remove(Element const& element);
     unsigned int remove_all(Element const& element);
@@ -56,132 +66,263 @@ public:
     void for_each(std::function<void(Element const& element)> const& f);
 
 private:
-    struct ListItem
+    ThreadSafeList(ThreadSafeList const&) = delete;
+    ThreadSafeList& operator=(ThreadSafeList const&) = delete;
+
+    class Item
     {
-        ListItem() {}
-        RecursiveReadWriteMutex mutex;
-        Element element{};
-        std::atomic<ListItem*> next{nullptr};
+    public:
+        explicit Item(Element const& element) : element(element) {}
+
+        void call(std::function<void(Element const& element)> const& f);
+        void remove_and_wait();
+
+        Element element;
 
-        ~ListItem() { delete next.load(); }
-    } head;
+    private:
+        class InUse;
+
+        std::atomic<bool> removed_{false};
+        std::atomic<unsigned int> users{0};
+
+        // Only used to wait for users on other threads when removing
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    using Snapshot = std::vector<std::shared_ptr<Item>>;
+
+    template<typename Predicate>
+    auto remove_if(Predicate const& should_remove) -> std::vector<std::shared_ptr<Item>>;
+    void publish(std::lock_guard<std::mutex> const&, std::unique_ptr<Snapshot> next);
+    void reclaim(std::lock_guard<std::mutex> const&);
+
+    std::atomic<Snapshot const*> published{nullptr};
+
+    // Readers count themselves against the parity of the epoch they entered
+    // in. Snapshots retired during an epoch are freed once the readers of the
+    // epoch before it have all left, which happens even if readers overlap
+    // continuously (newcomers join the current epoch).
+    std::atomic<unsigned int> epoch{0};
+    std::atomic<unsigned int> readers[2] = {};
+    std::atomic<bool> reclaimable{false};
+
+    std::mutex writer_mutex;
+    std::unique_ptr<Snapshot> current;
+    std::vector<std::unique_ptr<Snapshot>> retired[2];
 };
 
 template<class Element>
-void ThreadSafeList<Element>::for_each(
-    std::function<void(Element const& element)> const& f)
+class ThreadSafeList<Element>::Item::InUse
 {
-    ListItem* current_item = &head;
-
-    while (current_item)
+public:
+    explicit InUse(Item& item) : item(item)
     {
-        RecursiveReadLock lock{current_item->mutex};
+        ++item.users;
+        detail::thread_safe_list_items_in_use().push_back(&item);
+    }
 
-        // We need to take a copy in case we recursively remove during call
-        if (auto const copy_of_element = current_item->element) f(copy_of_element);
+    ~InUse()
+    {
+        detail::thread_safe_list_items_in_use().pop_back();
+        --item.users;
 
-        current_item = current_item->next;
+        if (item.removed_)
+        {
+            std::lock_guard<std::mutex> lock{item.mutex};
+            item.cv.notify_all();
+        }
     }
+
+private:
+    InUse(InUse const&) = delete;
+    InUse& operator=(InUse const&) = delete;
+
+    Item& item;
+};
+
+template<class Element>
+void ThreadSafeList<Element>::Item::call(std::function<void(Element const& element)> const& f)
+{
+    InUse const in_use{*this};
+
+    if (removed_)
+        return;
+
+    // We need to take a copy in case we recursively remove during call
+    if (auto const copy_of_element = element) f(copy_of_element);
 }
 
 template<class Element>
-void ThreadSafeList<Element>::add(Element const& element)
+void ThreadSafeList<Element>::Item::remove_and_wait()
 {
-    ListItem* current_item = &head;
+    removed_ = true;
+
+    auto const& in_use = detail::thread_safe_list_items_in_use();
+    unsigned int const uses_on_this_thread = std::count(in_use.begin(), in_use.end(), this);
+
+    std::unique_lock<std::mutex> lock{mutex};
+    cv.wait(lock, [&]{ return users == uses_on_this_thread; });
+
+    // Nobody can read element now, and callers up the stack have their own copy
+    element = Element{};
+}
+
+template<class Element>
+ThreadSafeList<Element>::~ThreadSafeList() = default;
 
-    do
+template<class Element>
+void ThreadSafeList<Element>::for_each(
+    std::function<void(Element const& element)> const& f)
+{
+    // While we are counted as a reader no snapshot we might see is freed
+    struct Reader
     {
-        // Note: we release the read lock to avoid two threads calling add at
-        // the same time mutually blocking the other's upgrade to write lock.
+        explicit Reader(ThreadSafeList& list) : list(list)
         {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element) continue;
+            for (;;)
+            {
+                slot = list.epoch % 2;
+                ++list.readers[slot];
+                if (list.epoch % 2 == slot)
+                    break;
+                --list.readers[slot];
+            }
         }
 
-        RecursiveWriteLock lock{current_item->mutex};
-
-        if (!current_item->element)
+        ~Reader()
         {
-            current_item->element = element;
-            return;
+            // The last reader out frees what it can, but never waits for a writer
+            if (--list.readers[slot] == 0 && list.reclaimable && list.writer_mutex.try_lock())
+            {
+                std::lock_guard<std::mutex> const lock{list.writer_mutex, std::adopt_lock};
+                list.reclaim(lock);
+            }
         }
-    }
-    while (current_item->next && (current_item = current_item->next));
 
-    // No empty Items so append a new one
-    auto new_item = new ListItem;
-    new_item->element = element;
+        ThreadSafeList& list;
+        unsigned int slot;
+    } const reader{*this};
 
-    for (ListItem* expected{nullptr};
-        !current_item->next.compare_exchange_weak(expected, new_item);
-        expected = nullptr)
+    if (auto const snapshot = published.load())
     {
-        if (expected) current_item = expected;
+        for (auto const& item : *snapshot)
+            item->call(f);
     }
 }
 
+template<class Element>
+void ThreadSafeList<Element>::add(Element const& element)
+{
+    std::lock_guard<std::mutex> lock{writer_mutex};
+
+    auto next = current ? std::make_unique<Snapshot>(*current) : std::make_unique<Snapshot>();
+    next->push_back(std::make_shared<Item>(element));
+
+    publish(lock, std::move(next));
+}
+
 template<class Element>
 void ThreadSafeList<Element>::remove(Element const& element)
 {
-    ListItem* current_item = &head;
+    bool found{false};
 
-    do
-    {
+    auto const removed = remove_if([&](Element const& candidate)
         {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element != element) continue;
-        }
+            if (found || candidate != element)
+                return false;
 
-        RecursiveWriteLock lock{current_item->mutex};
+            return found = true;
+        });
 
-        if (current_item->element == element)
-        {
-            current_item->element = Element{};
-            return;
-        }
-    }
-    while ((current_item = current_item->next));
+    for (auto const& item : removed)
+        item->remove_and_wait();
 }
 
 template<class Element>
 unsigned int ThreadSafeList<Element>::remove_all(Element const& element)
 {
-    ListItem* current_item = &head;
-    auto removed = 0u;
+    auto const removed = remove_if([&](Element const& candidate) { return candidate == element; });
 
-    do
-    {
-        {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element != element) continue;
-        }
+    for (auto const& item : removed)
+        item->remove_and_wait();
 
-        RecursiveWriteLock lock{current_item->mutex};
+    return removed.size();
+}
 
-        if (current_item->element == element)
-        {
-            current_item->element = Element{};
-            ++removed;
-        }
+template<class Element>
+void ThreadSafeList<Element>::clear()
+{
+    auto const removed = remove_if([](Element const&) { return true; });
+
+    for (auto const& item : removed)
+        item->remove_and_wait();
+}
+
+template<class Element>
+template<typename Predicate>
+auto ThreadSafeList<Element>::remove_if(Predicate const& should_remove) -> std::vector<std::shared_ptr<Item>>
+{
+    std::vector<std::shared_ptr<Item>> removed;
+
+    // We don't wait for the removed items under the writer lock: their
+    // callbacks may add or remove other elements
+    std::lock_guard<std::mutex> lock{writer_mutex};
+
+    if (!current)
+        return removed;
+
+    auto next = std::make_unique<Snapshot>();
+    next->reserve(current->size());
+
+    for (auto const& item : *current)
+    {
+        if (should_remove(item->element))
+            removed.push_back(item);
+        else
+            next->push_back(item);
     }
-    while ((current_item = current_item->next));
+
+    if (!removed.empty())
+        publish(lock, std::move(next));
 
     return removed;
 }
 
 template<class Element>
-void ThreadSafeList<Element>::clear()
+void ThreadSafeList<Element>::publish(std::lock_guard<std::mutex> const& lock, std::unique_ptr<Snapshot> next)
 {
-    ListItem* current_item = &head;
-
-    do
+    if (current)
     {
-        RecursiveWriteLock lock{current_item->mutex};
-        current_item->element = Element{};
+        retired[epoch % 2].push_back(std::move(current));
+        reclaimable = true;
     }
-    while ((current_item = current_item->next));
+
+    current = std::move(next);
+    published = current.get();
+
+    reclaim(lock);
 }
 
+template<class Element>
+void ThreadSafeList<Element>::reclaim(std::lock_guard<std::mutex> const&)
+{
+    // Twice, so that with no readers both epochs' snapshots are freed
+    for (int i = 0; i != 2; ++i)
+    {
+        // The slot of the previous epoch, which the next epoch will reuse
+        auto const previous = (epoch + 1) % 2;
+
+        // A reader that might have loaded a snapshot retired then is still counted
+        if (readers[previous] != 0)
+            return;
+
+        retired[previous].clear();
+        ++epoch;
+    }
+
+    reclaimable = !retired[0].empty() || !retired[1].empty();
+}
 }
 
 #endif /* MIR_THREAD_SAFE_LIST_H_ */
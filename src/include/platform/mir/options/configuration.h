@@ -53,6 +53,13 @@ extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const composite_delay_opt;
 extern char const* const enable_key_repeat_opt;
+extern char const* const metrics_file_opt;
+extern char const* const compositor_thread_policy_opt;
+extern char const* const compositor_cpu_affinity_opt;
+extern char const* const compositor_latency_hint_opt;
+extern char const* const renderer_opt;
+extern char const* const input_thread_policy_opt;
+extern char const* const input_cpu_affinity_opt;
 
 extern char const* const name_opt;
 extern char const* const offscreen_opt;
@@ -62,6 +69,7 @@ extern char const* const enable_key_repeat_opt;
 extern char const* const off_opt_value;
 extern char const* const log_opt_value;
 extern char const* const lttng_opt_value;
+extern char const* const metrics_opt_value;
 
 extern char const* const platform_graphics_lib;
 extern char const* const platform_input_lib;
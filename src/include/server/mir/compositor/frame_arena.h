@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_COMPOSITOR_FRAME_ARENA_H_
+#define MIR_COMPOSITOR_FRAME_ARENA_H_
+
+#include <memory>
+#include <cstddef>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Memory for the objects a compositing thread creates to draw one frame:
+ * snapshots of surfaces, scene elements and the like.
+ *
+ * Allocation is a pointer bump in a block the arena already has. After
+ * post() the thread calls reset() and the next frame reuses the blocks, so
+ * that in steady state compositing needn't touch the (contended) global
+ * heap. Objects may outlive their frame, or be released on other threads:
+ * a block still in use when the arena is reset is only freed once the last
+ * object in it is.
+ *
+ * Only the owning thread allocates, and only while a Scope makes the arena
+ * current. Code that may run elsewhere should use make_frame_shared(),
+ * which falls back to the global heap.
+ */
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t block_size = 64 * 1024);
+    ~FrameArena();
+
+    void* allocate(size_t size, size_t alignment);
+    static void deallocate(void* pointer) noexcept;
+
+    /** Starts a new frame, reusing the blocks no longer in use */
+    void reset();
+
+    /** Bytes handed out since the last reset() */
+    size_t bytes_allocated() const;
+
+    /** Blocks taken from the global heap since the last reset() */
+    size_t heap_allocations() const;
+
+    /** \returns the arena current on the calling thread, if any */
+    static FrameArena* current();
+
+    /** Makes an arena current on the calling thread for its lifetime */
+    class Scope
+    {
+    public:
+        explicit Scope(FrameArena& arena);
+        ~Scope();
+
+    private:
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        FrameArena* const previous;
+    };
+
+private:
+    FrameArena(FrameArena const&) = delete;
+    FrameArena& operator=(FrameArena const&) = delete;
+
+    struct Block;
+    Block* new_block(size_t min_size);
+
+    size_t const block_size;
+    Block* blocks;
+    Block* spare;
+    size_t bytes;
+    size_t heap_blocks;
+};
+
+template<typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    explicit FrameAllocator(FrameArena& arena) : arena{&arena} {}
+
+    template<typename U>
+    FrameAllocator(FrameAllocator<U> const& other) : arena{other.arena} {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t)
+    {
+        FrameArena::deallocate(pointer);
+    }
+
+    template<typename U>
+    bool operator==(FrameAllocator<U> const& other) const { return arena == other.arena; }
+    template<typename U>
+    bool operator!=(FrameAllocator<U> const& other) const { return arena != other.arena; }
+
+private:
+    template<typename U> friend class FrameAllocator;
+    FrameArena* arena;
+};
+
+/**
+ * Like std::make_shared(), but from the current thread's FrameArena if it
+ * has one.
+ */
+template<typename T, typename... Args>
+std::shared_ptr<T> make_frame_shared(Args&&... args)
+{
+    if (auto const arena = FrameArena::current())
+        return std::allocate_shared<T>(FrameAllocator<T>{*arena}, std::forward<Args>(args)...);
+
+    return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_FRAME_ARENA_H_ */
@@ -31,6 +31,7 @@ namespace mir
 class ServerActionQueue;
 class SharedLibrary;
 class SharedLibraryProberReport;
+class ThreadScheduler;
 
 template<class Observer>
 class ObserverRegistrar;
@@ -158,6 +159,7 @@ namespace report
 {
 class ReportFactory;
 class Reports;
+namespace metrics { class Registry; }
 }
 
 namespace renderer
@@ -342,6 +344,8 @@ public:
     virtual std::shared_ptr<time::Clock> the_clock();
     virtual std::shared_ptr<ServerActionQueue> the_server_action_queue();
     virtual std::shared_ptr<SharedLibraryProberReport>  the_shared_library_prober_report();
+    virtual std::shared_ptr<report::metrics::Registry> the_metrics_registry();
+    virtual std::shared_ptr<ThreadScheduler> the_thread_scheduler();
 
 private:
     // We need to ensure the platform library is destroyed last as the
@@ -438,6 +442,7 @@ protected:
     CachedPtr<EmergencyCleanup> emergency_cleanup;
     CachedPtr<shell::HostLifecycleEventListener> host_lifecycle_event_listener;
     CachedPtr<shell::PersistentSurfaceStore> persistent_surface_store;
+    CachedPtr<ThreadScheduler> thread_scheduler;
     CachedPtr<SharedLibraryProberReport> shared_library_prober_report;
     CachedPtr<shell::Shell> shell;
     CachedPtr<shell::ShellReport> shell_report;
@@ -466,6 +471,7 @@ private:
 
     auto report_factory(char const* report_opt) -> std::unique_ptr<report::ReportFactory>;
     auto initialise_reports() -> std::shared_ptr<report::Reports>;
+    CachedPtr<report::metrics::Registry> metrics_registry;
 
     CachedPtr<shell::detail::FrontendShell> frontend_shell;
     std::vector<mir::ExtensionDescription> the_extensions();
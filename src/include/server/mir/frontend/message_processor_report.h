@@ -22,6 +22,7 @@
 
 #include "mir_toolkit/event.h"
 
+#include <cstddef>
 #include <string>
 
 namespace mir
@@ -37,6 +38,10 @@ public:
 
     virtual void received_invocation(void const* mediator, int id, std::string const& method) = 0;
 
+    /// The size of the invocation's serialized parameters
+    /// (optional, so that existing reports needn't implement it)
+    virtual void received_invocation_size(void const* /*mediator*/, int /*id*/, size_t /*bytes*/) {}
+
     virtual void completed_invocation(void const* mediator, int id, bool result) = 0;
 
     virtual void unknown_method(void const* mediator, int id, std::string const& method) = 0;
@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_THREAD_SCHEDULING_H_
+#define MIR_THREAD_SCHEDULING_H_
+
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace thread
+{
+struct SchedulingPolicy
+{
+    enum class Kind
+    {
+        unchanged,      ///< Leave the thread as created
+        nice,           ///< SCHED_OTHER with the given nice level
+        fifo,           ///< SCHED_FIFO with the given real-time priority
+        round_robin     ///< SCHED_RR with the given real-time priority
+    };
+
+    Kind kind{Kind::unchanged};
+    int priority{0};
+};
+
+/// Parses "" (unchanged), "nice:<level>", "fifo:<priority>" or "rr:<priority>"
+/// \throws std::invalid_argument if spec is not one of these
+auto parse_scheduling_policy(std::string const& spec) -> SchedulingPolicy;
+
+/// Parses a CPU list in the form used by taskset(1) and cpusets, e.g. "0,2-3"
+/// \throws std::invalid_argument if spec is malformed
+auto parse_cpu_list(std::string const& spec) -> std::vector<int>;
+
+/// These apply to the calling thread only and throw std::system_error on failure
+/// (typically EPERM when real-time scheduling or negative nice levels are not permitted)
+/// \{
+void apply_scheduling_policy(SchedulingPolicy const& policy);
+void apply_cpu_affinity(std::vector<int> const& cpus);
+
+/// The CPUs the calling thread may run on, e.g. to restore after apply_cpu_affinity()
+auto current_cpu_affinity() -> std::vector<int>;
+
+/// Asks the kernel to run this thread at high CPU frequency when it is runnable
+/// (utilization clamping, Linux 5.3 onwards)
+void request_latency_sensitive_frequency();
+/// \}
+}
+}
+
+#endif /* MIR_THREAD_SCHEDULING_H_ */
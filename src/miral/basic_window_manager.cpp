@@ -159,6 +159,12 @@ void miral::BasicWindowManager::add_session(std::shared_ptr<scene::Session> cons
 void miral::BasicWindowManager::remove_session(std::shared_ptr<scene::Session> const& session)
 {
     Locker lock{this};
+
+    // A surface built without the lock (see add_surface()) may have been
+    // registered after the shell removed the session's surfaces
+    while (!app_info[session].windows().empty())
+        remove_window(session, info_for(app_info[session].windows().back()));
+
     policy->advise_delete_app(app_info[session]);
     app_info.erase(session);
 }
@@ -169,19 +175,37 @@ auto miral::BasicWindowManager::add_surface(
     std::function<frontend::SurfaceId(std::shared_ptr<scene::Session> const& session, scene::SurfaceCreationParameters const& params)> const& build)
 -> frontend::SurfaceId
 {
-    Locker lock{this};
-
-    auto& session_info = info_for(session);
+    auto const spec = [&]
+        {
+            Locker lock{this};
+            auto& session_info = info_for(session);
+            return policy->place_new_window(session_info, place_new_surface(session_info, params));
+        }();
 
-    WindowSpecification const& spec = policy->place_new_window(session_info, place_new_surface(session_info, params));
+    // Building the surface allocates buffers and may be slow. It doesn't touch any window
+    // management state, so do it without blocking input handling and other windows.
     scene::SurfaceCreationParameters parameters;
     spec.update(parameters);
     auto const surface_id = build(session, parameters);
+
+    Locker lock{this};
+
+    // The session may have been closed while we were building
+    auto const session_info_it = app_info.find(session);
+    if (session_info_it == app_info.end())
+        return surface_id;
+
+    auto& session_info = session_info_it->second;
     Window const window{session, session->surface(surface_id)};
     auto& window_info = this->window_info.emplace(window, WindowInfo{window, spec}).first->second;
 
-    if (spec.parent().is_set() && spec.parent().value().lock())
-        window_info.parent(info_for(spec.parent().value()).window());
+    // The parent may have gone while we were building
+    if (spec.parent().is_set())
+    {
+        auto const parent_info = this->window_info.find(spec.parent().value());
+        if (parent_info != this->window_info.end() && spec.parent().value().lock())
+            window_info.parent(parent_info->second.window());
+    }
 
     if (spec.userdata().is_set())
         window_info.userdata() = spec.userdata().value();
@@ -237,7 +261,11 @@ void miral::BasicWindowManager::modify_surface(
     shell::SurfaceSpecification const& modifications)
 {
     Locker lock{this};
-    auto& info = info_for(surface);
+    auto const info_it = window_info.find(surface);
+    if (info_it == window_info.end())
+        return; // Still being built by add_surface()
+
+    auto& info = info_it->second;
     WindowSpecification mods{modifications};
     validate_modification_request(mods, info);
     place_and_size_for_state(mods, info);
@@ -249,7 +277,11 @@ void miral::BasicWindowManager::remove_surface(
     std::weak_ptr<scene::Surface> const& surface)
 {
     Locker lock{this};
-    remove_window(session, info_for(surface));
+
+    // A surface still being built by add_surface() isn't a window yet
+    auto const info = window_info.find(surface);
+    if (info != window_info.end())
+        remove_window(session, info->second);
 }
 
 void miral::BasicWindowManager::remove_window(Application const& application, miral::WindowInfo const& info)
@@ -401,8 +433,9 @@ void miral::BasicWindowManager::handle_raise_surface(
     uint64_t timestamp)
 {
     Locker lock{this};
-    if (timestamp >= last_input_event_timestamp)
-        policy->handle_raise_window(info_for(surface));
+    auto const info = window_info.find(surface);
+    if (timestamp >= last_input_event_timestamp && info != window_info.end())
+        policy->handle_raise_window(info->second);
 }
 
 #if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 27, 0)
@@ -412,8 +445,9 @@ void miral::BasicWindowManager::handle_request_drag_and_drop(
     uint64_t timestamp)
 {
     Locker lock{this};
-    if (timestamp >= last_input_event_timestamp)
-        policy2->handle_request_drag_and_drop(info_for(surface));
+    auto const info = window_info.find(surface);
+    if (timestamp >= last_input_event_timestamp && info != window_info.end())
+        policy2->handle_request_drag_and_drop(info->second);
 }
 
 void miral::BasicWindowManager::handle_request_move(
@@ -422,9 +456,10 @@ void miral::BasicWindowManager::handle_request_move(
     uint64_t timestamp)
 {
     std::lock_guard<decltype(mutex)> lock(mutex);
-    if (timestamp >= last_input_event_timestamp && last_input_event)
+    auto const info = window_info.find(surface);
+    if (timestamp >= last_input_event_timestamp && last_input_event && info != window_info.end())
     {
-        policy2->handle_request_move(info_for(surface), mir_event_get_input_event(last_input_event));
+        policy2->handle_request_move(info->second, mir_event_get_input_event(last_input_event));
     }
 }
 #endif
@@ -466,7 +501,11 @@ int miral::BasicWindowManager::set_surface_attribute(
     }
 
     Locker lock{this};
-    auto& info = info_for(surface);
+    auto const info_it = window_info.find(surface);
+    if (info_it == window_info.end())
+        return surface->query(attrib); // Still being built by add_surface()
+
+    auto& info = info_it->second;
 
     validate_modification_request(modification, info);
     place_and_size_for_state(modification, info);
@@ -585,8 +624,10 @@ void miral::BasicWindowManager::focus_next_application()
         return;
 
     // Last resort: accept wherever focus_controller placed focus
+    // (which may be a surface add_surface() hasn't registered yet)
     auto const focussed_surface = focus_controller->focused_surface();
-    select_active_window(focussed_surface ? info_for(focussed_surface).window() : Window{});
+    auto const focussed_info = focussed_surface ? window_info.find(focussed_surface) : window_info.end();
+    select_active_window(focussed_info != window_info.end() ? focussed_info->second.window() : Window{});
 }
 
 auto miral::BasicWindowManager::workspaces_containing(Window const& window) const
@@ -723,8 +764,16 @@ void miral::BasicWindowManager::focus_prev_within_application()
 auto miral::BasicWindowManager::window_at(geometry::Point cursor) const
 -> Window
 {
-    auto surface_at = focus_controller->surface_at(cursor);
-    return surface_at ? info_for(surface_at).window() : Window{};
+    // The scene keeps the surfaces in z-order: we only need to map the surface to its window.
+    // A surface still being built in add_surface() may not have a window yet.
+    if (auto const surface_at = focus_controller->surface_at(cursor))
+    {
+        auto const info = window_info.find(surface_at);
+        if (info != window_info.end())
+            return info->second.window();
+    }
+
+    return {};
 }
 
 auto miral::BasicWindowManager::active_output()
@@ -0,0 +1,217 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "binary_trace_writer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace mt = miral::trace;
+
+namespace
+{
+std::atomic<uint64_t> next_serial{1};
+
+auto round_up_to_power_of_two(unsigned int value) -> unsigned int
+{
+    unsigned int result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+auto now() -> uint64_t
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+// A single producer (the owning thread), single consumer (the flusher) queue
+struct miral::BinaryTraceWriter::Ring
+{
+    Ring(uint32_t thread, unsigned int capacity) : thread{thread}, records(capacity) {}
+
+    uint32_t const thread;
+    std::vector<mt::Record> records;
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+miral::BinaryTraceWriter::BinaryTraceWriter(
+    std::string const& filename,
+    std::chrono::milliseconds flush_interval,
+    unsigned int records_per_thread) :
+    serial{next_serial++},
+    flush_interval{flush_interval},
+    records_per_thread{round_up_to_power_of_two(records_per_thread)},
+    file{filename, std::ios::binary | std::ios::trunc}
+{
+    if (!file)
+        throw std::runtime_error("Failed to open window management trace file: " + filename);
+
+    mt::FileHeader header;
+    std::copy(std::begin(mt::magic), std::end(mt::magic), header.magic);
+    header.version = mt::version;
+    header.record_size = sizeof(mt::Record);
+    file.write(reinterpret_cast<char const*>(&header), sizeof header);
+
+    flusher = std::thread{[this]
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+
+            while (!stopping)
+            {
+                wakeup.wait_for(lock, this->flush_interval);
+                drain();
+            }
+
+            drain();
+        }};
+}
+
+miral::BinaryTraceWriter::~BinaryTraceWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+
+    wakeup.notify_all();
+    flusher.join();
+}
+
+void miral::BinaryTraceWriter::write(trace::Call call, std::initializer_list<uint64_t> args)
+{
+    auto& ring = ring_for_this_thread();
+
+    if (auto const record = next_record(ring))
+    {
+        record->call = call;
+        auto const count = std::min(args.size(), sizeof record->arg/sizeof record->arg[0]);
+        auto const end = std::copy_n(args.begin(), count, record->arg);
+        std::fill(end, std::end(record->arg), 0);
+        commit_record(ring);
+    }
+}
+
+void miral::BinaryTraceWriter::write_name(trace::Call call, uint64_t id, std::string const& name)
+{
+    auto& ring = ring_for_this_thread();
+
+    if (auto const record = next_record(ring))
+    {
+        record->call = call;
+        record->arg[0] = id;
+        auto const text = reinterpret_cast<char*>(&record->arg[1]);
+        std::memset(text, 0, mt::max_name_length);
+        name.copy(text, mt::max_name_length);
+        commit_record(ring);
+    }
+}
+
+void miral::BinaryTraceWriter::flush()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    drain();
+}
+
+auto miral::BinaryTraceWriter::ring_for_this_thread() -> Ring&
+{
+    // Only the first record a thread makes (for a given writer) needs the lock
+    thread_local uint64_t cached_serial{0};
+    thread_local Ring* cached_ring{nullptr};
+
+    if (cached_serial != serial)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        auto& ring = rings[std::this_thread::get_id()];
+        if (!ring)
+            ring = std::make_unique<Ring>(rings.size(), records_per_thread);
+
+        cached_serial = serial;
+        cached_ring = ring.get();
+    }
+
+    return *cached_ring;
+}
+
+auto miral::BinaryTraceWriter::next_record(Ring& ring) -> trace::Record*
+{
+    auto const head = ring.head.load(std::memory_order_relaxed);
+
+    if (head - ring.tail.load(std::memory_order_acquire) == ring.records.size())
+    {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto const record = &ring.records[head & (ring.records.size() - 1)];
+    record->timestamp = now();
+    record->thread = ring.thread;
+    record->reserved = 0;
+    return record;
+}
+
+void miral::BinaryTraceWriter::commit_record(Ring& ring)
+{
+    auto const head = ring.head.load(std::memory_order_relaxed) + 1;
+    ring.head.store(head, std::memory_order_release);
+
+    // Don't wait for the next interval if the buffer is getting full
+    if (head - ring.tail.load(std::memory_order_relaxed) == ring.records.size()/2)
+        wakeup.notify_one();
+}
+
+void miral::BinaryTraceWriter::drain()
+{
+    std::vector<mt::Record> batch;
+
+    for (auto const& entry : rings)
+    {
+        auto& ring = *entry.second;
+        auto const head = ring.head.load(std::memory_order_acquire);
+        auto const mask = ring.records.size() - 1;
+
+        for (auto tail = ring.tail.load(std::memory_order_relaxed); tail != head; ++tail)
+            batch.push_back(ring.records[tail & mask]);
+
+        ring.tail.store(head, std::memory_order_release);
+
+        if (auto const dropped = ring.dropped.exchange(0, std::memory_order_relaxed))
+        {
+            mt::Record record{};
+            record.timestamp = now();
+            record.thread = ring.thread;
+            record.call = mt::Call::dropped;
+            record.arg[0] = dropped;
+            batch.push_back(record);
+        }
+    }
+
+    // Each thread's records are already in order, interleave them
+    std::stable_sort(begin(batch), end(batch),
+        [](mt::Record const& lhs, mt::Record const& rhs) { return lhs.timestamp < rhs.timestamp; });
+
+    file.write(reinterpret_cast<char const*>(batch.data()), batch.size()*sizeof(mt::Record));
+    file.flush();
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIRAL_BINARY_TRACE_WRITER_H
+#define MIRAL_BINARY_TRACE_WRITER_H
+
+#include "window_management_trace_format.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace miral
+{
+/// Collects trace records from any number of threads and writes them to a file.
+///
+/// Each thread records into a ring buffer of its own without taking locks; a
+/// background thread empties the buffers into the file periodically. If a buffer
+/// fills before it is emptied further records are dropped (and the number dropped
+/// is recorded) rather than delaying the caller.
+class BinaryTraceWriter
+{
+public:
+    BinaryTraceWriter(
+        std::string const& filename,
+        std::chrono::milliseconds flush_interval = std::chrono::milliseconds{100},
+        unsigned int records_per_thread = 4096);
+
+    /// Writes out any outstanding records
+    ~BinaryTraceWriter();
+
+    /// Record a call with up to six arguments
+    void write(trace::Call call, std::initializer_list<uint64_t> args);
+
+    /// Record the name of a window or application
+    void write_name(trace::Call call, uint64_t id, std::string const& name);
+
+    /// Write out all records made so far
+    void flush();
+
+private:
+    struct Ring;
+
+    auto ring_for_this_thread() -> Ring&;
+    auto next_record(Ring& ring) -> trace::Record*;
+    void commit_record(Ring& ring);
+    void drain();
+
+    uint64_t const serial;
+    std::chrono::milliseconds const flush_interval;
+    unsigned int const records_per_thread;
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping{false};
+    std::ofstream file;
+    std::map<std::thread::id, std::unique_ptr<Ring>> rings;
+
+    std::thread flusher;
+};
+}
+
+#endif //MIRAL_BINARY_TRACE_WRITER_H
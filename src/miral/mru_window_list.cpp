@@ -41,25 +41,45 @@ bool visible(miral::Window const& window)
 
 void miral::MRUWindowList::push(Window const& window)
 {
-    windows.erase(remove(begin(windows), end(windows), window), end(windows));
-    windows.push_back(window);
+    auto const found = index.find(window);
+
+    if (found != end(index))
+    {
+        windows.splice(begin(windows), windows, found->second);
+    }
+    else
+    {
+        windows.push_front(window);
+        index.emplace(window, begin(windows));
+    }
 }
 
 void miral::MRUWindowList::erase(Window const& window)
 {
-    windows.erase(remove(begin(windows), end(windows), window), end(windows));
+    auto const found = index.find(window);
+
+    if (found != end(index))
+    {
+        windows.erase(found->second);
+        index.erase(found);
+    }
 }
 
 auto miral::MRUWindowList::top() const -> Window
 {
-    auto const& found = std::find_if(rbegin(windows), rend(windows), visible);
-    return (found != rend(windows)) ? *found: Window{};
+    auto const& found = std::find_if(begin(windows), end(windows), visible);
+    return (found != end(windows)) ? *found: Window{};
 }
 
 void miral::MRUWindowList::enumerate(Enumerator const& enumerator) const
 {
-    for (auto i = windows.rbegin(); i != windows.rend(); ++i)
-        if (visible(*i))
-            if (!enumerator(const_cast<Window&>(*i)))
+    for (auto i = begin(windows); i != end(windows);)
+    {
+        // The enumerator may move or remove the current window
+        auto const current = i++;
+
+        if (visible(*current))
+            if (!enumerator(const_cast<Window&>(*current)))
                 break;
+    }
 }
@@ -22,7 +22,8 @@
 #include <miral/window.h>
 
 #include <functional>
-#include <vector>
+#include <list>
+#include <map>
 
 namespace miral
 {
@@ -36,10 +37,15 @@ public:
 
     using Enumerator = std::function<bool(Window& window)>;
 
+    /// Visits visible windows, most recently used first. The enumerator may
+    /// push or erase the window it is given.
     void enumerate(Enumerator const& enumerator) const;
 
 private:
-    std::vector<Window> windows;
+    using Windows = std::list<Window>;
+
+    Windows windows;    // Most recently used first
+    std::map<Window, Windows::iterator> index;
 };
 }
 
@@ -0,0 +1,400 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "window_management_binary_trace.h"
+#include "binary_trace_writer.h"
+
+#include <miral/application_info.h>
+#include <miral/window_info.h>
+
+#include <mir/scene/session.h>
+#include <mir/scene/surface.h>
+
+#include <array>
+
+namespace mt = miral::trace;
+
+namespace
+{
+auto id_of(void const* object) -> uint64_t
+{
+    return reinterpret_cast<uintptr_t>(object);
+}
+
+template<typename Object>
+auto id_of(std::shared_ptr<Object> const& object) -> uint64_t
+{
+    return id_of(object.get());
+}
+
+auto id_of(miral::Window const& window) -> uint64_t
+{
+    std::shared_ptr<mir::scene::Surface> const surface = window;
+    return id_of(surface);
+}
+
+auto packed(mir::geometry::Point point) -> uint64_t
+{
+    return mt::pack(point.x.as_int(), point.y.as_int());
+}
+
+auto packed(mir::geometry::Size size) -> uint64_t
+{
+    return mt::pack(size.width.as_int(), size.height.as_int());
+}
+
+auto packed(mir::geometry::Displacement displacement) -> uint64_t
+{
+    return mt::pack(displacement.dx.as_int(), displacement.dy.as_int());
+}
+
+/// The fields recorded for a specification: which are set, top_left, size and state
+auto packed(miral::WindowSpecification const& specification) -> std::array<uint64_t, 4>
+{
+    std::array<uint64_t, 4> result{};
+
+    if (specification.top_left().is_set())
+    {
+        result[0] |= mt::has_top_left;
+        result[1] = packed(specification.top_left().value());
+    }
+
+    if (specification.size().is_set())
+    {
+        result[0] |= mt::has_size;
+        result[2] = packed(specification.size().value());
+    }
+
+    if (specification.state().is_set())
+    {
+        result[0] |= mt::has_state;
+        result[3] = specification.state().value();
+    }
+
+    return result;
+}
+}
+
+miral::WindowManagementBinaryTrace::WindowManagementBinaryTrace(std::shared_ptr<BinaryTraceWriter> const& writer) :
+    writer{writer}
+{
+}
+
+void miral::WindowManagementBinaryTrace::count_applications(unsigned int result)
+{
+    writer->write(mt::Call::count_applications, {result});
+}
+
+void miral::WindowManagementBinaryTrace::for_each_application()
+{
+    writer->write(mt::Call::for_each_application, {});
+}
+
+void miral::WindowManagementBinaryTrace::find_application(Application const& result)
+{
+    writer->write(mt::Call::find_application, {id_of(result)});
+}
+
+void miral::WindowManagementBinaryTrace::info_for(ApplicationInfo const& result)
+{
+    writer->write(mt::Call::info_for_application, {id_of(result.application())});
+}
+
+void miral::WindowManagementBinaryTrace::info_for(WindowInfo const& result)
+{
+    writer->write(mt::Call::info_for_window, {id_of(result.window())});
+}
+
+void miral::WindowManagementBinaryTrace::ask_client_to_close(Window const& window)
+{
+    writer->write(mt::Call::ask_client_to_close, {id_of(window)});
+}
+
+void miral::WindowManagementBinaryTrace::force_close(Window const& window)
+{
+    writer->write(mt::Call::force_close, {id_of(window)});
+}
+
+void miral::WindowManagementBinaryTrace::active_window(Window const& result)
+{
+    writer->write(mt::Call::active_window, {id_of(result)});
+}
+
+void miral::WindowManagementBinaryTrace::select_active_window(Window const& hint, Window const& result)
+{
+    writer->write(mt::Call::select_active_window, {id_of(hint), id_of(result)});
+}
+
+void miral::WindowManagementBinaryTrace::window_at(Point cursor, Window const& result)
+{
+    writer->write(mt::Call::window_at, {packed(cursor), id_of(result)});
+}
+
+void miral::WindowManagementBinaryTrace::active_output(Rectangle const& result)
+{
+    writer->write(mt::Call::active_output, {packed(result.top_left), packed(result.size)});
+}
+
+void miral::WindowManagementBinaryTrace::info_for_window_id(std::string const& /*id*/, WindowInfo const& result)
+{
+    writer->write(mt::Call::info_for_window_id, {id_of(result.window())});
+}
+
+void miral::WindowManagementBinaryTrace::id_for_window(Window const& window, std::string const& /*result*/)
+{
+    writer->write(mt::Call::id_for_window, {id_of(window)});
+}
+
+void miral::WindowManagementBinaryTrace::place_and_size_for_state(
+    WindowSpecification const& modifications, WindowInfo const& window_info)
+{
+    auto const m = packed(modifications);
+    writer->write(mt::Call::place_and_size_for_state, {id_of(window_info.window()), m[0], m[1], m[2], m[3]});
+}
+
+void miral::WindowManagementBinaryTrace::drag_active_window(Displacement movement)
+{
+    writer->write(mt::Call::drag_active_window, {packed(movement)});
+}
+
+void miral::WindowManagementBinaryTrace::drag_window(Window const& window, Displacement movement)
+{
+    writer->write(mt::Call::drag_window, {id_of(window), packed(movement)});
+}
+
+void miral::WindowManagementBinaryTrace::focus_next_application()
+{
+    writer->write(mt::Call::focus_next_application, {});
+}
+
+void miral::WindowManagementBinaryTrace::focus_next_within_application()
+{
+    writer->write(mt::Call::focus_next_within_application, {});
+}
+
+void miral::WindowManagementBinaryTrace::focus_prev_within_application()
+{
+    writer->write(mt::Call::focus_prev_within_application, {});
+}
+
+void miral::WindowManagementBinaryTrace::raise_tree(Window const& root)
+{
+    writer->write(mt::Call::raise_tree, {id_of(root)});
+}
+
+void miral::WindowManagementBinaryTrace::start_drag_and_drop(WindowInfo const& window_info)
+{
+    writer->write(mt::Call::start_drag_and_drop, {id_of(window_info.window())});
+}
+
+void miral::WindowManagementBinaryTrace::end_drag_and_drop()
+{
+    writer->write(mt::Call::end_drag_and_drop, {});
+}
+
+void miral::WindowManagementBinaryTrace::modify_window(
+    WindowInfo const& window_info, WindowSpecification const& modifications)
+{
+    auto const id = id_of(window_info.window());
+    auto const m = packed(modifications);
+    writer->write(mt::Call::modify_window, {id, m[0], m[1], m[2], m[3]});
+
+    if (modifications.name().is_set())
+        writer->write_name(mt::Call::window_name, id, modifications.name().value());
+}
+
+void miral::WindowManagementBinaryTrace::invoke_under_lock()
+{
+    writer->write(mt::Call::invoke_under_lock, {});
+}
+
+void miral::WindowManagementBinaryTrace::create_workspace(std::shared_ptr<Workspace> const& result)
+{
+    writer->write(mt::Call::create_workspace, {id_of(result)});
+}
+
+void miral::WindowManagementBinaryTrace::add_tree_to_workspace(
+    Window const& window, std::shared_ptr<Workspace> const& workspace)
+{
+    writer->write(mt::Call::add_tree_to_workspace, {id_of(window), id_of(workspace)});
+}
+
+void miral::WindowManagementBinaryTrace::remove_tree_from_workspace(
+    Window const& window, std::shared_ptr<Workspace> const& workspace)
+{
+    writer->write(mt::Call::remove_tree_from_workspace, {id_of(window), id_of(workspace)});
+}
+
+void miral::WindowManagementBinaryTrace::move_workspace_content_to_workspace(
+    std::shared_ptr<Workspace> const& to_workspace, std::shared_ptr<Workspace> const& from_workspace)
+{
+    writer->write(mt::Call::move_workspace_content_to_workspace, {id_of(to_workspace), id_of(from_workspace)});
+}
+
+void miral::WindowManagementBinaryTrace::for_each_workspace_containing(Window const& window)
+{
+    writer->write(mt::Call::for_each_workspace_containing, {id_of(window)});
+}
+
+void miral::WindowManagementBinaryTrace::for_each_window_in_workspace(std::shared_ptr<Workspace> const& workspace)
+{
+    writer->write(mt::Call::for_each_window_in_workspace, {id_of(workspace)});
+}
+
+void miral::WindowManagementBinaryTrace::place_new_window(
+    ApplicationInfo const& app_info,
+    WindowSpecification const& /*requested_specification*/,
+    WindowSpecification const& result)
+{
+    auto const m = packed(result);
+    writer->write(mt::Call::place_new_window, {id_of(app_info.application()), m[0], m[1], m[2], m[3]});
+}
+
+void miral::WindowManagementBinaryTrace::handle_window_ready(WindowInfo const& window_info)
+{
+    writer->write(mt::Call::handle_window_ready, {id_of(window_info.window())});
+}
+
+void miral::WindowManagementBinaryTrace::handle_modify_window(
+    WindowInfo const& window_info, WindowSpecification const& modifications)
+{
+    auto const m = packed(modifications);
+    writer->write(mt::Call::handle_modify_window, {id_of(window_info.window()), m[0], m[1], m[2], m[3]});
+}
+
+void miral::WindowManagementBinaryTrace::handle_raise_window(WindowInfo const& window_info)
+{
+    writer->write(mt::Call::handle_raise_window, {id_of(window_info.window())});
+}
+
+void miral::WindowManagementBinaryTrace::handle_keyboard_event(MirKeyboardEvent const* event)
+{
+    writer->write(mt::Call::handle_keyboard_event, {
+        uint64_t(mir_input_event_get_device_id(mir_keyboard_event_input_event(event))),
+        uint64_t(mir_keyboard_event_action(event)),
+        uint64_t(mir_keyboard_event_key_code(event)),
+        uint64_t(mir_keyboard_event_scan_code(event)),
+        uint64_t(mir_keyboard_event_modifiers(event))});
+}
+
+void miral::WindowManagementBinaryTrace::handle_touch_event(MirTouchEvent const* event)
+{
+    auto const count = mir_touch_event_point_count(event);
+
+    writer->write(mt::Call::handle_touch_event, {
+        uint64_t(mir_input_event_get_device_id(mir_touch_event_input_event(event))),
+        count,
+        count ? mt::pack(mir_touch_event_id(event, 0),
+                         mir_touch_event_action(event, 0) | (mir_touch_event_tooltype(event, 0) << 16)) : 0,
+        count ? mt::pack(mir_touch_event_axis_value(event, 0, mir_touch_axis_x),
+                         mir_touch_event_axis_value(event, 0, mir_touch_axis_y)) : 0,
+        uint64_t(mir_touch_event_modifiers(event))});
+}
+
+void miral::WindowManagementBinaryTrace::handle_pointer_event(MirPointerEvent const* event)
+{
+    unsigned int button_state = 0;
+
+    for (auto const a : {mir_pointer_button_primary, mir_pointer_button_secondary, mir_pointer_button_tertiary,
+                         mir_pointer_button_back, mir_pointer_button_forward})
+        button_state |= mir_pointer_event_button_state(event, a) ? a : 0;
+
+    writer->write(mt::Call::handle_pointer_event, {
+        uint64_t(mir_input_event_get_device_id(mir_pointer_event_input_event(event))),
+        mt::pack(int32_t(mir_pointer_event_action(event)), int32_t(button_state)),
+        mt::pack(mir_pointer_event_axis_value(event, mir_pointer_axis_x),
+                 mir_pointer_event_axis_value(event, mir_pointer_axis_y)),
+        mt::pack(mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x),
+                 mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y)),
+        mt::pack(mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll),
+                 mir_pointer_event_axis_value(event, mir_pointer_axis_hscroll)),
+        uint64_t(mir_pointer_event_modifiers(event))});
+}
+
+void miral::WindowManagementBinaryTrace::confirm_inherited_move(WindowInfo const& window_info, Displacement movement)
+{
+    writer->write(mt::Call::confirm_inherited_move, {id_of(window_info.window()), packed(movement)});
+}
+
+void miral::WindowManagementBinaryTrace::end_of_transaction()
+{
+    writer->write(mt::Call::end_of_transaction, {});
+}
+
+void miral::WindowManagementBinaryTrace::advise_new_app(ApplicationInfo const& application)
+{
+    auto const& app = application.application();
+    writer->write_name(mt::Call::application_name, id_of(app), app->name());
+    writer->write(mt::Call::advise_new_app, {id_of(app)});
+}
+
+void miral::WindowManagementBinaryTrace::advise_delete_app(ApplicationInfo const& application)
+{
+    writer->write(mt::Call::advise_delete_app, {id_of(application.application())});
+}
+
+void miral::WindowManagementBinaryTrace::advise_new_window(WindowInfo const& window_info)
+{
+    auto const id = id_of(window_info.window());
+    writer->write_name(mt::Call::window_name, id, window_info.name());
+    writer->write(mt::Call::advise_new_window, {id});
+}
+
+void miral::WindowManagementBinaryTrace::advise_focus_lost(WindowInfo const& window_info)
+{
+    writer->write(mt::Call::advise_focus_lost, {id_of(window_info.window())});
+}
+
+void miral::WindowManagementBinaryTrace::advise_focus_gained(WindowInfo const& window_info)
+{
+    writer->write(mt::Call::advise_focus_gained, {id_of(window_info.window())});
+}
+
+void miral::WindowManagementBinaryTrace::advise_state_change(WindowInfo const& window_info, MirWindowState state)
+{
+    writer->write(mt::Call::advise_state_change, {id_of(window_info.window()), uint64_t(state)});
+}
+
+void miral::WindowManagementBinaryTrace::advise_move_to(WindowInfo const& window_info, Point top_left)
+{
+    writer->write(mt::Call::advise_move_to, {id_of(window_info.window()), packed(top_left)});
+}
+
+void miral::WindowManagementBinaryTrace::advise_resize(WindowInfo const& window_info, Size const& new_size)
+{
+    writer->write(mt::Call::advise_resize, {id_of(window_info.window()), packed(new_size)});
+}
+
+void miral::WindowManagementBinaryTrace::advise_delete_window(WindowInfo const& window_info)
+{
+    writer->write(mt::Call::advise_delete_window, {id_of(window_info.window())});
+}
+
+void miral::WindowManagementBinaryTrace::advise_raise(std::vector<Window> const& windows)
+{
+    // The count, followed by as many windows as fit
+    std::array<uint64_t, 6> args{{windows.size()}};
+    for (auto i = 0u; i != windows.size() && i + 1 != args.size(); ++i)
+        args[i + 1] = id_of(windows[i]);
+
+    writer->write(mt::Call::advise_raise, {args[0], args[1], args[2], args[3], args[4], args[5]});
+}
+
+void miral::WindowManagementBinaryTrace::exception(trace::Call call, char const* /*function*/)
+{
+    writer->write(mt::Call::exception, {static_cast<uint64_t>(call)});
+}
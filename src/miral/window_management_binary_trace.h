@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIRAL_WINDOW_MANAGEMENT_BINARY_TRACE_H
+#define MIRAL_WINDOW_MANAGEMENT_BINARY_TRACE_H
+
+#include "window_management_trace_sink.h"
+
+#include <memory>
+
+namespace miral
+{
+class BinaryTraceWriter;
+
+/// Records the calls seen by WindowManagementTrace as compact binary records
+/// that are cheap enough to leave enabled. The trace file is rendered as text by mirwmtrace.
+///
+/// Windows and applications are recorded by identity, with their names recorded
+/// when they are created (and when a window is renamed).
+class WindowManagementBinaryTrace : public WindowManagementTraceSink
+{
+public:
+    explicit WindowManagementBinaryTrace(std::shared_ptr<BinaryTraceWriter> const& writer);
+
+    void count_applications(unsigned int result) override;
+    void for_each_application() override;
+    void find_application(Application const& result) override;
+    void info_for(ApplicationInfo const& result) override;
+    void info_for(WindowInfo const& result) override;
+    void ask_client_to_close(Window const& window) override;
+    void force_close(Window const& window) override;
+    void active_window(Window const& result) override;
+    void select_active_window(Window const& hint, Window const& result) override;
+    void window_at(Point cursor, Window const& result) override;
+    void active_output(Rectangle const& result) override;
+    void info_for_window_id(std::string const& id, WindowInfo const& result) override;
+    void id_for_window(Window const& window, std::string const& result) override;
+    void place_and_size_for_state(WindowSpecification const& modifications, WindowInfo const& window_info) override;
+    void drag_active_window(Displacement movement) override;
+    void drag_window(Window const& window, Displacement movement) override;
+    void focus_next_application() override;
+    void focus_next_within_application() override;
+    void focus_prev_within_application() override;
+    void raise_tree(Window const& root) override;
+    void start_drag_and_drop(WindowInfo const& window_info) override;
+    void end_drag_and_drop() override;
+    void modify_window(WindowInfo const& window_info, WindowSpecification const& modifications) override;
+    void invoke_under_lock() override;
+
+    void create_workspace(std::shared_ptr<Workspace> const& result) override;
+    void add_tree_to_workspace(Window const& window, std::shared_ptr<Workspace> const& workspace) override;
+    void remove_tree_from_workspace(Window const& window, std::shared_ptr<Workspace> const& workspace) override;
+    void move_workspace_content_to_workspace(
+        std::shared_ptr<Workspace> const& to_workspace,
+        std::shared_ptr<Workspace> const& from_workspace) override;
+    void for_each_workspace_containing(Window const& window) override;
+    void for_each_window_in_workspace(std::shared_ptr<Workspace> const& workspace) override;
+
+    void place_new_window(
+        ApplicationInfo const& app_info,
+        WindowSpecification const& requested_specification,
+        WindowSpecification const& result) override;
+    void handle_window_ready(WindowInfo const& window_info) override;
+    void handle_modify_window(WindowInfo const& window_info, WindowSpecification const& modifications) override;
+    void handle_raise_window(WindowInfo const& window_info) override;
+    void handle_keyboard_event(MirKeyboardEvent const* event) override;
+    void handle_touch_event(MirTouchEvent const* event) override;
+    void handle_pointer_event(MirPointerEvent const* event) override;
+    void confirm_inherited_move(WindowInfo const& window_info, Displacement movement) override;
+
+    void end_of_transaction() override;
+
+    void advise_new_app(ApplicationInfo const& application) override;
+    void advise_delete_app(ApplicationInfo const& application) override;
+    void advise_new_window(WindowInfo const& window_info) override;
+    void advise_focus_lost(WindowInfo const& window_info) override;
+    void advise_focus_gained(WindowInfo const& window_info) override;
+    void advise_state_change(WindowInfo const& window_info, MirWindowState state) override;
+    void advise_move_to(WindowInfo const& window_info, Point top_left) override;
+    void advise_resize(WindowInfo const& window_info, Size const& new_size) override;
+    void advise_delete_window(WindowInfo const& window_info) override;
+    void advise_raise(std::vector<Window> const& windows) override;
+
+    void exception(trace::Call call, char const* function) override;
+
+private:
+    std::shared_ptr<BinaryTraceWriter> const writer;
+};
+}
+
+#endif //MIRAL_WINDOW_MANAGEMENT_BINARY_TRACE_H
@@ -20,6 +20,8 @@
 
 #include "basic_window_manager.h"
 #include "window_management_trace.h"
+#include "window_management_binary_trace.h"
+#include "binary_trace_writer.h"
 
 #include <mir/abnormal_exit.h>
 #include <mir/server.h>
@@ -35,6 +37,7 @@ namespace
 char const* const wm_option = "window-manager";
 char const* const wm_system_compositor = "system-compositor";
 char const* const trace_option = "window-management-trace";
+char const* const trace_file_option = "window-management-trace-file";
 }
 
 void miral::WindowManagerOptions::operator()(mir::Server& server) const
@@ -48,6 +51,8 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
 
     server.add_configuration_option(wm_option, description, policies.begin()->name);
     server.add_configuration_option(trace_option, "log trace message", mir::OptionType::null);
+    server.add_configuration_option(trace_file_option,
+        "write a binary trace of window management to this file (view with mirwmtrace)", mir::OptionType::string);
 
     server.override_the_window_manager_builder([this, &server](msh::FocusController* focus_controller)
         -> std::shared_ptr<msh::WindowManager>
@@ -62,6 +67,25 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
             {
                 if (selection == option.name)
                 {
+                    if (options->is_set(trace_file_option))
+                    {
+                        auto const writer = std::make_shared<BinaryTraceWriter>(
+                            options->get<std::string>(trace_file_option));
+
+                        auto trace_builder = [&option, writer](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
+                            {
+                                return std::make_unique<WindowManagementTrace>(
+                                    tools, option.build, std::make_shared<WindowManagementBinaryTrace>(writer));
+                            };
+
+                        return std::make_shared<BasicWindowManager>(
+                            focus_controller,
+                            display_layout,
+                            persistent_surface_store,
+                            *server.the_display_configuration_observer_registrar(),
+                            trace_builder);
+                    }
+
                     if (server.get_options()->is_set(trace_option))
                     {
                         auto trace_builder = [&option](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
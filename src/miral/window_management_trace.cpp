@@ -35,12 +35,10 @@
 
 using mir::operator<<;
 
-#define MIRAL_TRACE_EXCEPTION \
-catch (std::exception const& x)\
+#define MIRAL_TRACE_EXCEPTION(call) \
+catch (std::exception const&)\
 {\
-    std::stringstream out;\
-    mir::report_exception(out);\
-    mir::log_warning("%s throws %s", __func__, out.str().c_str());\
+    sink->exception(miral::trace::Call::call, __func__);\
     throw;\
 }
 
@@ -330,13 +328,298 @@ auto dump_of(mir::geometry::Size const size) -> std::string
     out << size;
     return out.str();
 }
+
+class LogTraceSink : public miral::WindowManagementTraceSink
+{
+public:
+    void count_applications(unsigned int result) override
+    {
+        mir::log_info("%s -> %d", __func__, result);
+    }
+
+    void for_each_application() override
+    {
+        mir::log_info("%s", __func__);
+    }
+
+    void find_application(miral::Application const& result) override
+    {
+        mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    }
+
+    void info_for(miral::ApplicationInfo const& result) override
+    {
+        mir::log_info("%s -> %s", __func__, result.application()->name().c_str());
+    }
+
+    void info_for(miral::WindowInfo const& result) override
+    {
+        mir::log_info("%s -> %s", __func__, result.name().c_str());
+    }
+
+    void ask_client_to_close(miral::Window const& window) override
+    {
+        mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    }
+
+    void force_close(miral::Window const& window) override
+    {
+        mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    }
+
+    void active_window(miral::Window const& result) override
+    {
+        mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    }
+
+    void select_active_window(miral::Window const& hint, miral::Window const& result) override
+    {
+        mir::log_info("%s hint=%s -> %s", __func__, dump_of(hint).c_str(), dump_of(result).c_str());
+    }
+
+    void window_at(mir::geometry::Point cursor, miral::Window const& result) override
+    {
+        std::stringstream out;
+        out << cursor << " -> " << dump_of(result);
+        mir::log_info("%s cursor=%s", __func__, out.str().c_str());
+    }
+
+    void active_output(mir::geometry::Rectangle const& result) override
+    {
+        std::stringstream out;
+        out << result;
+        mir::log_info("%s -> %s", __func__, out.str().c_str());
+    }
+
+    void info_for_window_id(std::string const& id, miral::WindowInfo const& result) override
+    {
+        mir::log_info("%s id=%s -> %s", __func__, id.c_str(), dump_of(result).c_str());
+    }
+
+    void id_for_window(miral::Window const& window, std::string const& result) override
+    {
+        mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), result.c_str());
+    }
+
+    void place_and_size_for_state(
+        miral::WindowSpecification const& modifications, miral::WindowInfo const& window_info) override
+    {
+        mir::log_info("%s modifications=%s window_info=%s", __func__, dump_of(modifications).c_str(), dump_of(window_info).c_str());
+    }
+
+    void drag_active_window(mir::geometry::Displacement movement) override
+    {
+        std::stringstream out;
+        out << movement;
+        mir::log_info("%s movement=%s", __func__, out.str().c_str());
+    }
+
+    void drag_window(miral::Window const& window, mir::geometry::Displacement movement) override
+    {
+        std::stringstream out;
+        out << movement;
+        mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), out.str().c_str());
+    }
+
+    void focus_next_application() override
+    {
+        mir::log_info("%s", __func__);
+    }
+
+    void focus_next_within_application() override
+    {
+        mir::log_info("%s", __func__);
+    }
+
+    void focus_prev_within_application() override
+    {
+        mir::log_info("%s", __func__);
+    }
+
+    void raise_tree(miral::Window const& root) override
+    {
+        mir::log_info("%s root=%s", __func__, dump_of(root).c_str());
+    }
+
+    void start_drag_and_drop(miral::WindowInfo const& window_info) override
+    {
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    }
+
+    void end_drag_and_drop() override
+    {
+        mir::log_info("%s", __func__);
+    }
+
+    void modify_window(miral::WindowInfo const& window_info, miral::WindowSpecification const& modifications) override
+    {
+        mir::log_info("%s window_info=%s, modifications=%s",
+                      __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    }
+
+    void invoke_under_lock() override
+    {
+        mir::log_info("%s", __func__);
+    }
+
+    void create_workspace(std::shared_ptr<miral::Workspace> const& /*result*/) override
+    {
+        mir::log_info("%s", __func__);
+    }
+
+    void add_tree_to_workspace(miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace) override
+    {
+        mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
+    }
+
+    void remove_tree_from_workspace(miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace) override
+    {
+        mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
+    }
+
+    void move_workspace_content_to_workspace(
+        std::shared_ptr<miral::Workspace> const& to_workspace,
+        std::shared_ptr<miral::Workspace> const& from_workspace) override
+    {
+        mir::log_info("%s to_workspace=%p, from_workspace=%p", __func__, to_workspace.get(), from_workspace.get());
+    }
+
+    void for_each_workspace_containing(miral::Window const& window) override
+    {
+        mir::log_info("%s window=%s", __func__, dump_of(window).c_str());
+    }
+
+    void for_each_window_in_workspace(std::shared_ptr<miral::Workspace> const& workspace) override
+    {
+        mir::log_info("%s workspace =%p", __func__, workspace.get());
+    }
+
+    void place_new_window(
+        miral::ApplicationInfo const& app_info,
+        miral::WindowSpecification const& requested_specification,
+        miral::WindowSpecification const& result) override
+    {
+        mir::log_info("%s app_info=%s, requested_specification=%s -> %s",
+                  __func__, dump_of(app_info).c_str(), dump_of(requested_specification).c_str(), dump_of(result).c_str());
+    }
+
+    void handle_window_ready(miral::WindowInfo const& window_info) override
+    {
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    }
+
+    void handle_modify_window(miral::WindowInfo const& window_info, miral::WindowSpecification const& modifications) override
+    {
+        mir::log_info("%s window_info=%s, modifications=%s",
+                      __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    }
+
+    void handle_raise_window(miral::WindowInfo const& window_info) override
+    {
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    }
+
+    void handle_keyboard_event(MirKeyboardEvent const* event) override
+    {
+        mir::log_info("%s event=%s", __func__, dump_of(event).c_str());
+    }
+
+    void handle_touch_event(MirTouchEvent const* event) override
+    {
+        mir::log_info("%s event=%s", __func__, dump_of(event).c_str());
+    }
+
+    void handle_pointer_event(MirPointerEvent const* event) override
+    {
+        mir::log_info("%s event=%s", __func__, dump_of(event).c_str());
+    }
+
+    void confirm_inherited_move(miral::WindowInfo const& window_info, mir::geometry::Displacement movement) override
+    {
+        std::stringstream out;
+        out << movement;
+        mir::log_info("%s window_info=%s, movement=%s", __func__, dump_of(window_info).c_str(), out.str().c_str());
+    }
+
+    void end_of_transaction() override
+    {
+        mir::log_info("====");
+    }
+
+    void advise_new_app(miral::ApplicationInfo const& application) override
+    {
+        mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    }
+
+    void advise_delete_app(miral::ApplicationInfo const& application) override
+    {
+        mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    }
+
+    void advise_new_window(miral::WindowInfo const& window_info) override
+    {
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    }
+
+    void advise_focus_lost(miral::WindowInfo const& window_info) override
+    {
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    }
+
+    void advise_focus_gained(miral::WindowInfo const& window_info) override
+    {
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    }
+
+    void advise_state_change(miral::WindowInfo const& window_info, MirWindowState state) override
+    {
+        mir::log_info("%s window_info=%s, state=%s", __func__, dump_of(window_info).c_str(), dump_of(state).c_str());
+    }
+
+    void advise_move_to(miral::WindowInfo const& window_info, mir::geometry::Point top_left) override
+    {
+        mir::log_info("%s window_info=%s, top_left=%s", __func__, dump_of(window_info).c_str(), dump_of(top_left).c_str());
+    }
+
+    void advise_resize(miral::WindowInfo const& window_info, mir::geometry::Size const& new_size) override
+    {
+        mir::log_info("%s window_info=%s, new_size=%s", __func__, dump_of(window_info).c_str(), dump_of(new_size).c_str());
+    }
+
+    void advise_delete_window(miral::WindowInfo const& window_info) override
+    {
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    }
+
+    void advise_raise(std::vector<miral::Window> const& windows) override
+    {
+        mir::log_info("%s window_info=%s", __func__, dump_of(windows).c_str());
+    }
+
+    void exception(miral::trace::Call /*call*/, char const* function) override
+    {
+        std::stringstream out;
+        mir::report_exception(out);
+        mir::log_warning("%s throws %s", function, out.str().c_str());
+    }
+};
 }
 
 miral::WindowManagementTrace::WindowManagementTrace(
     WindowManagerTools const& wrapped,
     WindowManagementPolicyBuilder const& builder) :
+    WindowManagementTrace{wrapped, builder, std::make_shared<LogTraceSink>()}
+{
+}
+
+miral::WindowManagementTrace::WindowManagementTrace(
+    WindowManagerTools const& wrapped,
+    WindowManagementPolicyBuilder const& builder,
+    std::shared_ptr<WindowManagementTraceSink> const& sink) :
     wrapped{wrapped},
-    policy(builder(WindowManagerTools{this}))
+    sink{sink},
+    policy(builder(WindowManagerTools{this})),
+    log_input{[]{}}
 {
 }
 
@@ -344,374 +627,367 @@ auto miral::WindowManagementTrace::count_applications() const -> unsigned int
 try {
     log_input();
     auto const result = wrapped.count_applications();
-    mir::log_info("%s -> %d", __func__, result);
+    sink->count_applications(result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(count_applications)
 
 void miral::WindowManagementTrace::for_each_application(std::function<void(miral::ApplicationInfo&)> const& functor)
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    sink->for_each_application();
     trace_count++;
     wrapped.for_each_application(functor);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(for_each_application)
 
 auto miral::WindowManagementTrace::find_application(std::function<bool(ApplicationInfo const& info)> const& predicate)
 -> Application
 try {
     log_input();
     auto result = wrapped.find_application(predicate);
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    sink->find_application(result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(find_application)
 
 auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Session> const& session) const -> ApplicationInfo&
 try {
     log_input();
     auto& result = wrapped.info_for(session);
-    mir::log_info("%s -> %s", __func__, result.application()->name().c_str());
+    sink->info_for(result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(info_for_application)
 
 auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Surface> const& surface) const -> WindowInfo&
 try {
     log_input();
     auto& result = wrapped.info_for(surface);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    sink->info_for(result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(info_for_window)
 
 auto miral::WindowManagementTrace::info_for(Window const& window) const -> WindowInfo&
 try {
     log_input();
     auto& result = wrapped.info_for(window);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    sink->info_for(result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(info_for_window)
 
 void miral::WindowManagementTrace::ask_client_to_close(miral::Window const& window)
 try {
     log_input();
-    mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    sink->ask_client_to_close(window);
     trace_count++;
     wrapped.ask_client_to_close(window);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(ask_client_to_close)
 
 void miral::WindowManagementTrace::force_close(miral::Window const& window)
 try {
     log_input();
-    mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    sink->force_close(window);
     trace_count++;
     wrapped.force_close(window);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(force_close)
 
 auto miral::WindowManagementTrace::active_window() const -> Window
 try {
     log_input();
     auto result = wrapped.active_window();
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    sink->active_window(result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(active_window)
 
 auto miral::WindowManagementTrace::select_active_window(Window const& hint) -> Window
 try {
     log_input();
     auto result = wrapped.select_active_window(hint);
-    mir::log_info("%s hint=%s -> %s", __func__, dump_of(hint).c_str(), dump_of(result).c_str());
+    sink->select_active_window(hint, result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(select_active_window)
 
 auto miral::WindowManagementTrace::window_at(mir::geometry::Point cursor) const -> Window
 try {
     log_input();
     auto result = wrapped.window_at(cursor);
-    std::stringstream out;
-    out << cursor << " -> " << dump_of(result);
-    mir::log_info("%s cursor=%s", __func__, out.str().c_str());
+    sink->window_at(cursor, result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(window_at)
 
 auto miral::WindowManagementTrace::active_output() -> mir::geometry::Rectangle const
 try {
     log_input();
     auto result = wrapped.active_output();
-    std::stringstream out;
-    out << result;
-    mir::log_info("%s -> ", __func__, out.str().c_str());
+    sink->active_output(result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(active_output)
 
 auto miral::WindowManagementTrace::info_for_window_id(std::string const& id) const -> WindowInfo&
 try {
     log_input();
     auto& result = wrapped.info_for_window_id(id);
-    mir::log_info("%s id=%s -> %s", __func__, id.c_str(), dump_of(result).c_str());
+    sink->info_for_window_id(id, result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(info_for_window_id)
 
 auto miral::WindowManagementTrace::id_for_window(Window const& window) const -> std::string
 try {
     log_input();
     auto result = wrapped.id_for_window(window);
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), result.c_str());
+    sink->id_for_window(window, result);
     trace_count++;
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(id_for_window)
 
 void miral::WindowManagementTrace::place_and_size_for_state(
     WindowSpecification& modifications, WindowInfo const& window_info) const
 try {
     log_input();
-    mir::log_info("%s modifications=%s window_info=%s", __func__, dump_of(modifications).c_str(), dump_of(window_info).c_str());
+    sink->place_and_size_for_state(modifications, window_info);
     wrapped.place_and_size_for_state(modifications, window_info);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(place_and_size_for_state)
 
 void miral::WindowManagementTrace::drag_active_window(mir::geometry::Displacement movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s movement=%s", __func__, out.str().c_str());
+    sink->drag_active_window(movement);
     trace_count++;
     wrapped.drag_active_window(movement);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(drag_active_window)
 
 void miral::WindowManagementTrace::drag_window(Window const& window, mir::geometry::Displacement& movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), out.str().c_str());
+    sink->drag_window(window, movement);
     trace_count++;
     wrapped.drag_window(window, movement);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(drag_window)
 
 void miral::WindowManagementTrace::focus_next_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    sink->focus_next_application();
     trace_count++;
     wrapped.focus_next_application();
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(focus_next_application)
 
 void miral::WindowManagementTrace::focus_next_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    sink->focus_next_within_application();
     trace_count++;
     wrapped.focus_next_within_application();
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(focus_next_within_application)
 
 void miral::WindowManagementTrace::focus_prev_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    sink->focus_prev_within_application();
     trace_count++;
     wrapped.focus_prev_within_application();
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(focus_prev_within_application)
 
 void miral::WindowManagementTrace::raise_tree(miral::Window const& root)
 try {
     log_input();
-    mir::log_info("%s root=%s", __func__, dump_of(root).c_str());
+    sink->raise_tree(root);
     trace_count++;
     wrapped.raise_tree(root);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(raise_tree)
 
 void miral::WindowManagementTrace::start_drag_and_drop(miral::WindowInfo& window_info, std::vector<uint8_t> const& handle)
 try {
     log_input();
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    sink->start_drag_and_drop(window_info);
     trace_count++;
     wrapped.start_drag_and_drop(window_info, handle);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(start_drag_and_drop)
 
 void miral::WindowManagementTrace::end_drag_and_drop()
 try {
     log_input();
-    mir::log_info("%s window_info=%s", __func__);
+    sink->end_drag_and_drop();
     trace_count++;
     wrapped.end_drag_and_drop();
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(end_drag_and_drop)
 
 void miral::WindowManagementTrace::modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
     log_input();
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    sink->modify_window(window_info, modifications);
     trace_count++;
     wrapped.modify_window(window_info, modifications);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(modify_window)
 
 void miral::WindowManagementTrace::invoke_under_lock(std::function<void()> const& callback)
 try {
-    mir::log_info("%s", __func__);
+    sink->invoke_under_lock();
     wrapped.invoke_under_lock(callback);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(invoke_under_lock)
 
 auto miral::WindowManagementTrace::create_workspace() -> std::shared_ptr<Workspace>
 try {
-    mir::log_info("%s", __func__);
-    return wrapped.create_workspace();
+    auto result = wrapped.create_workspace();
+    sink->create_workspace(result);
+    return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(create_workspace)
 
 void miral::WindowManagementTrace::add_tree_to_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
+    sink->add_tree_to_workspace(window, workspace);
     wrapped.add_tree_to_workspace(window, workspace);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(add_tree_to_workspace)
 
 void miral::WindowManagementTrace::remove_tree_from_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
+    sink->remove_tree_from_workspace(window, workspace);
     wrapped.remove_tree_from_workspace(window, workspace);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(remove_tree_from_workspace)
 
 void miral::WindowManagementTrace::move_workspace_content_to_workspace(
     std::shared_ptr<Workspace> const& to_workspace, std::shared_ptr<Workspace> const& from_workspace)
 try {
-    mir::log_info("%s to_workspace=%p, from_workspace=%p", __func__, to_workspace.get(), from_workspace.get());
+    sink->move_workspace_content_to_workspace(to_workspace, from_workspace);
     wrapped.move_workspace_content_to_workspace(to_workspace, from_workspace);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(move_workspace_content_to_workspace)
 
 void miral::WindowManagementTrace::for_each_workspace_containing(
     miral::Window const& window, std::function<void(std::shared_ptr<miral::Workspace> const&)> const& callback)
 try {
-    mir::log_info("%s window=%s", __func__, dump_of(window).c_str());
+    sink->for_each_workspace_containing(window);
     wrapped.for_each_workspace_containing(window, callback);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(for_each_workspace_containing)
 
 void miral::WindowManagementTrace::for_each_window_in_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::function<void(miral::Window const&)> const& callback)
 try {
-    mir::log_info("%s workspace =%p", __func__, workspace.get());
+    sink->for_each_window_in_workspace(workspace);
     wrapped.for_each_window_in_workspace(workspace, callback);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(for_each_window_in_workspace)
 
 auto miral::WindowManagementTrace::place_new_window(
     ApplicationInfo const& app_info,
     WindowSpecification const& requested_specification) -> WindowSpecification
 try {
     auto const result = policy->place_new_window(app_info, requested_specification);
-    mir::log_info("%s app_info=%s, requested_specification=%s -> %s",
-              __func__, dump_of(app_info).c_str(), dump_of(requested_specification).c_str(), dump_of(result).c_str());
+    sink->place_new_window(app_info, requested_specification, result);
     return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(place_new_window)
 
 void miral::WindowManagementTrace::handle_window_ready(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    sink->handle_window_ready(window_info);
     policy->handle_window_ready(window_info);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(handle_window_ready)
 
 void miral::WindowManagementTrace::handle_modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    sink->handle_modify_window(window_info, modifications);
     policy->handle_modify_window(window_info, modifications);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(handle_modify_window)
 
 void miral::WindowManagementTrace::handle_raise_window(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    sink->handle_raise_window(window_info);
     policy->handle_raise_window(window_info);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(handle_raise_window)
 
 bool miral::WindowManagementTrace::handle_keyboard_event(MirKeyboardEvent const* event)
 try {
     log_input = [event, this]
         {
-            mir::log_info("handle_keyboard_event event=%s", dump_of(event).c_str());
+            sink->handle_keyboard_event(event);
             log_input = []{};
         };
 
-    return policy->handle_keyboard_event(event);
+    auto const result = policy->handle_keyboard_event(event);
+    log_input = []{};
+    return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(handle_keyboard_event)
 
 bool miral::WindowManagementTrace::handle_touch_event(MirTouchEvent const* event)
 try {
     log_input = [event, this]
         {
-            mir::log_info("handle_touch_event event=%s", dump_of(event).c_str());
+            sink->handle_touch_event(event);
             log_input = []{};
         };
 
-    return policy->handle_touch_event(event);
+    auto const result = policy->handle_touch_event(event);
+    log_input = []{};
+    return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(handle_touch_event)
 
 bool miral::WindowManagementTrace::handle_pointer_event(MirPointerEvent const* event)
 try {
     log_input = [event, this]
         {
-            mir::log_info("handle_pointer_event event=%s", dump_of(event).c_str());
+            sink->handle_pointer_event(event);
             log_input = []{};
         };
 
-    return policy->handle_pointer_event(event);
+    auto const result = policy->handle_pointer_event(event);
+    log_input = []{};
+    return result;
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(handle_pointer_event)
 
 auto miral::WindowManagementTrace::confirm_inherited_move(WindowInfo const& window_info, Displacement movement)
 -> Rectangle
 try {
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window_info=%s, movement=%s", __func__, dump_of(window_info).c_str(), out.str().c_str());
-
+    sink->confirm_inherited_move(window_info, movement);
     return policy->confirm_inherited_move(window_info, movement);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(confirm_inherited_move)
 
 void miral::WindowManagementTrace::advise_begin()
 try {
@@ -719,82 +995,82 @@ try {
     trace_count.store(0);
     policy->advise_begin();
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_begin)
 
 void miral::WindowManagementTrace::advise_end()
 try {
     if (trace_count.load() > 0)
-        mir::log_info("====");
+        sink->end_of_transaction();
     policy->advise_end();
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_end)
 
 void miral::WindowManagementTrace::advise_new_app(miral::ApplicationInfo& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    sink->advise_new_app(application);
     policy->advise_new_app(application);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_new_app)
 
 void miral::WindowManagementTrace::advise_delete_app(miral::ApplicationInfo const& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    sink->advise_delete_app(application);
     policy->advise_delete_app(application);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_delete_app)
 
 void miral::WindowManagementTrace::advise_new_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    sink->advise_new_window(window_info);
     policy->advise_new_window(window_info);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_new_window)
 
 void miral::WindowManagementTrace::advise_focus_lost(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    sink->advise_focus_lost(window_info);
     policy->advise_focus_lost(window_info);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_focus_lost)
 
 void miral::WindowManagementTrace::advise_focus_gained(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    sink->advise_focus_gained(window_info);
     policy->advise_focus_gained(window_info);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_focus_gained)
 
 void miral::WindowManagementTrace::advise_state_change(miral::WindowInfo const& window_info, MirWindowState state)
 try {
-    mir::log_info("%s window_info=%s, state=%s", __func__, dump_of(window_info).c_str(), dump_of(state).c_str());
+    sink->advise_state_change(window_info, state);
     policy->advise_state_change(window_info, state);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_state_change)
 
 void miral::WindowManagementTrace::advise_move_to(miral::WindowInfo const& window_info, mir::geometry::Point top_left)
 try {
-    mir::log_info("%s window_info=%s, top_left=%s", __func__, dump_of(window_info).c_str(), dump_of(top_left).c_str());
+    sink->advise_move_to(window_info, top_left);
     policy->advise_move_to(window_info, top_left);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_move_to)
 
 void miral::WindowManagementTrace::advise_resize(miral::WindowInfo const& window_info, mir::geometry::Size const& new_size)
 try {
-    mir::log_info("%s window_info=%s, new_size=%s", __func__, dump_of(window_info).c_str(), dump_of(new_size).c_str());
+    sink->advise_resize(window_info, new_size);
     policy->advise_resize(window_info, new_size);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_resize)
 
 void miral::WindowManagementTrace::advise_delete_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    sink->advise_delete_window(window_info);
     policy->advise_delete_window(window_info);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_delete_window)
 
 void miral::WindowManagementTrace::advise_raise(std::vector<miral::Window> const& windows)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(windows).c_str());
+    sink->advise_raise(windows);
     policy->advise_raise(windows);
 }
-MIRAL_TRACE_EXCEPTION
+MIRAL_TRACE_EXCEPTION(advise_raise)
@@ -20,6 +20,7 @@
 #define MIRAL_WINDOW_MANAGEMENT_TRACE_H
 
 #include "window_manager_tools_implementation.h"
+#include "window_management_trace_sink.h"
 
 #include "miral/window_manager_tools.h"
 #include "miral/window_management_options.h"
@@ -29,11 +30,18 @@
 
 namespace miral
 {
+/// Wraps a window management policy, recording the calls it makes and receives in a sink.
+/// (By default these are logged as text.)
 class WindowManagementTrace : public WindowManagementPolicy, WindowManagerToolsImplementation
 {
 public:
     WindowManagementTrace(WindowManagerTools const& wrapped, WindowManagementPolicyBuilder const& builder);
 
+    WindowManagementTrace(
+        WindowManagerTools const& wrapped,
+        WindowManagementPolicyBuilder const& builder,
+        std::shared_ptr<WindowManagementTraceSink> const& sink);
+
 private:
     virtual auto count_applications() const -> unsigned int override;
 
@@ -137,6 +145,7 @@ public:
 
 private:
     WindowManagerTools wrapped;
+    std::shared_ptr<WindowManagementTraceSink> const sink;
     std::unique_ptr<miral::WindowManagementPolicy> const policy;
     std::atomic<unsigned> mutable trace_count;
     std::function<void()> log_input;
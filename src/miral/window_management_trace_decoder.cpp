@@ -0,0 +1,321 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "window_management_trace_decoder.h"
+#include "window_management_trace_format.h"
+
+#include <mir/event_printer.h>
+#include <mir/geometry/displacement.h>
+#include <mir/geometry/rectangle.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace mt = miral::trace;
+namespace geom = mir::geometry;
+using mir::operator<<;
+
+namespace
+{
+char const* const call_names[] =
+{
+#define MIRAL_TRACE_NAME(call, format) #call,
+    MIRAL_TRACE_CALLS(MIRAL_TRACE_NAME)
+#undef MIRAL_TRACE_NAME
+};
+
+char const* const call_formats[] =
+{
+#define MIRAL_TRACE_FORMAT(call, format) format,
+    MIRAL_TRACE_CALLS(MIRAL_TRACE_FORMAT)
+#undef MIRAL_TRACE_FORMAT
+};
+
+auto const arg_count = sizeof(mt::Record::arg)/sizeof(mt::Record::arg[0]);
+
+auto name_of(mt::Call call) -> std::string
+{
+    if (call < mt::Call::count)
+        return call_names[static_cast<unsigned>(call)];
+    else
+        return "unknown call " + std::to_string(static_cast<unsigned>(call));
+}
+
+auto point(uint64_t packed) -> geom::Point
+{
+    return {mt::unpack_first(packed), mt::unpack_second(packed)};
+}
+
+auto size(uint64_t packed) -> geom::Size
+{
+    return {mt::unpack_first(packed), mt::unpack_second(packed)};
+}
+
+auto displacement(uint64_t packed) -> geom::Displacement
+{
+    return {mt::unpack_first(packed), mt::unpack_second(packed)};
+}
+
+// Mirrors BracedItemStream in window_management_trace.cpp so the output reads the same
+struct BracedItemStream
+{
+    BracedItemStream(std::ostream& out) : out{out} { out << '{'; }
+    ~BracedItemStream() { out << '}'; }
+    bool mutable first_field = true;
+    std::ostream& out;
+
+    template<typename Type>
+    auto append(Type const& item) const -> BracedItemStream const&
+    {
+        if (!first_field) out << ", ";
+        out << item;
+        first_field = false;
+        return *this;
+    }
+
+    template<typename Type>
+    auto append(char const* name, Type const& item) const -> BracedItemStream const&
+    {
+        if (!first_field) out << ", ";
+        out << name << '=' << item;
+        first_field = false;
+        return *this;
+    }
+};
+
+class Decoder
+{
+public:
+    Decoder(std::ostream& out) : out{out} {}
+
+    void decode(mt::Record const& record)
+    {
+        switch (record.call)
+        {
+        case mt::Call::window_name:
+            window_names[record.arg[0]] = name_in(record);
+            return;
+
+        case mt::Call::application_name:
+            application_names[record.arg[0]] = name_in(record);
+            return;
+
+        default:
+            break;
+        }
+
+        out << '[' << record.timestamp/1000000000 << '.'
+            << std::setw(6) << std::setfill('0') << record.timestamp/1000 % 1000000 << std::setfill(' ')
+            << "] #" << record.thread << ' ';
+
+        switch (record.call)
+        {
+        case mt::Call::dropped:
+        case mt::Call::exception:
+        case mt::Call::end_of_transaction:
+            break;
+
+        default:
+            out << name_of(record.call) << ' ';
+        }
+
+        if (record.call < mt::Call::count)
+            render(call_formats[static_cast<unsigned>(record.call)], record);
+
+        out << '\n';
+    }
+
+private:
+    std::ostream& out;
+    std::map<uint64_t, std::string> window_names;
+    std::map<uint64_t, std::string> application_names;
+
+    static auto name_in(mt::Record const& record) -> std::string
+    {
+        auto const text = reinterpret_cast<char const*>(&record.arg[1]);
+        return std::string(text, strnlen(text, mt::max_name_length));
+    }
+
+    static auto lookup(std::map<uint64_t, std::string> const& names, uint64_t id) -> std::string
+    {
+        if (!id)
+            return "(null)";
+
+        auto const name = names.find(id);
+        if (name != names.end())
+            return name->second;
+
+        std::ostringstream anonymous;
+        anonymous << std::showbase << std::hex << id;
+        return anonymous.str();
+    }
+
+    void render(char const* format, mt::Record const& record)
+    {
+        // Padded so that a conversion near the end of the arguments reads zeros
+        uint64_t args[2*arg_count] = {};
+        std::copy(std::begin(record.arg), std::end(record.arg), args);
+        unsigned used = 0;
+
+        auto take = [&](unsigned count)
+            {
+                auto const result = args + std::min<unsigned>(used, arg_count);
+                used += count;
+                return result;
+            };
+
+        for (auto f = format; *f; ++f)
+        {
+            if (*f != '%' || !f[1])
+            {
+                out << *f;
+                continue;
+            }
+
+            switch (*++f)
+            {
+            case 'w': out << lookup(window_names, *take(1)); break;
+            case 'a': out << lookup(application_names, *take(1)); break;
+            case 'k': out << std::showbase << std::hex << *take(1) << std::dec << std::noshowbase; break;
+            case 'n': out << *take(1); break;
+            case 'S': out << static_cast<MirWindowState>(*take(1)); break;
+            case 'c': out << name_of(static_cast<mt::Call>(*take(1))); break;
+            case 'p': out << point(*take(1)); break;
+            case 's': out << size(*take(1)); break;
+            case 'd': out << displacement(*take(1)); break;
+            case 'N': out << name_in(record); used = arg_count; break;
+            case 'r':
+            {
+                auto const a = take(2);
+                out << geom::Rectangle{point(a[0]), size(a[1])};
+                break;
+            }
+            case 'm': render_specification(take(4)); break;
+            case 'W': render_windows(take(6)); break;
+            case 'K': render_keyboard_event(take(5)); break;
+            case 'P': render_pointer_event(take(6)); break;
+            case 'T': render_touch_event(take(5)); break;
+            default:
+                out << '%' << *f;
+            }
+        }
+    }
+
+    void render_specification(uint64_t const* a)
+    {
+        BracedItemStream bout{out};
+
+        if (a[0] & mt::has_top_left) bout.append("top_left", point(a[1]));
+        if (a[0] & mt::has_size) bout.append("size", size(a[2]));
+        if (a[0] & mt::has_state) bout.append("state", static_cast<MirWindowState>(a[3]));
+    }
+
+    void render_windows(uint64_t const* a)
+    {
+        BracedItemStream bout{out};
+
+        auto const recorded = std::min<uint64_t>(a[0], arg_count - 1);
+        for (auto i = 0u; i != recorded; ++i)
+            bout.append(lookup(window_names, a[1 + i]));
+
+        if (a[0] > recorded)
+            bout.append("(" + std::to_string(a[0] - recorded) + " more)");
+    }
+
+    void render_keyboard_event(uint64_t const* a)
+    {
+        BracedItemStream bout{out};
+
+        bout.append("from", a[0])
+            .append("action", static_cast<MirKeyboardAction>(a[1]))
+            .append("code", a[2])
+            .append("scan", a[3]);
+
+        out.setf(std::ios_base::hex, std::ios_base::basefield);
+        bout.append("modifiers", a[4]);
+        out.setf(std::ios_base::dec, std::ios_base::basefield);
+    }
+
+    void render_pointer_event(uint64_t const* a)
+    {
+        BracedItemStream bout{out};
+
+        bout.append("from", a[0])
+            .append("action", static_cast<MirPointerAction>(mt::unpack_first(a[1])))
+            .append("button_state", mt::unpack_second(a[1]))
+            .append("x", mt::unpack_first_float(a[2]))
+            .append("y", mt::unpack_second_float(a[2]))
+            .append("dx", mt::unpack_first_float(a[3]))
+            .append("dy", mt::unpack_second_float(a[3]))
+            .append("vscroll", mt::unpack_first_float(a[4]))
+            .append("hscroll", mt::unpack_second_float(a[4]));
+
+        out.setf(std::ios_base::hex, std::ios_base::basefield);
+        bout.append("modifiers", a[5]);
+        out.setf(std::ios_base::dec, std::ios_base::basefield);
+    }
+
+    void render_touch_event(uint64_t const* a)
+    {
+        BracedItemStream bout{out};
+
+        bout.append("from", a[0]);
+
+        if (a[1] > 0)
+        {
+            BracedItemStream{out}
+                .append("id", mt::unpack_first(a[2]))
+                .append("action", static_cast<MirTouchAction>(mt::unpack_second(a[2]) & 0xffff))
+                .append("tool", static_cast<MirTouchTooltype>(mt::unpack_second(a[2]) >> 16))
+                .append("x", mt::unpack_first_float(a[3]))
+                .append("y", mt::unpack_second_float(a[3]));
+        }
+
+        if (a[1] > 1)
+            bout.append("(" + std::to_string(a[1] - 1) + " more)");
+
+        out.setf(std::ios_base::hex, std::ios_base::basefield);
+        bout.append("modifiers", a[4]);
+        out.setf(std::ios_base::dec, std::ios_base::basefield);
+    }
+};
+}
+
+void mt::decode(std::istream& in, std::ostream& out)
+{
+    FileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof header) ||
+        !std::equal(std::begin(header.magic), std::end(header.magic), std::begin(magic)))
+        throw std::runtime_error("Not a window management trace");
+
+    if (header.version != version || header.record_size != sizeof(Record))
+        throw std::runtime_error("Unsupported window management trace version " + std::to_string(header.version));
+
+    Decoder decoder{out};
+    Record record;
+
+    // A trace cut short (e.g. by a crash) may end with a partial record, which is ignored
+    while (in.read(reinterpret_cast<char*>(&record), sizeof record))
+        decoder.decode(record);
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIRAL_WINDOW_MANAGEMENT_TRACE_DECODER_H
+#define MIRAL_WINDOW_MANAGEMENT_TRACE_DECODER_H
+
+#include <iosfwd>
+
+namespace miral
+{
+namespace trace
+{
+/// Render a binary window management trace as text, one line per call.
+/// \throws std::runtime_error if the input is not a trace this version understands
+void decode(std::istream& in, std::ostream& out);
+}
+}
+
+#endif //MIRAL_WINDOW_MANAGEMENT_TRACE_DECODER_H
@@ -0,0 +1,171 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIRAL_WINDOW_MANAGEMENT_TRACE_FORMAT_H
+#define MIRAL_WINDOW_MANAGEMENT_TRACE_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+/// The file format written by WindowManagementBinaryTrace and read by mirwmtrace.
+///
+/// A file is a FileHeader followed by fixed-size Records. Windows, applications
+/// and workspaces are recorded by identity; when a window or application is
+/// created (or a window renamed) a "name" Record maps the identity to its name.
+namespace miral
+{
+namespace trace
+{
+/// Each call is listed with the format used to render it. The conversions consume
+/// successive record arguments:
+///   %w window  %a application  %k workspace  %n number  %S window state
+///   %p point  %s size  %d displacement  %r rectangle (2 args)
+///   %m window specification (4 args)  %W window list (6 args)
+///   %K keyboard event (5 args)  %P pointer event (6 args)  %T touch event (5 args)
+///   %c call (the name of another call)  %N name (the remaining args as text)
+#define MIRAL_TRACE_CALLS(X)\
+    X(window_name,                          "%w is \"%N\"")\
+    X(application_name,                     "%a is \"%N\"")\
+    X(dropped,                              "[%n records dropped]")\
+    X(exception,                            "%c throws")\
+    X(end_of_transaction,                   "====")\
+    X(count_applications,                   "-> %n")\
+    X(for_each_application,                 "")\
+    X(find_application,                     "-> %a")\
+    X(info_for_application,                 "-> %a")\
+    X(info_for_window,                      "-> %w")\
+    X(ask_client_to_close,                  "-> %w")\
+    X(force_close,                          "-> %w")\
+    X(active_window,                        "-> %w")\
+    X(select_active_window,                 "hint=%w -> %w")\
+    X(window_at,                            "cursor=%p -> %w")\
+    X(active_output,                        "-> %r")\
+    X(info_for_window_id,                   "-> %w")\
+    X(id_for_window,                        "window=%w")\
+    X(place_and_size_for_state,             "window_info=%w, modifications=%m")\
+    X(drag_active_window,                   "movement=%d")\
+    X(drag_window,                          "window=%w -> %d")\
+    X(focus_next_application,               "")\
+    X(focus_next_within_application,        "")\
+    X(focus_prev_within_application,        "")\
+    X(raise_tree,                           "root=%w")\
+    X(start_drag_and_drop,                  "window_info=%w")\
+    X(end_drag_and_drop,                    "")\
+    X(modify_window,                        "window_info=%w, modifications=%m")\
+    X(invoke_under_lock,                    "")\
+    X(create_workspace,                     "-> %k")\
+    X(add_tree_to_workspace,                "window=%w, workspace=%k")\
+    X(remove_tree_from_workspace,           "window=%w, workspace=%k")\
+    X(move_workspace_content_to_workspace,  "to_workspace=%k, from_workspace=%k")\
+    X(for_each_workspace_containing,        "window=%w")\
+    X(for_each_window_in_workspace,         "workspace=%k")\
+    X(place_new_window,                     "app_info=%a -> %m")\
+    X(handle_window_ready,                  "window_info=%w")\
+    X(handle_modify_window,                 "window_info=%w, modifications=%m")\
+    X(handle_raise_window,                  "window_info=%w")\
+    X(handle_keyboard_event,                "event=%K")\
+    X(handle_touch_event,                   "event=%T")\
+    X(handle_pointer_event,                 "event=%P")\
+    X(confirm_inherited_move,               "window_info=%w, movement=%d")\
+    X(advise_begin,                         "")\
+    X(advise_end,                           "")\
+    X(advise_new_app,                       "application=%a")\
+    X(advise_delete_app,                    "application=%a")\
+    X(advise_new_window,                    "window_info=%w")\
+    X(advise_focus_lost,                    "window_info=%w")\
+    X(advise_focus_gained,                  "window_info=%w")\
+    X(advise_state_change,                  "window_info=%w, state=%S")\
+    X(advise_move_to,                       "window_info=%w, top_left=%p")\
+    X(advise_resize,                        "window_info=%w, new_size=%s")\
+    X(advise_delete_window,                 "window_info=%w")\
+    X(advise_raise,                         "windows=%W")
+
+enum class Call : uint16_t
+{
+#define MIRAL_TRACE_ENUMERATOR(call, format) call,
+    MIRAL_TRACE_CALLS(MIRAL_TRACE_ENUMERATOR)
+#undef MIRAL_TRACE_ENUMERATOR
+    count
+};
+
+struct Record
+{
+    uint64_t timestamp; ///< nanoseconds on the steady clock
+    uint32_t thread;    ///< the recording thread, numbered from 1 in order of first use
+    Call call;
+    uint16_t reserved;
+    uint64_t arg[6];
+};
+
+static_assert(sizeof(Record) == 64, "Records must be a fixed size");
+
+/// The text of a name Record follows its id, and may be truncated
+unsigned int const max_name_length = sizeof(Record::arg) - sizeof(Record::arg[0]);
+
+struct FileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+char const magic[8] = {'M', 'I', 'R', 'A', 'L', 'W', 'M', 'T'};
+uint32_t const version = 1;
+
+/// Bits in the first argument of a window specification
+enum SpecificationFields : uint64_t
+{
+    has_top_left    = 1 << 0,
+    has_size        = 1 << 1,
+    has_state       = 1 << 2,
+};
+
+inline auto pack(int32_t first, int32_t second) -> uint64_t
+{
+    return (uint64_t(uint32_t(first)) << 32) | uint32_t(second);
+}
+
+inline auto unpack_first(uint64_t packed) -> int32_t { return int32_t(uint32_t(packed >> 32)); }
+inline auto unpack_second(uint64_t packed) -> int32_t { return int32_t(uint32_t(packed)); }
+
+inline auto pack(float first, float second) -> uint64_t
+{
+    uint32_t bits[2];
+    std::memcpy(&bits[0], &first, sizeof first);
+    std::memcpy(&bits[1], &second, sizeof second);
+    return (uint64_t(bits[0]) << 32) | bits[1];
+}
+
+inline auto unpack_first_float(uint64_t packed) -> float
+{
+    auto const bits = uint32_t(packed >> 32);
+    float result;
+    std::memcpy(&result, &bits, sizeof result);
+    return result;
+}
+
+inline auto unpack_second_float(uint64_t packed) -> float
+{
+    auto const bits = uint32_t(packed);
+    float result;
+    std::memcpy(&result, &bits, sizeof result);
+    return result;
+}
+}
+}
+
+#endif //MIRAL_WINDOW_MANAGEMENT_TRACE_FORMAT_H
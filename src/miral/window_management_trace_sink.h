@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIRAL_WINDOW_MANAGEMENT_TRACE_SINK_H
+#define MIRAL_WINDOW_MANAGEMENT_TRACE_SINK_H
+
+#include "window_management_trace_format.h"
+
+#include "miral/application_info.h"
+#include "miral/window_manager_tools.h"
+#include "miral/window_management_policy.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace miral
+{
+/// Where WindowManagementTrace records the calls it sees.
+///
+/// Each function is called when the call of the same name is made (after it
+/// returns, if there is a result to record). Input events are only recorded if
+/// handling them leads to a call on the tools, so are reported just before that call.
+class WindowManagementTraceSink
+{
+public:
+    virtual ~WindowManagementTraceSink() = default;
+
+    virtual void count_applications(unsigned int result) = 0;
+    virtual void for_each_application() = 0;
+    virtual void find_application(Application const& result) = 0;
+    virtual void info_for(ApplicationInfo const& result) = 0;
+    virtual void info_for(WindowInfo const& result) = 0;
+    virtual void ask_client_to_close(Window const& window) = 0;
+    virtual void force_close(Window const& window) = 0;
+    virtual void active_window(Window const& result) = 0;
+    virtual void select_active_window(Window const& hint, Window const& result) = 0;
+    virtual void window_at(Point cursor, Window const& result) = 0;
+    virtual void active_output(Rectangle const& result) = 0;
+    virtual void info_for_window_id(std::string const& id, WindowInfo const& result) = 0;
+    virtual void id_for_window(Window const& window, std::string const& result) = 0;
+    virtual void place_and_size_for_state(WindowSpecification const& modifications, WindowInfo const& window_info) = 0;
+    virtual void drag_active_window(Displacement movement) = 0;
+    virtual void drag_window(Window const& window, Displacement movement) = 0;
+    virtual void focus_next_application() = 0;
+    virtual void focus_next_within_application() = 0;
+    virtual void focus_prev_within_application() = 0;
+    virtual void raise_tree(Window const& root) = 0;
+    virtual void start_drag_and_drop(WindowInfo const& window_info) = 0;
+    virtual void end_drag_and_drop() = 0;
+    virtual void modify_window(WindowInfo const& window_info, WindowSpecification const& modifications) = 0;
+    virtual void invoke_under_lock() = 0;
+
+    virtual void create_workspace(std::shared_ptr<Workspace> const& result) = 0;
+    virtual void add_tree_to_workspace(Window const& window, std::shared_ptr<Workspace> const& workspace) = 0;
+    virtual void remove_tree_from_workspace(Window const& window, std::shared_ptr<Workspace> const& workspace) = 0;
+    virtual void move_workspace_content_to_workspace(
+        std::shared_ptr<Workspace> const& to_workspace,
+        std::shared_ptr<Workspace> const& from_workspace) = 0;
+    virtual void for_each_workspace_containing(Window const& window) = 0;
+    virtual void for_each_window_in_workspace(std::shared_ptr<Workspace> const& workspace) = 0;
+
+    virtual void place_new_window(
+        ApplicationInfo const& app_info,
+        WindowSpecification const& requested_specification,
+        WindowSpecification const& result) = 0;
+    virtual void handle_window_ready(WindowInfo const& window_info) = 0;
+    virtual void handle_modify_window(WindowInfo const& window_info, WindowSpecification const& modifications) = 0;
+    virtual void handle_raise_window(WindowInfo const& window_info) = 0;
+    virtual void handle_keyboard_event(MirKeyboardEvent const* event) = 0;
+    virtual void handle_touch_event(MirTouchEvent const* event) = 0;
+    virtual void handle_pointer_event(MirPointerEvent const* event) = 0;
+    virtual void confirm_inherited_move(WindowInfo const& window_info, Displacement movement) = 0;
+
+    /// A transaction that made calls on the tools has ended
+    virtual void end_of_transaction() = 0;
+
+    virtual void advise_new_app(ApplicationInfo const& application) = 0;
+    virtual void advise_delete_app(ApplicationInfo const& application) = 0;
+    virtual void advise_new_window(WindowInfo const& window_info) = 0;
+    virtual void advise_focus_lost(WindowInfo const& window_info) = 0;
+    virtual void advise_focus_gained(WindowInfo const& window_info) = 0;
+    virtual void advise_state_change(WindowInfo const& window_info, MirWindowState state) = 0;
+    virtual void advise_move_to(WindowInfo const& window_info, Point top_left) = 0;
+    virtual void advise_resize(WindowInfo const& window_info, Size const& new_size) = 0;
+    virtual void advise_delete_window(WindowInfo const& window_info) = 0;
+    virtual void advise_raise(std::vector<Window> const& windows) = 0;
+
+    /// Called from the handler of an exception thrown by call (whose function is named function)
+    virtual void exception(trace::Call call, char const* function) = 0;
+
+protected:
+    WindowManagementTraceSink() = default;
+    WindowManagementTraceSink(WindowManagementTraceSink const&) = delete;
+    WindowManagementTraceSink& operator=(WindowManagementTraceSink const&) = delete;
+};
+}
+
+#endif //MIRAL_WINDOW_MANAGEMENT_TRACE_SINK_H
@@ -248,25 +248,6 @@ XcursorImagesDestroy (XcursorImages *images)
     free (images);
 }
 
-static void
-XcursorImagesSetName (XcursorImages *images, const char *name)
-{
-    char    *new;
-
-    if (!images || !name)
-        return;
-
-    new = malloc (strlen (name) + 1);
-
-    if (!new)
-	return;
-
-    strcpy (new, name);
-    if (images->name)
-	free (images->name);
-    images->name = new;
-}
-
 static XcursorBool
 _XcursorReadUInt (XcursorFile *file, XcursorUInt *u)
 {
@@ -790,15 +771,13 @@ _XcursorThemeInherits (const char *full)
 }
 
 static void
-load_all_cursors_from_dir(const char *path, int size,
-			  void (*load_callback)(XcursorImages *, void *),
-			  void *user_data)
+index_all_cursors_in_dir(const char *path,
+			 void (*index_callback)(const char *, const char *, void *),
+			 void *user_data)
 {
-	FILE *f;
 	DIR *dir = opendir(path);
 	struct dirent *ent;
 	char *full;
-	XcursorImages *images;
 
 	if (!dir)
 		return;
@@ -814,48 +793,33 @@ load_all_cursors_from_dir(const char *path, int size,
 		if (!full)
 			continue;
 
-		f = fopen(full, "r");
-		if (!f) {
-			free(full);
-			continue;
-		}
-
-		images = XcursorFileLoadImages(f, size);
+		index_callback(ent->d_name, full, user_data);
 
-		if (images) {
-			XcursorImagesSetName(images, ent->d_name);
-			load_callback(images, user_data);
-		}
-
-		fclose (f);
 		free(full);
 	}
 
 	closedir(dir);
 }
 
-/** Load all the cursor of a theme
+/** Index all the cursors of a theme
  *
- * This function loads all the cursor images of a given theme and its
- * inherited themes. Each cursor is loaded into an XcursorImages object
- * which is passed to the caller's load callback. If a cursor appears
- * more than once across all the inherited themes, the load callback
- * will be called multiple times, with possibly different XcursorImages
- * object which have the same name. The user is expected to destroy the
- * XcursorImages objects passed to the callback with
- * XcursorImagesDestroy().
+ * This function finds the cursor files of a given theme and its
+ * inherited themes without reading them. The index callback is called
+ * with the name and full path of each file found. If a cursor appears
+ * more than once across all the inherited themes, the index callback
+ * will be called multiple times with the same name. The files can be
+ * read later, as they are needed, with xcursor_load_images().
  *
- * \param theme The name of theme that should be loaded
- * \param size The desired size of the cursor images
- * \param load_callback A callback function that will be called
- * for each cursor loaded. The first parameter is the XcursorImages
- * object representing the loaded cursor and the second is a pointer
- * to data provided by the user.
- * \param user_data The data that should be passed to the load callback
+ * \param theme The name of theme that should be indexed
+ * \param index_callback A callback function that will be called
+ * for each cursor found. The first parameter is the name of the cursor,
+ * the second is the path of the file containing it and the third is a
+ * pointer to data provided by the user.
+ * \param user_data The data that should be passed to the index callback
  */
 void
-xcursor_load_theme(const char *theme, int size,
-		    void (*load_callback)(XcursorImages *, void *),
+xcursor_index_theme(const char *theme,
+		    void (*index_callback)(const char *, const char *, void *),
 		    void *user_data)
 {
 	char *full, *dir;
@@ -875,8 +839,8 @@ xcursor_load_theme(const char *theme, int size,
 		full = _XcursorBuildFullname(dir, "cursors", "");
 
 		if (full) {
-			load_all_cursors_from_dir(full, size, load_callback,
-						  user_data);
+			index_all_cursors_in_dir(full, index_callback,
+						 user_data);
 			free(full);
 		}
 
@@ -892,8 +856,32 @@ xcursor_load_theme(const char *theme, int size,
 	}
 
 	for (i = inherits; i; i = _XcursorNextPath(i))
-		xcursor_load_theme(i, size, load_callback, user_data);
+		xcursor_index_theme(i, index_callback, user_data);
 
 	if (inherits)
 		free(inherits);
 }
+
+/** Load the images of a cursor file
+ *
+ * \param path The path of the cursor file, as found by xcursor_index_theme()
+ * \param size The desired size of the cursor images
+ * \return The images of the best matching size, or NULL if the file
+ * could not be read. The caller is expected to destroy the result with
+ * XcursorImagesDestroy().
+ */
+XcursorImages *
+xcursor_load_images(const char *path, int size)
+{
+	FILE *f;
+	XcursorImages *images;
+
+	f = fopen(path, "r");
+	if (!f)
+		return NULL;
+
+	images = XcursorFileLoadImages(f, size);
+
+	fclose(f);
+	return images;
+}
@@ -21,7 +21,9 @@
 #include <mir/graphics/cursor_image.h>
 
 #include <boost/throw_exception.hpp>
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include <string.h>
 
@@ -44,9 +46,21 @@ namespace
 class XCursorImage : public mg::CursorImage
 {
 public:
-    XCursorImage(_XcursorImage *image, std::shared_ptr<_XcursorImages> const& save_resource)
-        : image(image),
-          save_resource(save_resource)
+    // Copies the frames we use so the rest of the file's images can be freed straight away
+    XCursorImage(std::vector<_XcursorImage const*> const& frames)
+        : XCursorImage(frames.front())
+    {
+        for (auto frame = frames.begin() + 1; frame != frames.end(); ++frame)
+            later_frames.push_back(std::make_unique<XCursorImage>(*frame));
+    }
+
+    XCursorImage(_XcursorImage const* image)
+        : pixels(image->pixels, image->pixels + image->width*image->height),
+          width(image->width),
+          height(image->height),
+          xhot(image->xhot),
+          yhot(image->yhot),
+          frame_delay(image->delay)
     {
     }
 
@@ -56,22 +70,66 @@ public:
 
     void const* as_argb_8888() const override
     {
-        return image->pixels;
+        return pixels.data();
     }
     geom::Size size() const override
     {
-        return {image->width, image->height};
+        return {width, height};
     }
     geom::Displacement hotspot() const override
     {
-        return {image->xhot, image->yhot};
+        return {xhot, yhot};
+    }
+
+    unsigned int frame_count() const override
+    {
+        return 1 + later_frames.size();
+    }
+    mg::CursorImage const& frame(unsigned int index) const override
+    {
+        return index == 0 ? *this : *later_frames.at(index - 1);
+    }
+    std::chrono::milliseconds delay(unsigned int index) const override
+    {
+        return std::chrono::milliseconds{index == 0 ? frame_delay : later_frames.at(index - 1)->frame_delay};
     }
 
 private:
-    _XcursorImage *image;
-    std::shared_ptr<_XcursorImages> const save_resource;
+    std::vector<XcursorPixel> const pixels;
+    XcursorDim const width;
+    XcursorDim const height;
+    XcursorDim const xhot;
+    XcursorDim const yhot;
+    XcursorUInt const frame_delay;
+    std::vector<std::unique_ptr<XCursorImage>> later_frames;
 };
 
+// Each XcursorImages represents the frames of a symbolic cursor at the nominal size requested.
+// Animated cursors have several frames of that size, which we keep in order.
+std::shared_ptr<mg::CursorImage> appropriately_sized_image(_XcursorImages const* images)
+{
+    auto const frames_sized = [images](XcursorDim width, XcursorDim height)
+        {
+            std::vector<_XcursorImage const*> frames;
+            for (int i = 0; i < images->nimage; i++)
+            {
+                _XcursorImage const* candidate = images->images[i];
+                if (candidate->width == width && candidate->height == height)
+                    frames.push_back(candidate);
+            }
+            return frames;
+        };
+
+    auto frames = frames_sized(
+        mi::default_cursor_size.width.as_uint32_t(),
+        mi::default_cursor_size.height.as_uint32_t());
+
+    if (frames.empty())
+        frames = frames_sized(images->images[0]->width, images->images[0]->height);
+
+    return std::make_shared<XCursorImage>(frames);
+}
+
 std::string const
 xcursor_name_for_mir_cursor(std::string const& mir_cursor_name)
 {
@@ -144,54 +202,56 @@ xcursor_name_for_mir_cursor(std::string const& mir_cursor_name)
 
 miral::XCursorLoader::XCursorLoader()
 {
-    load_cursor_theme("default");
+    index_cursor_theme("default");
 }
 
 miral::XCursorLoader::XCursorLoader(std::string const& theme)
 {
-    load_cursor_theme(theme);
+    index_cursor_theme(theme);
 }
 
-// Each XcursorImages represents images for the different sizes of a given symbolic cursor.
-void miral::XCursorLoader::load_appropriately_sized_image(_XcursorImages *images)
+void miral::XCursorLoader::index_cursor_theme(std::string const& theme_name)
 {
-    // We would rather take this lock in load_cursor_theme but the Xcursor lib style
-    // makes it difficult to use our standard 'pass the lg around to _locked members' pattern
     std::lock_guard<std::mutex> lg(guard);
 
-    // We have to save all the images as XCursor expects us to free them.
-    // This contains the actual image data though, so we need to ensure they stay alive
-    // with the lifetime of the mg::CursorImage instance which refers to them.
-    auto saved_xcursor_library_resource = std::shared_ptr<_XcursorImages>(images, [](_XcursorImages *images)
+    xcursor_index_theme(theme_name.c_str(),
+        [](char const* name, char const* path, void *this_ptr)  -> void
         {
-            XcursorImagesDestroy(images);
-        });
+            // Can't use lambda capture as this lambda is thunked to a C function ptr
+            auto p = static_cast<miral::XCursorLoader*>(this_ptr);
+            p->cursor_files[name].push_back(path);
+        }, this);
+}
 
-    for (int i = 0; i < images->nimage; i++)
+std::shared_ptr<mg::CursorImage> miral::XCursorLoader::image_locked(
+    std::lock_guard<std::mutex> const&,
+    std::string const& xcursor_name)
+{
+    auto const loaded = loaded_images.find(xcursor_name);
+    if (loaded != loaded_images.end())
+        return loaded->second;
+
+    auto const files = cursor_files.find(xcursor_name);
+    if (files == cursor_files.end())
+        return nullptr;
+
+    std::shared_ptr<mg::CursorImage> result;
+
+    // A cursor found later in the theme search (e.g. in an inherited theme) takes precedence.
+    // Cursors are named by their square dimension...called the nominal size in XCursor terminology,
+    // so we just look up by width. Later we verify the actual size.
+    for (auto path = files->second.rbegin(); path != files->second.rend() && !result; ++path)
     {
-        _XcursorImage *candidate = images->images[i];
-        if (candidate->width == mi::default_cursor_size.width.as_uint32_t() &&
-            candidate->height == mi::default_cursor_size.height.as_uint32_t())
+        if (auto const images = xcursor_load_images(path->c_str(), mi::default_cursor_size.width.as_uint32_t()))
         {
-            loaded_images[std::string(images->name)] = std::make_shared<XCursorImage>(candidate, saved_xcursor_library_resource);
-            return;
+            result = appropriately_sized_image(images);
+            XcursorImagesDestroy(images);
         }
     }
 
-    loaded_images[std::string(images->name)] = std::make_shared<XCursorImage>(images->images[0], saved_xcursor_library_resource);
-}
-
-void miral::XCursorLoader::load_cursor_theme(std::string const& theme_name)
-{
-    // Cursors are named by their square dimension...called the nominal size in XCursor terminology, so we just look up by width.
-    // Later we verify the actual size.
-    xcursor_load_theme(theme_name.c_str(), mi::default_cursor_size.width.as_uint32_t(),
-        [](XcursorImages* images, void *this_ptr)  -> void
-        {
-            // Can't use lambda capture as this lambda is thunked to a C function ptr
-            auto p = static_cast<miral::XCursorLoader*>(this_ptr);
-            p->load_appropriately_sized_image(images);
-        }, this);
+    // Remember failures too, so we don't keep rereading unusable files
+    loaded_images[xcursor_name] = result;
+    return result;
 }
 
 std::shared_ptr<mg::CursorImage> miral::XCursorLoader::image(
@@ -202,14 +262,9 @@ std::shared_ptr<mg::CursorImage> miral::XCursorLoader::image(
 
     std::lock_guard<std::mutex> lg(guard);
 
-    auto it = loaded_images.find(xcursor_name);
-    if (it != loaded_images.end())
-        return it->second;
+    if (auto const image = image_locked(lg, xcursor_name))
+        return image;
 
     // Fall back
-    it = loaded_images.find("arrow");
-    if (it != loaded_images.end())
-        return it->second;
-
-    return nullptr;
+    return image_locked(lg, "arrow");
 }
@@ -26,12 +26,7 @@
 #include <string>
 #include <map>
 #include <mutex>
-
-// Unfortunately this library does not compile as C++ so we can not namespace it.
-extern "C"
-{
-struct _XcursorImages;
-}
+#include <vector>
 
 namespace mir { namespace graphics { class CursorImage; } }
 
@@ -55,10 +50,15 @@ protected:
 private:
     std::mutex guard;
 
+    // The files providing each cursor, in the order the theme search finds them.
+    // They are only read when a cursor is first asked for.
+    std::map<std::string, std::vector<std::string>> cursor_files;
     std::map<std::string, std::shared_ptr<mir::graphics::CursorImage>> loaded_images;
 
-    void load_cursor_theme(std::string const& theme_name);
-    void load_appropriately_sized_image(_XcursorImages *images);
+    void index_cursor_theme(std::string const& theme_name);
+    std::shared_ptr<mir::graphics::CursorImage> image_locked(
+        std::lock_guard<std::mutex> const&,
+        std::string const& xcursor_name);
 };
 }
 
@@ -132,6 +132,14 @@ std::ostream& mg::operator<<(std::ostream& out, mg::DisplayConfigurationOutput c
     }
     out << std::endl;
 
+    out << "\tvrr: ";
+    if (val.vrr_capable)
+        out << val.min_vrr_hz << "-" << val.max_vrr_hz << "Hz, "
+            << (val.vrr_enabled ? "enabled" : "disabled");
+    else
+        out << "not supported";
+    out << std::endl;
+
     out << "\torientation: " << val.orientation << '\n';
     out << "}" << std::endl;
 
@@ -188,7 +196,11 @@ bool mg::operator==(mg::DisplayConfigurationOutput const& val1,
                (val1.modes.size() == val2.modes.size()) &&
                (val1.custom_logical_size == val2.custom_logical_size) &&
                (val1.scale == val2.scale) &&
-               (val1.form_factor == val2.form_factor)};
+               (val1.form_factor == val2.form_factor) &&
+               (val1.vrr_capable == val2.vrr_capable) &&
+               (val1.min_vrr_hz == val2.min_vrr_hz) &&
+               (val1.max_vrr_hz == val2.max_vrr_hz) &&
+               (val1.vrr_enabled == val2.vrr_enabled)};
 
     if (equal)
     {
@@ -268,6 +280,24 @@ glm::mat2 mg::DisplayConfigurationOutput::transformation() const
     return mg::transformation(orientation);
 }
 
+double mg::DisplayConfigurationOutput::min_refresh_hz() const
+{
+    if (vrr_capable && vrr_enabled)
+        return min_vrr_hz;
+
+    return current_mode_index < modes.size() ?
+           modes[current_mode_index].vrefresh_hz : 0.0;
+}
+
+double mg::DisplayConfigurationOutput::max_refresh_hz() const
+{
+    if (vrr_capable && vrr_enabled)
+        return max_vrr_hz;
+
+    return current_mode_index < modes.size() ?
+           modes[current_mode_index].vrefresh_hz : 0.0;
+}
+
 bool mg::DisplayConfigurationOutput::valid() const
 {
     if (!connected)
@@ -326,7 +356,11 @@ mg::UserDisplayConfigurationOutput::UserDisplayConfigurationOutput(
         gamma(master.gamma),
         gamma_supported(master.gamma_supported),
         edid(*reinterpret_cast<std::vector<uint8_t const>*>(&master.edid)),
-        custom_logical_size(master.custom_logical_size)
+        custom_logical_size(master.custom_logical_size),
+        vrr_capable(master.vrr_capable),
+        min_vrr_hz(master.min_vrr_hz),
+        max_vrr_hz(master.max_vrr_hz),
+        vrr_enabled(master.vrr_enabled)
 {
 }
 
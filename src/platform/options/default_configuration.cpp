@@ -55,10 +55,18 @@ char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
+char const* const mo::metrics_file_opt            = "metrics-file";
+char const* const mo::compositor_thread_policy_opt = "compositor-thread-policy";
+char const* const mo::compositor_cpu_affinity_opt = "compositor-cpu-affinity";
+char const* const mo::compositor_latency_hint_opt = "compositor-latency-hint";
+char const* const mo::renderer_opt                = "renderer";
+char const* const mo::input_thread_policy_opt     = "input-thread-policy";
+char const* const mo::input_cpu_affinity_opt      = "input-cpu-affinity";
 
 char const* const mo::off_opt_value = "off";
 char const* const mo::log_opt_value = "log";
 char const* const mo::lttng_opt_value = "lttng";
+char const* const mo::metrics_opt_value = "metrics";
 
 char const* const mo::platform_graphics_lib = "platform-graphics-lib";
 char const* const mo::platform_input_lib = "platform-input-lib";
@@ -158,21 +166,24 @@ mo::DefaultConfiguration::DefaultConfiguration(
         (enable_input_opt, po::value<bool>()->default_value(enable_input_default),
             "Enable input.")
         (compositor_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "Compositor reporting [{log,lttng,off}]")
+            "Compositor reporting [{log,lttng,metrics,off}]")
         (connector_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the Connector report. [{log,lttng,off}]")
         (display_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the Display report. [{log,lttng,off}]")
         (input_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle to Input report. [{log,lttng,off}]")
+            "How to handle to Input report. [{log,lttng,metrics,off}]")
         (legacy_input_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the Legacy Input report. [{log,off}]")
         (seat_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle to Seat report. [{log,off}]")
         (session_mediator_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle the SessionMediator report. [{log,lttng,off}]")
+            "How to handle the SessionMediator report. [{log,lttng,metrics,off}]")
         (msg_processor_report_opt, po::value<std::string>()->default_value(off_opt_value),
-            "How to handle the MessageProcessor report. [{log,lttng,off}]")
+            "How to handle the MessageProcessor report. [{log,lttng,metrics,off}]")
+        (metrics_file_opt, po::value<std::string>(),
+            "File periodically replaced with a snapshot of the reports set to \"metrics\" "
+            "[string:default=$XDG_RUNTIME_DIR/mir_metrics]")
         (scene_report_opt, po::value<std::string>()->default_value(off_opt_value),
             "How to handle the scene report. [{log,lttng,off}]")
         (shared_library_prober_report_opt, po::value<std::string>()->default_value(log_opt_value),
@@ -184,6 +195,25 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "frames from clients before compositing). Higher values result in "
             "lower latency but risk causing frame skipping. "
             "Default: A negative value means decide automatically.")
+        (compositor_thread_policy_opt, po::value<std::string>(),
+            "Scheduling of compositing threads [{nice:<level>,fifo:<priority>,rr:<priority>}] "
+            "(real-time policies and negative nice levels need CAP_SYS_NICE)")
+        (compositor_cpu_affinity_opt, po::value<std::string>(),
+            "CPUs to run compositing threads on, either for all outputs or per output. "
+            "E.g. \"2-3\" or \"HDMI-1=2;eDP-1=3\"")
+        (compositor_latency_hint_opt, po::value<bool>()->default_value(false),
+            "Ask the kernel to raise CPU frequency whenever a compositing thread runs")
+        (renderer_opt, po::value<std::string>()->default_value("gl"),
+            "How outputs are composited [{gl,software}]. \"software\" draws on the CPU, "
+            "for outputs without hardware accelerated GL (screencasts, and outputs the "
+            "platform can't map for the CPU, still use GL)")
+        (input_thread_policy_opt, po::value<std::string>(),
+            "Scheduling of the input thread [{nice:<level>,fifo:<priority>,rr:<priority>}]")
+        (input_cpu_affinity_opt, po::value<std::string>(),
+            "CPUs to run the input thread on, e.g. \"0\" or \"0,2-3\"")
+        (frontend_threads_opt, po::value<int>()->default_value(1),
+            "Number of threads handling client requests. Each client's "
+            "requests are still handled in order.")
         (name_opt, po::value<std::string>(),
             "When nested, the name Mir uses when registering with the host.")
         (nested_passthrough_opt, po::value<bool>()->default_value(true),
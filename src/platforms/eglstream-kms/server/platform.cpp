@@ -162,7 +162,9 @@ mir::UniqueModulePtr<mg::PlatformIpcOperations> mge::RenderingPlatform::make_ipc
 
         std::shared_ptr<mg::PlatformIPCPackage> connection_ipc_package() override
         {
-            return std::make_shared<mg::PlatformIPCPackage>(describe_graphics_module());
+            auto const package = std::make_shared<mg::PlatformIPCPackage>(describe_graphics_module());
+            package->client_module = "eglstream";
+            return package;
         }
 
         PlatformOperationMessage platform_operation(unsigned int const /*opcode*/,
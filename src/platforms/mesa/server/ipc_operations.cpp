@@ -54,6 +54,7 @@ struct MesaPlatformIPCPackage : public mg::PlatformIPCPackage
     MesaPlatformIPCPackage(int drm_auth_fd) :
         mg::PlatformIPCPackage(&description)
     {
+        client_module = "mesa";
         ipc_fds.push_back(drm_auth_fd);
     }
 
@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atomic_request.h"
+
+#include <xf86drm.h>
+#include <cerrno>
+
+namespace mgm = mir::graphics::mesa;
+
+mgm::AtomicRequest::AtomicRequest(int drm_fd)
+    : drm_fd{drm_fd},
+      request{drmModeAtomicAlloc(), &drmModeAtomicFree},
+      extra_flags{0},
+      error{request ? 0 : -ENOMEM},
+      flipper{nullptr}
+{
+}
+
+mgm::AtomicRequest::~AtomicRequest()
+{
+    /* The kernel keeps its own reference to blobs a commit used */
+    for (auto const blob : blobs)
+        drmModeDestroyPropertyBlob(drm_fd, blob);
+}
+
+void mgm::AtomicRequest::add(uint32_t object_id, uint32_t property_id, uint64_t value)
+{
+    if (error)
+        return;
+
+    auto const result = drmModeAtomicAddProperty(request.get(), object_id, property_id, value);
+    if (result < 0)
+        error = result;
+}
+
+uint32_t mgm::AtomicRequest::add_blob(void const* data, size_t size)
+{
+    uint32_t blob{0};
+
+    if (auto const result = drmModeCreatePropertyBlob(drm_fd, data, size, &blob))
+    {
+        if (!error)
+            error = result;
+        return 0;
+    }
+
+    blobs.push_back(blob);
+    return blob;
+}
+
+void mgm::AtomicRequest::allow_modeset()
+{
+    extra_flags |= DRM_MODE_ATOMIC_ALLOW_MODESET;
+}
+
+void mgm::AtomicRequest::add_flip_target(PageFlipper& flipper, uint32_t crtc_id, uint32_t connector_id)
+{
+    if (this->flipper && this->flipper != &flipper)
+        error = -EINVAL;
+
+    this->flipper = &flipper;
+    flip_targets.push_back({crtc_id, connector_id});
+}
+
+void mgm::AtomicRequest::on_commit(std::function<void()> const& action)
+{
+    commit_actions.push_back(action);
+}
+
+bool mgm::AtomicRequest::test() const
+{
+    return drm_commit(DRM_MODE_ATOMIC_TEST_ONLY, nullptr) == 0;
+}
+
+bool mgm::AtomicRequest::flip()
+{
+    if (!flipper || error)
+        return false;
+
+    return flipper->schedule_flip(
+        flip_targets,
+        [this](void* event_data)
+        {
+            return commit(DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK, event_data);
+        });
+}
+
+int mgm::AtomicRequest::commit(uint32_t flags, void* user_data)
+{
+    auto const result = drm_commit(flags, user_data);
+
+    if (result == 0 && !(flags & DRM_MODE_ATOMIC_TEST_ONLY))
+    {
+        for (auto const& action : commit_actions)
+            action();
+    }
+
+    return result;
+}
+
+int mgm::AtomicRequest::drm_commit(uint32_t flags, void* user_data) const
+{
+    if (error)
+        return error;
+
+    return drmModeAtomicCommit(drm_fd, request.get(), flags | extra_flags, user_data);
+}
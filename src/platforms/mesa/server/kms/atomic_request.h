@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_ATOMIC_REQUEST_H_
+#define MIR_GRAPHICS_MESA_ATOMIC_REQUEST_H_
+
+#include "page_flipper.h"
+
+#include <xf86drmMode.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace mir
+{
+namespace graphics
+{
+namespace mesa
+{
+
+/**
+ * Property changes to any number of CRTCs, planes and connectors of one
+ * DRM device, applied together by a single drmModeAtomicCommit().
+ *
+ * This is how all the outputs of a DisplaySyncGroup are flipped (or
+ * modeset) at once, rather than one after the other.
+ */
+class AtomicRequest
+{
+public:
+    explicit AtomicRequest(int drm_fd);
+    ~AtomicRequest();
+
+    void add(uint32_t object_id, uint32_t property_id, uint64_t value);
+
+    /**
+     * Creates a property blob (e.g. a MODE_ID) that lives as long as this
+     * request does.
+     */
+    uint32_t add_blob(void const* data, size_t size);
+
+    /** Lets commits change modes and routing (DRM_MODE_ATOMIC_ALLOW_MODESET) */
+    void allow_modeset();
+
+    /**
+     * Expects a page flip event for crtc_id from flip(). All the targets of
+     * a request must use the same page flipper.
+     */
+    void add_flip_target(PageFlipper& flipper, uint32_t crtc_id, uint32_t connector_id);
+
+    /** Runs action after a successful commit() or flip(), but not test() */
+    void on_commit(std::function<void()> const& action);
+
+    /** Checks with a DRM_MODE_ATOMIC_TEST_ONLY commit whether the hardware accepts the request */
+    bool test() const;
+
+    /**
+     * Schedules the request as a non-blocking commit whose page flip
+     * events complete through the flip targets' page flipper.
+     */
+    bool flip();
+
+    /** \returns the drmModeAtomicCommit() result, or the first error adding to the request */
+    int commit(uint32_t flags, void* user_data);
+
+private:
+    AtomicRequest(AtomicRequest const&) = delete;
+    AtomicRequest& operator=(AtomicRequest const&) = delete;
+
+    int drm_commit(uint32_t flags, void* user_data) const;
+
+    int const drm_fd;
+    std::unique_ptr<drmModeAtomicReq, decltype(&drmModeAtomicFree)> const request;
+    std::vector<uint32_t> blobs;
+    uint32_t extra_flags;
+    int error;
+
+    PageFlipper* flipper;
+    std::vector<PageFlipTarget> flip_targets;
+    std::vector<std::function<void()>> commit_actions;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_MESA_ATOMIC_REQUEST_H_ */
@@ -0,0 +1,418 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "crtc_planes.h"
+#include "atomic_request.h"
+#include "mir/log.h"
+#include "kms-utils/drm_mode_resources.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+
+namespace mgm = mir::graphics::mesa;
+namespace mgk = mir::graphics::kms;
+
+namespace
+{
+/** \returns the id of the connector's CRTC_ID property, or 0 if it lacks one */
+uint32_t connector_crtc_id_property(int drm_fd, uint32_t connector_id)
+{
+    try
+    {
+        mgk::ObjectProperties const props{drm_fd, connector_id, DRM_MODE_OBJECT_CONNECTOR};
+        return props.id_for("CRTC_ID");
+    }
+    catch (std::exception const&)
+    {
+        return 0;
+    }
+}
+}
+
+bool mgm::KMSPlane::supports(uint32_t format) const
+{
+    return std::find(formats.begin(), formats.end(), format) != formats.end();
+}
+
+mgm::CrtcPlanes::CrtcPlanes(int drm_fd, uint32_t crtc_id)
+    : drm_fd{drm_fd},
+      crtc{crtc_id},
+      crtc_active{0},
+      crtc_mode_id{0},
+      crtc_vrr_enabled{0},
+      has_primary{false},
+      primary{}
+{
+    /* TEST_ONLY commits are what make overlay planes usable at all */
+    if (drmSetClientCap(drm_fd, DRM_CLIENT_CAP_ATOMIC, 1))
+    {
+        mir::log_info("Driver lacks atomic modesetting; not using overlay planes");
+        return;
+    }
+
+    auto const properties_of = [drm_fd](uint32_t plane_id, mgk::ObjectProperties const& props)
+        {
+            PlaneProperties properties{
+                plane_id,
+                props.id_for("FB_ID"), props.id_for("CRTC_ID"),
+                props.id_for("SRC_X"), props.id_for("SRC_Y"), props.id_for("SRC_W"), props.id_for("SRC_H"),
+                props.id_for("CRTC_X"), props.id_for("CRTC_Y"), props.id_for("CRTC_W"), props.id_for("CRTC_H"),
+                0, 0};
+
+            if (props.has_property("zpos"))
+            {
+                mgk::DRMModePropertyUPtr const zpos{
+                    drmModeGetProperty(drm_fd, props.id_for("zpos")),
+                    &drmModeFreeProperty};
+
+                if (zpos && !(zpos->flags & DRM_MODE_PROP_IMMUTABLE))
+                {
+                    properties.zpos = zpos->prop_id;
+                    properties.zpos_min = zpos->count_values > 0 ? zpos->values[0] : 0;
+                }
+                else
+                {
+                    properties.zpos_min = props["zpos"];
+                }
+            }
+            return properties;
+        };
+
+    try
+    {
+        int crtc_index{-1};
+        int index{0};
+        mgk::DRMModeResources const resources{drm_fd};
+        resources.for_each_crtc(
+            [&](mgk::DRMModeCrtcUPtr candidate)
+            {
+                if (candidate->crtc_id == crtc_id)
+                    crtc_index = index;
+                ++index;
+            });
+
+        if (crtc_index < 0)
+            return;
+
+        uint32_t const crtc_mask = 1u << crtc_index;
+
+        mgk::PlaneResources const plane_resources{drm_fd};
+        for (auto& plane : plane_resources.planes())
+        {
+            if (!(plane->possible_crtcs & crtc_mask))
+                continue;
+
+            mgk::ObjectProperties const props{drm_fd, plane->plane_id, DRM_MODE_OBJECT_PLANE};
+            auto const type = props["type"];
+
+            if (type == DRM_PLANE_TYPE_PRIMARY && !has_primary)
+            {
+                primary = properties_of(plane->plane_id, props);
+                has_primary = true;
+            }
+            else if (type == DRM_PLANE_TYPE_OVERLAY && plane->possible_crtcs == crtc_mask)
+            {
+                try
+                {
+                    overlay_properties.push_back(properties_of(plane->plane_id, props));
+                    overlay_planes.push_back(KMSPlane{
+                        plane->plane_id,
+                        {plane->formats, plane->formats + plane->count_formats},
+                        overlay_properties.back().zpos != 0});
+                }
+                catch (std::out_of_range const&)
+                {
+                    mir::log_debug("Overlay plane %u lacks a standard property; not using it", plane->plane_id);
+                }
+            }
+        }
+
+        if (!has_primary)
+        {
+            overlay_properties.clear();
+            overlay_planes.clear();
+            return;
+        }
+
+        mgk::ObjectProperties const crtc_props{drm_fd, crtc_id, DRM_MODE_OBJECT_CRTC};
+        if (crtc_props.has_property("ACTIVE") && crtc_props.has_property("MODE_ID"))
+        {
+            crtc_active = crtc_props.id_for("ACTIVE");
+            crtc_mode_id = crtc_props.id_for("MODE_ID");
+        }
+        if (crtc_props.has_property("VRR_ENABLED"))
+            crtc_vrr_enabled = crtc_props.id_for("VRR_ENABLED");
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_info("Not using overlay planes on CRTC %u: %s", crtc_id, error.what());
+        has_primary = false;
+        overlay_properties.clear();
+        overlay_planes.clear();
+    }
+}
+
+mgm::CrtcPlanes::~CrtcPlanes()
+{
+    disable_overlays();
+}
+
+uint32_t mgm::CrtcPlanes::crtc_id() const
+{
+    return crtc;
+}
+
+auto mgm::CrtcPlanes::overlays() const -> std::vector<KMSPlane> const&
+{
+    return overlay_planes;
+}
+
+bool mgm::CrtcPlanes::atomic() const
+{
+    return has_primary;
+}
+
+bool mgm::CrtcPlanes::adaptive_sync() const
+{
+    return crtc_vrr_enabled != 0;
+}
+
+bool mgm::CrtcPlanes::test(KMSPlaneState const& primary, std::vector<KMSPlaneState> const& overlays)
+{
+    if (accepted_before(primary, overlays))
+        return true;
+
+    AtomicRequest request{drm_fd};
+
+    if (!add_frame(request, primary, overlays) || !request.test())
+    {
+        last_accepted.clear();
+        return false;
+    }
+
+    last_accepted.clear();
+    last_accepted.push_back(primary);
+    last_accepted.insert(last_accepted.end(), overlays.begin(), overlays.end());
+    return true;
+}
+
+int mgm::CrtcPlanes::commit(
+    KMSPlaneState const& primary,
+    std::vector<KMSPlaneState> const& overlays,
+    uint32_t flags,
+    void* user_data)
+{
+    AtomicRequest request{drm_fd};
+
+    if (!add_frame(request, primary, overlays))
+        return -EINVAL;
+
+    auto const result = request.commit(flags, user_data);
+
+    /* The hardware refused something it accepted before: ask it again next time */
+    if (result)
+        last_accepted.clear();
+
+    return result;
+}
+
+bool mgm::CrtcPlanes::overlays_enabled() const
+{
+    return !enabled_overlays.empty();
+}
+
+void mgm::CrtcPlanes::disable_overlays()
+{
+    if (enabled_overlays.empty())
+        return;
+
+    AtomicRequest request{drm_fd};
+
+    for (auto const id : enabled_overlays)
+    {
+        if (auto const plane = properties_for(id))
+        {
+            request.add(id, plane->fb_id, 0);
+            request.add(id, plane->crtc_id, 0);
+        }
+    }
+
+    if (auto const result = request.commit(0, nullptr))
+        mir::log_warning("Failed to turn off overlay planes (%s)", strerror(-result));
+
+    enabled_overlays.clear();
+}
+
+bool mgm::CrtcPlanes::accepted_before(
+    KMSPlaneState const& primary,
+    std::vector<KMSPlaneState> const& overlays) const
+{
+    if (last_accepted.size() != overlays.size() + 1)
+        return false;
+
+    /* The framebuffers themselves change every frame; what they need of the hardware needn't */
+    auto const same_layout = [](KMSPlaneState const& state, KMSPlaneState const& accepted)
+        {
+            return state.fb_format != 0 &&
+                state.plane_id == accepted.plane_id &&
+                state.fb_format == accepted.fb_format &&
+                state.fb_pitch == accepted.fb_pitch &&
+                state.source == accepted.source &&
+                state.destination == accepted.destination;
+        };
+
+    if (!same_layout(primary, last_accepted.front()))
+        return false;
+
+    return std::equal(overlays.begin(), overlays.end(), last_accepted.begin() + 1, same_layout);
+}
+
+auto mgm::CrtcPlanes::properties_for(uint32_t plane_id) const -> PlaneProperties const*
+{
+    for (auto const& plane : overlay_properties)
+    {
+        if (plane.plane_id == plane_id)
+            return &plane;
+    }
+    return nullptr;
+}
+
+bool mgm::CrtcPlanes::add_frame(
+    AtomicRequest& request,
+    KMSPlaneState const& primary_state,
+    std::vector<KMSPlaneState> const& overlays)
+{
+    if (!has_primary)
+        return false;
+
+    for (auto const& overlay : overlays)
+    {
+        if (!properties_for(overlay.plane_id))
+            return false;
+    }
+
+    auto const add_plane = [&](PlaneProperties const& plane, KMSPlaneState const& state)
+        {
+            auto const id = plane.plane_id;
+            request.add(id, plane.fb_id, state.fb_id);
+            request.add(id, plane.crtc_id, crtc);
+
+            /* Source coordinates are 16.16 fixed point; destination coordinates are not */
+            request.add(id, plane.src_x, uint64_t(state.source.top_left.x.as_int()) << 16);
+            request.add(id, plane.src_y, uint64_t(state.source.top_left.y.as_int()) << 16);
+            request.add(id, plane.src_w, uint64_t(state.source.size.width.as_int()) << 16);
+            request.add(id, plane.src_h, uint64_t(state.source.size.height.as_int()) << 16);
+
+            request.add(id, plane.crtc_x, state.destination.top_left.x.as_int());
+            request.add(id, plane.crtc_y, state.destination.top_left.y.as_int());
+            request.add(id, plane.crtc_w, state.destination.size.width.as_int());
+            request.add(id, plane.crtc_h, state.destination.size.height.as_int());
+        };
+
+    add_plane(primary, primary_state);
+
+    /* The primary goes at the bottom, and each overlay above those beneath it */
+    if (primary.zpos)
+        request.add(primary.plane_id, primary.zpos, primary.zpos_min);
+
+    auto zpos = primary.zpos_min;
+    std::vector<uint32_t> shown;
+    for (auto const& overlay : overlays)
+    {
+        auto const plane = properties_for(overlay.plane_id);
+
+        add_plane(*plane, overlay);
+
+        if (plane->zpos)
+        {
+            zpos = std::max(zpos + 1, plane->zpos_min);
+            request.add(plane->plane_id, plane->zpos, zpos);
+        }
+
+        shown.push_back(plane->plane_id);
+    }
+
+    /* Overlay planes we no longer want get turned off in the same commit */
+    for (auto const id : enabled_overlays)
+    {
+        auto const still_wanted = std::find(shown.begin(), shown.end(), id) != shown.end();
+
+        if (!still_wanted)
+        {
+            if (auto const plane = properties_for(id))
+            {
+                request.add(id, plane->fb_id, 0);
+                request.add(id, plane->crtc_id, 0);
+            }
+        }
+    }
+
+    request.on_commit([this, shown] { enabled_overlays = shown; });
+    return true;
+}
+
+bool mgm::CrtcPlanes::add_modeset(
+    AtomicRequest& request,
+    uint32_t connector_id,
+    drmModeModeInfo const& mode,
+    bool vrr)
+{
+    if (!has_primary || !crtc_active || !crtc_mode_id)
+        return false;
+
+    auto const connector_crtc_id = connector_crtc_id_property(drm_fd, connector_id);
+    if (!connector_crtc_id)
+        return false;
+
+    request.add(crtc, crtc_mode_id, request.add_blob(&mode, sizeof mode));
+    request.add(crtc, crtc_active, 1);
+    request.add(connector_id, connector_crtc_id, crtc);
+    if (crtc_vrr_enabled)
+        request.add(crtc, crtc_vrr_enabled, vrr);
+
+    /* What the hardware accepted in one mode it needn't in another */
+    request.on_commit([this] { last_accepted.clear(); });
+    return true;
+}
+
+bool mgm::CrtcPlanes::add_disable(AtomicRequest& request, uint32_t connector_id)
+{
+    if (!has_primary || !crtc_active || !crtc_mode_id)
+        return false;
+
+    auto const connector_crtc_id = connector_crtc_id_property(drm_fd, connector_id);
+    if (!connector_crtc_id)
+        return false;
+
+    request.add(crtc, crtc_active, 0);
+    request.add(crtc, crtc_mode_id, 0);
+    request.add(connector_id, connector_crtc_id, 0);
+
+    /* An inactive CRTC can't have planes left on it */
+    request.add(primary.plane_id, primary.fb_id, 0);
+    request.add(primary.plane_id, primary.crtc_id, 0);
+    for (auto const& plane : overlay_properties)
+    {
+        request.add(plane.plane_id, plane.fb_id, 0);
+        request.add(plane.plane_id, plane.crtc_id, 0);
+    }
+
+    request.on_commit([this] { last_accepted.clear(); });
+    return true;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_CRTC_PLANES_H_
+#define MIR_GRAPHICS_MESA_CRTC_PLANES_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <xf86drmMode.h>
+
+#include <vector>
+#include <cstdint>
+
+namespace mir
+{
+namespace graphics
+{
+namespace mesa
+{
+class AtomicRequest;
+
+/**
+ * A hardware plane that can be stacked above a CRTC's primary plane.
+ */
+struct KMSPlane
+{
+    uint32_t id;
+    std::vector<uint32_t> formats;  ///< DRM fourcc formats the plane can scan out
+    bool stackable;                 ///< Whether our zpos can order it above other overlays
+
+    bool supports(uint32_t format) const;
+};
+
+/**
+ * What a plane should show: source is in framebuffer pixels, destination
+ * in CRTC pixels.
+ */
+struct KMSPlaneState
+{
+    uint32_t plane_id;
+    uint32_t fb_id;
+    geometry::Rectangle source;
+    geometry::Rectangle destination;
+
+    /// The framebuffer's format and pitch: whether the hardware can scan it
+    /// out depends on these, not on which framebuffer it is. 0 if unknown.
+    uint32_t fb_format{0};
+    uint32_t fb_pitch{0};
+};
+
+/**
+ * The primary and overlay planes of a single CRTC, updated with atomic
+ * commits.
+ *
+ * Only overlay planes dedicated to this CRTC are used, so that two CRTCs
+ * never compete for a plane. If the driver lacks atomic modesetting there
+ * are no overlays at all, and nothing can be added to an AtomicRequest.
+ */
+class CrtcPlanes
+{
+public:
+    CrtcPlanes(int drm_fd, uint32_t crtc_id);
+    ~CrtcPlanes();
+
+    uint32_t crtc_id() const;
+    std::vector<KMSPlane> const& overlays() const;
+
+    /** Whether the CRTC can be driven by atomic commits */
+    bool atomic() const;
+
+    /** Whether the CRTC can stretch vblank to wait for the next frame (VRR) */
+    bool adaptive_sync() const;
+
+    /**
+     * Adds showing primary with overlays (bottom-most first) stacked above
+     * it, and turning off any other overlay planes we have used, to request.
+     *
+     * \returns false, leaving request untouched, if !atomic()
+     */
+    bool add_frame(
+        AtomicRequest& request,
+        KMSPlaneState const& primary,
+        std::vector<KMSPlaneState> const& overlays);
+
+    /**
+     * Adds setting mode on the CRTC, and routing connector_id to it, to
+     * request. The request needs AtomicRequest::allow_modeset().
+     *
+     * Where the CRTC has adaptive_sync() it is also turned on or off, as
+     * vrr asks.
+     *
+     * \returns false, leaving request untouched, if the driver doesn't
+     *          expose the properties this takes
+     */
+    bool add_modeset(
+        AtomicRequest& request,
+        uint32_t connector_id,
+        drmModeModeInfo const& mode,
+        bool vrr);
+
+    /**
+     * Adds turning the CRTC off, with its planes, and unrouting
+     * connector_id from it, to request. The request needs
+     * AtomicRequest::allow_modeset().
+     *
+     * \returns false, leaving request untouched, if the driver doesn't
+     *          expose the properties this takes
+     */
+    bool add_disable(AtomicRequest& request, uint32_t connector_id);
+
+    /**
+     * Checks, with a DRM_MODE_ATOMIC_TEST_ONLY commit, whether the hardware
+     * can show primary with overlays (bottom-most first) stacked above it.
+     *
+     * The last plane assignment accepted is remembered, so asking again
+     * with only different framebuffers of the same format and pitch (a
+     * client's next frame) doesn't take another commit.
+     */
+    bool test(KMSPlaneState const& primary, std::vector<KMSPlaneState> const& overlays);
+
+    /**
+     * Shows primary and exactly overlays (bottom-most first), turning off
+     * any other overlay planes we have used.
+     *
+     * \returns the drmModeAtomicCommit() result
+     */
+    int commit(
+        KMSPlaneState const& primary,
+        std::vector<KMSPlaneState> const& overlays,
+        uint32_t flags,
+        void* user_data);
+
+    /** Whether the last successful commit() left any overlay planes on */
+    bool overlays_enabled() const;
+
+    /** Turns off any overlay planes left on by commit() */
+    void disable_overlays();
+
+private:
+    struct PlaneProperties
+    {
+        uint32_t plane_id;
+        uint32_t fb_id, crtc_id;
+        uint32_t src_x, src_y, src_w, src_h;
+        uint32_t crtc_x, crtc_y, crtc_w, crtc_h;
+        uint32_t zpos;      ///< 0 if the plane has no mutable zpos
+        uint64_t zpos_min;  ///< Lowest zpos we can give it; its zpos if immutable
+    };
+
+    PlaneProperties const* properties_for(uint32_t plane_id) const;
+    bool accepted_before(KMSPlaneState const& primary, std::vector<KMSPlaneState> const& overlays) const;
+
+    int const drm_fd;
+    uint32_t const crtc;
+    uint32_t crtc_active, crtc_mode_id;  ///< 0 if the driver lacks them
+    uint32_t crtc_vrr_enabled;           ///< 0 if the CRTC lacks adaptive sync
+    bool has_primary;
+    PlaneProperties primary;
+    std::vector<PlaneProperties> overlay_properties;
+    std::vector<KMSPlane> overlay_planes;
+    std::vector<uint32_t> enabled_overlays;
+    std::vector<KMSPlaneState> last_accepted;   ///< Primary, then overlays
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_MESA_CRTC_PLANES_H_ */
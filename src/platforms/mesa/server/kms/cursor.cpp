@@ -28,6 +28,7 @@
 
 #include <boost/exception/errinfo_errno.hpp>
 
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 
@@ -38,6 +39,9 @@ namespace geom = mir::geometry;
 namespace
 {
 const uint64_t fallback_cursor_size = 64;
+// Enough to keep the shapes a busy client flicks between (and the frames of
+// an animated cursor) resident without re-padding them on every change.
+std::size_t const max_cached_images = 16;
 char const* const mir_drm_cursor_64x64 = "MIR_DRM_CURSOR_64x64";
 
 // Transforms a relative position within the display bounds described by \a rect which is rotated with \a orientation
@@ -99,16 +103,36 @@ gbm_device* gbm_create_device_checked(int fd)
 }
 }
 
-mgm::Cursor::GBMBOWrapper::GBMBOWrapper(int fd, MirOrientation orientation) :
-    device{gbm_create_device_checked(fd)},
+mgm::Cursor::GBMDeviceWrapper::GBMDeviceWrapper(int fd) :
+    device{gbm_create_device_checked(fd)}
+{
+}
+
+inline mgm::Cursor::GBMDeviceWrapper::operator gbm_device*()
+{
+    return device;
+}
+
+inline mgm::Cursor::GBMDeviceWrapper::~GBMDeviceWrapper()
+{
+    if (device)
+        gbm_device_destroy(device);
+}
+
+mgm::Cursor::GBMDeviceWrapper::GBMDeviceWrapper(GBMDeviceWrapper&& from)
+    : device{from.device}
+{
+    from.device = nullptr;
+}
+
+mgm::Cursor::GBMBOWrapper::GBMBOWrapper(gbm_device* device, int fd) :
     buffer{
         gbm_bo_create(
             device,
             get_drm_cursor_width(fd),
             get_drm_cursor_height(fd),
             GBM_FORMAT_ARGB8888,
-            GBM_BO_USE_CURSOR | GBM_BO_USE_WRITE)},
-    current_orientation{orientation}
+            GBM_BO_USE_CURSOR | GBM_BO_USE_WRITE)}
 {
     if (!buffer) BOOST_THROW_EXCEPTION(std::runtime_error("failed to create gbm buffer"));
 }
@@ -120,28 +144,14 @@ inline mgm::Cursor::GBMBOWrapper::operator gbm_bo*()
 
 inline mgm::Cursor::GBMBOWrapper::~GBMBOWrapper()
 {
-    if (device)
-        gbm_device_destroy(device);
     if (buffer)
         gbm_bo_destroy(buffer);
 }
 
 mgm::Cursor::GBMBOWrapper::GBMBOWrapper(GBMBOWrapper&& from)
-    : device{from.device},
-      buffer{from.buffer},
-      current_orientation{from.current_orientation}
+    : buffer{from.buffer}
 {
     from.buffer = nullptr;
-    from.device = nullptr;
-}
-
-auto mir::graphics::mesa::Cursor::GBMBOWrapper::change_orientation(MirOrientation new_orientation) -> bool
-{
-    if (current_orientation == new_orientation)
-        return false;
-
-    current_orientation = new_orientation;
-    return true;
 }
 
 mgm::Cursor::Cursor(
@@ -150,11 +160,12 @@ mgm::Cursor::Cursor(
         output_container(output_container),
         current_position(),
         last_set_failed(false),
+        image_cache(1),
         min_buffer_width{std::numeric_limits<uint32_t>::max()},
         min_buffer_height{std::numeric_limits<uint32_t>::max()},
         current_configuration(current_configuration)
 {
-    // Generate the buffers for the initial configuration.
+    // Open the devices for the initial configuration.
     current_configuration->with_current_configuration_do(
         [this](KMSDisplayConfiguration const& kms_conf)
         {
@@ -162,7 +173,7 @@ mgm::Cursor::Cursor(
                 [this, &kms_conf](auto const& output)
                 {
                     // I'm not sure why g++ needs the explicit "this->" but it does - alan_g
-                    this->buffer_for_output(*kms_conf.get_output_for(output.id));
+                    this->device_for_output(*kms_conf.get_output_for(output.id));
                 });
         });
 
@@ -192,9 +203,11 @@ void mgm::Cursor::write_buffer_data_locked(
 
 void mgm::Cursor::pad_and_write_image_data_locked(
     std::lock_guard<std::mutex> const& lg,
-    GBMBOWrapper& buffer)
+    CachedImage const& image,
+    gbm_bo* buffer,
+    MirOrientation orientation)
 {
-    auto const orientation = buffer.orientation();
+    auto const& size = image.size;
     bool const sideways = orientation == mir_orientation_left || orientation == mir_orientation_right;
 
     auto const min_width  = sideways ? min_buffer_width : min_buffer_height;
@@ -212,7 +225,7 @@ void mgm::Cursor::pad_and_write_image_data_locked(
     size_t rhs_padding = buffer_stride - 4*image_width;
 
     auto const filler = 0; // 0x3f; is useful to make buffer visible for debugging
-    uint8_t const* src = argb8888.data();
+    uint8_t const* src = image.argb8888.data();
     uint8_t* dest = &padded[0];
 
     switch (orientation)
@@ -290,19 +303,38 @@ void mgm::Cursor::show(CursorImage const& cursor_image)
 {
     std::lock_guard<std::mutex> lg(guard);
 
-    size = cursor_image.size();
+    auto const size = cursor_image.size();
+    auto const pixels = static_cast<uint8_t const*>(cursor_image.as_argb_8888());
+    size_t const image_bytes = size.width.as_uint32_t() * size.height.as_uint32_t() * 4;
 
-    argb8888.resize(size.width.as_uint32_t() * size.height.as_uint32_t() * 4);
-    memcpy(argb8888.data(), cursor_image.as_argb_8888(), argb8888.size());
+    auto const cached = std::find_if(
+        image_cache.begin(),
+        image_cache.end(),
+        [&](CachedImage const& candidate)
+        {
+            return candidate.size == size &&
+                   candidate.argb8888.size() == image_bytes &&
+                   memcmp(candidate.argb8888.data(), pixels, image_bytes) == 0;
+        });
 
-    hotspot = cursor_image.hotspot();
+    if (cached != image_cache.end())
     {
-        auto locked_buffers = buffers.lock();
-        for (auto& pair : *locked_buffers)
-        {
-            pad_and_write_image_data_locked(lg, pair.second);
-        }
+        image_cache.splice(image_cache.begin(), image_cache, cached);
     }
+    else
+    {
+        image_cache.push_front(CachedImage{size, {pixels, pixels + image_bytes}, {}});
+        if (image_cache.size() > max_cached_images)
+            image_cache.pop_back();
+    }
+
+    hotspot = cursor_image.hotspot();
+
+    for_each_used_output([&](KMSOutput& output, geom::Rectangle const& output_rect, MirOrientation orientation)
+    {
+        if (output_rect.contains(current_position))
+            buffer_for_output_locked(lg, output, orientation);
+    });
 
     // Writing the data could throw an exception so lets
     // hold off on setting visible until after we have succeeded.
@@ -387,19 +419,31 @@ void mgm::Cursor::place_cursor_at_locked(
         if (output_rect.contains(position))
         {
             auto dp = transform(output_rect, position - output_rect.top_left, orientation);
-            auto hs = transform(geom::Rectangle{{0,0}, size}, hotspot, orientation);
+            auto hs = transform(geom::Rectangle{{0,0}, image_cache.front().size}, hotspot, orientation);
 
             // It's a little strange that we implement hotspot this way as there is
             // drmModeSetCursor2 with hotspot support. However it appears to not actually
             // work on radeon and intel. There also seems to be precedent in weston for
             // implementing hotspot in this fashion.
             output.move_cursor(geom::Point{} + dp - hs);
-            auto& buffer = buffer_for_output(output);
+            auto const buffer = buffer_for_output_locked(lg, output, orientation);
 
-            auto const changed_orientation = buffer.change_orientation(orientation);
+            auto const last_orientation = std::find_if(
+                output_orientations.begin(),
+                output_orientations.end(),
+                [&output](auto const& candidate) { return candidate.first == &output; });
 
-            if (changed_orientation)
-                pad_and_write_image_data_locked(lg, buffer);
+            auto changed_orientation = false;
+            if (last_orientation == output_orientations.end())
+            {
+                output_orientations.emplace_back(&output, orientation);
+                changed_orientation = orientation != mir_orientation_normal;
+            }
+            else if (last_orientation->second != orientation)
+            {
+                last_orientation->second = orientation;
+                changed_orientation = true;
+            }
 
             if (force_state || !output.has_cursor() || changed_orientation)
             {
@@ -419,26 +463,29 @@ void mgm::Cursor::place_cursor_at_locked(
     last_set_failed = !set_on_all_outputs;
 }
 
-mgm::Cursor::GBMBOWrapper& mgm::Cursor::buffer_for_output(KMSOutput const& output)
+gbm_device* mgm::Cursor::device_for_output(KMSOutput const& output)
 {
-    auto locked_buffers = buffers.lock();
+    auto locked_devices = devices.lock();
 
-    auto buffer_it = std::find_if(
-        locked_buffers->begin(),
-        locked_buffers->end(),
+    auto device_it = std::find_if(
+        locked_devices->begin(),
+        locked_devices->end(),
         [&output](auto const& candidate)
             {
                 return candidate.first == output.drm_fd();
             });
 
-    if (buffer_it != locked_buffers->end())
+    if (device_it != locked_devices->end())
     {
-        return buffer_it->second;
+        return device_it->second;
     }
 
-    locked_buffers->push_back(std::make_pair(output.drm_fd(), GBMBOWrapper(output.drm_fd(), mir_orientation_normal)));
+    locked_devices->push_back(std::make_pair(output.drm_fd(), GBMDeviceWrapper(output.drm_fd())));
+
+    gbm_device* const device = locked_devices->back().second;
 
-    GBMBOWrapper& bo = locked_buffers->back().second;
+    // The driver may round the requested size up, so probe an actual cursor buffer
+    GBMBOWrapper bo{device, output.drm_fd()};
     if (gbm_bo_get_width(bo) < min_buffer_width)
     {
         min_buffer_width = gbm_bo_get_width(bo);
@@ -448,5 +495,32 @@ mgm::Cursor::GBMBOWrapper& mgm::Cursor::buffer_for_output(KMSOutput const& outpu
         min_buffer_height = gbm_bo_get_height(bo);
     }
 
-    return bo;
+    return device;
+}
+
+gbm_bo* mgm::Cursor::buffer_for_output_locked(
+    std::lock_guard<std::mutex> const& lg,
+    KMSOutput const& output,
+    MirOrientation orientation)
+{
+    auto& image = image_cache.front();
+
+    auto buffer_it = std::find_if(
+        image.buffers.begin(),
+        image.buffers.end(),
+        [&output, orientation](auto const& candidate)
+            {
+                return candidate.drm_fd == output.drm_fd() && candidate.orientation == orientation;
+            });
+
+    if (buffer_it != image.buffers.end())
+    {
+        return buffer_it->bo;
+    }
+
+    GBMBOWrapper bo{device_for_output(output), output.drm_fd()};
+    pad_and_write_image_data_locked(lg, image, bo, orientation);
+
+    image.buffers.push_back(CachedImage::Buffer{output.drm_fd(), orientation, std::move(bo)});
+    return image.buffers.back().bo;
 }
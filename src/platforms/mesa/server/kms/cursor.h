@@ -30,6 +30,7 @@
 #include <gbm.h>
 
 #include <functional>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -85,7 +86,7 @@ public:
 
 private:
     enum ForceCursorState { UpdateState, ForceState };
-    struct GBMBOWrapper;
+    struct CachedImage;
     void for_each_used_output(std::function<void(KMSOutput&, geometry::Rectangle const&, MirOrientation orientation)> const& f);
     void place_cursor_at(geometry::Point position, ForceCursorState force_state);
     void place_cursor_at_locked(std::lock_guard<std::mutex> const&, geometry::Point position, ForceCursorState force_state);
@@ -96,41 +97,74 @@ private:
         size_t count);
     void pad_and_write_image_data_locked(
         std::lock_guard<std::mutex> const&,
-        GBMBOWrapper& buffer);
+        CachedImage const& image,
+        gbm_bo* buffer,
+        MirOrientation orientation);
     void clear(std::lock_guard<std::mutex> const&);
 
-    GBMBOWrapper& buffer_for_output(KMSOutput const& output);
+    gbm_device* device_for_output(KMSOutput const& output);
+    gbm_bo* buffer_for_output_locked(
+        std::lock_guard<std::mutex> const&,
+        KMSOutput const& output,
+        MirOrientation orientation);
     
     std::mutex guard;
 
     KMSOutputContainer& output_container;
     geometry::Point current_position;
     geometry::Displacement hotspot;
-    geometry::Size size;
-    std::vector<uint8_t> argb8888;
 
     bool visible;
     bool last_set_failed;
 
+    struct GBMDeviceWrapper
+    {
+        explicit GBMDeviceWrapper(int fd);
+        operator gbm_device*();
+
+        ~GBMDeviceWrapper();
+
+        GBMDeviceWrapper(GBMDeviceWrapper&& from);
+    private:
+        gbm_device* device;
+        GBMDeviceWrapper(GBMDeviceWrapper const&) = delete;
+        GBMDeviceWrapper& operator=(GBMDeviceWrapper const&) = delete;
+    };
+    Mutex<std::vector<std::pair<int, GBMDeviceWrapper>>> devices;
+
     struct GBMBOWrapper
     {
-        GBMBOWrapper(int fd, MirOrientation orientation);
+        GBMBOWrapper(gbm_device* device, int fd);
         operator gbm_bo*();
 
-        auto orientation() const -> MirOrientation { return current_orientation; }
-        auto change_orientation(MirOrientation new_orientation) -> bool;
-
         ~GBMBOWrapper();
 
         GBMBOWrapper(GBMBOWrapper&& from);
     private:
-        gbm_device* device;
         gbm_bo* buffer;
-        MirOrientation current_orientation;
         GBMBOWrapper(GBMBOWrapper const&) = delete;
         GBMBOWrapper& operator=(GBMBOWrapper const&) = delete;
     };
-    Mutex<std::vector<std::pair<int, GBMBOWrapper>>> buffers;
+
+    // A cursor image together with the buffers it has already been
+    // padded, rotated and written into, one per (drm fd, orientation).
+    struct CachedImage
+    {
+        struct Buffer
+        {
+            int drm_fd;
+            MirOrientation orientation;
+            GBMBOWrapper bo;
+        };
+
+        geometry::Size size;
+        std::vector<uint8_t> argb8888;
+        std::vector<Buffer> buffers;
+    };
+    // Most recently shown first; the front is the current image.
+    std::list<CachedImage> image_cache;
+
+    std::vector<std::pair<KMSOutput const*, MirOrientation>> output_orientations;
 
     uint32_t min_buffer_width;
     uint32_t min_buffer_height;
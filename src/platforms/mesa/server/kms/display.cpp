@@ -20,9 +20,11 @@
 #include "cursor.h"
 #include "platform.h"
 #include "display_buffer.h"
+#include "dumb_display_buffer.h"
 #include "kms_display_configuration.h"
 #include "kms_output.h"
 #include "kms_page_flipper.h"
+#include "atomic_request.h"
 #include "virtual_terminal.h"
 #include "mir/graphics/overlapping_output_grouping.h"
 #include "mir/graphics/event_handler_register.h"
@@ -46,6 +48,7 @@
 #include <stdexcept>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace mgm = mir::graphics::mesa;
 namespace mg = mir::graphics;
@@ -175,7 +178,8 @@ mgm::Display::Display(std::vector<std::shared_ptr<helpers::DRMHelper>> const& dr
                       mgm::BypassOption bypass_option,
                       std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
                       std::shared_ptr<GLConfig> const& gl_config,
-                      std::shared_ptr<DisplayReport> const& listener)
+                      std::shared_ptr<DisplayReport> const& listener,
+                      ScanoutOption scanout_option)
     : drm{drm},
       gbm(gbm),
       vt(vt),
@@ -200,6 +204,7 @@ mgm::Display::Display(std::vector<std::shared_ptr<helpers::DRMHelper>> const& dr
       current_display_configuration{output_container},
       dirty_configuration{false},
       bypass_option(bypass_option),
+      scanout_option{scanout_option},
       gl_config{gl_config}
 {
     vt->set_graphics_mode();
@@ -481,7 +486,8 @@ void mgm::Display::configure_locked(
     bool const comp{
         (&kms_conf != &current_display_configuration) &&
         compatible(kms_conf, current_display_configuration)};
-    std::vector<std::unique_ptr<DisplayBuffer>> display_buffers_new;
+    std::vector<std::unique_ptr<KMSDisplayBuffer>> display_buffers_new;
+    std::vector<std::function<void()>> output_settings;
 
     if (!comp)
     {
@@ -526,10 +532,15 @@ void mgm::Display::configure_locked(
                     auto const mode_index = kms_conf.get_kms_mode_index(conf_output.id,
                                                                   conf_output.current_mode_index);
                     kms_output->configure(conf_output.top_left - bounding_rect.top_left, mode_index);
+                    kms_output->set_adaptive_sync(conf_output.vrr_capable && conf_output.vrr_enabled);
                     if (!comp)
                     {
-                        kms_output->set_power_mode(conf_output.power_mode);
-                        kms_output->set_gamma(conf_output.gamma);
+                        output_settings.push_back(
+                            [kms_output, power_mode = conf_output.power_mode, gamma = conf_output.gamma]
+                            {
+                                kms_output->set_power_mode(power_mode);
+                                kms_output->set_gamma(gamma);
+                            });
                         add_to_drm_device_group(kms_output_groups, std::move(kms_output));
                     }
 
@@ -557,6 +568,18 @@ void mgm::Display::configure_locked(
 
                 for (auto const& group : kms_output_groups)
                 {
+                    if (scanout_option == ScanoutOption::dumb_buffer)
+                    {
+                        display_buffers_new.push_back(
+                            std::make_unique<DumbDisplayBuffer>(
+                                listener,
+                                group,
+                                geom::Size{width, height},
+                                bounding_rect,
+                                transformation));
+                        continue;
+                    }
+
                     /*
                      * In a hybrid setup a scanout surface needs to be allocated differently if it
                      * needs to be able to be shared across GPUs. This likely reduces performance.
@@ -591,7 +614,79 @@ void mgm::Display::configure_locked(
         });
 
     if (!comp)
+    {
+        /*
+         * Ask the hardware before applying anything: a configuration it
+         * rejects leaves the current one on screen. (The display buffers we
+         * keep set their CRTCs again, as their outputs have been reset, and
+         * power modes and gamma are only set once the modes are.)
+         *
+         * The whole configuration of each DRM device is checked with one
+         * TEST_ONLY commit, so limits shared between CRTCs count too. That
+         * includes the outputs clear_connected_unused_outputs() will turn
+         * off: they're added first, so that a CRTC an output is moving to
+         * is set up rather than turned off.
+         */
+        std::unordered_map<int, std::unique_ptr<AtomicRequest>> tests;
+        std::unordered_set<int> untestable;
+
+        auto const test_for = [&](int drm_fd) -> AtomicRequest&
+            {
+                auto& test = tests[drm_fd];
+                if (!test)
+                {
+                    test = std::make_unique<AtomicRequest>(drm_fd);
+                    test->allow_modeset();
+                }
+                return *test;
+            };
+
+        kms_conf.for_each_output(
+            [&](DisplayConfigurationOutput const& conf_output)
+            {
+                if (conf_output.connected &&
+                    (!conf_output.used || (conf_output.power_mode != mir_power_mode_on)))
+                {
+                    auto const kms_output = current_display_configuration.get_output_for(conf_output.id);
+                    if (!kms_output->add_clear_crtc_to(test_for(kms_output->drm_fd())))
+                        untestable.insert(kms_output->drm_fd());
+                }
+            });
+
+        for (auto const& db : display_buffers_new)
+        {
+            if (!db->add_set_crtc_to(test_for(db->drm_fd())))
+                untestable.insert(db->drm_fd());
+        }
+
+        auto const rejected = std::any_of(tests.begin(), tests.end(),
+            [&](decltype(tests)::value_type const& test)
+            {
+                return !untestable.count(test.first) && !test.second->test();
+            });
+
+        if (rejected)
+        {
+            if (&kms_conf != &current_display_configuration)
+            {
+                for (auto& db : display_buffers)
+                    db->schedule_set_crtc();
+
+                BOOST_THROW_EXCEPTION(
+                    std::runtime_error("Display configuration rejected by the hardware"));
+            }
+
+            mir::log_warning("Hardware rejects the initial display configuration; trying it anyway");
+        }
+
+        for (auto& db : display_buffers_new)
+            db->set_crtc();
+
+        for (auto const& apply : output_settings)
+            apply();
+
         display_buffers = std::move(display_buffers_new);
+    }
 
     /* Store applied configuration */
     current_display_configuration = kms_conf;
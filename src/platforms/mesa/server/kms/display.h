@@ -55,7 +55,7 @@ class DRMHelper;
 class GBMHelper;
 }
 
-class DisplayBuffer;
+class KMSDisplayBuffer;
 class VirtualTerminal;
 class KMSOutput;
 class Cursor;
@@ -71,7 +71,8 @@ public:
             BypassOption bypass_option,
             std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
             std::shared_ptr<GLConfig> const& gl_config,
-            std::shared_ptr<DisplayReport> const& listener);
+            std::shared_ptr<DisplayReport> const& listener,
+            ScanoutOption scanout_option = ScanoutOption::gbm_surface);
     ~Display();
 
     geometry::Rectangle view_area() const;
@@ -112,7 +113,7 @@ private:
     std::shared_ptr<DisplayReport> const listener;
     mir::udev::Monitor monitor;
     helpers::EGLHelper shared_egl;
-    std::vector<std::unique_ptr<DisplayBuffer>> display_buffers;
+    std::vector<std::unique_ptr<KMSDisplayBuffer>> display_buffers;
     std::shared_ptr<KMSOutputContainer> const output_container;
     mutable RealKMSDisplayConfiguration current_display_configuration;
     mutable std::atomic<bool> dirty_configuration;
@@ -122,6 +123,7 @@ private:
         std::lock_guard<decltype(configuration_mutex)> const&);
 
     BypassOption bypass_option;
+    ScanoutOption const scanout_option;
     std::weak_ptr<Cursor> cursor;
     std::shared_ptr<GLConfig> const gl_config;
 };
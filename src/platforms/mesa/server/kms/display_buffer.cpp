@@ -18,6 +18,7 @@
 
 #include "display_buffer.h"
 #include "kms_output.h"
+#include "atomic_request.h"
 #include "mir/graphics/display_report.h"
 #include "mir/graphics/transformation.h"
 #include "bypass.h"
@@ -164,6 +165,35 @@ bool needs_bounce_buffer(mgm::KMSOutput const& destination, gbm_bo* source)
     return destination.buffer_requires_migration(source);
 }
 
+uint32_t kms_format_of(gbm_bo* bo)
+{
+    auto const format = gbm_bo_get_format(bo);
+
+    if (format == GBM_BO_FORMAT_XRGB8888)
+        return GBM_FORMAT_XRGB8888;
+    else if (format == GBM_BO_FORMAT_ARGB8888)
+        return GBM_FORMAT_ARGB8888;
+
+    return format;
+}
+
+bool has_alpha(uint32_t kms_format)
+{
+    return kms_format == DRM_FORMAT_ARGB8888 || kms_format == DRM_FORMAT_ABGR8888;
+}
+
+/*
+ * A candidate for an overlay plane, along with what it needs from the
+ * hardware.
+ */
+struct PlaneCandidate
+{
+    std::shared_ptr<mg::Renderable> renderable;
+    std::shared_ptr<mg::Buffer> buffer;
+    mgm::OverlayPlacement placement;
+    bool stackable;
+};
+
 const GLchar* const vshader =
     {
         "attribute vec4 position;\n"
@@ -546,11 +576,10 @@ mgm::DisplayBuffer::DisplayBuffer(
         }
     }
 
-    set_crtc(*outputs.front()->fb_for(visible_composite_frame));
+    last_composite_bufobj = outputs.front()->fb_for(visible_composite_frame);
 
     release_current();
 
-    listener->report_successful_drm_mode_set_crtc_on_construction();
     listener->report_successful_display_construction();
     surface.report_egl_configuration(
         [&listener] (EGLDisplay disp, EGLConfig cfg)
@@ -579,8 +608,23 @@ void mgm::DisplayBuffer::set_transformation(glm::mat2 const& t, geometry::Rectan
     area = a;
 }
 
+gbm_bo* mgm::DisplayBuffer::scanout_bo_for(graphics::Buffer& buffer) const
+{
+    auto native = std::dynamic_pointer_cast<mgm::NativeBuffer>(buffer.native_buffer_handle());
+    if (native && native->flags & mir_buffer_flag_can_scanout &&
+        !needs_bounce_buffer(*outputs.front(), native->bo))
+    {
+        return native->bo;
+    }
+
+    return nullptr;
+}
+
 bool mgm::DisplayBuffer::overlay(RenderableList const& renderable_list)
 {
+    overlays.clear();
+    overlay_bufs.clear();
+
     glm::mat2 static const no_transformation;
     if (transform == no_transformation &&
        (bypass_option == mgm::BypassOption::allowed))
@@ -590,12 +634,10 @@ bool mgm::DisplayBuffer::overlay(RenderableList const& renderable_list)
         if (bypass_it != renderable_list.rend())
         {
             auto bypass_buffer = (*bypass_it)->buffer();
-            auto native = std::dynamic_pointer_cast<mgm::NativeBuffer>(bypass_buffer->native_buffer_handle());
-            if (native && native->flags & mir_buffer_flag_can_scanout &&
-                bypass_buffer->size() == surface.size() &&
-                !needs_bounce_buffer(*outputs.front(), native->bo))
+            auto const bo = scanout_bo_for(*bypass_buffer);
+            if (bo && bypass_buffer->size() == surface.size())
             {
-                if (auto bufobj = outputs.front()->fb_for(native->bo))
+                if (auto bufobj = outputs.front()->fb_for(bo))
                 {
                     bypass_buf = bypass_buffer;
                     bypass_bufobj = bufobj;
@@ -610,6 +652,159 @@ bool mgm::DisplayBuffer::overlay(RenderableList const& renderable_list)
     return false;
 }
 
+bool mgm::DisplayBuffer::overlay(RenderableList const& renderable_list, RenderableList& remainder)
+{
+    if (overlay(renderable_list))
+    {
+        remainder.clear();
+        return true;
+    }
+
+    remainder = renderable_list;
+
+    /*
+     * Overlay planes come with the same caveats as bypass, and in clone
+     * mode each output would need its own planes for the same buffers.
+     */
+    glm::mat2 static const no_transformation;
+    if (transform != no_transformation ||
+        bypass_option != mgm::BypassOption::allowed ||
+        outputs.size() != 1 ||
+        !last_composite_bufobj)
+    {
+        return false;
+    }
+
+    auto const& output = outputs.front();
+    auto free_planes = output->overlay_planes();
+    if (free_planes.empty())
+        return false;
+
+    /*
+     * Work down from the top of the scene. Everything we composite ends up
+     * on the primary plane, beneath every overlay, so nothing it overlaps
+     * further down may go on an overlay either.
+     */
+    std::vector<geom::Rectangle> composited;
+    std::vector<PlaneCandidate> placed;     // Top-most first
+
+    for (auto it = renderable_list.rbegin(); it != renderable_list.rend(); ++it)
+    {
+        auto const& renderable = *it;
+        auto const rect = renderable->screen_position();
+        geom::Rectangle const destination{geom::Point{} + (rect.top_left - area.top_left), rect.size};
+
+        auto const beneath_composited = std::any_of(composited.begin(), composited.end(),
+            [&rect](geom::Rectangle const& above) { return above.overlaps(rect); });
+
+        auto const buffer = renderable->buffer();
+        auto const bo = beneath_composited || !buffer ? nullptr : scanout_bo_for(*buffer);
+
+        if (bo &&
+            renderable->alpha() == 1.0f &&
+            renderable->transformation() == glm::mat4{} &&
+            area.contains(rect) &&
+            renderable->shaped() == has_alpha(kms_format_of(bo)))
+        {
+            /*
+             * Only planes with a zpos we control can be relied upon to
+             * stack in the right order where they overlap.
+             */
+            bool needs_stacking{false};
+            bool can_stack{true};
+            for (auto const& above : placed)
+            {
+                if (above.placement.destination.overlaps(destination))
+                {
+                    needs_stacking = true;
+                    can_stack = can_stack && above.stackable;
+                }
+            }
+
+            auto const format = kms_format_of(bo);
+            auto const plane = std::find_if(free_planes.begin(), free_planes.end(),
+                [&](KMSPlane const& plane)
+                {
+                    return plane.supports(format) &&
+                        (!needs_stacking || (can_stack && plane.stackable));
+                });
+
+            auto const bufobj = plane != free_planes.end() ? output->fb_for(bo) : nullptr;
+            if (bufobj)
+            {
+                placed.push_back({renderable, buffer, {plane->id, bufobj, buffer->size(), destination}, plane->stackable});
+                free_planes.erase(plane);
+                continue;
+            }
+        }
+
+        composited.push_back(rect);
+    }
+
+    /*
+     * Ask the hardware whether it can really do it, giving the composited
+     * work back one plane at a time, bottom-most first, until it can.
+     */
+    while (!placed.empty())
+    {
+        remainder.clear();
+        std::copy_if(renderable_list.begin(), renderable_list.end(), std::back_inserter(remainder),
+            [&placed](std::shared_ptr<Renderable> const& renderable)
+            {
+                return std::none_of(placed.begin(), placed.end(),
+                    [&renderable](PlaneCandidate const& candidate)
+                    {
+                        return candidate.renderable == renderable;
+                    });
+            });
+
+        /* With the rest out of the way, what's left might bypass too */
+        auto primary = last_composite_bufobj;
+        bypass_buf = nullptr;
+        bypass_bufobj = nullptr;
+        mgm::BypassMatch bypass_match(area);
+        if (remainder.size() == 1 && bypass_match(remainder.front()))
+        {
+            auto bypass_buffer = remainder.front()->buffer();
+            auto const bo = scanout_bo_for(*bypass_buffer);
+            if (bo && bypass_buffer->size() == surface.size())
+            {
+                if (auto bufobj = output->fb_for(bo))
+                {
+                    bypass_buf = bypass_buffer;
+                    bypass_bufobj = bufobj;
+                    primary = bufobj;
+                }
+            }
+        }
+
+        std::vector<OverlayPlacement> placements;
+        for (auto candidate = placed.rbegin(); candidate != placed.rend(); ++candidate)
+            placements.push_back(candidate->placement);
+
+        if (output->test_overlays(*primary, placements))
+        {
+            overlays = std::move(placements);
+            for (auto const& candidate : placed)
+                overlay_bufs.push_back(candidate.buffer);
+
+            if (bypass_buf)
+            {
+                remainder.clear();
+                return true;
+            }
+            return false;
+        }
+
+        placed.pop_back();
+    }
+
+    bypass_buf = nullptr;
+    bypass_bufobj = nullptr;
+    remainder = renderable_list;
+    return false;
+}
+
 void mgm::DisplayBuffer::for_each_display_buffer(
     std::function<void(graphics::DisplayBuffer&)> const& f)
 {
@@ -623,8 +818,51 @@ void mgm::DisplayBuffer::swap_buffers()
     bypass_bufobj = nullptr;
 }
 
+int mgm::DisplayBuffer::drm_fd() const
+{
+    return outputs.front()->drm_fd();
+}
+
+bool mgm::DisplayBuffer::add_set_crtc_to(AtomicRequest& request)
+{
+    for (auto& output : outputs)
+    {
+        if (!output->add_set_crtc_to(request, *last_composite_bufobj))
+            return false;
+    }
+
+    return true;
+}
+
+void mgm::DisplayBuffer::set_crtc()
+{
+    set_crtc(*last_composite_bufobj);
+    listener->report_successful_drm_mode_set_crtc_on_construction();
+}
+
 void mgm::DisplayBuffer::set_crtc(FBHandle const& forced_frame)
 {
+    /* Where the driver allows, the whole group is modeset by one commit */
+    AtomicRequest request{outputs.front()->drm_fd()};
+    request.allow_modeset();
+
+    auto const atomic = std::all_of(outputs.begin(), outputs.end(),
+        [&](std::shared_ptr<KMSOutput> const& output)
+        {
+            return output->add_set_crtc_to(request, forced_frame);
+        });
+
+    if (atomic)
+    {
+        if (request.commit(0, nullptr) == 0)
+        {
+            overlays_shown = false;
+            return;
+        }
+
+        mir::log_warning("Atomic modeset failed; falling back to setting each CRTC");
+    }
+
     for (auto& output : outputs)
     {
         /*
@@ -639,6 +877,9 @@ void mgm::DisplayBuffer::set_crtc(FBHandle const& forced_frame)
                 "Screen contents may be incomplete. "
                 "Try plugging the monitor in again.");
     }
+
+    /* Setting the CRTC takes down any overlays */
+    overlays_shown = false;
 }
 
 void mgm::DisplayBuffer::post()
@@ -662,6 +903,7 @@ void mgm::DisplayBuffer::post()
         bufobj = outputs.front()->fb_for(scheduled_composite_frame);
         if (!bufobj)
             fatal_error("Failed to get front buffer object");
+        last_composite_bufobj = bufobj;
     }
 
     /*
@@ -726,9 +968,14 @@ void mgm::DisplayBuffer::post()
     // Buffer lifetimes are managed exclusively by scheduled*/visible* now
     bypass_buf = nullptr;
     bypass_bufobj = nullptr;
+    overlays.clear();
 
+    /*
+     * With Adaptive Sync the monitor waits for us, so the next frame should
+     * be composited and flipped as soon as a client posts one.
+     */
     recommend_sleep = 0ms;
-    if (outputs.size() == 1)
+    if (outputs.size() == 1 && !outputs.front()->adaptive_sync())
     {
         auto const& output = outputs.front();
         auto const min_frame_interval = 1000ms / output->max_refresh_rate();
@@ -742,18 +989,58 @@ std::chrono::milliseconds mgm::DisplayBuffer::recommended_sleep() const
     return recommend_sleep;
 }
 
+bool mgm::DisplayBuffer::schedule_atomic_page_flip(FBHandle const& bufobj)
+{
+    AtomicRequest request{outputs.front()->drm_fd()};
+
+    for (auto& output : outputs)
+    {
+        if (!output->add_page_flip_to(request, bufobj, overlays))
+            return false;
+    }
+
+    return request.flip();
+}
+
 bool mgm::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
 {
     /*
      * Schedule the current front buffer object for display. Note that
      * the page flip is asynchronous and synchronized with vertical refresh.
+     *
+     * Clones flip together in one atomic commit where the driver allows,
+     * so that they all show the same frame from the same vblank.
      */
+    if (outputs.size() > 1 && schedule_atomic_page_flip(bufobj))
+    {
+        page_flips_pending = true;
+        scheduled_overlay_bufs = std::move(overlay_bufs);
+        overlay_bufs.clear();
+        return true;
+    }
+
     for (auto& output : outputs)
     {
-        if (output->schedule_page_flip(bufobj))
+        /*
+         * Overlays take an atomic commit, as does taking them down again;
+         * otherwise stick with the plain flip.
+         */
+        if (!overlays.empty() || overlays_shown)
+        {
+            auto const flipped = output->schedule_page_flip(bufobj, overlays);
+            if (flipped)
+                page_flips_pending = true;
+            overlays_shown = flipped && !overlays.empty();
+        }
+        else if (output->schedule_page_flip(bufobj))
+        {
             page_flips_pending = true;
+        }
     }
 
+    scheduled_overlay_bufs = std::move(overlay_bufs);
+    overlay_bufs.clear();
+
     return page_flips_pending;
 }
 
@@ -777,6 +1064,9 @@ void mgm::DisplayBuffer::wait_for_page_flip()
 
         visible_composite_frame = std::move(scheduled_composite_frame);
         scheduled_composite_frame = nullptr;
+
+        visible_overlay_bufs = std::move(scheduled_overlay_bufs);
+        scheduled_overlay_bufs.clear();
     }
 }
 
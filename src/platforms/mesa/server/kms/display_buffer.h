@@ -19,10 +19,11 @@
 #ifndef MIR_GRAPHICS_MESA_DISPLAY_BUFFER_H_
 #define MIR_GRAPHICS_MESA_DISPLAY_BUFFER_H_
 
-#include "mir/graphics/display_buffer.h"
-#include "mir/graphics/display.h"
+#include "mir/graphics/overlay_planes.h"
 #include "mir/renderer/gl/render_target.h"
 #include "display_helpers.h"
+#include "kms_display_buffer.h"
+#include "kms_output.h"
 #include "egl_helper.h"
 #include "platform_common.h"
 
@@ -42,9 +43,8 @@ namespace mesa
 {
 
 class Platform;
-class FBHandle;
-class KMSOutput;
 class NativeBuffer;
+class AtomicRequest;
 
 class GBMOutputSurface : public renderer::gl::RenderTarget
 {
@@ -93,9 +93,8 @@ private:
     GBMSurfaceUPtr surface;
 };
 
-class DisplayBuffer : public graphics::DisplayBuffer,
-                      public graphics::DisplaySyncGroup,
-                      public graphics::NativeDisplayBuffer,
+class DisplayBuffer : public KMSDisplayBuffer,
+                      public graphics::OverlayPlanes,
                       public renderer::gl::RenderTarget
 {
 public:
@@ -112,6 +111,7 @@ public:
     void release_current() override;
     void swap_buffers() override;
     bool overlay(RenderableList const& renderlist) override;
+    bool overlay(RenderableList const& renderlist, RenderableList& remainder) override;
     void bind() override;
 
     void for_each_display_buffer(
@@ -122,17 +122,30 @@ public:
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
 
-    void set_transformation(glm::mat2 const& t, geometry::Rectangle const& a);
-    void schedule_set_crtc();
-    void wait_for_page_flip();
+    void set_transformation(glm::mat2 const& t, geometry::Rectangle const& a) override;
+    int drm_fd() const override;
+
+    bool add_set_crtc_to(AtomicRequest& request) override;
+    void set_crtc() override;
+    void schedule_set_crtc() override;
+    void wait_for_page_flip() override;
 
 private:
     bool schedule_page_flip(FBHandle const& bufobj);
+    bool schedule_atomic_page_flip(FBHandle const& bufobj);
     void set_crtc(FBHandle const&);
+    gbm_bo* scanout_bo_for(graphics::Buffer& buffer) const;
 
     std::shared_ptr<graphics::Buffer> visible_bypass_frame, scheduled_bypass_frame;
     std::shared_ptr<Buffer> bypass_buf{nullptr};
     FBHandle* bypass_bufobj{nullptr};
+
+    /* Client buffers shown on overlay planes, held like the bypass frames */
+    std::vector<OverlayPlacement> overlays;
+    std::vector<std::shared_ptr<graphics::Buffer>> overlay_bufs;
+    std::vector<std::shared_ptr<graphics::Buffer>> scheduled_overlay_bufs, visible_overlay_bufs;
+    bool overlays_shown{false};
+    FBHandle* last_composite_bufobj{nullptr};
     std::shared_ptr<DisplayReport> const listener;
     BypassOption bypass_option;
 
@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dumb_buffer.h"
+
+#include <boost/throw_exception.hpp>
+#include <xf86drm.h>
+#include <drm_fourcc.h>
+#include <sys/mman.h>
+
+#include <system_error>
+#include <cstring>
+
+namespace mgm = mir::graphics::mesa;
+namespace geom = mir::geometry;
+
+namespace
+{
+uint32_t add_fb(int drm_fd, geom::Size const& size, uint32_t gem_handle, uint32_t pitch)
+{
+    uint32_t handles[4] = {gem_handle, 0, 0, 0};
+    uint32_t strides[4] = {pitch, 0, 0, 0};
+    uint32_t offsets[4] = {0, 0, 0, 0};
+    uint32_t fb_id{0};
+
+    auto const ret = drmModeAddFB2(
+        drm_fd,
+        size.width.as_uint32_t(), size.height.as_uint32_t(),
+        DRM_FORMAT_XRGB8888,
+        handles, strides, offsets, &fb_id, 0);
+    if (ret)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{-ret, std::system_category(), "Failed to attach dumb buffer to FB"}));
+    }
+
+    return fb_id;
+}
+}
+
+mgm::DumbBuffer::Handle::Handle(int drm_fd, geom::Size const& size)
+    : drm_fd{drm_fd}
+{
+    struct drm_mode_create_dumb params = {};
+
+    params.width = size.width.as_uint32_t();
+    params.height = size.height.as_uint32_t();
+    params.bpp = 32;
+
+    if (drmIoctl(drm_fd, DRM_IOCTL_MODE_CREATE_DUMB, &params) != 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to create dumb buffer"}));
+    }
+
+    gem_handle = params.handle;
+    pitch = params.pitch;
+    this->size = params.size;
+}
+
+mgm::DumbBuffer::Handle::~Handle()
+{
+    struct drm_mode_destroy_dumb params = {};
+    params.handle = gem_handle;
+
+    drmIoctl(drm_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &params);
+}
+
+mgm::DumbBuffer::Mapping::Mapping(Handle const& handle)
+    : data{
+        [&handle]
+        {
+            struct drm_mode_map_dumb map_request = {};
+            map_request.handle = handle.gem_handle;
+
+            if (drmIoctl(handle.drm_fd, DRM_IOCTL_MODE_MAP_DUMB, &map_request) != 0)
+            {
+                BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to map dumb buffer"}));
+            }
+
+            auto const map = mmap(
+                nullptr, handle.size, PROT_READ | PROT_WRITE, MAP_SHARED, handle.drm_fd, map_request.offset);
+            if (map == MAP_FAILED)
+            {
+                BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to mmap() dumb buffer"}));
+            }
+            return map;
+        }()},
+      size{handle.size}
+{
+}
+
+mgm::DumbBuffer::Mapping::~Mapping()
+{
+    munmap(data, size);
+}
+
+mgm::DumbBuffer::DumbBuffer(int drm_fd, geom::Size const& size)
+    : size_{size},
+      handle{drm_fd, size},
+      fb_{drm_fd, add_fb(drm_fd, size, handle.gem_handle, handle.pitch), DRM_FORMAT_XRGB8888, handle.pitch},
+      mapping{handle}
+{
+    /* Start out black rather than showing whatever the memory last held */
+    memset(mapping.data, 0, mapping.size);
+}
+
+mgm::DumbBuffer::~DumbBuffer() = default;
+
+auto mgm::DumbBuffer::fb() const -> FBHandle const&
+{
+    return fb_;
+}
+
+unsigned char* mgm::DumbBuffer::pixels() const
+{
+    return static_cast<unsigned char*>(mapping.data);
+}
+
+geom::Size mgm::DumbBuffer::size() const
+{
+    return size_;
+}
+
+geom::Stride mgm::DumbBuffer::stride() const
+{
+    return geom::Stride{handle.pitch};
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_DUMB_BUFFER_H_
+#define MIR_GRAPHICS_MESA_DUMB_BUFFER_H_
+
+#include "fb_handle.h"
+#include "mir/geometry/size.h"
+#include "mir/geometry/dimensions.h"
+
+#include <cstddef>
+
+namespace mir
+{
+namespace graphics
+{
+namespace mesa
+{
+
+/**
+ * An XRGB8888 KMS framebuffer in a dumb buffer, mapped for CPU access for
+ * as long as it lives.
+ */
+class DumbBuffer
+{
+public:
+    DumbBuffer(int drm_fd, geometry::Size const& size);
+    ~DumbBuffer();
+
+    DumbBuffer(DumbBuffer const&) = delete;
+    DumbBuffer& operator=(DumbBuffer const&) = delete;
+
+    FBHandle const& fb() const;
+    unsigned char* pixels() const;
+    geometry::Size size() const;
+    geometry::Stride stride() const;
+
+private:
+    /* Destroys the dumb buffer if construction fails part way */
+    struct Handle
+    {
+        Handle(int drm_fd, geometry::Size const& size);
+        ~Handle();
+
+        int const drm_fd;
+        uint32_t gem_handle;
+        uint32_t pitch;
+        uint64_t size;
+    };
+
+    struct Mapping
+    {
+        Mapping(Handle const& handle);
+        ~Mapping();
+
+        void* const data;
+        size_t const size;
+    };
+
+    geometry::Size const size_;
+    Handle const handle;
+    FBHandle const fb_;
+    Mapping const mapping;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_MESA_DUMB_BUFFER_H_ */
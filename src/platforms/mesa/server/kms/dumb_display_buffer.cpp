@@ -0,0 +1,230 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dumb_display_buffer.h"
+#include "kms_output.h"
+#include "atomic_request.h"
+#include "mir/graphics/display_report.h"
+#include "mir/log.h"
+
+#include <algorithm>
+
+namespace mg = mir::graphics;
+namespace mgm = mir::graphics::mesa;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+mgm::DumbDisplayBuffer::DumbDisplayBuffer(
+    std::shared_ptr<DisplayReport> const& listener,
+    std::vector<std::shared_ptr<KMSOutput>> const& outputs,
+    geom::Size const& size,
+    geom::Rectangle const& area,
+    glm::mat2 const& transformation)
+    : listener(listener),
+      outputs(outputs),
+      buffers{{
+          std::make_unique<DumbBuffer>(outputs.front()->drm_fd(), size),
+          std::make_unique<DumbBuffer>(outputs.front()->drm_fd(), size)}},
+      area(area),
+      transform{transformation},
+      needs_set_crtc{false},
+      page_flips_pending{false}
+{
+    listener->report_successful_setup_of_native_resources();
+    listener->report_successful_display_construction();
+}
+
+mgm::DumbDisplayBuffer::~DumbDisplayBuffer()
+{
+    /* Don't unmap a buffer the hardware may still be flipping to */
+    wait_for_page_flip();
+}
+
+geom::Rectangle mgm::DumbDisplayBuffer::view_area() const
+{
+    return area;
+}
+
+bool mgm::DumbDisplayBuffer::overlay(RenderableList const&)
+{
+    /* Client buffers are never scanned out directly; everything is composited */
+    return false;
+}
+
+glm::mat2 mgm::DumbDisplayBuffer::transformation() const
+{
+    return transform;
+}
+
+void mgm::DumbDisplayBuffer::set_transformation(glm::mat2 const& t, geometry::Rectangle const& a)
+{
+    transform = t;
+    area = a;
+}
+
+mg::NativeDisplayBuffer* mgm::DumbDisplayBuffer::native_display_buffer()
+{
+    return this;
+}
+
+void mgm::DumbDisplayBuffer::for_each_display_buffer(
+    std::function<void(graphics::DisplayBuffer&)> const& f)
+{
+    f(*this);
+}
+
+mrs::WritableFrame mgm::DumbDisplayBuffer::map_back_buffer()
+{
+    /*
+     * In clone mode post() doesn't wait for the flip, so the back buffer may
+     * still be on screen until it completes.
+     */
+    wait_for_page_flip();
+
+    auto const& back = *buffers[1 - front];
+    return {back.pixels(), back.size(), back.stride(), mir_pixel_format_xrgb_8888};
+}
+
+void mgm::DumbDisplayBuffer::swap_buffers()
+{
+    back_drawn = true;
+}
+
+void mgm::DumbDisplayBuffer::post()
+{
+    wait_for_page_flip();
+
+    if (back_drawn)
+    {
+        front = 1 - front;
+        back_drawn = false;
+    }
+
+    auto const& fb = buffers[front]->fb();
+
+    if (!needs_set_crtc && !schedule_page_flip(fb))
+        needs_set_crtc = true;
+
+    if (needs_set_crtc)
+    {
+        set_crtc(fb);
+        needs_set_crtc = false;
+    }
+
+    /* As with GL composition, clones are left to flip while we draw the next frame */
+    if (outputs.size() == 1)
+        wait_for_page_flip();
+}
+
+std::chrono::milliseconds mgm::DumbDisplayBuffer::recommended_sleep() const
+{
+    return std::chrono::milliseconds{0};
+}
+
+bool mgm::DumbDisplayBuffer::schedule_page_flip(FBHandle const& fb)
+{
+    if (outputs.size() > 1)
+    {
+        AtomicRequest request{outputs.front()->drm_fd()};
+
+        auto const atomic = std::all_of(outputs.begin(), outputs.end(),
+            [&](std::shared_ptr<KMSOutput> const& output)
+            {
+                return output->add_page_flip_to(request, fb, {});
+            });
+
+        if (atomic && request.flip())
+        {
+            page_flips_pending = true;
+            return true;
+        }
+    }
+
+    for (auto& output : outputs)
+    {
+        if (output->schedule_page_flip(fb))
+            page_flips_pending = true;
+    }
+
+    return page_flips_pending;
+}
+
+void mgm::DumbDisplayBuffer::wait_for_page_flip()
+{
+    if (page_flips_pending)
+    {
+        for (auto& output : outputs)
+            output->wait_for_page_flip();
+
+        page_flips_pending = false;
+    }
+}
+
+int mgm::DumbDisplayBuffer::drm_fd() const
+{
+    return outputs.front()->drm_fd();
+}
+
+bool mgm::DumbDisplayBuffer::add_set_crtc_to(AtomicRequest& request)
+{
+    for (auto& output : outputs)
+    {
+        if (!output->add_set_crtc_to(request, buffers[front]->fb()))
+            return false;
+    }
+
+    return true;
+}
+
+void mgm::DumbDisplayBuffer::set_crtc()
+{
+    set_crtc(buffers[front]->fb());
+    listener->report_successful_drm_mode_set_crtc_on_construction();
+}
+
+void mgm::DumbDisplayBuffer::set_crtc(FBHandle const& fb)
+{
+    AtomicRequest request{outputs.front()->drm_fd()};
+    request.allow_modeset();
+
+    auto const atomic = std::all_of(outputs.begin(), outputs.end(),
+        [&](std::shared_ptr<KMSOutput> const& output)
+        {
+            return output->add_set_crtc_to(request, fb);
+        });
+
+    if (atomic)
+    {
+        if (request.commit(0, nullptr) == 0)
+            return;
+
+        mir::log_warning("Atomic modeset failed; falling back to setting each CRTC");
+    }
+
+    for (auto& output : outputs)
+    {
+        /* As for GL composition, failing to set the CRTC is not fatal */
+        if (!output->set_crtc(fb))
+            mir::log_error("Failed to set DRM CRTC. "
+                "Screen contents may be incomplete. "
+                "Try plugging the monitor in again.");
+    }
+}
+
+void mgm::DumbDisplayBuffer::schedule_set_crtc()
+{
+    needs_set_crtc = true;
+}
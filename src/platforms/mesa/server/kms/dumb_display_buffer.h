@@ -0,0 +1,99 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_DUMB_DISPLAY_BUFFER_H_
+#define MIR_GRAPHICS_MESA_DUMB_DISPLAY_BUFFER_H_
+
+#include "kms_display_buffer.h"
+#include "dumb_buffer.h"
+#include "mir/renderer/sw/render_target.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <atomic>
+
+namespace mir
+{
+namespace graphics
+{
+
+class DisplayReport;
+
+namespace mesa
+{
+
+class KMSOutput;
+
+/**
+ * A display buffer for outputs that are composited by the CPU: frames are
+ * drawn straight into one of a pair of mapped dumb buffers and then flipped
+ * to, so no GL (nor any copy) is involved in putting them on screen.
+ */
+class DumbDisplayBuffer : public KMSDisplayBuffer,
+                          public renderer::software::RenderTarget
+{
+public:
+    DumbDisplayBuffer(std::shared_ptr<DisplayReport> const& listener,
+                      std::vector<std::shared_ptr<KMSOutput>> const& outputs,
+                      geometry::Size const& size,
+                      geometry::Rectangle const& area,
+                      glm::mat2 const& transformation);
+    ~DumbDisplayBuffer();
+
+    geometry::Rectangle view_area() const override;
+    bool overlay(RenderableList const& renderlist) override;
+    glm::mat2 transformation() const override;
+    NativeDisplayBuffer* native_display_buffer() override;
+
+    void for_each_display_buffer(
+        std::function<void(graphics::DisplayBuffer&)> const& f) override;
+    void post() override;
+    std::chrono::milliseconds recommended_sleep() const override;
+
+    renderer::software::WritableFrame map_back_buffer() override;
+    void swap_buffers() override;
+
+    void set_transformation(glm::mat2 const& t, geometry::Rectangle const& a) override;
+    int drm_fd() const override;
+    bool add_set_crtc_to(AtomicRequest& request) override;
+    void set_crtc() override;
+    void schedule_set_crtc() override;
+    void wait_for_page_flip() override;
+
+private:
+    bool schedule_page_flip(FBHandle const& fb);
+    void set_crtc(FBHandle const& fb);
+
+    std::shared_ptr<DisplayReport> const listener;
+    std::vector<std::shared_ptr<KMSOutput>> const outputs;
+
+    std::array<std::unique_ptr<DumbBuffer>, 2> const buffers;
+    /* The buffer last flipped to (or being flipped to); the other is drawn into */
+    size_t front{0};
+    bool back_drawn{false};
+
+    geometry::Rectangle area;
+    glm::mat2 transform;
+    std::atomic<bool> needs_set_crtc;
+    bool page_flips_pending;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_MESA_DUMB_DISPLAY_BUFFER_H_ */
@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_FB_HANDLE_H_
+#define MIR_GRAPHICS_MESA_FB_HANDLE_H_
+
+#include <xf86drmMode.h>
+#include <cstdint>
+
+namespace mir
+{
+namespace graphics
+{
+namespace mesa
+{
+
+/**
+ * A KMS framebuffer, removed again when the handle is destroyed.
+ */
+class FBHandle
+{
+public:
+    FBHandle(int drm_fd, uint32_t drm_fb_id, uint32_t format, uint32_t pitch)
+        : drm_fd{drm_fd}, drm_fb_id{drm_fb_id}, format{format}, pitch{pitch}
+    {
+    }
+
+    ~FBHandle()
+    {
+        if (drm_fb_id)
+        {
+            drmModeRmFB(drm_fd, drm_fb_id);
+        }
+    }
+
+    FBHandle(FBHandle const&) = delete;
+    FBHandle& operator=(FBHandle const&) = delete;
+
+    uint32_t get_drm_fb_id() const
+    {
+        return drm_fb_id;
+    }
+
+    /** The DRM fourcc format the framebuffer was created with */
+    uint32_t get_format() const
+    {
+        return format;
+    }
+
+    uint32_t get_pitch() const
+    {
+        return pitch;
+    }
+
+private:
+    int const drm_fd;
+    uint32_t const drm_fb_id;
+    uint32_t const format;
+    uint32_t const pitch;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_MESA_FB_HANDLE_H_ */
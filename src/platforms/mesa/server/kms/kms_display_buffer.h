@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_KMS_DISPLAY_BUFFER_H_
+#define MIR_GRAPHICS_MESA_KMS_DISPLAY_BUFFER_H_
+
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/display.h"
+#include "mir/geometry/rectangle.h"
+
+namespace mir
+{
+namespace graphics
+{
+namespace mesa
+{
+
+class AtomicRequest;
+
+/**
+ * The display buffer of a group of KMS outputs showing the same frames,
+ * as the Display drives it through modesets and reconfiguration.
+ */
+class KMSDisplayBuffer : public graphics::DisplayBuffer,
+                         public graphics::DisplaySyncGroup,
+                         public graphics::NativeDisplayBuffer
+{
+public:
+    virtual void set_transformation(glm::mat2 const& t, geometry::Rectangle const& a) = 0;
+    virtual int drm_fd() const = 0;
+
+    /**
+     * Adds showing the initial frame on all our outputs, in their configured
+     * modes, to request (e.g. to test a whole display configuration).
+     *
+     * \returns false if the driver lacks atomic modesetting
+     */
+    virtual bool add_set_crtc_to(AtomicRequest& request) = 0;
+    /** Shows the initial frame, setting the modes of all our outputs */
+    virtual void set_crtc() = 0;
+    virtual void schedule_set_crtc() = 0;
+    virtual void wait_for_page_flip() = 0;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_MESA_KMS_DISPLAY_BUFFER_H_ */
@@ -27,8 +27,10 @@
 #include "mir_toolkit/common.h"
 
 #include "kms-utils/drm_mode_resources.h"
+#include "crtc_planes.h"
 
 #include <gbm.h>
+#include <vector>
 
 namespace mir
 {
@@ -40,6 +42,18 @@ namespace mesa
 {
 
 class FBHandle;
+class AtomicRequest;
+
+/**
+ * A whole buffer scanned out on an overlay plane, above the primary plane.
+ */
+struct OverlayPlacement
+{
+    uint32_t plane_id;
+    FBHandle const* fb;
+    geometry::Size source;              ///< The size of the buffer
+    geometry::Rectangle destination;    ///< Relative to the output
+};
 
 class KMSOutput
 {
@@ -64,11 +78,64 @@ public:
      */
     virtual int max_refresh_rate() const = 0;
 
+    /**
+     * Whether the CRTC should hold each frame until the next is flipped to
+     * (Adaptive Sync), rather than refreshing at a fixed rate. This takes
+     * effect from the next add_set_crtc_to(), and is ignored unless both
+     * the connector and the CRTC support it.
+     */
+    virtual void set_adaptive_sync(bool enabled) = 0;
+    /**
+     * Whether Adaptive Sync is in effect, so that a flip is shown as soon as
+     * it is scheduled (within the monitor's refresh range).
+     */
+    virtual bool adaptive_sync() const = 0;
+
     virtual bool set_crtc(FBHandle const& fb) = 0;
     virtual void clear_crtc() = 0;
     virtual bool schedule_page_flip(FBHandle const& fb) = 0;
     virtual void wait_for_page_flip() = 0;
 
+    /**
+     * The overlay planes that can be stacked above this output's primary
+     * plane. Empty if there are none we can use.
+     */
+    virtual std::vector<KMSPlane> overlay_planes() = 0;
+    /**
+     * Check, without changing what is shown, whether the hardware could show
+     * fb with overlays (bottom-most first) stacked above it.
+     */
+    virtual bool test_overlays(FBHandle const& fb, std::vector<OverlayPlacement> const& overlays) = 0;
+    /**
+     * As schedule_page_flip(fb), but showing exactly overlays (bottom-most
+     * first) above fb from the same vblank. Completion is waited for with
+     * wait_for_page_flip().
+     */
+    virtual bool schedule_page_flip(FBHandle const& fb, std::vector<OverlayPlacement> const& overlays) = 0;
+
+    /**
+     * Add flipping to fb, with overlays above it, to request: a commit that
+     * flips every output of a DisplaySyncGroup at once. Completion is waited
+     * for with wait_for_page_flip().
+     *
+     * \returns false, leaving request untouched, if the output can't take
+     *          part in atomic commits
+     */
+    virtual bool add_page_flip_to(
+        AtomicRequest& request,
+        FBHandle const& fb,
+        std::vector<OverlayPlacement> const& overlays) = 0;
+    /**
+     * As add_page_flip_to(), but for the atomic equivalent of set_crtc(fb):
+     * the output's mode and routing are set too.
+     */
+    virtual bool add_set_crtc_to(AtomicRequest& request, FBHandle const& fb) = 0;
+    /**
+     * As add_set_crtc_to(), but for the atomic equivalent of clear_crtc().
+     * An output with no CRTC to clear adds nothing, and returns true.
+     */
+    virtual bool add_clear_crtc_to(AtomicRequest& request) = 0;
+
     virtual bool set_cursor(gbm_bo* buffer) = 0;
     virtual void move_cursor(geometry::Point destination) = 0;
     virtual bool clear_cursor() = 0;
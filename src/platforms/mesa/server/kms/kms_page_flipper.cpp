@@ -18,8 +18,10 @@
 
 #include "kms_page_flipper.h"
 #include "mir/graphics/display_report.h"
+#include "mir/thread_name.h"
 
 #include <stdexcept>
+#include <system_error>
 #include <boost/throw_exception.hpp>
 #include <boost/exception/errinfo_errno.hpp>
 
@@ -27,6 +29,8 @@
 #include <xf86drmMode.h>
 #include <chrono>
 #include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
 
 namespace mg = mir::graphics;
 namespace mgm = mir::graphics::mesa;
@@ -44,6 +48,31 @@ void page_flip_handler(int /*fd*/, unsigned int seq,
                                               seq, ns);
 }
 
+#if DRM_EVENT_CONTEXT_VERSION >= 3
+void page_flip_handler2(int /*fd*/, unsigned int seq,
+                        unsigned int sec, unsigned int usec,
+                        unsigned int crtc_id, void* data)
+{
+    auto page_flip_data = static_cast<mgm::PageFlipEventData*>(data);
+    std::chrono::nanoseconds ns{sec*1000000000LL + usec*1000LL};
+
+    /* Kernels predating DRM_CAP_CRTC_IN_VBLANK_EVENT leave crtc_id at 0 */
+    page_flip_data->flipper->notify_page_flip(crtc_id ? crtc_id : page_flip_data->crtc_id,
+                                              seq, ns);
+}
+#endif
+
+bool drm_reports_crtc_in_events(int drm_fd)
+{
+#if DRM_EVENT_CONTEXT_VERSION >= 3 && defined(DRM_CAP_CRTC_IN_VBLANK_EVENT)
+    uint64_t crtc_in_event = 0;
+    return !drmGetCap(drm_fd, DRM_CAP_CRTC_IN_VBLANK_EVENT, &crtc_in_event) && crtc_in_event;
+#else
+    (void)drm_fd;
+    return false;
+#endif
+}
+
 }
 
 mgm::KMSPageFlipper::KMSPageFlipper(
@@ -52,25 +81,67 @@ mgm::KMSPageFlipper::KMSPageFlipper(
     drm_fd{drm_fd},
     report{report},
     pending_page_flips(),
-    worker_tid()
+    any_crtc{0, 0, this},
+    crtc_in_events{drm_reports_crtc_in_events(drm_fd)},
+    stop_dispatch{eventfd(0, EFD_CLOEXEC)}
 {
     uint64_t mono = 0;
     if (drmGetCap(drm_fd, DRM_CAP_TIMESTAMP_MONOTONIC, &mono) || !mono)
         clock_id = CLOCK_REALTIME;
     else
         clock_id = CLOCK_MONOTONIC;
+
+    if (stop_dispatch < 0)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno,
+                                                 std::system_category(),
+                                                 "Failed to create eventfd for page flip events"}));
+    }
+}
+
+mgm::KMSPageFlipper::~KMSPageFlipper()
+{
+    if (event_thread.joinable())
+    {
+        eventfd_write(stop_dispatch, 1);
+        event_thread.join();
+    }
 }
 
 bool mgm::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
                                         uint32_t fb_id,
                                         uint32_t connector_id)
+{
+    return schedule_flip(
+        {{crtc_id, connector_id}},
+        [this, crtc_id, fb_id](void* event_data)
+        {
+            return drmModePageFlip(drm_fd, crtc_id, fb_id,
+                                   DRM_MODE_PAGE_FLIP_EVENT,
+                                   event_data);
+        });
+}
+
+bool mgm::KMSPageFlipper::schedule_flip(std::vector<PageFlipTarget> const& targets,
+                                        std::function<int(void* event_data)> const& flip)
 {
     std::unique_lock<std::mutex> lock{pf_mutex};
 
-    if (pending_page_flips.find(crtc_id) != pending_page_flips.end())
-        BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
+    if (targets.empty())
+        BOOST_THROW_EXCEPTION(std::logic_error("Page flip has no CRTC to flip"));
 
-    pending_page_flips[crtc_id] = PageFlipEventData{crtc_id, connector_id, this};
+    /* Without CRTC ids in the events we couldn't tell which CRTC has flipped */
+    if (targets.size() > 1 && !crtc_in_events)
+        return false;
+
+    for (auto const& target : targets)
+    {
+        if (pending_page_flips.find(target.crtc_id) != pending_page_flips.end())
+            BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
+    }
+
+    for (auto const& target : targets)
+        pending_page_flips[target.crtc_id] = PageFlipEventData{target.crtc_id, target.connector_id, this};
 
     /*
      * It appears we can't tell the difference between flipping being
@@ -78,95 +149,96 @@ bool mgm::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
      * fails with -22 (Invalid argument) despite the arguments being
      * apparently valid.
      */
-    auto ret = drmModePageFlip(drm_fd, crtc_id, fb_id,
-                               DRM_MODE_PAGE_FLIP_EVENT,
-                               &pending_page_flips[crtc_id]);
+    auto ret = targets.size() == 1 ?
+        flip(&pending_page_flips[targets.front().crtc_id]) :
+        flip(&any_crtc);
 
     if (ret)
-        pending_page_flips.erase(crtc_id);
+    {
+        for (auto const& target : targets)
+            pending_page_flips.erase(target.crtc_id);
+    }
 
     return (ret == 0);
 }
 
 mg::Frame mgm::KMSPageFlipper::wait_for_flip(uint32_t crtc_id)
 {
-    drmEventContext evctx;
-    memset(&evctx, 0, sizeof evctx);
-    evctx.version = 2;  // We only support the old v2 page_flip_handler
-    evctx.page_flip_handler = &page_flip_handler;
+    std::unique_lock<std::mutex> lock{pf_mutex};
 
-    static std::thread::id const invalid_tid;
+    if (page_flip_is_done(crtc_id))
+        return completed_page_flips[crtc_id];
 
-    {
-        std::unique_lock<std::mutex> lock{pf_mutex};
+    /* Nothing reads the DRM fd until somebody first needs it to */
+    if (!event_thread.joinable())
+        event_thread = std::thread{[this] { dispatch_events(); }};
 
-        /*
-         * While another thread is the worker (it is controlling the
-         * page flip event loop) and our event has not arrived, wait.
-         */
-        while (worker_tid != invalid_tid && !page_flip_is_done(crtc_id))
-            pf_cv.wait(lock);
+    pf_cv.wait(lock, [&] { return page_flip_is_done(crtc_id) || dispatch_error; });
 
-        /* If the page flip we are waiting for has arrived we are done. */
-        if (page_flip_is_done(crtc_id))
-            return completed_page_flips[crtc_id];
+    if (!page_flip_is_done(crtc_id))
+        std::rethrow_exception(dispatch_error);
 
-        /* ...otherwise we become the worker */
-        worker_tid = std::this_thread::get_id();
-    }
+    return completed_page_flips[crtc_id];
+}
 
-    /* Only the worker thread reaches this point */
-    bool done{false};
+void mgm::KMSPageFlipper::dispatch_events()
+{
+    mir::set_thread_name("Mir/KMS/flip");
 
-    while (!done)
-    {
-        fd_set fds;
-        FD_ZERO(&fds);
-        FD_SET(drm_fd, &fds);
+    drmEventContext evctx;
+    memset(&evctx, 0, sizeof evctx);
+    evctx.version = 2;
+    evctx.page_flip_handler = &page_flip_handler;
+#if DRM_EVENT_CONTEXT_VERSION >= 3
+    evctx.version = 3;
+    evctx.page_flip_handler2 = &page_flip_handler2;
+#endif
 
+    pollfd fds[] = {{drm_fd, POLLIN, 0}, {stop_dispatch, POLLIN, 0}};
+
+    while (true)
+    {
         /*
          * Wait for a page flip event. When we get a page flip event,
          * page_flip_handler(), called through drmHandleEvent(), will update
          * the pending_page_flips map.
          */
-        auto ret = select(drm_fd + 1, &fds, nullptr, nullptr, nullptr);
+        auto const ret = poll(fds, sizeof fds / sizeof fds[0], -1);
+
+        if (fds[1].revents)
+            return;
 
         {
-            std::unique_lock<std::mutex> lock{pf_mutex};
+            std::lock_guard<std::mutex> lock{pf_mutex};
 
-            if (ret > 0)
+            if (ret > 0 && (fds[0].revents & POLLIN))
             {
                 drmHandleEvent(drm_fd, &evctx);
             }
-            else if (ret < 0 && errno != EINTR)
+            else if ((ret < 0 && errno != EINTR) || (ret > 0 && fds[0].revents))
             {
-                std::string const msg("Error while waiting for page-flip event");
-                BOOST_THROW_EXCEPTION(
-                    boost::enable_error_info(
-                        std::runtime_error(msg)) << boost::errinfo_errno(errno));
-            }
+                auto const error = ret < 0 ? errno : EBADF;
 
-            done = page_flip_is_done(crtc_id);
-            /* Give up loop control if we are done */
-            if (done)
-                worker_tid = invalid_tid;
+                try
+                {
+                    std::string const msg("Error while waiting for page-flip event");
+                    BOOST_THROW_EXCEPTION(
+                        boost::enable_error_info(
+                            std::runtime_error(msg)) << boost::errinfo_errno(error));
+                }
+                catch (...)
+                {
+                    dispatch_error = std::current_exception();
+                }
+            }
         }
 
-        /*
-         * Wake up other (non-worker) threads, so they can check whether
-         * their page-flip events have arrived, or whether they can become
-         * the worker (see pf_cv.wait(lock) above).
-         */
+        /* Wake up the threads waiting for their page flips to complete */
         pf_cv.notify_all();
-    }
-    return completed_page_flips[crtc_id];
-}
 
-std::thread::id mgm::KMSPageFlipper::debug_get_worker_tid()
-{
-    std::unique_lock<std::mutex> lock{pf_mutex};
-
-    return worker_tid;
+        if (dispatch_error)
+            return;
+    }
 }
 
 /* This method should be called with the 'pf_mutex' locked */
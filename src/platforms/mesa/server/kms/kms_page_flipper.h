@@ -20,9 +20,11 @@
 #define MIR_GRAPHICS_MESA_KMS_PAGE_FLIPPER_H_
 
 #include "page_flipper.h"
+#include "mir/fd.h"
 
 #include <unordered_map>
 #include <chrono>
+#include <exception>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -47,19 +49,29 @@ struct PageFlipEventData
     KMSPageFlipper* flipper;
 };
 
+/**
+ * Schedules page flips on one DRM device.
+ *
+ * Page flip events are read by a dedicated event thread, so completing a
+ * flip never needs the threads waiting for one to poll the DRM fd
+ * themselves: they only block on a condition variable.
+ */
 class KMSPageFlipper : public PageFlipper
 {
 public:
     KMSPageFlipper(int drm_fd, std::shared_ptr<DisplayReport> const& report);
+    ~KMSPageFlipper();
 
     bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) override;
+    bool schedule_flip(
+        std::vector<PageFlipTarget> const& targets,
+        std::function<int(void* event_data)> const& flip) override;
     Frame wait_for_flip(uint32_t crtc_id) override;
 
-    std::thread::id debug_get_worker_tid();
-
     void notify_page_flip(uint32_t crtc_id, int64_t msc, std::chrono::nanoseconds ust);
 private:
     bool page_flip_is_done(uint32_t crtc_id);
+    void dispatch_events();
 
     int const drm_fd;
     std::shared_ptr<DisplayReport> const report;
@@ -67,8 +79,15 @@ private:
     std::unordered_map<uint32_t,Frame> completed_page_flips;
     std::mutex pf_mutex;
     std::condition_variable pf_cv;
-    std::thread::id worker_tid;
     clockid_t clock_id;
+
+    /// Event data for multi-CRTC flips, whose events carry their CRTC id
+    PageFlipEventData any_crtc;
+    bool crtc_in_events;
+
+    mir::Fd const stop_dispatch;
+    std::thread event_thread;
+    std::exception_ptr dispatch_error;
 };
 
 }
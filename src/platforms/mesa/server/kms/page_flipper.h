@@ -21,6 +21,8 @@
 
 #include "mir/graphics/frame.h"
 #include <cstdint>
+#include <functional>
+#include <vector>
 
 namespace mir
 {
@@ -29,12 +31,31 @@ namespace graphics
 namespace mesa
 {
 
+/** A CRTC, and the connector it drives, whose page flip event is awaited */
+struct PageFlipTarget
+{
+    uint32_t crtc_id;
+    uint32_t connector_id;
+};
+
 class PageFlipper
 {
 public:
     virtual ~PageFlipper() {}
 
     virtual bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) = 0;
+    /**
+     * Schedules a flip that flip() submits itself (e.g. as an atomic commit),
+     * passing event_data as the user data of its DRM page flip events. One
+     * commit may flip several CRTCs, each completing (and waited for with
+     * wait_for_flip()) separately.
+     * \returns whether flip() returned 0; false without calling flip() if
+     *          the driver can't say which CRTC the events of a multi-CRTC
+     *          flip belong to
+     */
+    virtual bool schedule_flip(
+        std::vector<PageFlipTarget> const& targets,
+        std::function<int(void* event_data)> const& flip) = 0;
     virtual Frame wait_for_flip(uint32_t crtc_id) = 0;
 
 protected:
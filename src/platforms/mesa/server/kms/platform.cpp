@@ -54,13 +54,15 @@ namespace mgmh = mgm::helpers;
 mgm::Platform::Platform(std::shared_ptr<DisplayReport> const& listener,
                         std::shared_ptr<VirtualTerminal> const& vt,
                         EmergencyCleanupRegistry& emergency_cleanup_registry,
-                        BypassOption bypass_option)
+                        BypassOption bypass_option,
+                        ScanoutOption scanout_option)
     : udev{std::make_shared<mir::udev::Context>()},
       drm{helpers::DRMHelper::open_all_devices(udev)},
       gbm{std::make_shared<mgmh::GBMHelper>()},
       listener{listener},
       vt{vt},
-      bypass_option_{bypass_option}
+      bypass_option_{bypass_option},
+      scanout_option{scanout_option}
 {
     // We assume the first DRM device is the boot GPU, and arbitrarily pick it as our
     // shell renderer.
@@ -115,7 +117,8 @@ mir::UniqueModulePtr<mg::Display> mgm::Platform::create_display(
         bypass_option_,
         initial_conf_policy,
         gl_config,
-        listener);
+        listener,
+        scanout_option);
 }
 
 mg::NativeDisplayPlatform* mgm::Platform::native_display_platform()
@@ -43,7 +43,8 @@ public:
     explicit Platform(std::shared_ptr<DisplayReport> const& reporter,
                       std::shared_ptr<VirtualTerminal> const& vt,
                       EmergencyCleanupRegistry& emergency_cleanup_registry,
-                      BypassOption bypass_option);
+                      BypassOption bypass_option,
+                      ScanoutOption scanout_option = ScanoutOption::gbm_surface);
 
     /* From Platform */
     UniqueModulePtr<graphics::GraphicBufferAllocator> create_buffer_allocator() override;
@@ -68,6 +69,7 @@ public:
     BypassOption bypass_option() const;
 private:
     BypassOption const bypass_option_;
+    ScanoutOption const scanout_option;
     std::unique_ptr<DRMNativePlatformAuthFactory> auth_factory;
 };
 
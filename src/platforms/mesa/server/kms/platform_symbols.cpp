@@ -39,6 +39,7 @@ namespace
 char const* bypass_option_name{"bypass"};
 char const* vt_option_name{"vt"};
 char const* host_socket{"host-socket"};
+char const* renderer_option_name{"renderer"};
 
 struct RealVTFileOperations : public mgm::VTFileOperations
 {
@@ -100,6 +101,16 @@ struct RealPosixProcessOperations : public mgm::PosixProcessOperations
         return ::setsid();
     }
 };
+
+/*
+ * The software renderer draws into mapped dumb buffers, which saves
+ * compositing with GL (perhaps llvmpipe) into GBM surfaces and copying.
+ */
+bool software_rendering_requested(mo::Option const& options)
+{
+    return options.is_set(renderer_option_name) &&
+           options.get<std::string>(renderer_option_name) == "software";
+}
 }
 
 mir::UniqueModulePtr<mg::Platform> create_host_platform(
@@ -122,8 +133,12 @@ mir::UniqueModulePtr<mg::Platform> create_host_platform(
     if (!options->get<bool>(bypass_option_name))
         bypass_option = mgm::BypassOption::prohibited;
 
+    auto scanout_option = mgm::ScanoutOption::gbm_surface;
+    if (software_rendering_requested(*options))
+        scanout_option = mgm::ScanoutOption::dumb_buffer;
+
     return mir::make_module_ptr<mgm::Platform>(
-        report, vt, *emergency_cleanup_registry, bypass_option);
+        report, vt, *emergency_cleanup_registry, bypass_option, scanout_option);
 }
 
 void add_graphics_platform_options(boost::program_options::options_description& config)
@@ -264,8 +279,12 @@ mir::UniqueModulePtr<mir::graphics::DisplayPlatform> create_display_platform(
     if (!options->get<bool>(bypass_option_name))
         bypass_option = mgm::BypassOption::prohibited;
 
+    auto scanout_option = mgm::ScanoutOption::gbm_surface;
+    if (software_rendering_requested(*options))
+        scanout_option = mgm::ScanoutOption::dumb_buffer;
+
     return mir::make_module_ptr<mgm::Platform>(
-        report, vt, *emergency_cleanup_registry, bypass_option);
+        report, vt, *emergency_cleanup_registry, bypass_option, scanout_option);
 }
 
 mir::UniqueModulePtr<mir::graphics::RenderingPlatform> create_rendering_platform(
@@ -17,9 +17,12 @@
  */
 
 #include "real_kms_output.h"
+#include "fb_handle.h"
 #include "mir/graphics/display_configuration.h"
 #include "page_flipper.h"
+#include "atomic_request.h"
 #include "kms-utils/kms_connector.h"
+#include "mir/graphics/edid.h"
 #include "mir/fatal.h"
 #include "mir/log.h"
 #include <string.h> // strcmp
@@ -32,39 +35,44 @@ namespace mgm = mg::mesa;
 namespace mgk = mg::kms;
 namespace geom = mir::geometry;
 
-class mgm::FBHandle
+namespace
+{
+void bo_user_data_destroy(gbm_bo* /*bo*/, void *data)
+{
+    auto bufobj = static_cast<mgm::FBHandle*>(data);
+    delete bufobj;
+}
+
+bool connector_vrr_capable(int drm_fd, uint32_t connector_id)
 {
-public:
-    FBHandle(gbm_bo* bo, uint32_t drm_fb_id)
-        : bo{bo}, drm_fb_id{drm_fb_id}
+    try
     {
+        mgk::ObjectProperties const props{drm_fd, connector_id, DRM_MODE_OBJECT_CONNECTOR};
+        return props.has_property("vrr_capable") && props["vrr_capable"];
     }
-
-    ~FBHandle()
+    catch (std::exception const&)
     {
-        if (drm_fb_id)
-        {
-            int drm_fd = gbm_device_get_fd(gbm_bo_get_device(bo));
-            drmModeRmFB(drm_fd, drm_fb_id);
-        }
+        return false;
     }
+}
 
-    uint32_t get_drm_fb_id() const
+std::vector<mgm::KMSPlaneState> plane_states_for(std::vector<mgm::OverlayPlacement> const& overlays)
+{
+    std::vector<mgm::KMSPlaneState> states;
+    states.reserve(overlays.size());
+
+    for (auto const& overlay : overlays)
     {
-        return drm_fb_id;
+        states.push_back(
+            {overlay.plane_id,
+             overlay.fb->get_drm_fb_id(),
+             {{0, 0}, overlay.source},
+             overlay.destination,
+             overlay.fb->get_format(),
+             overlay.fb->get_pitch()});
     }
 
-private:
-    gbm_bo *bo;
-    uint32_t drm_fb_id;
-};
-
-namespace
-{
-void bo_user_data_destroy(gbm_bo* /*bo*/, void *data)
-{
-    auto bufobj = static_cast<mgm::FBHandle*>(data);
-    delete bufobj;
+    return states;
 }
 
 }
@@ -81,6 +89,9 @@ mgm::RealKMSOutput::RealKMSOutput(
       saved_crtc(),
       using_saved_crtc{true},
       has_cursor_{false},
+      vrr_capable{false},
+      vrr_wanted{false},
+      vrr_enabled{false},
       power_mode(mir_power_mode_on)
 {
     reset();
@@ -99,6 +110,7 @@ mgm::RealKMSOutput::RealKMSOutput(
 
 mgm::RealKMSOutput::~RealKMSOutput()
 {
+    planes.reset();
     restore_saved_crtc();
 }
 
@@ -136,6 +148,8 @@ void mgm::RealKMSOutput::reset()
         }
     }
 
+    vrr_capable = connector_vrr_capable(drm_fd_, connector->connector_id);
+
     /* Discard previously current crtc */
     current_crtc = nullptr;
 }
@@ -152,6 +166,16 @@ int mgm::RealKMSOutput::max_refresh_rate() const
     return current_mode.vrefresh;
 }
 
+void mgm::RealKMSOutput::set_adaptive_sync(bool enabled)
+{
+    vrr_wanted = enabled;
+}
+
+bool mgm::RealKMSOutput::adaptive_sync() const
+{
+    return vrr_enabled;
+}
+
 void mgm::RealKMSOutput::configure(geom::Displacement offset, size_t kms_mode_index)
 {
     fb_offset = offset;
@@ -167,6 +191,9 @@ bool mgm::RealKMSOutput::set_crtc(FBHandle const& fb)
         return false;
     }
 
+    if (planes)
+        planes->disable_overlays();
+
     auto ret = drmModeSetCrtc(drm_fd_, current_crtc->crtc_id,
                               fb.get_drm_fb_id(), fb_offset.dx.as_int(), fb_offset.dy.as_int(),
                               &connector->connector_id, 1,
@@ -177,7 +204,9 @@ bool mgm::RealKMSOutput::set_crtc(FBHandle const& fb)
         return false;
     }
 
+    /* Only atomic modesets manage VRR_ENABLED, so don't count on it here */
     using_saved_crtc = false;
+    vrr_enabled = false;
     return true;
 }
 
@@ -198,6 +227,8 @@ void mgm::RealKMSOutput::clear_crtc()
         return;
     }
 
+    planes.reset();
+
     auto result = drmModeSetCrtc(drm_fd_, current_crtc->crtc_id,
                                  0, 0, 0, nullptr, 0, nullptr);
     if (result)
@@ -207,6 +238,7 @@ void mgm::RealKMSOutput::clear_crtc()
     }
 
     current_crtc = nullptr;
+    vrr_enabled = false;
 }
 
 bool mgm::RealKMSOutput::schedule_page_flip(FBHandle const& fb)
@@ -240,6 +272,158 @@ void mgm::RealKMSOutput::wait_for_page_flip()
     last_frame_.store(page_flipper->wait_for_flip(current_crtc->crtc_id));
 }
 
+std::vector<mgm::KMSPlane> mgm::RealKMSOutput::overlay_planes()
+{
+    if (auto const crtc_planes = this->crtc_planes())
+        return crtc_planes->overlays();
+
+    return {};
+}
+
+bool mgm::RealKMSOutput::test_overlays(
+    FBHandle const& fb,
+    std::vector<OverlayPlacement> const& overlays)
+{
+    auto const crtc_planes = this->crtc_planes();
+    if (!crtc_planes)
+        return overlays.empty();
+
+    return crtc_planes->test(primary_plane_state(fb), plane_states_for(overlays));
+}
+
+bool mgm::RealKMSOutput::schedule_page_flip(
+    FBHandle const& fb,
+    std::vector<OverlayPlacement> const& overlays)
+{
+    std::unique_lock<std::mutex> lg(power_mutex);
+    if (power_mode != mir_power_mode_on)
+        return true;
+    if (!current_crtc)
+    {
+        mir::log_error("Output %s has no associated CRTC to schedule page flips on",
+                       mgk::connector_name(connector).c_str());
+        return false;
+    }
+
+    auto const crtc_planes = this->crtc_planes();
+
+    /* Nothing on the overlays now or before: the legacy flip will do */
+    if (overlays.empty() && !(crtc_planes && crtc_planes->overlays_enabled()))
+    {
+        return page_flipper->schedule_flip(
+            current_crtc->crtc_id,
+            fb.get_drm_fb_id(),
+            connector->connector_id);
+    }
+
+    if (!crtc_planes)
+        return false;
+
+    auto const primary = primary_plane_state(fb);
+    auto const states = plane_states_for(overlays);
+
+    if (page_flipper->schedule_flip(
+            {{current_crtc->crtc_id, connector->connector_id}},
+            [&](void* event_data)
+            {
+                return crtc_planes->commit(
+                    primary,
+                    states,
+                    DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK,
+                    event_data);
+            }))
+    {
+        return true;
+    }
+
+    /* Whatever the caller falls back to mustn't be hidden by stale overlays */
+    crtc_planes->disable_overlays();
+    return false;
+}
+
+bool mgm::RealKMSOutput::add_page_flip_to(
+    AtomicRequest& request,
+    FBHandle const& fb,
+    std::vector<OverlayPlacement> const& overlays)
+{
+    std::unique_lock<std::mutex> lg(power_mutex);
+    auto const crtc_planes = this->crtc_planes();
+    if (!crtc_planes || !crtc_planes->atomic())
+        return false;
+
+    /* As with schedule_page_flip(), there's nothing to flip while we're off */
+    if (power_mode != mir_power_mode_on)
+        return true;
+
+    if (!crtc_planes->add_frame(request, primary_plane_state(fb), plane_states_for(overlays)))
+        return false;
+
+    request.add_flip_target(*page_flipper, current_crtc->crtc_id, connector->connector_id);
+    return true;
+}
+
+bool mgm::RealKMSOutput::add_set_crtc_to(AtomicRequest& request, FBHandle const& fb)
+{
+    if (!ensure_crtc())
+        return false;
+
+    auto const crtc_planes = this->crtc_planes();
+    if (!crtc_planes)
+        return false;
+
+    auto const vrr = vrr_wanted && vrr_capable && crtc_planes->adaptive_sync();
+    if (!crtc_planes->add_modeset(request, connector->connector_id, connector->modes[mode_index], vrr) ||
+        !crtc_planes->add_frame(request, primary_plane_state(fb), {}))
+    {
+        return false;
+    }
+
+    request.on_commit([this, vrr] { using_saved_crtc = false; vrr_enabled = vrr; });
+    return true;
+}
+
+bool mgm::RealKMSOutput::add_clear_crtc_to(AtomicRequest& request)
+{
+    try
+    {
+        if (!ensure_crtc())
+            return true;
+    }
+    catch (...)
+    {
+        /* As in clear_crtc(), an output without a CRTC isn't showing anything */
+        return true;
+    }
+
+    auto const crtc_planes = this->crtc_planes();
+    return crtc_planes && crtc_planes->add_disable(request, connector->connector_id);
+}
+
+mgm::CrtcPlanes* mgm::RealKMSOutput::crtc_planes()
+{
+    if (!current_crtc)
+        return nullptr;
+
+    if (!planes || planes->crtc_id() != current_crtc->crtc_id)
+    {
+        planes.reset();
+        planes = std::make_unique<CrtcPlanes>(drm_fd_, current_crtc->crtc_id);
+    }
+
+    return planes.get();
+}
+
+mgm::KMSPlaneState mgm::RealKMSOutput::primary_plane_state(FBHandle const& fb) const
+{
+    return {
+        0,
+        fb.get_drm_fb_id(),
+        {geom::Point{} + fb_offset, size()},
+        {{0, 0}, size()},
+        fb.get_format(),
+        fb.get_pitch()};
+}
+
 mg::Frame mgm::RealKMSOutput::last_frame() const
 {
     return last_frame_.load();
@@ -586,6 +770,15 @@ void mgm::RealKMSOutput::update_from_hardware_state(
     output.subpixel_arrangement = kms_subpixel_to_mir_subpixel(connector->subpixel);
     output.gamma = gamma;
     output.edid = edid;
+
+    /* The kernel only says whether VRR works; the range is the monitor's */
+    unsigned min_hz{0}, max_hz{0};
+    output.vrr_capable =
+        connected && vrr_capable &&
+        edid.size() >= mg::Edid::minimum_size &&
+        reinterpret_cast<mg::Edid const*>(edid.data())->get_refresh_range(min_hz, max_hz);
+    output.min_vrr_hz = output.vrr_capable ? min_hz : 0.0;
+    output.max_vrr_hz = output.vrr_capable ? max_hz : 0.0;
 }
 
 mgm::FBHandle* mgm::RealKMSOutput::fb_for(gbm_bo* bo) const
@@ -626,7 +819,7 @@ mgm::FBHandle* mgm::RealKMSOutput::fb_for(gbm_bo* bo) const
         return nullptr;
 
     /* Create a FBHandle and associate it with the gbm_bo */
-    bufobj = new FBHandle{bo, fb_id};
+    bufobj = new FBHandle{drm_fd_, fb_id, format, strides[0]};
     gbm_bo_set_user_data(bo, bufobj, bo_user_data_destroy);
 
     return bufobj;
@@ -50,12 +50,24 @@ public:
     void configure(geometry::Displacement fb_offset, size_t kms_mode_index) override;
     geometry::Size size() const override;
     int max_refresh_rate() const override;
+    void set_adaptive_sync(bool enabled) override;
+    bool adaptive_sync() const override;
 
     bool set_crtc(FBHandle const& fb) override;
     void clear_crtc() override;
     bool schedule_page_flip(FBHandle const& fb) override;
     void wait_for_page_flip() override;
 
+    std::vector<KMSPlane> overlay_planes() override;
+    bool test_overlays(FBHandle const& fb, std::vector<OverlayPlacement> const& overlays) override;
+    bool schedule_page_flip(FBHandle const& fb, std::vector<OverlayPlacement> const& overlays) override;
+    bool add_page_flip_to(
+        AtomicRequest& request,
+        FBHandle const& fb,
+        std::vector<OverlayPlacement> const& overlays) override;
+    bool add_set_crtc_to(AtomicRequest& request, FBHandle const& fb) override;
+    bool add_clear_crtc_to(AtomicRequest& request) override;
+
     bool set_cursor(gbm_bo* buffer) override;
     void move_cursor(geometry::Point destination) override;
     bool clear_cursor() override;
@@ -76,6 +88,8 @@ public:
 private:
     bool ensure_crtc();
     void restore_saved_crtc();
+    CrtcPlanes* crtc_planes();
+    KMSPlaneState primary_plane_state(FBHandle const& fb) const;
 
     int const drm_fd_;
     std::shared_ptr<PageFlipper> const page_flipper;
@@ -84,9 +98,13 @@ private:
     size_t mode_index;
     geometry::Displacement fb_offset;
     kms::DRMModeCrtcUPtr current_crtc;
+    std::unique_ptr<CrtcPlanes> planes;
     drmModeCrtc saved_crtc;
     bool using_saved_crtc;
     bool has_cursor_;
+    bool vrr_capable;
+    bool vrr_wanted;
+    bool vrr_enabled;
 
     MirPowerMode power_mode;
     int dpms_enum_id;
@@ -32,6 +32,16 @@ enum class BypassOption
     prohibited
 };
 
+/**
+ * How frames reach the KMS outputs: drawn with GL into GBM surfaces, or
+ * drawn by the CPU straight into mapped dumb buffers.
+ */
+enum class ScanoutOption
+{
+    gbm_surface,
+    dumb_buffer
+};
+
 }
 }
 }
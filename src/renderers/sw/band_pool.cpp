@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "band_pool.h"
+#include "mir/thread_name.h"
+
+#include <algorithm>
+#include <string>
+
+namespace mrs = mir::renderer::software;
+
+mrs::BandPool::BandPool(unsigned int bands)
+    : band_count{std::max(bands, 1u)}
+{
+    for (auto band = 1u; band != band_count; ++band)
+        threads.emplace_back([this, band] { work(band); });
+}
+
+mrs::BandPool::~BandPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        stopping = true;
+    }
+    job_posted.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+unsigned int mrs::BandPool::bands() const
+{
+    return band_count;
+}
+
+void mrs::BandPool::run(std::function<void(unsigned int band)> const& job)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        this->job = &job;
+        pending = band_count - 1;
+        error = nullptr;
+        ++generation;
+    }
+    job_posted.notify_all();
+
+    std::exception_ptr own_error;
+    try
+    {
+        job(0);
+    }
+    catch (...)
+    {
+        own_error = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock{mutex};
+    job_done.wait(lock, [this] { return pending == 0; });
+    this->job = nullptr;
+
+    if (own_error)
+        std::rethrow_exception(own_error);
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void mrs::BandPool::work(unsigned int band)
+{
+    mir::set_thread_name("Mir/SWRender/" + std::to_string(band));
+
+    unsigned long done_generation = 0;
+    std::unique_lock<std::mutex> lock{mutex};
+
+    while (true)
+    {
+        job_posted.wait(lock, [&] { return stopping || generation != done_generation; });
+        if (stopping)
+            return;
+
+        done_generation = generation;
+        auto const& current_job = *job;
+
+        lock.unlock();
+        std::exception_ptr band_error;
+        try
+        {
+            current_job(band);
+        }
+        catch (...)
+        {
+            band_error = std::current_exception();
+        }
+        lock.lock();
+
+        if (band_error && !error)
+            error = band_error;
+        if (--pending == 0)
+            job_done.notify_one();
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_BAND_POOL_H_
+#define MIR_RENDERER_SW_BAND_POOL_H_
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/// Runs a job once per horizontal band of a frame, one band per thread
+class BandPool
+{
+public:
+    explicit BandPool(unsigned int bands);
+    ~BandPool();
+
+    unsigned int bands() const;
+
+    /**
+     * Calls job(band) for every band in [0, bands()), band 0 on the calling
+     * thread. Returns once all have finished, rethrowing the first exception.
+     */
+    void run(std::function<void(unsigned int band)> const& job);
+
+private:
+    BandPool(BandPool const&) = delete;
+    BandPool& operator=(BandPool const&) = delete;
+
+    void work(unsigned int band);
+
+    unsigned int const band_count;
+    std::mutex mutex;
+    std::condition_variable job_posted;
+    std::condition_variable job_done;
+    std::function<void(unsigned int)> const* job{nullptr};
+    unsigned long generation{0};
+    unsigned int pending{0};
+    bool stopping{false};
+    std::exception_ptr error;
+    std::vector<std::thread> threads;
+};
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_BAND_POOL_H_ */
@@ -0,0 +1,157 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "blend.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace mrs = mir::renderer::software;
+
+namespace
+{
+// x*a/255, correctly rounded, for x and a in [0, 255]
+inline uint32_t mul_255(uint32_t x, uint32_t a)
+{
+    auto const t = x*a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+inline uint32_t channel(uint32_t pixel, int c)
+{
+    return (pixel >> (8*c)) & 0xff;
+}
+
+#ifdef __SSE2__
+// The same rounding as mul_255() on eight 16-bit lanes
+inline __m128i mul_255(__m128i x, __m128i a)
+{
+    auto const t = _mm_add_epi16(_mm_mullo_epi16(x, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+inline __m128i scale(__m128i pixels, __m128i a)
+{
+    auto const zero = _mm_setzero_si128();
+    return _mm_packus_epi16(
+        mul_255(_mm_unpacklo_epi8(pixels, zero), a),
+        mul_255(_mm_unpackhi_epi8(pixels, zero), a));
+}
+
+// Spreads each pixel's alpha across its four 16-bit channel lanes
+inline __m128i spread_alpha(__m128i widened)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(widened, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+}
+
+size_t blend_row_sse2(uint32_t* dst, uint32_t const* src, size_t n, mrs::BlendMode mode, uint8_t alpha)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const all = _mm_set1_epi16(255);
+    auto const a = _mm_set1_epi16(alpha);
+    auto const one_minus_a = _mm_set1_epi16(255 - alpha);
+    auto const alpha_mask = _mm_set1_epi32(0xff000000);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        auto const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        __m128i result;
+
+        if (mode == mrs::BlendMode::over)
+        {
+            if (alpha != 255)
+                s = scale(s, a);
+
+            auto const s_lo = _mm_unpacklo_epi8(s, zero);
+            auto const s_hi = _mm_unpackhi_epi8(s, zero);
+            auto const d_lo = mul_255(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(all, spread_alpha(s_lo)));
+            auto const d_hi = mul_255(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(all, spread_alpha(s_hi)));
+            result = _mm_adds_epu8(s, _mm_packus_epi16(d_lo, d_hi));
+        }
+        else
+        {
+            auto const sum = _mm_adds_epu8(scale(s, a), scale(d, one_minus_a));
+            result = _mm_or_si128(_mm_andnot_si128(alpha_mask, sum), _mm_and_si128(alpha_mask, d));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+    }
+    return i;
+}
+#endif
+}
+
+void mrs::blend_row_generic(uint32_t* dst, uint32_t const* src, size_t n, BlendMode mode, uint8_t alpha)
+{
+    switch (mode)
+    {
+    case BlendMode::copy:
+        memcpy(dst, src, n*sizeof *dst);
+        break;
+
+    case BlendMode::over:
+        for (size_t i = 0; i != n; ++i)
+        {
+            auto const s = src[i];
+            auto const d = dst[i];
+            auto const s_alpha = mul_255(channel(s, 3), alpha);
+            uint32_t result = 0;
+            for (int c = 0; c != 4; ++c)
+            {
+                auto const value = mul_255(channel(s, c), alpha) + mul_255(channel(d, c), 255 - s_alpha);
+                result |= std::min(value, 255u) << (8*c);
+            }
+            dst[i] = result;
+        }
+        break;
+
+    case BlendMode::fade:
+        for (size_t i = 0; i != n; ++i)
+        {
+            auto const s = src[i];
+            auto const d = dst[i];
+            uint32_t result = d & 0xff000000;
+            for (int c = 0; c != 3; ++c)
+            {
+                auto const value = mul_255(channel(s, c), alpha) + mul_255(channel(d, c), 255 - alpha);
+                result |= std::min(value, 255u) << (8*c);
+            }
+            dst[i] = result;
+        }
+        break;
+    }
+}
+
+void mrs::blend_row(uint32_t* dst, uint32_t const* src, size_t n, BlendMode mode, uint8_t alpha)
+{
+    if (mode == BlendMode::copy)
+    {
+        memcpy(dst, src, n*sizeof *dst);
+        return;
+    }
+
+    size_t done = 0;
+#ifdef __SSE2__
+    done = blend_row_sse2(dst, src, n, mode, alpha);
+#endif
+    blend_row_generic(dst + done, src + done, n - done, mode, alpha);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_BLEND_H_
+#define MIR_RENDERER_SW_BLEND_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/// How a row of (premultiplied) source pixels is combined with the frame
+enum class BlendMode
+{
+    copy,   ///< Opaque source: dst = src
+    over,   ///< Source with alpha: dst = alpha*src + (1 - alpha*src.a)*dst
+    fade    ///< Opaque source, translucent window: dst.rgb = alpha*src + (1 - alpha)*dst
+};
+
+/**
+ * Combines n 32-bit pixels from src into dst. alpha is the window
+ * opacity, 255 being fully opaque. Uses SIMD where the target has it.
+ */
+void blend_row(uint32_t* dst, uint32_t const* src, size_t n, BlendMode mode, uint8_t alpha);
+
+/// Portable implementation of blend_row(), giving identical results
+void blend_row_generic(uint32_t* dst, uint32_t const* src, size_t n, BlendMode mode, uint8_t alpha);
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_BLEND_H_ */
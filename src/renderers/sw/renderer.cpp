@@ -0,0 +1,411 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "renderer.h"
+#include "blend.h"
+#include "sample.h"
+
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/pixel_format_utils.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+
+namespace
+{
+struct Layer
+{
+    std::shared_ptr<mg::Buffer> buffer;
+    mrs::PixelSource* source;
+    unsigned char const* pixels;
+    int width;
+    int height;
+    size_t stride;
+
+    glm::dmat3 to_source;       // frame pixel coordinates -> buffer pixel coordinates
+    bool translation_only;      // to_source moves whole pixels...
+    int dx;                     // ...by this much
+    int dy;
+
+    int left, top, right, bottom;   // part of the frame covered, [left, right) x [top, bottom)
+
+    mrs::BlendMode mode;
+    uint8_t alpha;
+    bool swap_red_blue;
+};
+
+glm::dmat3 translation(double x, double y)
+{
+    glm::dmat3 result{1.0};
+    result[2] = glm::dvec3{x, y, 1.0};
+    return result;
+}
+
+glm::dmat3 scaling(double x, double y)
+{
+    glm::dmat3 result{1.0};
+    result[0][0] = x;
+    result[1][1] = y;
+    return result;
+}
+
+glm::dmat3 affine_part_of(glm::mat4 const& transform)
+{
+    glm::dmat3 result{1.0};
+    result[0] = glm::dvec3{transform[0][0], transform[0][1], 0.0};
+    result[1] = glm::dvec3{transform[1][0], transform[1][1], 0.0};
+    result[2] = glm::dvec3{transform[3][0], transform[3][1], 1.0};
+    return result;
+}
+
+// Larger buffers would overflow sample positions (as they would most GL texture limits)
+int const max_source_size = 32767;
+
+bool red_first(MirPixelFormat format)
+{
+    return format == mir_pixel_format_abgr_8888 || format == mir_pixel_format_xbgr_8888;
+}
+
+bool is_near(double value, double expected)
+{
+    return std::abs(value - expected) < 1e-6;
+}
+
+uint32_t* frame_row(mrs::WritableFrame const& frame, int y)
+{
+    return reinterpret_cast<uint32_t*>(frame.pixels + y * frame.stride.as_int());
+}
+
+uint32_t const* source_row(Layer const& layer, int y)
+{
+    return reinterpret_cast<uint32_t const*>(layer.pixels + y * layer.stride);
+}
+
+int64_t const fixed_one = 1 << 16;
+
+// Sample positions are in pixels with 16 fractional bits
+int64_t to_fixed(double value)
+{
+    return std::llround(value * fixed_one);
+}
+
+int64_t floor_div(int64_t a, int64_t b)   // b > 0
+{
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// Narrows [first, end) to the samples start + k*step (k = 0, 1, ...) that
+// land in [0, size) pixels. An affine mapping crosses the source along a
+// straight line, so they are contiguous.
+void clip_samples(int64_t start, int64_t step, int size, int64_t& first, int64_t& end)
+{
+    auto const last_position = size * fixed_one - 1;
+    int64_t lowest, highest;
+
+    if (step > 0)
+    {
+        lowest = -floor_div(start, step);
+        highest = floor_div(last_position - start, step);
+    }
+    else if (step < 0)
+    {
+        lowest = -floor_div(last_position - start, -step);
+        highest = floor_div(start, -step);
+    }
+    else if (0 <= start && start <= last_position)
+    {
+        return;
+    }
+    else
+    {
+        end = first;
+        return;
+    }
+
+    first = std::max(first, lowest);
+    end = std::max(first, std::min(end, highest + 1));
+}
+
+void composite(mrs::WritableFrame const& frame, std::vector<Layer> const& layers, int first_row, int end_row)
+{
+    auto const width = frame.size.width.as_int();
+    for (auto y = first_row; y != end_row; ++y)
+        memset(frame_row(frame, y), 0, width * sizeof(uint32_t));
+
+    std::vector<uint32_t> samples(width);
+
+    for (auto const& layer : layers)
+    {
+        if (!layer.pixels)
+            continue;
+
+        auto const top = std::max(first_row, layer.top);
+        auto const bottom = std::min(end_row, layer.bottom);
+
+        if (layer.translation_only && !layer.swap_red_blue)
+        {
+            auto const left = std::max(layer.left, -layer.dx);
+            auto const right = std::min(layer.right, layer.width - layer.dx);
+            for (auto y = top; y < bottom; ++y)
+            {
+                mrs::blend_row(
+                    frame_row(frame, y) + left, source_row(layer, y + layer.dy) + left + layer.dx,
+                    right - left, layer.mode, layer.alpha);
+            }
+            continue;
+        }
+
+        // Otherwise sample the buffer at each pixel centre that falls inside it
+        auto const& m = layer.to_source;
+        mrs::SamplePosition const step{
+            static_cast<int32_t>(to_fixed(m[0].x)),
+            static_cast<int32_t>(to_fixed(m[0].y))};
+
+        for (auto y = top; y < bottom; ++y)
+        {
+            auto const s = m * glm::dvec3{layer.left + 0.5, y + 0.5, 1.0};
+            auto const start_x = to_fixed(s.x);
+            auto const start_y = to_fixed(s.y);
+
+            int64_t first = 0;
+            int64_t end = layer.right - layer.left;
+            clip_samples(start_x, step.x, layer.width, first, end);
+            clip_samples(start_y, step.y, layer.height, first, end);
+
+            if (first == end)
+                continue;
+
+            auto const x = layer.left + first;
+            mrs::sample_row(
+                &samples[x], layer.pixels, layer.stride,
+                {static_cast<int32_t>(start_x + first * step.x), static_cast<int32_t>(start_y + first * step.y)},
+                step, end - first, layer.swap_red_blue);
+            mrs::blend_row(frame_row(frame, y) + x, &samples[x], end - first, layer.mode, layer.alpha);
+        }
+    }
+}
+
+// Pixel sources only promise their pixels are readable inside read(), so
+// nest the reads and do the work from within the innermost one.
+//
+// A source may not call back at all (e.g. a wl_shm buffer the client has
+// destroyed): leave that layer's pixels null and carry on with the rest, so
+// that the frame is still composited.
+void with_pixels_of(std::vector<Layer>& layers, size_t first, std::function<void()> const& work)
+{
+    if (first == layers.size())
+    {
+        work();
+        return;
+    }
+
+    bool called_back{false};
+    layers[first].source->read(
+        [&](unsigned char const* pixels)
+        {
+            called_back = true;
+            layers[first].pixels = pixels;
+            with_pixels_of(layers, first + 1, work);
+        });
+
+    if (!called_back)
+    {
+        layers[first].pixels = nullptr;
+        with_pixels_of(layers, first + 1, work);
+    }
+}
+}
+
+mrs::Renderer::Renderer(mg::DisplayBuffer& display_buffer, unsigned int bands)
+    : render_target{dynamic_cast<RenderTarget*>(display_buffer.native_display_buffer())},
+      viewport{display_buffer.view_area()},
+      display_transform{display_buffer.transformation()},
+      bands{bands}
+{
+    if (!render_target)
+        BOOST_THROW_EXCEPTION(std::logic_error("DisplayBuffer does not support software rendering"));
+}
+
+void mrs::Renderer::set_viewport(geometry::Rectangle const& rect)
+{
+    viewport = rect;
+}
+
+void mrs::Renderer::set_output_transform(glm::mat2 const& transform)
+{
+    display_transform = transform;
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    auto const frame = render_target->map_back_buffer();
+    if (MIR_BYTES_PER_PIXEL(frame.format) != 4)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Software rendering needs a 32-bit frame format"));
+
+    auto const frame_width = frame.size.width.as_int();
+    auto const frame_height = frame.size.height.as_int();
+    auto const view_width = viewport.size.width.as_int();
+    auto const view_height = viewport.size.height.as_int();
+
+    auto const transformed = display_transform * glm::vec2(view_width, view_height);
+    auto const transformed_width = std::abs(transformed.x);
+    auto const transformed_height = std::abs(transformed.y);
+
+    std::vector<Layer> layers;
+
+    if (transformed_width > 0.0f && transformed_height > 0.0f && frame_width > 0 && frame_height > 0)
+    {
+        // Letterbox the (transformed) viewport into the frame, as the GL
+        // renderer does, so that pixels stay square
+        auto used_width = frame_width;
+        auto used_height = frame_height;
+        if (transformed_width * frame_height >= frame_width * transformed_height)
+            used_height = frame_width * transformed_height / transformed_width;
+        else
+            used_width = frame_height * transformed_width / transformed_height;
+
+        auto const offset_x = (frame_width - used_width) / 2;
+        auto const offset_y = (frame_height - used_height) / 2;
+
+        // The display transform applies to GL's y-up coordinates; flip it
+        // into y-down frame coordinates
+        glm::dmat3 flipped_display_transform{1.0};
+        flipped_display_transform[0] = glm::dvec3{display_transform[0][0], -display_transform[0][1], 0.0};
+        flipped_display_transform[1] = glm::dvec3{-display_transform[1][0], display_transform[1][1], 0.0};
+
+        auto const screen_to_frame =
+            translation(offset_x, offset_y) *
+            scaling(used_width / 2.0, used_height / 2.0) *
+            translation(1.0, 1.0) *
+            flipped_display_transform *
+            translation(-1.0, -1.0) *
+            scaling(2.0 / view_width, 2.0 / view_height) *
+            translation(-viewport.top_left.x.as_int(), -viewport.top_left.y.as_int());
+
+        for (auto const& renderable : renderables)
+        {
+            auto const buffer = renderable->buffer();
+            auto const source = dynamic_cast<PixelSource*>(buffer->native_buffer_base());
+            auto const format = buffer->pixel_format();
+
+            // Like the GL renderer failing to load a texture, leave out what
+            // can't be drawn rather than fail the frame
+            if (!source || MIR_BYTES_PER_PIXEL(format) != 4)
+                continue;
+
+            auto const alpha = static_cast<uint8_t>(std::round(std::min(std::max(renderable->alpha(), 0.0f), 1.0f) * 255));
+            auto const position = renderable->screen_position();
+            auto const size = buffer->size();
+            if (alpha == 0 || size.width.as_int() <= 0 || size.height.as_int() <= 0 ||
+                size.width.as_int() > max_source_size || size.height.as_int() > max_source_size ||
+                position.size.width.as_int() <= 0 || position.size.height.as_int() <= 0)
+            {
+                continue;
+            }
+
+            auto const centre_x = position.top_left.x.as_int() + position.size.width.as_int() / 2.0;
+            auto const centre_y = position.top_left.y.as_int() + position.size.height.as_int() / 2.0;
+
+            auto const source_to_frame =
+                screen_to_frame *
+                translation(centre_x, centre_y) *
+                affine_part_of(renderable->transformation()) *
+                translation(-centre_x, -centre_y) *
+                translation(position.top_left.x.as_int(), position.top_left.y.as_int()) *
+                scaling(position.size.width.as_int() / double(size.width.as_int()),
+                        position.size.height.as_int() / double(size.height.as_int()));
+
+            if (std::abs(glm::determinant(source_to_frame)) < 1e-9)
+                continue;
+
+            Layer layer;
+            layer.buffer = buffer;
+            layer.source = source;
+            layer.pixels = nullptr;
+            layer.width = size.width.as_int();
+            layer.height = size.height.as_int();
+            layer.stride = source->stride().as_int();
+            layer.to_source = glm::inverse(source_to_frame);
+
+            auto const& m = layer.to_source;
+            layer.translation_only =
+                is_near(m[0][0], 1.0) && is_near(m[1][1], 1.0) &&
+                is_near(m[0][1], 0.0) && is_near(m[1][0], 0.0) &&
+                is_near(m[2][0], std::round(m[2][0])) && is_near(m[2][1], std::round(m[2][1]));
+            layer.dx = static_cast<int>(std::round(m[2][0]));
+            layer.dy = static_cast<int>(std::round(m[2][1]));
+
+            auto min_x = frame_width, min_y = frame_height, max_x = 0, max_y = 0;
+            for (auto const& corner : {glm::dvec3(0, 0, 1), glm::dvec3(layer.width, 0, 1),
+                                       glm::dvec3(0, layer.height, 1), glm::dvec3(layer.width, layer.height, 1)})
+            {
+                auto const p = source_to_frame * corner;
+                min_x = std::min(min_x, static_cast<int>(std::floor(p.x)));
+                min_y = std::min(min_y, static_cast<int>(std::floor(p.y)));
+                max_x = std::max(max_x, static_cast<int>(std::ceil(p.x)));
+                max_y = std::max(max_y, static_cast<int>(std::ceil(p.y)));
+            }
+            layer.left = std::max(min_x, offset_x);
+            layer.top = std::max(min_y, offset_y);
+            layer.right = std::min(max_x, offset_x + used_width);
+            layer.bottom = std::min(max_y, offset_y + used_height);
+            if (layer.left >= layer.right || layer.top >= layer.bottom)
+                continue;
+
+            // These renderable method names could be better (see LP: #1236224)
+            if (renderable->shaped() && mg::contains_alpha(format))
+                layer.mode = BlendMode::over;
+            else if (alpha == 255)
+                layer.mode = BlendMode::copy;
+            else
+                layer.mode = BlendMode::fade;
+            layer.alpha = alpha;
+            layer.swap_red_blue = red_first(format) != red_first(frame.format);
+
+            layers.push_back(std::move(layer));
+        }
+    }
+
+    auto const rows_per_band = (frame_height + bands.bands() - 1) / bands.bands();
+
+    with_pixels_of(layers, 0,
+        [&]
+        {
+            bands.run(
+                [&](unsigned int band)
+                {
+                    auto const first_row = std::min<int>(band * rows_per_band, frame_height);
+                    auto const end_row = std::min<int>(first_row + rows_per_band, frame_height);
+                    composite(frame, layers, first_row, end_row);
+                });
+        });
+
+    render_target->swap_buffers();
+}
+
+void mrs::Renderer::suspend()
+{
+}
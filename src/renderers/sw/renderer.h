@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDERER_H_
+#define MIR_RENDERER_SW_RENDERER_H_
+
+#include "band_pool.h"
+
+#include "mir/renderer/renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/geometry/rectangle.h"
+
+#include <glm/glm.hpp>
+
+namespace mir
+{
+namespace graphics { class DisplayBuffer; }
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * Composites renderables on the CPU straight into a frame mapped by the
+ * display buffer, for outputs without a (fast) GL implementation.
+ * Each horizontal band of the frame is composited on its own thread.
+ */
+class Renderer : public renderer::Renderer
+{
+public:
+    Renderer(graphics::DisplayBuffer& display_buffer, unsigned int bands);
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(glm::mat2 const& transform) override;
+    void render(graphics::RenderableList const& renderables) const override;
+    void suspend() override;
+
+private:
+    RenderTarget* const render_target;
+    geometry::Rectangle viewport;
+    glm::mat2 display_transform;
+    mutable BandPool bands;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_RENDERER_H_ */
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "sample.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace mrs = mir::renderer::software;
+
+namespace
+{
+inline uint32_t pixel_at(unsigned char const* src, size_t stride, int32_t x, int32_t y)
+{
+    return reinterpret_cast<uint32_t const*>(src + (y >> 16) * stride)[x >> 16];
+}
+
+inline uint32_t swap_red_blue(uint32_t pixel)
+{
+    return (pixel & 0xff00ff00) | ((pixel >> 16) & 0xff) | ((pixel & 0xff) << 16);
+}
+
+// Positions past the last sample may not fit, so step in unsigned (wrapping) arithmetic
+inline int32_t advance(int32_t position, int32_t step, size_t count)
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(position) + static_cast<uint32_t>(step) * count);
+}
+
+#ifdef __SSE2__
+inline __m128i swap_red_blue(__m128i pixels)
+{
+    auto const red_and_blue = _mm_set1_epi32(0x00ff00ff);
+    auto const moved = _mm_or_si128(_mm_srli_epi32(pixels, 16), _mm_slli_epi32(pixels, 16));
+    return _mm_or_si128(_mm_andnot_si128(red_and_blue, pixels), _mm_and_si128(red_and_blue, moved));
+}
+
+// SSE2 has no gather, so the pixels are fetched one at a time; the position
+// arithmetic, channel swap and stores are done four pixels at a time.
+size_t sample_row_sse2(
+    uint32_t* dst, unsigned char const* src, size_t stride,
+    mrs::SamplePosition start, mrs::SamplePosition step, size_t n, bool swap)
+{
+    auto x = _mm_set_epi32(advance(start.x, step.x, 3), advance(start.x, step.x, 2), advance(start.x, step.x, 1), start.x);
+    auto y = _mm_set_epi32(advance(start.y, step.y, 3), advance(start.y, step.y, 2), advance(start.y, step.y, 1), start.y);
+    auto const step_x = _mm_set1_epi32(advance(0, step.x, 4));
+    auto const step_y = _mm_set1_epi32(advance(0, step.y, 4));
+
+    alignas(16) int32_t columns[4];
+    alignas(16) int32_t rows[4];
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        _mm_store_si128(reinterpret_cast<__m128i*>(columns), _mm_srai_epi32(x, 16));
+        _mm_store_si128(reinterpret_cast<__m128i*>(rows), _mm_srai_epi32(y, 16));
+
+        auto const at = [&](int j) { return reinterpret_cast<uint32_t const*>(src + rows[j] * stride)[columns[j]]; };
+        auto pixels = _mm_set_epi32(at(3), at(2), at(1), at(0));
+
+        if (swap)
+            pixels = swap_red_blue(pixels);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), pixels);
+
+        x = _mm_add_epi32(x, step_x);
+        y = _mm_add_epi32(y, step_y);
+    }
+    return i;
+}
+#endif
+}
+
+void mrs::sample_row_generic(
+    uint32_t* dst, unsigned char const* src, size_t stride,
+    SamplePosition start, SamplePosition step, size_t n, bool swap)
+{
+    for (size_t i = 0; i != n; ++i)
+    {
+        auto const pixel = pixel_at(src, stride, advance(start.x, step.x, i), advance(start.y, step.y, i));
+        dst[i] = swap ? swap_red_blue(pixel) : pixel;
+    }
+}
+
+void mrs::sample_row(
+    uint32_t* dst, unsigned char const* src, size_t stride,
+    SamplePosition start, SamplePosition step, size_t n, bool swap)
+{
+    size_t done = 0;
+#ifdef __SSE2__
+    done = sample_row_sse2(dst, src, stride, start, step, n, swap);
+#endif
+    sample_row_generic(
+        dst + done, src, stride,
+        {advance(start.x, step.x, done), advance(start.y, step.y, done)}, step, n - done, swap);
+}
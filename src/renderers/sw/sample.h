@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_RENDERER_SW_SAMPLE_H_
+#define MIR_RENDERER_SW_SAMPLE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/// A position in a source buffer, in pixels with 16 fractional bits
+struct SamplePosition
+{
+    int32_t x;
+    int32_t y;
+};
+
+/**
+ * Nearest-neighbour samples n 32-bit pixels of src (whose rows are stride
+ * bytes apart) along a line, starting at start and moving by step for each
+ * pixel. Every sample must fall inside the source, so sources are limited
+ * to 32767 pixels each way. Swaps red and blue when asked to, for sources
+ * in the other byte order. Uses SIMD where the target has it.
+ */
+void sample_row(
+    uint32_t* dst, unsigned char const* src, size_t stride,
+    SamplePosition start, SamplePosition step, size_t n, bool swap_red_blue);
+
+/// Portable implementation of sample_row(), giving identical results
+void sample_row_generic(
+    uint32_t* dst, unsigned char const* src, size_t stride,
+    SamplePosition start, SamplePosition step, size_t n, bool swap_red_blue);
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_SAMPLE_H_ */
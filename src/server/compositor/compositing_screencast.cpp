@@ -28,14 +28,20 @@
 #include "mir/compositor/display_buffer_compositor_factory.h"
 #include "mir/graphics/transformation.h"
 #include "mir/compositor/display_buffer_compositor.h"
+#include "mir/compositor/scene.h"
 #include "mir/geometry/rectangles.h"
+#include "mir/scene/legacy_scene_change_notification.h"
 #include "mir/raii.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <atomic>
+#include <set>
+
 namespace mc = mir::compositor;
 namespace mf = mir::frontend;
 namespace mg = mir::graphics;
+namespace ms = mir::scene;
 namespace geom = mir::geometry;
 
 namespace
@@ -82,17 +88,26 @@ public:
       display_buffer_compositor{db_compositor_factory.create_compositor_for(*display_buffer)},
       virtual_output{make_virtual_output(display, capture_region)},
       queue_size(capture_size),
-      mirror_mode(mirror_mode)
+      mirror_mode(mirror_mode),
+      observer{std::make_shared<ms::LegacySceneChangeNotification>(
+          [this] { ++scene_changes; },
+          [this, capture_region](int, geom::Rectangle const& damage)
+          {
+              if (damage.overlaps(capture_region))
+                  ++scene_changes;
+          })}
     {
         for (auto buffer : buffers)
             free_queue.schedule(buffer);
 
         scene->register_compositor(this);
+        scene->add_observer(observer);
         if (virtual_output)
             virtual_output->enable();
     }
     ~ScreencastSessionContext()
     {
+        scene->remove_observer(observer);
         scene->unregister_compositor(this);
     }
 
@@ -102,6 +117,11 @@ public:
         if (queue_size != display_buffer->renderbuffer_size())
             display_buffer->set_renderbuffer_size(queue_size);
 
+        // Nothing in the region has changed: the last capture is still good
+        auto const changes = scene_changes.load();
+        if (last_captured_buffer && changes == last_captured_changes)
+            return last_captured_buffer;
+
         //FIXME:: the client needs a better way to express it is no longer
         //using the last captured buffer
         if (last_captured_buffer)
@@ -110,12 +130,20 @@ public:
         display_buffer_compositor->composite(scene->scene_elements_for(this));
 
         last_captured_buffer = ready_queue.next_buffer();
+        last_captured_changes = changes;
+        note_pending_frames();
         return last_captured_buffer;
     }
 
     void capture(std::shared_ptr<mg::Buffer> const& buffer)
     {
         std::lock_guard<decltype(mutex)> lk(mutex);
+
+        // The buffer already holds the current contents of the region
+        auto const changes = scene_changes.load();
+        if (changes == current_buffers_changes && current_buffers.count(buffer->id()))
+            return;
+
         if (buffer->size() != display_buffer->renderbuffer_size())
             display_buffer->set_renderbuffer_size(buffer->size());
        
@@ -143,9 +171,24 @@ public:
             throw std::runtime_error("unable to capture to buffer");
 
         display_buffer->set_transformation(mg::transformation(mirror_mode));
+
+        if (changes != current_buffers_changes)
+        {
+            current_buffers.clear();
+            current_buffers_changes = changes;
+        }
+        current_buffers.insert(buffer->id());
+        note_pending_frames();
     }
 
 private:
+    // Frames still queued for us will change the scene before the next capture
+    void note_pending_frames()
+    {
+        if (scene->frames_pending(this))
+            ++scene_changes;
+    }
+
     std::mutex mutex;
     std::shared_ptr<Scene> const scene;
     QueueingSchedule free_queue;
@@ -157,6 +200,13 @@ private:
     std::shared_ptr<mg::Buffer> last_captured_buffer;
     geom::Size queue_size;
     MirMirrorMode mirror_mode;
+
+    // Counts the changes to the scene that may be visible in the capture region
+    std::atomic<uint64_t> scene_changes{1};
+    std::shared_ptr<ms::Observer> const observer;
+    uint64_t last_captured_changes{0};
+    uint64_t current_buffers_changes{0};
+    std::set<mg::BufferID> current_buffers;
 };
 
 
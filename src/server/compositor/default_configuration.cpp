@@ -23,14 +23,19 @@
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
 #include "gl/renderer_factory.h"
+#include "sw/renderer_factory.h"
 #include "compositing_screencast.h"
 #include "mir/main_loop.h"
 
 #include "mir/frontend/screencast.h"
 #include "mir/options/configuration.h"
+#include "mir/abnormal_exit.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <algorithm>
+#include <thread>
+
 namespace mc = mir::compositor;
 namespace ms = mir::scene;
 namespace mf = mir::frontend;
@@ -79,15 +84,29 @@ mir::DefaultServerConfiguration::the_compositor()
                 the_shell(),
                 the_compositor_report(),
                 composite_delay,
-                !the_options()->is_set(options::host_socket_opt));
+                !the_options()->is_set(options::host_socket_opt),
+                the_thread_scheduler());
         });
 }
 
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
-        []()
+        [this]() -> std::shared_ptr<mir::renderer::RendererFactory>
         {
+            auto const renderer = the_options()->get<std::string>(options::renderer_opt);
+
+            if (renderer == "software")
+            {
+                return std::make_shared<mir::renderer::software::RendererFactory>(
+                    std::max(std::thread::hardware_concurrency(), 1u),
+                    std::make_shared<mir::renderer::gl::RendererFactory>());
+            }
+            else if (renderer != "gl")
+            {
+                BOOST_THROW_EXCEPTION(mir::AbnormalExit("Unknown renderer: " + renderer));
+            }
+
             return std::make_shared<mir::renderer::gl::RendererFactory>();
         });
 }
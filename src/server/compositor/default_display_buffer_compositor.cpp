@@ -23,6 +23,7 @@
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/overlay_planes.h"
 #include "mir/graphics/buffer.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/renderer/renderer.h"
@@ -54,7 +55,7 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     for (auto const& element : occlusions)
         element->occluded();
 
-    mg::RenderableList renderable_list;
+    /* The lists are members only so that their storage is reused each frame */
     renderable_list.reserve(scene_elements.size());
     for (auto const& element : scene_elements)
     {
@@ -66,13 +67,23 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
      * Note: Buffer lifetimes are ensured by the two objects holding
      *       references to them; scene_elements and renderable_list.
      *       So no buffer is going to be released back to the client till
-     *       both of those containers get destroyed (end of the function).
+     *       both of those containers get cleared (end of the function).
      *       Actually, there's a third reference held by the texture cache
      *       in GLRenderer, but that gets released earlier in render().
      */
     scene_elements.clear();  // Those in use are still in renderable_list
 
-    if (display_buffer.overlay(renderable_list))
+    /*
+     * Display buffers with overlay planes may take on part of the list,
+     * leaving us to render only the remainder underneath.
+     */
+    auto const overlay_planes =
+        dynamic_cast<mg::OverlayPlanes*>(display_buffer.native_display_buffer());
+    auto const overlaid = overlay_planes ?
+        overlay_planes->overlay(renderable_list, remainder) :
+        display_buffer.overlay(renderable_list);
+
+    if (overlaid)
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
@@ -81,7 +92,7 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     {
         renderer->set_output_transform(display_buffer.transformation());
         renderer->set_viewport(view_area);
-        renderer->render(renderable_list);
+        renderer->render(overlay_planes ? remainder : renderable_list);
 
         report->renderables_in_frame(this, renderable_list);
         report->rendered_frame(this);
@@ -98,7 +109,11 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
          *        acquisition calls when we composite the next frame.
          */
         renderable_list.clear();
+        remainder.clear();
     }
 
     report->finished_frame(this);
+
+    renderable_list.clear();
+    remainder.clear();
 }
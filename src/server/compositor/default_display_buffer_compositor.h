@@ -21,6 +21,7 @@
 
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/compositor_report.h"
+#include "mir/graphics/renderable.h"
 #include <memory>
 
 namespace mir
@@ -52,6 +53,9 @@ private:
     graphics::DisplayBuffer& display_buffer;
     std::shared_ptr<renderer::Renderer> const renderer;
     std::shared_ptr<CompositorReport> const report;
+
+    graphics::RenderableList renderable_list;
+    graphics::RenderableList remainder;
 };
 
 }
@@ -27,16 +27,22 @@ mc::DroppingSchedule::DroppingSchedule()
 {
 }
 
+mc::DroppingSchedule::~DroppingSchedule()
+{
+    delete the_only_buffer.load();
+}
+
 void mc::DroppingSchedule::schedule(std::shared_ptr<mg::Buffer> const& buffer)
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    the_only_buffer = buffer;
+    auto const scheduled = buffer ? new std::shared_ptr<mg::Buffer>{buffer} : nullptr;
+
+    // Releases the frame being dropped, if the compositor didn't take it
+    delete the_only_buffer.exchange(scheduled);
 }
 
 unsigned int mc::DroppingSchedule::num_scheduled()
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    if (the_only_buffer)
+    if (the_only_buffer.load())
         return 1;
     else
         return 0;
@@ -44,10 +50,8 @@ unsigned int mc::DroppingSchedule::num_scheduled()
 
 std::shared_ptr<mg::Buffer> mc::DroppingSchedule::next_buffer()
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    if (!the_only_buffer)
+    std::unique_ptr<std::shared_ptr<mg::Buffer>> const buffer{the_only_buffer.exchange(nullptr)};
+    if (!buffer)
         BOOST_THROW_EXCEPTION(std::logic_error("no buffer scheduled"));
-    auto buffer = the_only_buffer;
-    the_only_buffer = nullptr;
-    return buffer;
+    return std::move(*buffer);
 }
@@ -0,0 +1,187 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/compositor/frame_arena.h"
+
+#include <atomic>
+#include <algorithm>
+#include <new>
+#include <cstdint>
+
+namespace mc = mir::compositor;
+
+namespace
+{
+thread_local mc::FrameArena* current_arena{nullptr};
+}
+
+struct alignas(alignof(std::max_align_t)) mc::FrameArena::Block
+{
+    Block(size_t size) : references{1}, next{nullptr}, size{size}, used{0} {}
+
+    /* One for the arena, while it owns the block, and one per allocation */
+    std::atomic<size_t> references;
+    Block* next;
+    size_t const size;
+    size_t used;
+
+    unsigned char* data() { return reinterpret_cast<unsigned char*>(this + 1); }
+
+    void* try_allocate(size_t bytes, size_t alignment)
+    {
+        auto const start = reinterpret_cast<uintptr_t>(data());
+        auto const header = start + used;
+        auto const object = (header + sizeof(Block*) + alignment - 1) & ~(alignment - 1);
+
+        if (object + bytes > start + size)
+            return nullptr;
+
+        used = object + bytes - start;
+        *reinterpret_cast<Block**>(object - sizeof(Block*)) = this;
+        references.fetch_add(1, std::memory_order_relaxed);
+        return reinterpret_cast<void*>(object);
+    }
+
+    void release()
+    {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            this->~Block();
+            ::operator delete(this);
+        }
+    }
+};
+
+mc::FrameArena::FrameArena(size_t block_size)
+    : block_size{block_size},
+      blocks{nullptr},
+      spare{nullptr},
+      bytes{0},
+      heap_blocks{0}
+{
+}
+
+mc::FrameArena::~FrameArena()
+{
+    for (auto const list : {blocks, spare})
+    {
+        for (auto block = list; block;)
+        {
+            auto const next = block->next;
+            block->release();
+            block = next;
+        }
+    }
+}
+
+void* mc::FrameArena::allocate(size_t size, size_t alignment)
+{
+    alignment = std::max(alignment, alignof(Block*));
+
+    void* result = blocks ? blocks->try_allocate(size, alignment) : nullptr;
+
+    if (!result)
+    {
+        auto const needed = size + alignment + sizeof(Block*);
+
+        Block* block;
+        if (spare && spare->size >= needed)
+        {
+            block = spare;
+            spare = spare->next;
+        }
+        else
+        {
+            block = new_block(needed);
+        }
+
+        block->next = blocks;
+        blocks = block;
+        result = block->try_allocate(size, alignment);
+    }
+
+    bytes += size;
+    return result;
+}
+
+void mc::FrameArena::deallocate(void* pointer) noexcept
+{
+    auto const header = static_cast<unsigned char*>(pointer) - sizeof(Block*);
+    (*reinterpret_cast<Block**>(header))->release();
+}
+
+void mc::FrameArena::reset()
+{
+    for (auto block = blocks; block;)
+    {
+        auto const next = block->next;
+
+        if (block->references.load(std::memory_order_acquire) == 1)
+        {
+            /* Nothing from the block is still alive, and only we can add to it */
+            block->used = 0;
+            block->next = spare;
+            spare = block;
+        }
+        else
+        {
+            /* Left for whoever releases the last object in it to free */
+            block->release();
+        }
+
+        block = next;
+    }
+
+    blocks = nullptr;
+    bytes = 0;
+    heap_blocks = 0;
+}
+
+size_t mc::FrameArena::bytes_allocated() const
+{
+    return bytes;
+}
+
+size_t mc::FrameArena::heap_allocations() const
+{
+    return heap_blocks;
+}
+
+auto mc::FrameArena::new_block(size_t min_size) -> Block*
+{
+    auto const size = std::max(min_size, block_size);
+    auto const memory = ::operator new(sizeof(Block) + size);
+
+    ++heap_blocks;
+    return new (memory) Block{size};
+}
+
+mc::FrameArena* mc::FrameArena::current()
+{
+    return current_arena;
+}
+
+mc::FrameArena::Scope::Scope(FrameArena& arena)
+    : previous{current_arena}
+{
+    current_arena = &arena;
+}
+
+mc::FrameArena::Scope::~Scope()
+{
+    current_arena = previous;
+}
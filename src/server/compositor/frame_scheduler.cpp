@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "frame_scheduler.h"
+
+namespace mc = mir::compositor;
+namespace geom = mir::geometry;
+
+size_t mc::FrameScheduler::add_output(geom::Rectangle const& area)
+{
+    outputs.push_back({area, 0, false, Clock::time_point{}});
+    return outputs.size() - 1;
+}
+
+bool mc::FrameScheduler::schedule(int frames)
+{
+    bool added_work = false;
+
+    for (auto& output : outputs)
+    {
+        if (frames > output.frames_scheduled)
+        {
+            output.frames_scheduled = frames;
+            added_work = true;
+        }
+    }
+
+    return added_work;
+}
+
+bool mc::FrameScheduler::schedule(int frames, geom::Rectangle const& damage)
+{
+    bool added_work = false;
+
+    for (auto& output : outputs)
+    {
+        auto const took_damage = !output.composited || damage.overlaps(output.area);
+
+        if (took_damage && frames > output.frames_scheduled)
+        {
+            output.frames_scheduled = frames;
+            added_work = true;
+        }
+    }
+
+    return added_work;
+}
+
+void mc::FrameScheduler::schedule_output(size_t output, int frames)
+{
+    auto& o = outputs.at(output);
+
+    if (frames > o.frames_scheduled)
+        o.frames_scheduled = frames;
+}
+
+bool mc::FrameScheduler::has_work() const
+{
+    for (auto const& output : outputs)
+    {
+        if (output.frames_scheduled > 0)
+            return true;
+    }
+
+    return false;
+}
+
+mc::FrameScheduler::Clock::time_point mc::FrameScheduler::next_due() const
+{
+    auto due = Clock::time_point::max();
+
+    for (auto const& output : outputs)
+    {
+        if (output.frames_scheduled > 0 && output.not_before < due)
+            due = output.not_before;
+    }
+
+    return due;
+}
+
+std::vector<size_t> mc::FrameScheduler::start_frame(Clock::time_point now)
+{
+    std::vector<size_t> due;
+
+    for (size_t i = 0; i != outputs.size(); ++i)
+    {
+        auto& output = outputs[i];
+
+        if (output.frames_scheduled > 0 && output.not_before <= now)
+        {
+            --output.frames_scheduled;
+            output.composited = true;
+            due.push_back(i);
+        }
+    }
+
+    return due;
+}
+
+void mc::FrameScheduler::posted(std::vector<size_t> const& posted, Clock::time_point now, Clock::duration delay)
+{
+    for (auto const i : posted)
+        outputs.at(i).not_before = now + delay;
+}
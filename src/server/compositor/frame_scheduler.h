@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_COMPOSITOR_FRAME_SCHEDULER_H_
+#define MIR_COMPOSITOR_FRAME_SCHEDULER_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <chrono>
+#include <vector>
+#include <cstddef>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Decides which outputs of a display sync group to composite, and when.
+ *
+ * Each output has its own count of frames to composite (from damage to its
+ * area, or frames queued by clients) and its own deadline: it is not
+ * composited again before the time the platform recommended after its last
+ * post(), which keeps sampling the scene as close as possible to the next
+ * vblank. Outputs without damage are left alone.
+ *
+ * FrameScheduler is not thread safe; callers serialize access.
+ */
+class FrameScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** \returns the index the output is known by in the other calls */
+    size_t add_output(geometry::Rectangle const& area);
+
+    /** Schedules frames on every output. \returns true if that adds work */
+    bool schedule(int frames);
+
+    /**
+     * Schedules frames on the outputs overlapping damage, and on any output
+     * not yet composited. \returns true if that adds work
+     */
+    bool schedule(int frames, geometry::Rectangle const& damage);
+
+    /** Makes sure the output composites at least frames more times */
+    void schedule_output(size_t output, int frames);
+
+    /** \returns whether any output has frames scheduled, due or not */
+    bool has_work() const;
+
+    /** \returns when the earliest output with frames scheduled is due */
+    Clock::time_point next_due() const;
+
+    /**
+     * Takes one frame from each output that is due at now.
+     * \returns the outputs to composite, in index order
+     */
+    std::vector<size_t> start_frame(Clock::time_point now);
+
+    /** Notes the outputs were posted at now, not to be composited again for delay */
+    void posted(std::vector<size_t> const& outputs, Clock::time_point now, Clock::duration delay);
+
+private:
+    struct Output
+    {
+        geometry::Rectangle area;
+        int frames_scheduled;
+        bool composited;
+        Clock::time_point not_before;
+    };
+
+    std::vector<Output> outputs;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_FRAME_SCHEDULER_H_ */
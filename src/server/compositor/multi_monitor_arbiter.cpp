@@ -30,8 +30,11 @@ namespace mf = mir::frontend;
 
 mc::MultiMonitorArbiter::MultiMonitorArbiter(
     std::shared_ptr<Schedule> const& schedule) :
-    schedule(schedule)
+    schedule(schedule.get()),
+    schedules{schedule}
 {
+    for (auto& slot : consumer_slots)
+        slot = nullptr;
 }
 
 mc::MultiMonitorArbiter::~MultiMonitorArbiter()
@@ -41,17 +44,19 @@ mc::MultiMonitorArbiter::~MultiMonitorArbiter()
 std::shared_ptr<mg::Buffer> mc::MultiMonitorArbiter::compositor_acquire(compositor::CompositorID id)
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
+    auto const sched = schedule.load();
 
-    if (!current_buffer && !schedule->num_scheduled())
+    if (!current_buffer && !sched->num_scheduled())
         BOOST_THROW_EXCEPTION(std::logic_error("no buffer to give to compositor"));
 
-    if (current_buffer_users.find(id) != current_buffer_users.end() || !current_buffer)
+    auto const bit = register_consumer(id, lk);
+    if ((current_buffer_users & bit) || !current_buffer)
     {
-        if (schedule->num_scheduled())
-            current_buffer = schedule->next_buffer();
-        current_buffer_users.clear();
+        if (sched->num_scheduled())
+            set_current_buffer(sched->next_buffer(), lk);
+        current_buffer_users = 0;
     }
-    current_buffer_users.insert(id);
+    current_buffer_users |= bit;
 
     return current_buffer;
 }
@@ -59,14 +64,15 @@ std::shared_ptr<mg::Buffer> mc::MultiMonitorArbiter::compositor_acquire(composit
 std::shared_ptr<mg::Buffer> mc::MultiMonitorArbiter::snapshot_acquire()
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
+    auto const sched = schedule.load();
 
-    if (!current_buffer && !schedule->num_scheduled())
+    if (!current_buffer && !sched->num_scheduled())
         BOOST_THROW_EXCEPTION(std::logic_error("no buffer to give to snapshotter"));
 
     if (!current_buffer)
     {
-        if (schedule->num_scheduled())
-            current_buffer = schedule->next_buffer();
+        if (sched->num_scheduled())
+            set_current_buffer(sched->next_buffer(), lk);
     }
 
     return current_buffer;
@@ -75,28 +81,76 @@ std::shared_ptr<mg::Buffer> mc::MultiMonitorArbiter::snapshot_acquire()
 void mc::MultiMonitorArbiter::set_schedule(std::shared_ptr<Schedule> const& new_schedule)
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
-    schedule = new_schedule;
+    if (std::find(schedules.begin(), schedules.end(), new_schedule) == schedules.end())
+        schedules.push_back(new_schedule);
+    schedule = new_schedule.get();
 }
 
 bool mc::MultiMonitorArbiter::buffer_ready_for(mc::CompositorID id)
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    return schedule->num_scheduled() ||
-       ((current_buffer_users.find(id) == current_buffer_users.end()) && current_buffer);
+    // Called for every stream by every compositor on every frame, so this
+    // deliberately avoids the lock. The answer is a hint: compositor_acquire()
+    // re-evaluates it under the lock.
+    if (schedule.load()->num_scheduled())
+        return true;
+    return has_current_buffer && !(current_buffer_users & consumer_bit_for(id));
 }
 
 bool mc::MultiMonitorArbiter::has_buffer()
 {
-    std::lock_guard<decltype(mutex)> lk(mutex);
-    return static_cast<bool>(current_buffer);
+    return has_current_buffer;
 }
 
 void mc::MultiMonitorArbiter::advance_schedule()
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
-    if (schedule->num_scheduled())
+    auto const sched = schedule.load();
+    if (sched->num_scheduled())
     {
-        current_buffer = schedule->next_buffer();
-        current_buffer_users.clear();
+        set_current_buffer(sched->next_buffer(), lk);
+        current_buffer_users = 0;
     } 
 }
+
+mc::MultiMonitorArbiter::ConsumerMask mc::MultiMonitorArbiter::consumer_bit_for(mc::CompositorID id) const
+{
+    for (auto i = 0u; i != consumer_slots.size(); ++i)
+    {
+        auto const slot_id = consumer_slots[i].load();
+        if (slot_id == id)
+            return ConsumerMask{1} << i;
+        if (!slot_id)
+            break;
+    }
+    // An unregistered compositor hasn't consumed anything yet
+    return 0;
+}
+
+mc::MultiMonitorArbiter::ConsumerMask mc::MultiMonitorArbiter::register_consumer(
+    mc::CompositorID id, std::lock_guard<std::mutex> const&)
+{
+    if (auto const bit = consumer_bit_for(id))
+        return bit;
+
+    auto free_slot = std::find(consumer_slots.begin(), consumer_slots.end(), nullptr);
+    if (free_slot == consumer_slots.end())
+    {
+        // Compositors that have gone away never unregister, so once we run out
+        // of slots start afresh. At worst every compositor sees the current
+        // buffer as unconsumed once more.
+        for (auto& slot : consumer_slots)
+            slot = nullptr;
+        current_buffer_users = 0;
+        free_slot = consumer_slots.begin();
+    }
+
+    *free_slot = id;
+    return ConsumerMask{1} << (free_slot - consumer_slots.begin());
+}
+
+void mc::MultiMonitorArbiter::set_current_buffer(
+    std::shared_ptr<mg::Buffer> const& buffer, std::lock_guard<std::mutex> const&)
+{
+    current_buffer = buffer;
+    has_current_buffer = static_cast<bool>(current_buffer);
+}
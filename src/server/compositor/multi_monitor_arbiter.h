@@ -21,10 +21,12 @@
 #include "mir/compositor/compositor_id.h"
 #include "mir/graphics/buffer_id.h"
 #include "buffer_acquisition.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
-#include <deque>
-#include <set>
+#include <vector>
 
 namespace mir
 {
@@ -49,10 +51,26 @@ public:
     void advance_schedule();
 
 private:
+    using ConsumerMask = std::uint64_t;
+    static size_t const max_consumers = 64;
+
+    ConsumerMask consumer_bit_for(compositor::CompositorID id) const;
+    ConsumerMask register_consumer(compositor::CompositorID id, std::lock_guard<std::mutex> const&);
+    void set_current_buffer(std::shared_ptr<graphics::Buffer> const& buffer, std::lock_guard<std::mutex> const&);
+
+    // Guards the handoff of current_buffer and changes to the consumer slots
     std::mutex mutable mutex;
     std::shared_ptr<graphics::Buffer> current_buffer;
-    std::set<compositor::CompositorID> current_buffer_users;
-    std::shared_ptr<Schedule> schedule;
+
+    // Read without the lock by buffer_ready_for() and has_buffer()
+    std::atomic<bool> has_current_buffer{false};
+    std::atomic<ConsumerMask> current_buffer_users{0};
+    std::array<std::atomic<compositor::CompositorID>, max_consumers> consumer_slots;
+    std::atomic<Schedule*> schedule;
+
+    // Schedules are kept alive for the lifetime of the arbiter so that a lock-free
+    // reader never dereferences one that has been replaced by set_schedule()
+    std::vector<std::shared_ptr<Schedule>> schedules;
 };
 
 }
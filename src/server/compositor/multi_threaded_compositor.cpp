@@ -17,6 +17,7 @@
  */
 
 #include "multi_threaded_compositor.h"
+#include "frame_scheduler.h"
 #include "mir/graphics/display.h"
 #include "mir/graphics/display_buffer.h"
 #include "mir/compositor/display_buffer_compositor.h"
@@ -24,6 +25,7 @@
 #include "mir/compositor/display_listener.h"
 #include "mir/compositor/scene.h"
 #include "mir/compositor/compositor_report.h"
+#include "mir/compositor/frame_arena.h"
 #include "mir/scene/legacy_scene_change_notification.h"
 #include "mir/scene/surface_observer.h"
 #include "mir/scene/surface.h"
@@ -31,10 +33,14 @@
 #include "mir/raii.h"
 #include "mir/unwind_helpers.h"
 #include "mir/thread_name.h"
+#include "mir/thread_scheduler.h"
+#include "mir/graphics/display_configuration.h"
+#include "mir/output_type_names.h"
 
 #include <thread>
 #include <chrono>
 #include <condition_variable>
+#include <map>
 #include <boost/throw_exception.hpp>
 
 using namespace std::literals::chrono_literals;
@@ -43,6 +49,39 @@ namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
 
+namespace
+{
+/*
+ * Names outputs as xrandr does ("HDMI-1", "DP-2", "eDP-1"...): numbered per
+ * type, and short enough that "Mir/Comp/<name>" usually fits the 15
+ * characters Linux allows for a thread name.
+ */
+auto output_names_by_area(mg::DisplayConfiguration const& config)
+-> std::vector<std::pair<mir::geometry::Rectangle, std::string>>
+{
+    std::map<mg::DisplayConfigurationOutputType, int> count_of_type;
+    std::vector<std::pair<mir::geometry::Rectangle, std::string>> names;
+
+    config.for_each_output([&](mg::DisplayConfigurationOutput const& output)
+        {
+            auto const index = ++count_of_type[output.type];
+
+            if (!output.used || !output.connected)
+                return;
+
+            std::string type{mir::output_type_name(static_cast<unsigned>(output.type))};
+            if (type == "DisplayPort")
+                type = "DP";
+            else if (type == "HDMI-A" || type == "HDMI-B")
+                type = "HDMI";
+
+            names.emplace_back(output.extents(), type + "-" + std::to_string(index));
+        });
+
+    return names;
+}
+}
+
 namespace mir
 {
 namespace compositor
@@ -54,26 +93,32 @@ public:
     CompositingFunctor(
         std::shared_ptr<mc::DisplayBufferCompositorFactory> const& db_compositor_factory,
         mg::DisplaySyncGroup& group,
+        std::string const& output_name,
         std::shared_ptr<mc::Scene> const& scene,
         std::shared_ptr<DisplayListener> const& display_listener,
         std::chrono::milliseconds fixed_composite_delay,
-        std::shared_ptr<CompositorReport> const& report) :
+        std::shared_ptr<CompositorReport> const& report,
+        std::shared_ptr<ThreadScheduler> const& thread_scheduler) :
         compositor_factory{db_compositor_factory},
         group(group),
+        output_name{output_name},
         scene(scene),
         running{true},
-        frames_scheduled{0},
         force_sleep{fixed_composite_delay},
         display_listener{display_listener},
         report{report},
+        thread_scheduler{thread_scheduler},
         started_future{started.get_future()}
     {
+        group.for_each_display_buffer([this](mg::DisplayBuffer& buffer)
+            { scheduler.add_output(buffer.view_area()); });
     }
 
     void operator()() noexcept  // noexcept is important! (LP: #1237332)
     try
     {
-        mir::set_thread_name("Mir/Comp");
+        mir::set_thread_name(output_name.empty() ? "Mir/Comp" : "Mir/Comp/" + output_name);
+        thread_scheduler->compositor_thread_started(output_name);
 
         std::vector<std::tuple<mg::DisplayBuffer*, std::unique_ptr<mc::DisplayBufferCompositor>>> compositors;
         group.for_each_display_buffer(
@@ -108,6 +153,10 @@ public:
                     scene->unregister_compositor(std::get<1>(compositor).get());
             });
 
+        /* Snapshots of the scene and the like come from here, not the heap */
+        FrameArena arena;
+        FrameArena::Scope const arena_scope{arena};
+
         started.set_value();
 
         try
@@ -116,62 +165,69 @@ public:
             while (running)
             {
                 /* Wait until compositing has been scheduled or we are stopped */
-                run_cv.wait(lock, [&]{ return (frames_scheduled > 0) || !running; });
+                run_cv.wait(lock, [&]{ return scheduler.has_work() || !running; });
 
                 /*
                  * Check if we are running before compositing, since we may have
                  * been stopped while waiting for the run_cv above.
                  */
-                if (running)
+                if (!running)
+                    break;
+
+                /*
+                 * "Predictive bypass" optimization: If the last frame was
+                 * bypassed/overlayed or you simply have a fast GPU, it is
+                 * beneficial to wait for most of the next frame. This reduces
+                 * the latency between snapshotting the scene and post()
+                 * completing by almost a whole frame. Unlike sleeping, the
+                 * wait still lets us be stopped, or other outputs become due.
+                 */
+                auto const due = scheduler.next_due();
+                if (due > FrameScheduler::Clock::now())
                 {
-                    /*
-                     * Each surface could have a number of frames ready in its buffer
-                     * queue. And we need to ensure that we render all of them so that
-                     * none linger in the queue indefinitely (seen as input lag).
-                     * frames_scheduled indicates the number of frames that are scheduled
-                     * to ensure all surfaces' queues are fully drained.
-                     */
-                    frames_scheduled--;
-                    not_posted_yet = false;
-                    lock.unlock();
-
-                    for (auto& tuple : compositors)
-                    {
-                        auto& compositor = std::get<1>(tuple);
-                        compositor->composite(scene->scene_elements_for(compositor.get()));
-                    }
-                    group.post();
-
-                    /*
-                     * "Predictive bypass" optimization: If the last frame was
-                     * bypassed/overlayed or you simply have a fast GPU, it is
-                     * beneficial to sleep for most of the next frame. This reduces
-                     * the latency between snapshotting the scene and post()
-                     * completing by almost a whole frame.
-                     */
-                    auto delay = force_sleep >= std::chrono::milliseconds::zero() ?
-                                 force_sleep : group.recommended_sleep();
-                    std::this_thread::sleep_for(delay);
-
-                    lock.lock();
-
-                    /*
-                     * Note the compositor may have chosen to ignore any number
-                     * of renderables and not consumed buffers from them. So it's
-                     * important to re-count number of frames pending, separately
-                     * to the initial scene_elements_for()...
-                     */
-                    int pending = 0;
-                    for (auto& compositor : compositors)
-                    {
-                        auto const comp_id = std::get<1>(compositor).get();
-                        int pend = scene->frames_pending(comp_id);
-                        if (pend > pending)
-                            pending = pend;
-                    }
-
-                    if (pending > frames_scheduled)
-                        frames_scheduled = pending;
+                    run_cv.wait_until(lock, due);
+                    continue;
+                }
+
+                /*
+                 * Each surface could have a number of frames ready in its buffer
+                 * queue. And we need to ensure that we render all of them so that
+                 * none linger in the queue indefinitely (seen as input lag).
+                 * The scheduler counts the frames each output needs to ensure
+                 * all surfaces' queues are fully drained, and leaves out the
+                 * outputs that need none.
+                 */
+                auto const outputs = scheduler.start_frame(FrameScheduler::Clock::now());
+                lock.unlock();
+
+                for (auto const output : outputs)
+                {
+                    auto& compositor = std::get<1>(compositors[output]);
+                    compositor->composite(scene->scene_elements_for(compositor.get()));
+                }
+                group.post();
+
+                report->allocations_in_frame(&group, arena.bytes_allocated(), arena.heap_allocations());
+                arena.reset();
+
+                auto const delay = force_sleep >= std::chrono::milliseconds::zero() ?
+                                   force_sleep : group.recommended_sleep();
+
+                lock.lock();
+                scheduler.posted(outputs, FrameScheduler::Clock::now(), delay);
+
+                /*
+                 * Note the compositor may have chosen to ignore any number
+                 * of renderables and not consumed buffers from them. So it's
+                 * important to re-count number of frames pending, separately
+                 * to the initial scene_elements_for()...
+                 */
+                for (size_t output = 0; output != compositors.size(); ++output)
+                {
+                    auto const comp_id = std::get<1>(compositors[output]).get();
+                    auto const pending = scene->frames_pending(comp_id);
+                    report->frames_pending(comp_id, pending);
+                    scheduler.schedule_output(output, pending);
                 }
             }
         }
@@ -193,26 +249,16 @@ public:
     {
         std::lock_guard<std::mutex> lock{run_mutex};
 
-        if (num_frames > frames_scheduled)
-        {
-            frames_scheduled = num_frames;
+        if (scheduler.schedule(num_frames))
             run_cv.notify_one();
-        }
     }
 
     void schedule_compositing(int num_frames, geometry::Rectangle const& damage)
     {
         std::lock_guard<std::mutex> lock{run_mutex};
-        bool took_damage = not_posted_yet;
 
-        group.for_each_display_buffer([&](mg::DisplayBuffer& buffer)
-            { if (damage.overlaps(buffer.view_area())) took_damage = true; });
-
-        if (took_damage && num_frames > frames_scheduled)
-        {
-            frames_scheduled = num_frames;
+        if (scheduler.schedule(num_frames, damage))
             run_cv.notify_one();
-        }
     }
 
     void stop()
@@ -233,17 +279,18 @@ public:
 private:
     std::shared_ptr<mc::DisplayBufferCompositorFactory> const compositor_factory;
     mg::DisplaySyncGroup& group;
+    std::string const output_name;
     std::shared_ptr<mc::Scene> const scene;
     bool running;
-    int frames_scheduled;
+    FrameScheduler scheduler;
     std::chrono::milliseconds force_sleep{-1};
     std::mutex run_mutex;
     std::condition_variable run_cv;
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<ThreadScheduler> const thread_scheduler;
     std::promise<void> started;
     std::future<void> started_future;
-    bool not_posted_yet = true;
 };
 
 }
@@ -256,12 +303,14 @@ mc::MultiThreadedCompositor::MultiThreadedCompositor(
     std::shared_ptr<DisplayListener> const& display_listener,
     std::shared_ptr<CompositorReport> const& compositor_report,
     std::chrono::milliseconds fixed_composite_delay,
-    bool compose_on_start)
+    bool compose_on_start,
+    std::shared_ptr<ThreadScheduler> const& thread_scheduler)
     : display{display},
       scene{scene},
       display_buffer_compositor_factory{db_compositor_factory},
       display_listener{display_listener},
       report{compositor_report},
+      thread_scheduler{thread_scheduler},
       state{CompositorState::stopped},
       fixed_composite_delay{fixed_composite_delay},
       compose_on_start{compose_on_start},
@@ -363,12 +412,24 @@ void mc::MultiThreadedCompositor::stop()
 
 void mc::MultiThreadedCompositor::create_compositing_threads()
 {
+    auto const output_names = output_names_by_area(*display->configuration());
+
     /* Start the display buffer compositing threads */
-    display->for_each_display_sync_group([this](mg::DisplaySyncGroup& group)
+    display->for_each_display_sync_group([this, &output_names](mg::DisplaySyncGroup& group)
     {
+        std::string output_name;
+        group.for_each_display_buffer([&](mg::DisplayBuffer& buffer)
+            {
+                for (auto const& name : output_names)
+                {
+                    if (output_name.empty() && name.first == buffer.view_area())
+                        output_name = name.second;
+                }
+            });
+
         auto thread_functor = std::make_unique<mc::CompositingFunctor>(
-            display_buffer_compositor_factory, group, scene, display_listener,
-            fixed_composite_delay, report);
+            display_buffer_compositor_factory, group, output_name, scene, display_listener,
+            fixed_composite_delay, report, thread_scheduler);
 
         futures.push_back(thread_pool.run(std::ref(*thread_functor), &group));
         thread_functors.push_back(std::move(thread_functor));
@@ -31,6 +31,7 @@
 
 namespace mir
 {
+class ThreadScheduler;
 namespace geometry { struct Rectangle; }
 namespace graphics
 {
@@ -68,7 +69,8 @@ public:
         std::shared_ptr<DisplayListener> const& display_listener,
         std::shared_ptr<CompositorReport> const& compositor_report,
         std::chrono::milliseconds fixed_composite_delay,  // -1 = automatic
-        bool compose_on_start);
+        bool compose_on_start,
+        std::shared_ptr<ThreadScheduler> const& thread_scheduler);
     ~MultiThreadedCompositor();
 
     void start();
@@ -83,6 +85,7 @@ private:
     std::shared_ptr<DisplayBufferCompositorFactory> const display_buffer_compositor_factory;
     std::shared_ptr<DisplayListener> const display_listener;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<ThreadScheduler> const thread_scheduler;
 
     std::vector<std::unique_ptr<CompositingFunctor>> thread_functors;
     std::vector<std::future<void>> futures;
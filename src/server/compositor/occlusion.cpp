@@ -21,6 +21,7 @@
 #include "mir/graphics/renderable.h"
 #include "occlusion.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace mir::geometry;
@@ -68,22 +69,22 @@ SceneElementSequence mir::compositor::filter_occlusions_from(
     Rectangle const& area)
 {
     SceneElementSequence occluded;
-    std::vector<Rectangle> coverage;
 
-    auto it = elements.rbegin();
-    while (it != elements.rend())
+    // Each compositing thread keeps its own, so that steady state doesn't allocate
+    thread_local std::vector<Rectangle> coverage;
+    coverage.clear();
+
+    /* Topmost first, moving the occluded out and leaving a gap behind */
+    for (auto it = elements.rbegin(); it != elements.rend(); ++it)
     {
-        auto const renderable = (*it)->renderable();
-        if (renderable_is_occluded(*renderable, area, coverage))
-        {
-            occluded.insert(occluded.begin(), *it);
-            it = SceneElementSequence::reverse_iterator(elements.erase(std::prev(it.base())));
-        }
-        else
-        {
-            it++;
-        }
+        if (renderable_is_occluded(*(*it)->renderable(), area, coverage))
+            occluded.push_back(std::move(*it));
     }
 
+    elements.erase(
+        std::remove(elements.begin(), elements.end(), nullptr),
+        elements.end());
+    std::reverse(occluded.begin(), occluded.end());
+
     return occluded;
 }
@@ -20,6 +20,7 @@
 #define MIR_COMPOSITOR_QUEUEING_SCHEDULE_H_
 #include "schedule.h"
 #include <memory>
+#include <atomic>
 #include <deque>
 #include <mutex>
 
@@ -38,6 +39,7 @@ public:
 private:
     std::mutex mutable mutex;
     std::deque<std::shared_ptr<graphics::Buffer>> queue;
+    std::atomic<unsigned int> queue_size{0};
 };
 }
 }
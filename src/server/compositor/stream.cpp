@@ -37,7 +37,9 @@ enum class mc::Stream::ScheduleMode {
 mc::Stream::Stream(
     geom::Size size, MirPixelFormat pf) :
     schedule_mode(ScheduleMode::Queueing),
-    schedule(std::make_shared<mc::QueueingSchedule>()),
+    queueing_schedule(std::make_shared<mc::QueueingSchedule>()),
+    dropping_schedule(std::make_shared<mc::DroppingSchedule>()),
+    schedule(queueing_schedule),
     arbiter(std::make_shared<mc::MultiMonitorArbiter>(schedule)),
     size(size),
     pf(pf),
@@ -107,12 +109,12 @@ void mc::Stream::allow_framedropping(bool dropping)
     std::lock_guard<decltype(mutex)> lk(mutex); 
     if (dropping && schedule_mode == ScheduleMode::Queueing)
     {
-        transition_schedule(std::make_shared<mc::DroppingSchedule>(), lk);
+        transition_schedule(dropping_schedule, lk);
         schedule_mode = ScheduleMode::Dropping;
     }
     else if (!dropping && schedule_mode == ScheduleMode::Dropping)
     {
-        transition_schedule(std::make_shared<mc::QueueingSchedule>(), lk);
+        transition_schedule(queueing_schedule, lk);
         schedule_mode = ScheduleMode::Queueing;
     }
 }
@@ -123,7 +125,7 @@ bool mc::Stream::framedropping() const
 }
 
 void mc::Stream::transition_schedule(
-    std::shared_ptr<mc::Schedule>&& new_schedule, std::lock_guard<std::mutex> const&)
+    std::shared_ptr<mc::Schedule> const& new_schedule, std::lock_guard<std::mutex> const&)
 {
     std::vector<std::shared_ptr<mg::Buffer>> transferred_buffers;
     while(schedule->num_scheduled())
@@ -136,7 +138,6 @@ void mc::Stream::transition_schedule(
 
 int mc::Stream::buffers_ready_for_compositor(void const* id) const
 {
-    std::lock_guard<decltype(mutex)> lk(mutex); 
     if (arbiter->buffer_ready_for(id))
         return 1;
     return 0;
@@ -160,7 +161,6 @@ void mc::Stream::drop_old_buffers()
 
 bool mc::Stream::has_submitted_buffer() const
 {
-    std::lock_guard<decltype(mutex)> lk(mutex); 
     return first_frame_posted;
 }
 
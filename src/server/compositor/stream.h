@@ -26,6 +26,7 @@
 #include "mir/lockable_callback.h"
 #include "mir/geometry/size.h"
 #include "multi_monitor_arbiter.h"
+#include <atomic>
 #include <mutex>
 #include <memory>
 #include <set>
@@ -60,15 +61,19 @@ public:
 
 private:
     enum class ScheduleMode;
-    void transition_schedule(std::shared_ptr<Schedule>&& new_schedule, std::lock_guard<std::mutex> const&);
+    void transition_schedule(std::shared_ptr<Schedule> const& new_schedule, std::lock_guard<std::mutex> const&);
 
+    // Only taken on the client side (submission, resizing, schedule changes);
+    // the compositor side goes straight to the arbiter.
     std::mutex mutable mutex;
-    ScheduleMode schedule_mode;
+    std::atomic<ScheduleMode> schedule_mode;
+    std::shared_ptr<Schedule> const queueing_schedule;
+    std::shared_ptr<Schedule> const dropping_schedule;
     std::shared_ptr<Schedule> schedule;
     std::shared_ptr<MultiMonitorArbiter> const arbiter;
     geometry::Size size; 
     MirPixelFormat pf;
-    bool first_frame_posted;
+    std::atomic<bool> first_frame_posted;
 
     scene::SurfaceObservers observers;
 };
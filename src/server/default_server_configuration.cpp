@@ -41,6 +41,7 @@
 #include "mir/default_configuration.h"
 #include "mir/scene/null_prompt_session_listener.h"
 #include "default_emergency_cleanup.h"
+#include "thread/default_thread_scheduler.h"
 #include "mir/graphics/platform.h"
 #include "mir/scene/coordinate_translator.h"
 
@@ -96,6 +97,17 @@ mir::DefaultServerConfiguration::the_session_listener()
         });
 }
 
+std::shared_ptr<mir::ThreadScheduler>
+mir::DefaultServerConfiguration::the_thread_scheduler()
+{
+    return thread_scheduler(
+        [this]
+        {
+            return std::make_shared<mir::thread::DefaultThreadScheduler>(
+                mir::thread::DefaultThreadScheduler::settings_from(*the_options()));
+        });
+}
+
 std::shared_ptr<ms::PromptSessionListener>
 mir::DefaultServerConfiguration::the_prompt_session_listener()
 {
@@ -58,6 +58,7 @@ mir::DefaultServerConfiguration::the_connector()
             {
                 return std::make_shared<mf::BasicConnector>(
                     the_connection_creator(),
+                    the_options()->get<int>(options::frontend_threads_opt),
                     the_connector_report());
             }
             else
@@ -65,6 +66,7 @@ mir::DefaultServerConfiguration::the_connector()
                 auto const result = std::make_shared<mf::PublishedSocketConnector>(
                     the_socket_file(),
                     the_connection_creator(),
+                    the_options()->get<int>(options::frontend_threads_opt),
                     *the_emergency_cleanup(),
                     the_connector_report());
 
@@ -139,6 +141,7 @@ mir::DefaultServerConfiguration::the_prompt_connector()
                 return std::make_shared<mf::PublishedSocketConnector>(
                     the_socket_file() + "_trusted",
                     the_prompt_connection_creator(),
+                    1,
                     *the_emergency_cleanup(),
                     the_connector_report());
             }
@@ -146,6 +149,7 @@ mir::DefaultServerConfiguration::the_prompt_connector()
             {
                 return std::make_shared<mf::BasicConnector>(
                     the_prompt_connection_creator(),
+                    1,
                     the_connector_report());
             }
         });
@@ -236,7 +236,6 @@ mf::DefaultIpcFactory::DefaultIpcFactory(
     shell(shell),
     no_prompt_shell(std::make_shared<NoPromptShell>(shell)),
     sm_observer(sm_observer),
-    cache(std::make_shared<ResourceCache>()),
     platform_ipc_operations(platform_ipc_operations),
     display_changer(display_changer),
     buffer_allocator(buffer_allocator),
@@ -255,6 +254,7 @@ std::shared_ptr<mf::detail::DisplayServer> mf::DefaultIpcFactory::make_ipc_serve
     SessionCredentials const &creds,
     std::shared_ptr<EventSinkFactory> const& sink_factory,
     std::shared_ptr<mf::MessageSender> const& message_sender,
+    std::shared_ptr<ResourceCache> const& resource_cache,
     ConnectionContext const &connection_context)
 {
     bool input_configuration_is_authorized = session_authorizer->configure_input_is_allowed(creds);
@@ -295,17 +295,13 @@ std::shared_ptr<mf::detail::DisplayServer> mf::DefaultIpcFactory::make_ipc_serve
         sm_observer,
         sink_factory,
         message_sender,
+        resource_cache,
         effective_screencast,
         connection_context,
         cursor_images,
         input_config_changer);
 }
 
-std::shared_ptr<mf::ResourceCache> mf::DefaultIpcFactory::resource_cache()
-{
-    return cache;
-}
-
 std::shared_ptr<mf::detail::DisplayServer> mf::DefaultIpcFactory::make_mediator(
     std::shared_ptr<Shell> const& shell,
     std::shared_ptr<mg::PlatformIpcOperations> const& platform_ipc_operations,
@@ -314,6 +310,7 @@ std::shared_ptr<mf::detail::DisplayServer> mf::DefaultIpcFactory::make_mediator(
     std::shared_ptr<SessionMediatorObserver> const& sm_observer,
     std::shared_ptr<mf::EventSinkFactory> const& sink_factory,
     std::shared_ptr<mf::MessageSender> const& message_sender,
+    std::shared_ptr<ResourceCache> const& resource_cache,
     std::shared_ptr<Screencast> const& effective_screencast,
     ConnectionContext const& connection_context,
     std::shared_ptr<mi::CursorImages> const& cursor_images,
@@ -327,7 +324,7 @@ std::shared_ptr<mf::detail::DisplayServer> mf::DefaultIpcFactory::make_mediator(
         sm_observer,
         sink_factory,
         message_sender,
-        resource_cache(),
+        resource_cache,
         effective_screencast,
         connection_context,
         cursor_images,
@@ -79,10 +79,9 @@ public:
         SessionCredentials const &creds,
         std::shared_ptr<EventSinkFactory> const& sink_factory,
         std::shared_ptr<MessageSender> const& message_sender,
+        std::shared_ptr<ResourceCache> const& resource_cache,
         ConnectionContext const &connection_context) override;
 
-    virtual std::shared_ptr<ResourceCache> resource_cache() override;
-
     virtual std::shared_ptr<detail::DisplayServer> make_mediator(
         std::shared_ptr<Shell> const& shell,
         std::shared_ptr<graphics::PlatformIpcOperations> const& platform_ipc_operations,
@@ -91,6 +90,7 @@ public:
         std::shared_ptr<SessionMediatorObserver> const& sm_observer,
         std::shared_ptr<EventSinkFactory> const& sink_factory,
         std::shared_ptr<MessageSender> const& message_sender,
+        std::shared_ptr<ResourceCache> const& resource_cache,
         std::shared_ptr<Screencast> const& effective_screencast,
         ConnectionContext const& connection_context,
         std::shared_ptr<input::CursorImages> const& cursor_images,
@@ -100,7 +100,6 @@ private:
     std::shared_ptr<Shell> const shell;
     std::shared_ptr<Shell> const no_prompt_shell;
     std::shared_ptr<SessionMediatorObserver> const sm_observer;
-    std::shared_ptr<ResourceCache> const cache;
     std::shared_ptr<graphics::PlatformIpcOperations> const platform_ipc_operations;
     std::shared_ptr<DisplayChanger> const display_changer;
     std::shared_ptr<graphics::GraphicBufferAllocator> const buffer_allocator;
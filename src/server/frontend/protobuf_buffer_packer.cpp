@@ -92,6 +92,11 @@ void pack_protobuf_display_output(mp::DisplayOutput& protobuf_output,
     protobuf_output.set_logical_width(logical_size.width.as_int());
     protobuf_output.set_logical_height(logical_size.height.as_int());
     protobuf_output.set_custom_logical_size(display_output.custom_logical_size.is_set());
+
+    protobuf_output.set_vrr_capable(display_output.vrr_capable);
+    protobuf_output.set_vrr_enabled(display_output.vrr_enabled);
+    protobuf_output.set_min_vrr_hz(display_output.min_vrr_hz);
+    protobuf_output.set_max_vrr_hz(display_output.max_vrr_hz);
 }
 
 }
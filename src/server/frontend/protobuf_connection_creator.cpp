@@ -25,6 +25,7 @@
 #include "protobuf_responder.h"
 #include "socket_messenger.h"
 #include "socket_connection.h"
+#include "resource_cache.h"
 
 #include "protobuf_ipc_factory.h"
 #include "mir/frontend/session_authorizer.h"
@@ -86,10 +87,13 @@ void mf::ProtobufConnectionCreator::create_connection_for(
 
     if (session_authorizer->connection_is_allowed(creds))
     {
+        // Resources only need to outlive the responses to this client, so
+        // they are owned by the connection rather than shared by everyone.
+        auto const resource_cache = std::make_shared<ResourceCache>();
+
         auto const message_sender = std::make_shared<detail::ProtobufResponder>(
             messenger,
-            ipc_factory->resource_cache());
-
+            resource_cache);
 
         auto const msg_processor = create_processor(
             message_sender,
@@ -97,6 +101,7 @@ void mf::ProtobufConnectionCreator::create_connection_for(
                 creds,
                 std::make_shared<ProtobufEventFactory>(operations),
                 messenger,
+                resource_cache,
                 connection_context),
             report);
 
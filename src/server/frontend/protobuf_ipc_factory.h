@@ -45,10 +45,9 @@ public:
         SessionCredentials const &creds,
         std::shared_ptr<EventSinkFactory> const& sink_factory,
         std::shared_ptr<MessageSender> const& message_sender,
+        std::shared_ptr<ResourceCache> const& resource_cache,
         ConnectionContext const &connection_context) = 0;
 
-    virtual std::shared_ptr<ResourceCache> resource_cache() = 0;
-
 protected:
     ProtobufIpcFactory() {}
     virtual ~ProtobufIpcFactory() {}
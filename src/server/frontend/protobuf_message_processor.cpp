@@ -192,6 +192,7 @@ bool mfd::ProtobufMessageProcessor::dispatch(
     std::vector<mir::Fd> const& side_channel_fds)
 {
     report->received_invocation(display_server.get(), invocation.id(), invocation.method_name());
+    report->received_invocation_size(display_server.get(), invocation.id(), invocation.parameters().size());
 
     bool result = true;
 
@@ -30,6 +30,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 
@@ -124,9 +125,10 @@ std::shared_ptr<boost::asio::local::stream_protocol::socket> make_socket_self_co
 mf::PublishedSocketConnector::PublishedSocketConnector(
     const std::string& socket_file,
     std::shared_ptr<ConnectionCreator> const& connection_creator,
+    int threads,
     EmergencyCleanupRegistry& emergency_cleanup_registry,
     std::shared_ptr<ConnectorReport> const& report)
-:   BasicConnector(connection_creator, report),
+:   BasicConnector(connection_creator, threads, report),
     socket_file(remove_if_stale(socket_file)),
     acceptor(*io_service, socket_file)
 {
@@ -184,19 +186,21 @@ void mf::PublishedSocketConnector::on_new_connection(
 
 mf::BasicConnector::BasicConnector(
     std::shared_ptr<ConnectionCreator> const& connection_creator,
+    int threads,
     std::shared_ptr<ConnectorReport> const& report)
 :   io_service(std::make_shared<boost::asio::io_service>()),
     work(*io_service),
     report(report),
+    threads{std::max(threads, 1)},
     connection_creator{connection_creator}
 {
 }
 
 void mf::BasicConnector::start()
 {
-    auto run_io_service = [this]
+    auto run_io_service = [this](std::string const& name)
     {
-        mir::set_thread_name("Mir/IPC");
+        mir::set_thread_name(name);
         while (true)
         try
         {
@@ -211,7 +215,17 @@ void mf::BasicConnector::start()
         }
     };
 
-    io_service_thread = std::thread(run_io_service);
+    // The io_service hands each ready handler to whichever of these threads
+    // is idle, which balances the load of busy clients across the pool.
+    if (threads == 1)
+    {
+        io_service_threads.emplace_back(run_io_service, "Mir/IPC");
+    }
+    else
+    {
+        for (auto i = 0; i != threads; ++i)
+            io_service_threads.emplace_back(run_io_service, "Mir/IPC/" + std::to_string(i));
+    }
 }
 
 void mf::BasicConnector::stop()
@@ -219,9 +233,13 @@ void mf::BasicConnector::stop()
     /* Stop processing new requests */
     io_service->stop();
 
-    /* Wait for io processing thread to finish */
-    if (io_service_thread.joinable())
-        io_service_thread.join();
+    /* Wait for io processing threads to finish */
+    for (auto& thread : io_service_threads)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+    io_service_threads.clear();
 
     /* Prepare for a potential restart */
     io_service->reset();
@@ -26,6 +26,7 @@
 #include <thread>
 #include <string>
 #include <functional>
+#include <vector>
 
 namespace google
 {
@@ -45,11 +46,17 @@ class ConnectionCreator;
 class ConnectorReport;
 
 /// provides a client-side socket fd for each connection
+///
+/// Requests are handled by a pool of \a threads sharing one io_service, so a
+/// slow request only holds up the client that made it. Each connection's
+/// reads are serialized on its own strand (see SocketMessenger), so a client's
+/// requests are still handled, and answered, in order.
 class BasicConnector : public Connector
 {
 public:
     explicit BasicConnector(
         std::shared_ptr<ConnectionCreator> const& connection_creator,
+        int threads,
         std::shared_ptr<ConnectorReport> const& report);
     ~BasicConnector() noexcept;
     void start() override;
@@ -67,7 +74,8 @@ protected:
     std::shared_ptr<ConnectorReport> const report;
 
 private:
-    std::thread io_service_thread;
+    int const threads;
+    std::vector<std::thread> io_service_threads;
     std::shared_ptr<ConnectionCreator> const connection_creator;
 };
 
@@ -78,6 +86,7 @@ public:
     explicit PublishedSocketConnector(
         const std::string& socket_file,
         std::shared_ptr<ConnectionCreator> const& connection_creator,
+        int threads,
         EmergencyCleanupRegistry& emergency_cleanup_registry,
         std::shared_ptr<ConnectorReport> const& report);
     ~PublishedSocketConnector() noexcept;
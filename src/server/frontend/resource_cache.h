@@ -51,6 +51,9 @@ public:
 };
 
 // Used to save resources that must be retained until a call completes.
+// Each connection has its own, so anything not freed by a response is
+// released when the client disconnects. The lock is only contended when a
+// client's call completes on another thread while it is being answered.
 class ResourceCache : public MessageResourceCache
 {
 public:
@@ -184,6 +184,9 @@ void mf::SessionMediator::connect(
         module->set_file(graphics_module->file);
     }
 
+    if (auto const client_module = ipc_package->client_module)
+        platform->set_client_module(client_module);
+
     auto display_config = display_changer->base_configuration();
     auto protobuf_config = response->mutable_display_configuration();
     mfd::pack_protobuf_display_configuration(*protobuf_config, *display_config);
@@ -1403,6 +1406,9 @@ mf::SessionMediator::unpack_and_sanitize_display_configuration(
                                             src.logical_height()};
             }
         }
+
+        if (src.has_vrr_enabled())
+            dest.vrr_enabled = src.vrr_enabled();
     });
 
     return config;
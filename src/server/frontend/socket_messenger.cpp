@@ -36,7 +36,8 @@ namespace ba = boost::asio;
 
 mfd::SocketMessenger::SocketMessenger(std::shared_ptr<ba::local::stream_protocol::socket> const& socket)
     : socket(socket),
-      socket_fd{IntOwnedFd{socket->native_handle()}}
+      socket_fd{IntOwnedFd{socket->native_handle()}},
+      strand{socket->get_io_service()}
 {
     // Make the socket non-blocking to avoid hanging the server when a client
     // is unresponsive. Also increase the send buffer size to 64KiB to allow
@@ -101,7 +102,7 @@ void mfd::SocketMessenger::async_receive_msg(
          *socket,
          buffer,
          boost::asio::transfer_exactly(ba::buffer_size(buffer)),
-         handler);
+         strand.wrap(handler));
 }
 
 bs::error_code mfd::SocketMessenger::receive_msg(
@@ -51,6 +51,10 @@ private:
     std::shared_ptr<boost::asio::local::stream_protocol::socket> socket;
     mir::Fd socket_fd;
 
+    // Completions of this connection's reads never run concurrently, even
+    // when the io_service is run by a pool of threads.
+    boost::asio::io_service::strand strand;
+
     std::mutex message_lock;
     SessionCredentials session_creds{0, 0, 0};
 };
@@ -64,7 +64,7 @@
 #include <iostream>
 #include <mir/log.h>
 #include <cstring>
-#include <deque>
+#include <atomic>
 #include MIR_SERVER_GL_H
 #include MIR_SERVER_GLEXT_H
 
@@ -2051,18 +2051,44 @@ void cleanup_display(wl_display *display)
     wl_display_destroy(display);
 }
 
+/**
+ * An Executor running work on the Wayland event loop.
+ *
+ * Work is pushed onto a lock-free stack, so producers (input dispatch, the
+ * compositor's frame callbacks, ...) never wait for each other or for the
+ * event loop. Only the spawn that finds the stack empty wakes the event loop;
+ * it then takes and runs the whole batch. wl_display_run() flushes clients
+ * once per dispatch, so a batch of events costs one wakeup and one flush
+ * per client however many events it holds.
+ */
 class WaylandExecutor : public mir::Executor
 {
 public:
+    ~WaylandExecutor()
+    {
+        // Work spawned after the event loop went away is never run
+        delete_batch(pending.exchange(nullptr));
+    }
+
     void spawn (std::function<void ()>&& work) override
     {
+        auto const item = new WorkItem{std::move(work), nullptr};
+
+        // Once published the item belongs to the event loop, so remember
+        // what it was pushed onto rather than reading item->next afterwards.
+        auto head = pending.load(std::memory_order_relaxed);
+        do
         {
-            std::lock_guard<std::recursive_mutex> lock{mutex};
-            workqueue.emplace_back(std::move(work));
+            item->next = head;
         }
-        if (auto err = eventfd_write(notify_fd, 1))
+        while (!pending.compare_exchange_weak(head, item, std::memory_order_release, std::memory_order_relaxed));
+
+        if (head)
+            return;     // The wakeup for the batch we joined is already pending
+
+        if (eventfd_write(notify_fd, 1))
         {
-            BOOST_THROW_EXCEPTION((std::system_error{err, std::system_category(), "eventfd_write failed to notify event loop"}));
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "eventfd_write failed to notify event loop"}));
         }
     }
 
@@ -2097,8 +2123,14 @@ public:
     }
 
 private:
+    struct WorkItem
+    {
+        std::function<void()> work;
+        WorkItem* next;
+    };
+
     WaylandExecutor(wl_event_loop* loop)
-        : notify_fd{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE | EFD_NONBLOCK)},
+        : notify_fd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)},
           notify_source{wl_event_loop_add_fd(loop, notify_fd, WL_EVENT_READABLE, &on_notify, this)}
     {
         if (notify_fd == mir::Fd::invalid)
@@ -2110,26 +2142,49 @@ private:
         }
     }
 
+    static void delete_batch(WorkItem* item)
+    {
+        while (item)
+        {
+            auto const next = item->next;
+            delete item;
+            item = next;
+        }
+    }
+
     static int on_notify(int fd, uint32_t, void* data)
     {
         auto executor = static_cast<WaylandExecutor*>(data);
 
+        // Consume the wakeup *before* taking the batch: a spawn onto the
+        // emptied stack then always leaves a fresh wakeup for the next batch.
         eventfd_t unused;
-        if (auto err = eventfd_read(fd, &unused))
+        if (eventfd_read(fd, &unused))
         {
             mir::log_error(
                 "eventfd_read failed to consume wakeup notification: %s (%i)",
-                strerror(err),
-                err);
+                strerror(errno),
+                errno);
         }
 
-        std::lock_guard<std::recursive_mutex> lock{executor->mutex};
-        while (!executor->workqueue.empty())
+        // The stack holds the newest item first; reverse it to run in spawn order
+        WorkItem* batch = nullptr;
+        for (auto item = executor->pending.exchange(nullptr, std::memory_order_acquire); item;)
         {
-            auto work = std::move(executor->workqueue.front());
+            auto const next = item->next;
+            item->next = batch;
+            batch = item;
+            item = next;
+        }
+
+        while (batch)
+        {
+            std::unique_ptr<WorkItem> const item{batch};
+            batch = item->next;
+
             try
             {
-                work();
+                item->work();
             }
             catch(...)
             {
@@ -2139,8 +2194,6 @@ private:
                     std::current_exception(),
                     "Exception processing Wayland event loop work item");
             }
-
-            executor->workqueue.pop_front();
         }
 
         return 0;
@@ -2151,16 +2204,12 @@ private:
         DestructionShim* shim;
         shim = wl_container_of(listener, shim, destruction_listener);
 
-        {
-            std::lock_guard<std::recursive_mutex> lock{shim->executor->mutex};
-            wl_event_source_remove(shim->executor->notify_source);
-        }
+        wl_event_source_remove(shim->executor->notify_source);
         delete shim;
     }
 
-    std::recursive_mutex mutex;
     mir::Fd const notify_fd;
-    std::deque<std::function<void()>> workqueue;
+    std::atomic<WorkItem*> pending{nullptr};
 
     wl_event_source* const notify_source;
 
@@ -27,6 +27,8 @@
 #include "mir/graphics/egl_error.h"
 #include "buffer.h"
 
+#include <algorithm>
+#include <iterator>
 #include <sstream>
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
@@ -68,7 +70,6 @@ mgn::detail::DisplayBuffer::DisplayBuffer(
     host_stream{create_host_stream(*host_connection, best_output)},
     host_surface{create_host_surface(*host_connection, host_stream, best_output)},
     host_connection{host_connection},
-    host_chain{nullptr},
     egl_config{egl_display.choose_windowed_config(best_output.current_format)},
     egl_context{egl_display, eglCreateContext(egl_display, egl_config, egl_display.egl_context(), nested_egl_context_attribs)},
     area{best_output.extents()},
@@ -104,9 +105,10 @@ void mgn::detail::DisplayBuffer::swap_buffers()
         spec->add_stream(*host_stream, geom::Displacement{0,0}, area.size);
         content = BackingContent::stream;
         host_surface->apply_spec(*spec);
-        //if the host_chain is not released, a buffer of the passthrough surface might get caught
+        //if the host chains are not released, a buffer of a passthrough surface might get caught
         //up in the host server, resulting a drop in nbuffers available to the client
-        host_chain = nullptr;
+        passthroughs.clear();
+        passthrough_layout.clear();
     }
 }
 
@@ -114,63 +116,143 @@ void mgn::detail::DisplayBuffer::bind()
 {
 }
 
+bool mgn::detail::DisplayBuffer::covers_area(Renderable const& renderable) const
+{
+    return (renderable.screen_position() == area) &&
+           (renderable.alpha() == 1.0f) &&
+           (!renderable.shaped()) &&
+           (renderable.transformation() == identity);
+}
+
 bool mgn::detail::DisplayBuffer::overlay(RenderableList const& list)
 {
-    if ((passthrough_option == mgn::PassthroughOption::disabled) ||
-        list.empty())
+    if (passthrough_option == mgn::PassthroughOption::disabled)
+        return false;
+
+    // Nothing below the topmost renderable that opaquely covers the output can
+    // be seen: that one is the bottom layer, and the ones above it are stacked
+    // on it as further host chains.
+    auto const bottom = std::find_if(list.rbegin(), list.rend(),
+        [this](std::shared_ptr<Renderable> const& renderable) { return covers_area(*renderable); });
+
+    if (bottom == list.rend())
     {
         //could not represent scene with subsurfaces
         return false;
     }
 
-    auto const topmost = list.back();
+    struct Layer
+    {
+        std::shared_ptr<graphics::Buffer> buffer;
+        std::shared_ptr<graphics::NativeBuffer> native_handle;
+        mgn::NativeBuffer* native;
+        geom::Rectangle position;
+        unsigned int swap_interval;
+    };
+    std::vector<Layer> layers;
 
-    if ((topmost->screen_position() != area) ||
-        (topmost->alpha() != 1.0f) ||
-        (topmost->shaped()) ||
-        (topmost->transformation() != identity))
+    for (auto renderable = std::prev(bottom.base()); renderable != list.end(); ++renderable)
     {
-        //could not represent scene with subsurfaces
-        return false;
+        auto const position = (*renderable)->screen_position();
+        if (!position.overlaps(area))
+            continue;
+
+        // The host can place and scale our chains, but can't rotate, blend
+        // or clip them
+        if (!area.contains(position) ||
+            ((*renderable)->alpha() != 1.0f) ||
+            ((*renderable)->transformation() != identity))
+        {
+            return false;
+        }
+
+        auto const buffer = (*renderable)->buffer();
+        auto const native_handle = buffer->native_buffer_handle();
+        auto const native = dynamic_cast<mgn::NativeBuffer*>(native_handle.get());
+        if (!native)
+            return false;
+
+        for (auto const& layer : layers)
+        {
+            if (layer.native->client_handle() == native->client_handle())
+                return false;   // A buffer can't be on two host chains
+        }
+
+        layers.push_back({buffer, native_handle, native, position, (*renderable)->swap_interval()});
     }
 
-    auto passthrough_buffer = topmost->buffer();
-    auto native = dynamic_cast<mgn::NativeBuffer*>(passthrough_buffer->native_buffer_handle().get());
-    if (!native)
+    std::vector<geom::Rectangle> layout;
+    for (auto const& layer : layers)
+        layout.push_back(layer.position);
+
+    // The host applies each chain's submissions and the surface spec that
+    // places the chains separately, so moving chains that are already shown
+    // could show a layer's new buffer in its old place. Composite frames where
+    // the layout changes instead: the next frame switches back to passthrough
+    // with its buffers submitted before the chains are shown.
+    if ((content == BackingContent::chain) && (layout != passthrough_layout))
         return false;
 
-    if (!host_chain)
-        host_chain = host_connection->create_chain();
+    while (passthroughs.size() < layers.size())
+        passthroughs.push_back({host_connection->create_chain(), SubmissionInfo{nullptr, nullptr}});
 
+    std::vector<bool> needs_submission(layers.size(), true);
     {
         std::unique_lock<std::mutex> lk(mutex);
-        SubmissionInfo submission_info{native->client_handle(), host_chain->handle()};
-        auto submitted = submitted_buffers.find(submission_info);
-        if ((submission_info != last_submitted) && (submitted != submitted_buffers.end()))
-            BOOST_THROW_EXCEPTION(std::logic_error("cannot resubmit buffer that has not been returned by host server"));
-        if ((submission_info == last_submitted) && (submitted != submitted_buffers.end()))
-            return true;
-
-        if (topmost->swap_interval() == 0)
-            host_chain->set_submission_mode(mgn::SubmissionMode::dropping);
-        else
-            host_chain->set_submission_mode(mgn::SubmissionMode::queueing);
-
-        submitted_buffers[submission_info] = passthrough_buffer;
-        last_submitted = submission_info;
+        for (auto i = 0u; i != layers.size(); ++i)
+        {
+            auto& passthrough = passthroughs[i];
+            SubmissionInfo submission_info{layers[i].native->client_handle(), passthrough.chain->handle()};
+            auto submitted = submitted_buffers.find(submission_info);
+            if ((submission_info != passthrough.last_submitted) && (submitted != submitted_buffers.end()))
+                BOOST_THROW_EXCEPTION(std::logic_error("cannot resubmit buffer that has not been returned by host server"));
+            if ((submission_info == passthrough.last_submitted) && (submitted != submitted_buffers.end()))
+                needs_submission[i] = false;
+        }
+
+        for (auto i = 0u; i != layers.size(); ++i)
+        {
+            if (!needs_submission[i])
+                continue;
+
+            auto& passthrough = passthroughs[i];
+            if (layers[i].swap_interval == 0)
+                passthrough.chain->set_submission_mode(mgn::SubmissionMode::dropping);
+            else
+                passthrough.chain->set_submission_mode(mgn::SubmissionMode::queueing);
+
+            SubmissionInfo submission_info{layers[i].native->client_handle(), passthrough.chain->handle()};
+            submitted_buffers[submission_info] = layers[i].buffer;
+            passthrough.last_submitted = submission_info;
+        }
     }
 
-    native->on_ownership_notification(
-        std::bind(&mgn::detail::DisplayBuffer::release_buffer, this,
-        native->client_handle(), host_chain->handle()));
-    host_chain->submit_buffer(*native);
+    for (auto i = 0u; i != layers.size(); ++i)
+    {
+        if (!needs_submission[i])
+            continue;
+
+        auto& chain = *passthroughs[i].chain;
+        auto& native = *layers[i].native;
+        native.on_ownership_notification(
+            std::bind(&mgn::detail::DisplayBuffer::release_buffer, this,
+            native.client_handle(), chain.handle()));
+        chain.submit_buffer(native);
+    }
 
     if (content != BackingContent::chain)
     {
         auto spec = host_connection->create_surface_spec();
-        spec->add_chain(*host_chain, geom::Displacement{0,0}, area.size);
+        for (auto i = 0u; i != layers.size(); ++i)
+        {
+            auto const& position = layers[i].position;
+            spec->add_chain(*passthroughs[i].chain, position.top_left - area.top_left, position.size);
+        }
         content = BackingContent::chain;
         host_surface->apply_spec(*spec);
+
+        passthrough_layout = std::move(layout);
+        passthroughs.resize(layers.size());
     }
     return true;
 }
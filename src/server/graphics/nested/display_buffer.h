@@ -27,6 +27,7 @@
 #include "host_chain.h"
 
 #include <map>
+#include <vector>
 #include <glm/glm.hpp>
 #include <EGL/egl.h>
 
@@ -73,7 +74,6 @@ private:
     std::shared_ptr<HostStream> const host_stream;
     std::shared_ptr<HostSurface> const host_surface;
     std::shared_ptr<HostConnection> const host_connection;
-    std::unique_ptr<HostChain> host_chain;
     EGLConfig const egl_config;
     EGLContextStore const egl_context;
     geometry::Rectangle const area;
@@ -90,11 +90,21 @@ private:
     } content;
     glm::mat4 const identity;
 
-    std::mutex mutex;
     typedef std::tuple<MirBuffer*, MirPresentationChain*> SubmissionInfo;
+
+    // One host chain per passed-through renderable, bottom to top
+    struct Passthrough
+    {
+        std::unique_ptr<HostChain> chain;
+        SubmissionInfo last_submitted;
+    };
+    std::vector<Passthrough> passthroughs;
+    std::vector<geometry::Rectangle> passthrough_layout;
+
+    std::mutex mutex;
     std::map<SubmissionInfo, std::shared_ptr<graphics::Buffer>> submitted_buffers;
-    SubmissionInfo last_submitted { nullptr, nullptr };
 
+    bool covers_area(Renderable const& renderable) const;
     void release_buffer(MirBuffer* b, MirPresentationChain* c);
 };
 }
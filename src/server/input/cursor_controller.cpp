@@ -16,6 +16,8 @@
  * Authored by: Robert Carr <robert.carr@canonical.com>
  */
 
+#define MIR_LOG_COMPONENT "cursor"
+
 #include "cursor_controller.h"
 
 #include "mir/input/scene.h"
@@ -25,7 +27,12 @@
 #include "mir/scene/observer.h"
 #include "mir/scene/null_surface_observer.h"
 #include "mir/scene/surface.h"
+#include "mir/time/alarm.h"
+#include "mir/time/alarm_factory.h"
+#include "mir/lockable_callback.h"
+#include "mir/log.h"
 
+#include <functional>
 #include <mutex>
 #include <map>
 
@@ -193,15 +200,70 @@ bool is_empty(std::shared_ptr<mg::CursorImage> const& image)
     auto const size = image->size();
     return size.width.as_int() == 0 || size.height.as_int() == 0;
 }
+
+// The alarm dispatch takes the lock before calling us, so the controller state
+// is guarded without the callback racing a cancel() made under the same mutex.
+// The frame is shown once the lock is released.
+class ShowNextFrame : public mir::LockableCallback
+{
+public:
+    ShowNextFrame(
+        std::mutex& guard,
+        std::function<void()> const& advance_frame_locked,
+        std::function<void()> const& show_frame)
+        : guard(guard),
+          advance_frame_locked(advance_frame_locked),
+          show_frame(show_frame)
+    {
+    }
+
+    void operator()() override
+    {
+        advance_frame_locked();
+    }
+    void lock() override
+    {
+        guard.lock();
+    }
+    void unlock() override
+    {
+        guard.unlock();
+
+        // We're unlocked by a lock_guard destructor: don't throw from it
+        try
+        {
+            show_frame();
+        }
+        catch (...)
+        {
+            mir::log(
+                mir::logging::Severity::error,
+                MIR_LOG_COMPONENT,
+                std::current_exception(),
+                "Failed to show cursor animation frame");
+        }
+    }
+
+private:
+    std::mutex& guard;
+    std::function<void()> const advance_frame_locked;
+    std::function<void()> const show_frame;
+};
 }
 
 mi::CursorController::CursorController(std::shared_ptr<mi::Scene> const& input_targets,
     std::shared_ptr<mg::Cursor> const& cursor,
-    std::shared_ptr<mg::CursorImage> const& default_cursor_image) :
+    std::shared_ptr<mg::CursorImage> const& default_cursor_image,
+    std::shared_ptr<mir::time::AlarmFactory> const& alarm_factory) :
         input_targets(input_targets),
         cursor(cursor),
         default_cursor_image(default_cursor_image),
-        current_cursor(default_cursor_image)
+        current_cursor(default_cursor_image),
+        next_frame_alarm(alarm_factory->create_alarm(
+            std::make_unique<ShowNextFrame>(
+                cursor_state_guard,
+                [this] { advance_frame_locked(); },
+                [this] { show_current_image(); })))
 {
     // TODO: Add observer could return weak_ptr to eliminate this
     // pattern
@@ -231,13 +293,67 @@ void mi::CursorController::set_cursor_image_locked(std::unique_lock<std::mutex>&
     }
 
     current_cursor = image;
+    current_frame = 0;
+    ++image_generation;
+    schedule_next_frame_locked();
 
     lock.unlock();
 
+    show_current_image();
+}
+
+void mi::CursorController::schedule_next_frame_locked()
+{
+    if (current_cursor && !is_empty(current_cursor) && current_cursor->frame_count() > 1)
+    {
+        auto const delay = current_cursor->delay(current_frame);
+
+        // A frame without a delay is where the animation stops
+        if (delay.count() > 0)
+        {
+            next_frame_alarm->reschedule_in(delay);
+            return;
+        }
+    }
+
+    next_frame_alarm->cancel();
+}
+
+void mi::CursorController::advance_frame_locked()
+{
+    if (!current_cursor || current_cursor->frame_count() <= 1)
+        return;
+
+    current_frame = (current_frame + 1) % current_cursor->frame_count();
+    ++image_generation;
+    schedule_next_frame_locked();
+}
+
+void mi::CursorController::show_current_image()
+{
+    std::lock_guard<std::mutex> show_lock{show_guard};
+
+    std::shared_ptr<mg::CursorImage> image;
+    unsigned int frame;
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock{cursor_state_guard};
+
+        // Someone else got here first with this (or a later) image
+        if (image_generation == shown_generation)
+            return;
+
+        image = current_cursor;
+        frame = current_frame;
+        generation = image_generation;
+    }
+
     if (image && !is_empty(image))
-        cursor->show(*image);
+        cursor->show(image->frame(frame));
     else
         cursor->hide();
+
+    shown_generation = generation;
 }
 
 void mi::CursorController::update_cursor_image_locked(std::unique_lock<std::mutex>& lock)
@@ -22,6 +22,7 @@
 #include "mir/input/cursor_listener.h"
 #include "mir/geometry/point.h"
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
 
@@ -36,6 +37,11 @@ namespace scene
 {
 class Observer;
 }
+namespace time
+{
+class Alarm;
+class AlarmFactory;
+}
 
 namespace input
 {
@@ -46,7 +52,8 @@ class CursorController : public CursorListener
 public:
     CursorController(std::shared_ptr<Scene> const& input_targets,
         std::shared_ptr<graphics::Cursor> const& cursor,
-        std::shared_ptr<graphics::CursorImage> const& default_cursor_image);
+        std::shared_ptr<graphics::CursorImage> const& default_cursor_image,
+        std::shared_ptr<time::AlarmFactory> const& alarm_factory);
     virtual ~CursorController();
 
     void cursor_moved_to(float abs_x, float abs_y);
@@ -63,12 +70,27 @@ private:
     std::mutex cursor_state_guard;
     geometry::Point cursor_location;
     std::shared_ptr<graphics::CursorImage> current_cursor;
+    unsigned int current_frame{0};
+    // Bumped whenever the image or frame to show changes
+    uint64_t image_generation{0};
+
+    // Taken before cursor_state_guard (never while holding it) so that the
+    // cursor is only updated outside the state lock, newest image last
+    std::mutex show_guard;
+    uint64_t shown_generation{0};
 
     std::weak_ptr<scene::Observer> observer;
-    
+
+    // Declared last so it is destroyed (and can't fire) before the state it uses
+    std::unique_ptr<time::Alarm> const next_frame_alarm;
 
     void update_cursor_image_locked(std::unique_lock<std::mutex>&);
     void set_cursor_image_locked(std::unique_lock<std::mutex>&, std::shared_ptr<graphics::CursorImage> const& image);
+    void schedule_next_frame_locked();
+    // Called by next_frame_alarm with cursor_state_guard held
+    void advance_frame_locked();
+    // Shows the current image and frame, unless a later call already has
+    void show_current_image();
 };
 
 }
@@ -134,7 +134,8 @@ mir::DefaultServerConfiguration::the_cursor_listener()
             return wrap_cursor_listener(std::make_shared<mi::CursorController>(
                     the_input_scene(),
                     the_cursor(),
-                    the_default_cursor_image()));
+                    the_default_cursor_image(),
+                    the_main_loop()));
         });
 
 }
@@ -208,7 +209,8 @@ mir::DefaultServerConfiguration::the_input_manager()
                 // TODO: move this into a nested graphics platform
                 auto platform = std::make_shared<mgn::InputPlatform>(the_host_connection(), device_registry, input_report);
 
-                return std::make_shared<mi::DefaultInputManager>(the_input_reading_multiplexer(), std::move(platform));
+                return std::make_shared<mi::DefaultInputManager>(
+                    the_input_reading_multiplexer(), std::move(platform), the_thread_scheduler());
             }
             else
             {
@@ -228,7 +230,8 @@ mir::DefaultServerConfiguration::the_input_manager()
                                                      input_report, *the_shared_library_prober_report());
                 }
 
-                return std::make_shared<mi::DefaultInputManager>(the_input_reading_multiplexer(), std::move(platform));
+                return std::make_shared<mi::DefaultInputManager>(
+                    the_input_reading_multiplexer(), std::move(platform), the_thread_scheduler());
             }
         }
     );
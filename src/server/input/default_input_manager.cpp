@@ -24,6 +24,7 @@
 #include "mir/dispatch/threaded_dispatcher.h"
 
 #include "mir/main_loop.h"
+#include "mir/thread_scheduler.h"
 #include "mir/thread_name.h"
 #include "mir/unwind_helpers.h"
 #include "mir/terminate_with_current_exception.h"
@@ -34,10 +35,12 @@ namespace mi = mir::input;
 
 mi::DefaultInputManager::DefaultInputManager(
     std::shared_ptr<dispatch::MultiplexingDispatchable> const& multiplexer,
-    std::shared_ptr<Platform> const& platform) :
+    std::shared_ptr<Platform> const& platform,
+    std::shared_ptr<ThreadScheduler> const& thread_scheduler) :
     platform{platform},
     multiplexer{multiplexer},
     queue{std::make_shared<mir::dispatch::ActionQueue>()},
+    thread_scheduler{thread_scheduler},
     state{State::stopped}
 {
 }
@@ -82,6 +85,7 @@ void mi::DefaultInputManager::start()
      */
     queue->enqueue([this,promise = std::move(started_promise)]()
                    {
+                        thread_scheduler->input_thread_started();
                         start_platforms();
                         promise->set_value();
                    });
@@ -26,6 +26,8 @@
 
 namespace mir
 {
+class ThreadScheduler;
+
 namespace dispatch
 {
 class MultiplexingDispatchable;
@@ -43,7 +45,8 @@ class DefaultInputManager : public InputManager
 public:
     DefaultInputManager(
         std::shared_ptr<dispatch::MultiplexingDispatchable> const& multiplexer,
-        std::shared_ptr<Platform> const& platform);
+        std::shared_ptr<Platform> const& platform,
+        std::shared_ptr<ThreadScheduler> const& thread_scheduler);
     ~DefaultInputManager();
 
     void start() override;
@@ -56,6 +59,7 @@ private:
     std::shared_ptr<Platform> const platform;
     std::shared_ptr<dispatch::MultiplexingDispatchable> const multiplexer;
     std::shared_ptr<dispatch::ActionQueue> const queue;
+    std::shared_ptr<ThreadScheduler> const thread_scheduler;
     std::unique_ptr<dispatch::ThreadedDispatcher> input_thread;
 
     enum class State
@@ -111,13 +111,25 @@ void deliver(
     MirEvent const* ev,
     std::vector<uint8_t> const& drag_and_drop_handle)
 {
+    auto const& bounds = surface->input_bounds();
+    geom::Displacement const displacement{bounds.top_left.x.as_int(), bounds.top_left.y.as_int()};
+
+    /*
+     * Surfaces at the origin (fullscreen ones, typically) see the event
+     * exactly as it is, so there's no need to copy it for them.
+     */
+    if (displacement == geom::Displacement{} && drag_and_drop_handle.empty())
+    {
+        surface->consume(ev);
+        return;
+    }
+
     auto to_deliver = mev::clone_event(*ev);
 
     if (!drag_and_drop_handle.empty())
         mev::set_drag_and_drop_handle(*to_deliver, drag_and_drop_handle);
 
-    auto const& bounds = surface->input_bounds();
-    mev::transform_positions(*to_deliver, geom::Displacement{bounds.top_left.x.as_int(), bounds.top_left.y.as_int()});
+    mev::transform_positions(*to_deliver, displacement);
     surface->consume(to_deliver.get());
 }
 
@@ -23,9 +23,13 @@
 #include "lttng_report_factory.h"
 #include "logging_report_factory.h"
 #include "null_report_factory.h"
+#include "metrics_report_factory.h"
+#include "metrics/registry.h"
 
 #include "mir/abnormal_exit.h"
 
+#include <cstdlib>
+
 namespace mg = mir::graphics;
 namespace mf = mir::frontend;
 namespace mc = mir::compositor;
@@ -44,6 +48,10 @@ std::unique_ptr<mir::report::ReportFactory> mir::DefaultServerConfiguration::rep
     {
         return std::make_unique<report::LttngReportFactory>();
     }
+    else if (opt == options::metrics_opt_value)
+    {
+        return std::make_unique<report::MetricsReportFactory>(the_metrics_registry(), the_clock());
+    }
     else if (opt == options::off_opt_value)
     {
         return std::make_unique<report::NullReportFactory>();
@@ -52,10 +60,33 @@ std::unique_ptr<mir::report::ReportFactory> mir::DefaultServerConfiguration::rep
     {
         throw AbnormalExit(std::string("Invalid ") + report_opt + " option: " + opt + " (valid options are: \"" +
             options::off_opt_value + "\" and \"" + options::log_opt_value +
-                           "\" and \"" + options::lttng_opt_value + "\")");
+                           "\" and \"" + options::lttng_opt_value +
+                           "\" and \"" + options::metrics_opt_value + "\")");
     }
 }
 
+auto mir::DefaultServerConfiguration::the_metrics_registry() -> std::shared_ptr<report::metrics::Registry>
+{
+    return metrics_registry(
+        [this]()
+        {
+            auto const options = the_options();
+
+            std::string path;
+            if (options->is_set(options::metrics_file_opt))
+                path = options->get<std::string>(options::metrics_file_opt);
+            else if (auto const runtime_dir = getenv("XDG_RUNTIME_DIR"))
+                path = std::string{runtime_dir} + "/mir_metrics";
+            else
+                throw AbnormalExit(std::string("Metrics reports need --") + options::metrics_file_opt +
+                                   " (or XDG_RUNTIME_DIR) to be set");
+
+            auto const registry = std::make_shared<report::metrics::Registry>();
+            registry->snapshot_periodically_to(path, std::chrono::seconds{1});
+            return registry;
+        });
+}
+
 std::shared_ptr<mir::report::Reports> mir::DefaultServerConfiguration::initialise_reports()
 {
     return std::make_unique<report::Reports>(*this, *the_options());
@@ -66,6 +66,10 @@ void mrl::CompositorReport::renderables_in_frame(SubCompositorId, mir::graphics:
 {
 }
 
+void mrl::CompositorReport::allocations_in_frame(SubCompositorId, size_t, size_t)
+{
+}
+
 void mrl::CompositorReport::rendered_frame(SubCompositorId id)
 {
     std::lock_guard<std::mutex> lock(mutex);
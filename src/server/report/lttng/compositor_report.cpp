@@ -62,3 +62,9 @@ void mir::report::lttng::CompositorReport::finished_frame(SubCompositorId id)
 {
     mir_tracepoint(mir_server_compositor, finished_frame, id);
 }
+
+void mir::report::lttng::CompositorReport::allocations_in_frame(
+    SubCompositorId id, size_t arena_bytes, size_t heap_allocations)
+{
+    mir_tracepoint(mir_server_compositor, allocations_in_frame, id, arena_bytes, heap_allocations);
+}
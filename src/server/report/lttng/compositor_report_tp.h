@@ -77,6 +77,17 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    allocations_in_frame,
+    TP_ARGS(void const*, id, size_t, arena_bytes, size_t, heap_allocations),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(size_t, arena_bytes, arena_bytes)
+        ctf_integer(size_t, heap_allocations, heap_allocations)
+    )
+)
+
 TRACEPOINT_EVENT(
     mir_server_compositor,
     buffers_in_frame,
@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compositor_report.h"
+#include "registry.h"
+
+#include "mir/graphics/renderable.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+std::uint64_t microseconds(mir::time::Duration duration)
+{
+    auto const us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    return us > 0 ? us : 0;
+}
+
+// Each display buffer is composited on one thread at a time, so its frame
+// state lives with that thread rather than behind a lock in the report.
+// Entries are tagged with the report and the run they were written in, so a
+// pooled thread doesn't take state from an earlier run as the last frame.
+struct FrameState
+{
+    std::uint64_t report;
+    std::uint64_t run;
+    void const* id;
+    mir::time::Timestamp start_of_frame;
+    mir::time::Timestamp end_of_frame;
+    bool bypassed;
+};
+
+// A compositor thread handles one display group: typically one or two display buffers
+thread_local std::vector<FrameState> this_thread_frames;
+
+std::atomic<std::uint64_t> next_instance{1};
+
+FrameState& frame_state_for(std::uint64_t report, std::uint64_t run, void const* id)
+{
+    auto& states = this_thread_frames;
+    states.erase(
+        std::remove_if(states.begin(), states.end(),
+            [&](FrameState const& state) { return state.report != report || state.run != run; }),
+        states.end());
+
+    for (auto& state : states)
+    {
+        if (state.id == id)
+            return state;
+    }
+
+    states.push_back(FrameState{report, run, id, {}, {}, true});
+    return states.back();
+}
+}
+
+mrm::CompositorReport::CompositorReport(
+    std::shared_ptr<Registry> const& registry,
+    std::shared_ptr<time::Clock> const& clock) :
+    instance{next_instance.fetch_add(1)},
+    registry{registry},
+    clock{clock},
+    frames{registry->counter("compositor.frames")},
+    bypassed_frames{registry->counter("compositor.bypassed_frames")},
+    frame_interval{registry->histogram("compositor.frame_interval_us")},
+    render_time{registry->histogram("compositor.render_time_us")},
+    scene_to_post{registry->histogram("compositor.scene_to_post_us")},
+    renderables{registry->histogram("compositor.renderables")},
+    arena_bytes{registry->histogram("compositor.frame_arena_bytes")},
+    heap_allocations{registry->counter("compositor.frame_heap_allocations")},
+    buffer_queue_depth{registry->histogram("compositor.buffer_queue_depth")},
+    last_scheduled{0},
+    run{0}
+{
+}
+
+void mrm::CompositorReport::added_display(int, int, int, int, SubCompositorId)
+{
+}
+
+void mrm::CompositorReport::began_frame(SubCompositorId id)
+{
+    auto& state = frame_state_for(instance, run.load(std::memory_order_relaxed), id);
+    state.start_of_frame = clock->now();
+    state.bypassed = true;
+}
+
+void mrm::CompositorReport::renderables_in_frame(SubCompositorId, graphics::RenderableList const& list)
+{
+    renderables.record(list.size());
+}
+
+void mrm::CompositorReport::rendered_frame(SubCompositorId id)
+{
+    auto& state = frame_state_for(instance, run.load(std::memory_order_relaxed), id);
+    state.bypassed = false;
+
+    render_time.record(microseconds(clock->now() - state.start_of_frame));
+}
+
+void mrm::CompositorReport::finished_frame(SubCompositorId id)
+{
+    auto const now = clock->now();
+
+    auto& state = frame_state_for(instance, run.load(std::memory_order_relaxed), id);
+    auto const end_of_last_frame = state.end_of_frame;
+    state.end_of_frame = now;
+
+    if (end_of_last_frame != time::Timestamp{})
+        frame_interval.record(microseconds(now - end_of_last_frame));
+
+    if (auto const scheduled = last_scheduled.load(std::memory_order_relaxed))
+        scene_to_post.record(microseconds(now - time::Timestamp{time::Duration{scheduled}}));
+
+    frames.increment();
+    if (state.bypassed)
+        bypassed_frames.increment();
+}
+
+void mrm::CompositorReport::allocations_in_frame(SubCompositorId, size_t bytes, size_t allocations)
+{
+    arena_bytes.record(bytes);
+    if (allocations)
+        heap_allocations.increment(allocations);
+}
+
+void mrm::CompositorReport::frames_pending(SubCompositorId, int pending)
+{
+    buffer_queue_depth.record(pending);
+}
+
+void mrm::CompositorReport::started()
+{
+}
+
+void mrm::CompositorReport::stopped()
+{
+    // Don't count the time the compositor was stopped as a frame interval
+    run.fetch_add(1, std::memory_order_relaxed);
+}
+
+void mrm::CompositorReport::scheduled()
+{
+    last_scheduled.store(clock->now().time_since_epoch().count(), std::memory_order_relaxed);
+}
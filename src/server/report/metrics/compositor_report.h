@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_
+#define MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_
+
+#include "mir/compositor/compositor_report.h"
+#include "mir/time/clock.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+class Registry;
+class Counter;
+class Histogram;
+
+class CompositorReport : public compositor::CompositorReport
+{
+public:
+    CompositorReport(std::shared_ptr<Registry> const& registry, std::shared_ptr<time::Clock> const& clock);
+
+    void added_display(int width, int height, int x, int y, SubCompositorId id) override;
+    void began_frame(SubCompositorId id) override;
+    void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
+    void rendered_frame(SubCompositorId id) override;
+    void finished_frame(SubCompositorId id) override;
+    void allocations_in_frame(SubCompositorId id, size_t arena_bytes, size_t heap_allocations) override;
+    void frames_pending(SubCompositorId id, int pending) override;
+    void started() override;
+    void stopped() override;
+    void scheduled() override;
+
+private:
+    std::uint64_t const instance;
+    std::shared_ptr<Registry> const registry;
+    std::shared_ptr<time::Clock> const clock;
+
+    Counter& frames;
+    Counter& bypassed_frames;
+    Histogram& frame_interval;
+    Histogram& render_time;
+    Histogram& scene_to_post;
+    Histogram& renderables;
+    Histogram& arena_bytes;
+    Counter& heap_allocations;
+    Histogram& buffer_queue_depth;
+
+    std::atomic<time::Timestamp::rep> last_scheduled;
+    /// Bumped by stopped() so compositor threads forget their frame state
+    std::atomic<std::uint64_t> run;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_COMPOSITOR_REPORT_H_ */
@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+unsigned int const sub_bucket_count = 1u << mrm::Histogram::sub_bucket_bits;
+std::uint64_t const max_trackable = (std::uint64_t{1} << mrm::Histogram::max_value_bits) - 1;
+
+unsigned int most_significant_bit(std::uint64_t value)
+{
+    return 63 - __builtin_clzll(value);
+}
+
+void update_min(std::atomic<std::uint64_t>& min, std::uint64_t value)
+{
+    auto current = min.load(std::memory_order_relaxed);
+    while (value < current && !min.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        ;
+}
+
+void update_max(std::atomic<std::uint64_t>& max, std::uint64_t value)
+{
+    auto current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        ;
+}
+}
+
+unsigned int mrm::this_thread_shard()
+{
+    static std::atomic<unsigned int> next_shard{0};
+    thread_local unsigned int const shard = next_shard.fetch_add(1, std::memory_order_relaxed) % shard_count;
+    return shard;
+}
+
+mrm::Counter::Counter()
+{
+}
+
+void mrm::Counter::increment(std::uint64_t by)
+{
+    shards[this_thread_shard()].value.fetch_add(by, std::memory_order_relaxed);
+}
+
+std::uint64_t mrm::Counter::value() const
+{
+    std::uint64_t total{0};
+    for (auto const& shard : shards)
+        total += shard.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+mrm::Histogram::Histogram()
+{
+    for (auto& shard : shards)
+    {
+        for (auto& bucket : shard.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+unsigned int mrm::Histogram::bucket_for(std::uint64_t value)
+{
+    value = std::min(value, max_trackable);
+
+    // Values below 2*sub_bucket_count map one-to-one onto buckets; above that
+    // each power of two is split into sub_bucket_count equal parts.
+    auto const shift = value < 2*sub_bucket_count ? 0 : most_significant_bit(value) - sub_bucket_bits;
+    return (shift << sub_bucket_bits) + (value >> shift);
+}
+
+std::uint64_t mrm::Histogram::bucket_lowest_value(unsigned int bucket)
+{
+    auto const shift = bucket < 2*sub_bucket_count ? 0 : (bucket >> sub_bucket_bits) - 1;
+    auto const top = bucket - (shift << sub_bucket_bits);
+    return std::uint64_t{top} << shift;
+}
+
+std::uint64_t mrm::Histogram::bucket_highest_value(unsigned int bucket)
+{
+    auto const shift = bucket < 2*sub_bucket_count ? 0 : (bucket >> sub_bucket_bits) - 1;
+    auto const top = bucket - (shift << sub_bucket_bits);
+    return ((std::uint64_t{top} + 1) << shift) - 1;
+}
+
+void mrm::Histogram::record(std::uint64_t value)
+{
+    auto& shard = shards[this_thread_shard()];
+
+    shard.buckets[bucket_for(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    update_min(shard.min, value);
+    update_max(shard.max, value);
+    shard.count.fetch_add(1, std::memory_order_release);
+}
+
+auto mrm::Histogram::snapshot() const -> Snapshot
+{
+    Snapshot result{0, 0, UINT64_MAX, 0, std::vector<std::uint64_t>(bucket_count, 0)};
+
+    for (auto const& shard : shards)
+    {
+        if (!shard.count.load(std::memory_order_acquire))
+            continue;
+
+        result.sum += shard.sum.load(std::memory_order_relaxed);
+        result.min = std::min(result.min, shard.min.load(std::memory_order_relaxed));
+        result.max = std::max(result.max, shard.max.load(std::memory_order_relaxed));
+
+        for (auto i = 0u; i != bucket_count; ++i)
+            result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    }
+
+    // Derive the count from the buckets so that percentiles are self-consistent
+    // even if a writer was part way through record()
+    for (auto const bucket : result.buckets)
+        result.count += bucket;
+
+    if (!result.count)
+        result.min = 0;
+
+    return result;
+}
+
+std::uint64_t mrm::Histogram::Snapshot::value_at_percentile(double percentile) const
+{
+    if (!count)
+        return 0;
+
+    auto const wanted = std::max<std::uint64_t>(1, std::ceil(count * std::min(percentile, 100.0) / 100.0));
+
+    std::uint64_t seen{0};
+    for (auto i = 0u; i != buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen >= wanted)
+            return std::min(bucket_highest_value(i), max);
+    }
+
+    return max;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_HISTOGRAM_H_
+#define MIR_REPORT_METRICS_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+/// Index of the shard the calling thread updates. Threads are spread across
+/// the shards round-robin so that concurrent writers rarely share a cache line.
+unsigned int this_thread_shard();
+
+unsigned int const shard_count = 4;
+
+/// A monotonic counter that can be bumped from any thread without locking.
+class Counter
+{
+public:
+    Counter();
+
+    void increment(std::uint64_t by = 1);
+    std::uint64_t value() const;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<std::uint64_t> value{0};
+    };
+    std::array<Shard, shard_count> shards;
+};
+
+/**
+ * A log-linear ("HDR-style") histogram of unsigned values.
+ *
+ * Each power-of-two range is split into 16 linear sub-buckets, so any recorded
+ * value is reported with a relative error of at most 1/16. Values at or above
+ * 2^36 are clamped into the last bucket.
+ *
+ * record() is wait-free; snapshot() may run concurrently with it and
+ * returns a consistent-enough view for reporting.
+ */
+class Histogram
+{
+public:
+    static unsigned int const sub_bucket_bits = 4;
+    static unsigned int const max_value_bits = 36;
+    static unsigned int const bucket_count = (max_value_bits - sub_bucket_bits + 1) << sub_bucket_bits;
+
+    Histogram();
+
+    void record(std::uint64_t value);
+
+    struct Snapshot
+    {
+        std::uint64_t count;
+        std::uint64_t sum;
+        std::uint64_t min;
+        std::uint64_t max;
+        std::vector<std::uint64_t> buckets;
+
+        /// The smallest value v such that at least \a percentile % of the recorded values are <= v
+        std::uint64_t value_at_percentile(double percentile) const;
+    };
+
+    Snapshot snapshot() const;
+
+    static unsigned int bucket_for(std::uint64_t value);
+    static std::uint64_t bucket_lowest_value(unsigned int bucket);
+    static std::uint64_t bucket_highest_value(unsigned int bucket);
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> sum{0};
+        std::atomic<std::uint64_t> min{UINT64_MAX};
+        std::atomic<std::uint64_t> max{0};
+        std::array<std::atomic<std::uint64_t>, bucket_count> buckets;
+    };
+    std::array<Shard, shard_count> shards;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_HISTOGRAM_H_ */
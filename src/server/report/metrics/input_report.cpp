@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_report.h"
+#include "registry.h"
+
+namespace mrm = mir::report::metrics;
+
+mrm::InputReport::InputReport(
+    std::shared_ptr<Registry> const& registry,
+    std::shared_ptr<time::Clock> const& clock) :
+    registry{registry},
+    clock{clock},
+    kernel_events{registry->counter("input.kernel_events")},
+    published_events{registry->counter("input.published_events")},
+    opened_devices{registry->counter("input.opened_devices")},
+    failed_devices{registry->counter("input.failed_devices")},
+    kernel_to_server{registry->histogram("input.kernel_to_server_us")},
+    event_to_publish{registry->histogram("input.event_to_publish_us")}
+{
+}
+
+void mrm::InputReport::record_latency(Histogram& histogram, int64_t event_time)
+{
+    // Event times are nanoseconds on the monotonic clock, as is the steady clock
+    auto const now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock->now().time_since_epoch()).count();
+
+    if (now > event_time)
+        histogram.record((now - event_time) / 1000);
+}
+
+void mrm::InputReport::received_event_from_kernel(int64_t when, int, int, int)
+{
+    kernel_events.increment();
+    record_latency(kernel_to_server, when);
+}
+
+void mrm::InputReport::published_key_event(int, uint32_t, int64_t event_time)
+{
+    published_events.increment();
+    record_latency(event_to_publish, event_time);
+}
+
+void mrm::InputReport::published_motion_event(int, uint32_t, int64_t event_time)
+{
+    published_events.increment();
+    record_latency(event_to_publish, event_time);
+}
+
+void mrm::InputReport::opened_input_device(char const*, char const*)
+{
+    opened_devices.increment();
+}
+
+void mrm::InputReport::failed_to_open_input_device(char const*, char const*)
+{
+    failed_devices.increment();
+}
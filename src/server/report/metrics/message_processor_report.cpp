@@ -0,0 +1,143 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "message_processor_report.h"
+#include "registry.h"
+
+#include <atomic>
+#include <cctype>
+#include <string>
+
+#include <pthread.h>
+
+namespace mrm = mir::report::metrics;
+
+namespace
+{
+// Invocations are dispatched synchronously on the IPC thread that received
+// them, so the one in flight on this thread is the one being completed.
+struct Invocation
+{
+    void const* mediator;
+    int id;
+    mir::time::Timestamp received;
+};
+
+thread_local Invocation current_invocation{nullptr, 0, {}};
+
+// Looking up the per-thread counters takes the registry lock, so each thread
+// remembers them. Reports are numbered so that a thread outliving one report
+// doesn't use the counters it cached for it with the next.
+struct CachedThreadMetrics
+{
+    std::uint64_t report;
+    mrm::Counter* busy_time;
+    mrm::Counter* invocations;
+};
+
+thread_local CachedThreadMetrics this_thread_metrics{0, nullptr, nullptr};
+
+std::atomic<std::uint64_t> next_instance{1};
+
+std::string metric_name_for_this_thread()
+{
+    char name[16] = "unnamed";
+    pthread_getname_np(pthread_self(), name, sizeof name);
+
+    // Thread names like "Mir/IPC/0" don't fit in the dot separated,
+    // space delimited snapshot format as they are.
+    std::string result{name};
+    for (auto& c : result)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)))
+            c = '_';
+    }
+    return result;
+}
+}
+
+mrm::MessageProcessorReport::MessageProcessorReport(
+    std::shared_ptr<Registry> const& registry,
+    std::shared_ptr<time::Clock> const& clock) :
+    instance{next_instance.fetch_add(1)},
+    registry{registry},
+    clock{clock},
+    invocations{registry->counter("ipc.invocations")},
+    failed_invocations{registry->counter("ipc.failed_invocations")},
+    unknown_methods{registry->counter("ipc.unknown_methods")},
+    exceptions{registry->counter("ipc.exceptions")},
+    invocation_time{registry->histogram("ipc.invocation_time_us")},
+    request_size{registry->histogram("ipc.request_bytes")}
+{
+}
+
+void mrm::MessageProcessorReport::received_invocation(void const* mediator, int id, std::string const&)
+{
+    current_invocation = Invocation{mediator, id, clock->now()};
+}
+
+void mrm::MessageProcessorReport::received_invocation_size(void const*, int, size_t bytes)
+{
+    request_size.record(bytes);
+}
+
+void mrm::MessageProcessorReport::completed_invocation(void const* mediator, int id, bool result)
+{
+    invocations.increment();
+    if (!result)
+        failed_invocations.increment();
+
+    if (current_invocation.mediator == mediator && current_invocation.id == id)
+    {
+        auto const elapsed = clock->now() - current_invocation.received;
+        auto const elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        invocation_time.record(elapsed_us);
+        current_invocation.mediator = nullptr;
+
+        auto const thread = metrics_for_this_thread();
+        thread.busy_time->increment(elapsed_us);
+        thread.invocations->increment();
+    }
+}
+
+mrm::MessageProcessorReport::ThreadMetrics mrm::MessageProcessorReport::metrics_for_this_thread()
+{
+    if (this_thread_metrics.report != instance)
+    {
+        auto const prefix = "ipc.thread." + metric_name_for_this_thread();
+        this_thread_metrics = CachedThreadMetrics{
+            instance,
+            &registry->counter(prefix + ".busy_us"),
+            &registry->counter(prefix + ".invocations")};
+    }
+
+    return {this_thread_metrics.busy_time, this_thread_metrics.invocations};
+}
+
+void mrm::MessageProcessorReport::unknown_method(void const*, int, std::string const&)
+{
+    unknown_methods.increment();
+}
+
+void mrm::MessageProcessorReport::exception_handled(void const*, int, std::exception const&)
+{
+    exceptions.increment();
+}
+
+void mrm::MessageProcessorReport::exception_handled(void const*, std::exception const&)
+{
+    exceptions.increment();
+}
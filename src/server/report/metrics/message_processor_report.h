@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_MESSAGE_PROCESSOR_REPORT_H_
+#define MIR_REPORT_METRICS_MESSAGE_PROCESSOR_REPORT_H_
+
+#include "mir/frontend/message_processor_report.h"
+#include "mir/time/clock.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+class Registry;
+class Counter;
+class Histogram;
+
+/**
+ * Besides the totals, each IPC thread gets "ipc.thread.<thread name>.busy_us"
+ * and "ipc.thread.<thread name>.invocations" counters: the growth of busy_us
+ * between two snapshots, divided by the time between them, is how busy that
+ * thread of the pool was.
+ */
+class MessageProcessorReport : public frontend::MessageProcessorReport
+{
+public:
+    MessageProcessorReport(std::shared_ptr<Registry> const& registry, std::shared_ptr<time::Clock> const& clock);
+
+    void received_invocation(void const* mediator, int id, std::string const& method) override;
+    void received_invocation_size(void const* mediator, int id, size_t bytes) override;
+    void completed_invocation(void const* mediator, int id, bool result) override;
+    void unknown_method(void const* mediator, int id, std::string const& method) override;
+    void exception_handled(void const* mediator, int id, std::exception const& error) override;
+    void exception_handled(void const* mediator, std::exception const& error) override;
+
+private:
+    struct ThreadMetrics
+    {
+        Counter* busy_time;
+        Counter* invocations;
+    };
+    ThreadMetrics metrics_for_this_thread();
+
+    std::uint64_t const instance;
+    std::shared_ptr<Registry> const registry;
+    std::shared_ptr<time::Clock> const clock;
+
+    Counter& invocations;
+    Counter& failed_invocations;
+    Counter& unknown_methods;
+    Counter& exceptions;
+    Histogram& invocation_time;
+    Histogram& request_size;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_MESSAGE_PROCESSOR_REPORT_H_ */
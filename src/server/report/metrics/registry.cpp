@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "registry.h"
+
+#include "mir/thread_name.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <cstdio>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+namespace mrm = mir::report::metrics;
+
+mrm::Registry::Registry()
+{
+}
+
+mrm::Registry::~Registry()
+{
+    {
+        std::lock_guard<std::mutex> lock{writer_mutex};
+        stopping = true;
+    }
+    writer_cv.notify_all();
+
+    if (writer.joinable())
+        writer.join();
+}
+
+mrm::Counter& mrm::Registry::counter(std::string const& name)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& counter = counters[name];
+    if (!counter)
+        counter = std::make_unique<Counter>();
+    return *counter;
+}
+
+mrm::Histogram& mrm::Registry::histogram(std::string const& name)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& histogram = histograms[name];
+    if (!histogram)
+        histogram = std::make_unique<Histogram>();
+    return *histogram;
+}
+
+void mrm::Registry::write_snapshot(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    out << "# mir-metrics 1\n";
+
+    for (auto const& counter : counters)
+        out << "counter " << counter.first << ' ' << counter.second->value() << '\n';
+
+    for (auto const& histogram : histograms)
+    {
+        auto const& name = histogram.first;
+        auto const snapshot = histogram.second->snapshot();
+
+        out << "histogram " << name
+            << " count=" << snapshot.count
+            << " sum=" << snapshot.sum
+            << " min=" << snapshot.min
+            << " max=" << snapshot.max
+            << " p50=" << snapshot.value_at_percentile(50)
+            << " p90=" << snapshot.value_at_percentile(90)
+            << " p99=" << snapshot.value_at_percentile(99)
+            << " p999=" << snapshot.value_at_percentile(99.9) << '\n';
+
+        for (auto i = 0u; i != snapshot.buckets.size(); ++i)
+        {
+            if (snapshot.buckets[i])
+            {
+                out << "bucket " << name << ' ' << Histogram::bucket_highest_value(i)
+                    << ' ' << snapshot.buckets[i] << '\n';
+            }
+        }
+    }
+}
+
+void mrm::Registry::write_snapshot_to(std::string const& path) const
+{
+    std::ostringstream out;
+    write_snapshot(out);
+    auto const snapshot = out.str();
+
+    // mkstemp() creates the file exclusively (never through a symlink) and
+    // rename() replaces the path itself, so a planted link can't redirect us.
+    std::string temporary = path + ".XXXXXX";
+    int const fd = mkstemp(&temporary[0]);
+    if (fd < 0)
+        return;
+
+    bool written = true;
+    for (size_t done = 0; written && done != snapshot.size(); )
+    {
+        auto const result = write(fd, snapshot.data() + done, snapshot.size() - done);
+        if (result < 0)
+            written = false;
+        else
+            done += result;
+    }
+    written = close(fd) == 0 && written;
+
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0)
+        unlink(temporary.c_str());
+}
+
+void mrm::Registry::snapshot_periodically_to(std::string const& path, std::chrono::milliseconds period)
+{
+    if (writer.joinable())
+        BOOST_THROW_EXCEPTION(std::logic_error("Metrics snapshots are already being written"));
+
+    writer = std::thread{
+        [this, path, period]
+        {
+            mir::set_thread_name("Mir/Metrics");
+
+            std::unique_lock<std::mutex> lock{writer_mutex};
+            while (!stopping)
+            {
+                writer_cv.wait_for(lock, period, [this] { return stopping; });
+
+                lock.unlock();
+                write_snapshot_to(path);
+                lock.lock();
+            }
+        }};
+}
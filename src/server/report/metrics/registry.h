@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_METRICS_REGISTRY_H_
+#define MIR_REPORT_METRICS_REGISTRY_H_
+
+#include "histogram.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mir
+{
+namespace report
+{
+namespace metrics
+{
+/**
+ * The set of named counters and histograms fed by the metrics reports.
+ *
+ * Looking up a metric by name takes a lock, so reports do that once and
+ * keep the reference: the metrics themselves are updated without locking
+ * and live as long as the registry.
+ *
+ * The snapshot format is line based and stable:
+ *
+ *     # mir-metrics 1
+ *     counter <name> <value>
+ *     histogram <name> count=<n> sum=<n> min=<n> max=<n> p50=<n> p90=<n> p99=<n> p999=<n>
+ *     bucket <name> <highest value in bucket> <count>
+ *
+ * There is one "bucket" line for each non-empty bucket of the preceding
+ * histogram. Names are dot separated and end with the unit ("_us", "_bytes")
+ * where there is one.
+ */
+class Registry
+{
+public:
+    Registry();
+    ~Registry();
+
+    Counter& counter(std::string const& name);
+    Histogram& histogram(std::string const& name);
+
+    void write_snapshot(std::ostream& out) const;
+
+    /// Atomically replace the file at \a path with a snapshot every \a period
+    void snapshot_periodically_to(std::string const& path, std::chrono::milliseconds period);
+
+private:
+    void write_snapshot_to(std::string const& path) const;
+
+    std::mutex mutable mutex;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+
+    std::mutex writer_mutex;
+    std::condition_variable writer_cv;
+    bool stopping{false};
+    std::thread writer;
+
+    Registry(Registry const&) = delete;
+    Registry& operator=(Registry const&) = delete;
+};
+}
+}
+}
+
+#endif /* MIR_REPORT_METRICS_REGISTRY_H_ */
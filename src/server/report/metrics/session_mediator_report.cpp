@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "session_mediator_report.h"
+#include "registry.h"
+
+namespace mrm = mir::report::metrics;
+
+mrm::SessionMediatorReport::SessionMediatorReport(std::shared_ptr<Registry> const& registry) :
+    registry{registry},
+    connect{registry->counter("session.connect")},
+    create_surface{registry->counter("session.create_surface")},
+    submit_buffer{registry->counter("session.submit_buffer")},
+    allocate_buffers{registry->counter("session.allocate_buffers")},
+    release_buffers{registry->counter("session.release_buffers")},
+    release_surface{registry->counter("session.release_surface")},
+    disconnect{registry->counter("session.disconnect")},
+    configure_surface{registry->counter("session.configure_surface")},
+    configure_surface_cursor{registry->counter("session.configure_surface_cursor")},
+    configure_display{registry->counter("session.configure_display")},
+    set_base_display_configuration{registry->counter("session.set_base_display_configuration")},
+    preview_base_display_configuration{registry->counter("session.preview_base_display_configuration")},
+    confirm_base_display_configuration{registry->counter("session.confirm_base_display_configuration")},
+    start_prompt_session{registry->counter("session.start_prompt_session")},
+    stop_prompt_session{registry->counter("session.stop_prompt_session")},
+    create_buffer_stream{registry->counter("session.create_buffer_stream")},
+    release_buffer_stream{registry->counter("session.release_buffer_stream")},
+    errors{registry->counter("session.errors")}
+{
+}
+
+void mrm::SessionMediatorReport::session_connect_called(std::string const&)
+{
+    connect.increment();
+}
+
+void mrm::SessionMediatorReport::session_create_surface_called(std::string const&)
+{
+    create_surface.increment();
+}
+
+void mrm::SessionMediatorReport::session_submit_buffer_called(std::string const&)
+{
+    submit_buffer.increment();
+}
+
+void mrm::SessionMediatorReport::session_allocate_buffers_called(std::string const&)
+{
+    allocate_buffers.increment();
+}
+
+void mrm::SessionMediatorReport::session_release_buffers_called(std::string const&)
+{
+    release_buffers.increment();
+}
+
+void mrm::SessionMediatorReport::session_release_surface_called(std::string const&)
+{
+    release_surface.increment();
+}
+
+void mrm::SessionMediatorReport::session_disconnect_called(std::string const&)
+{
+    disconnect.increment();
+}
+
+void mrm::SessionMediatorReport::session_configure_surface_called(std::string const&)
+{
+    configure_surface.increment();
+}
+
+void mrm::SessionMediatorReport::session_configure_surface_cursor_called(std::string const&)
+{
+    configure_surface_cursor.increment();
+}
+
+void mrm::SessionMediatorReport::session_configure_display_called(std::string const&)
+{
+    configure_display.increment();
+}
+
+void mrm::SessionMediatorReport::session_set_base_display_configuration_called(std::string const&)
+{
+    set_base_display_configuration.increment();
+}
+
+void mrm::SessionMediatorReport::session_preview_base_display_configuration_called(std::string const&)
+{
+    preview_base_display_configuration.increment();
+}
+
+void mrm::SessionMediatorReport::session_confirm_base_display_configuration_called(std::string const&)
+{
+    confirm_base_display_configuration.increment();
+}
+
+void mrm::SessionMediatorReport::session_start_prompt_session_called(std::string const&, pid_t)
+{
+    start_prompt_session.increment();
+}
+
+void mrm::SessionMediatorReport::session_stop_prompt_session_called(std::string const&)
+{
+    stop_prompt_session.increment();
+}
+
+void mrm::SessionMediatorReport::session_create_buffer_stream_called(std::string const&)
+{
+    create_buffer_stream.increment();
+}
+
+void mrm::SessionMediatorReport::session_release_buffer_stream_called(std::string const&)
+{
+    release_buffer_stream.increment();
+}
+
+void mrm::SessionMediatorReport::session_error(std::string const&, char const*, std::string const&)
+{
+    errors.increment();
+}
@@ -40,6 +40,10 @@ void mrn::CompositorReport::finished_frame(SubCompositorId)
 {
 }
 
+void mrn::CompositorReport::allocations_in_frame(SubCompositorId, size_t, size_t)
+{
+}
+
 void mrn::CompositorReport::started()
 {
 }
@@ -20,6 +20,7 @@
 
 #include "basic_surface.h"
 #include "mir/compositor/buffer_stream.h"
+#include "mir/compositor/frame_arena.h"
 #include "mir/frontend/event_sink.h"
 #include "mir/shell/input_targeter.h"
 #include "mir/graphics/buffer.h"
@@ -900,7 +901,7 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             else
                 size = info.stream->stream_size();
 
-            list.emplace_back(std::make_shared<SurfaceSnapshot>(
+            list.emplace_back(mc::make_frame_shared<SurfaceSnapshot>(
                 info.stream, id,
                 geom::Rectangle{surface_rect.top_left + info.displacement, std::move(size)},
                 transformation_matrix, surface_alpha, info.stream.get()));
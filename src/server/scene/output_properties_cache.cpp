@@ -57,7 +57,8 @@ void ms::OutputPropertiesCache::update_from(mg::DisplayConfiguration const &conf
                     output.extents(),
                     calculate_dpi(mode.size, output.physical_size_mm),
                     output.scale,
-                    mode.vrefresh_hz,
+                    // With adaptive sync clients may render as fast as the VRR range allows
+                    output.max_refresh_hz(),
                     output.form_factor,
                     output.id});
             }
@@ -23,6 +23,7 @@
 #include "mir/scene/surface.h"
 #include "mir/scene/scene_report.h"
 #include "mir/compositor/scene_element.h"
+#include "mir/compositor/frame_arena.h"
 #include "mir/graphics/renderable.h"
 
 #include <boost/throw_exception.hpp>
@@ -46,14 +47,12 @@ class SurfaceSceneElement : public mc::SceneElement
 {
 public:
     SurfaceSceneElement(
-        std::string name,
         std::shared_ptr<mg::Renderable> const& renderable,
         std::shared_ptr<ms::RenderingTracker> const& tracker,
         mc::CompositorID id)
         : renderable_{renderable},
           tracker{tracker},
-          cid{id},
-          surface_name(name)
+          cid{id}
     {
     }
 
@@ -76,7 +75,6 @@ private:
     std::shared_ptr<mg::Renderable> const renderable_;
     std::shared_ptr<ms::RenderingTracker> const tracker;
     mc::CompositorID cid;
-    std::string const surface_name;
 };
 
 //note: something different than a 2D/HWC overlay
@@ -121,6 +119,7 @@ mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID i
 
     scene_changed = false;
     mc::SceneElementSequence elements;
+    elements.reserve(surfaces.size() + overlays.size());
     for (auto const& surface : surfaces)
     {
         if (surface->visible())
@@ -128,8 +127,7 @@ mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID i
             for (auto& renderable : surface->generate_renderables(id))
             {
                 elements.emplace_back(
-                    std::make_shared<SurfaceSceneElement>(
-                        surface->name(),
+                    mc::make_frame_shared<SurfaceSceneElement>(
                         renderable,
                         rendering_trackers[surface.get()],
                         id));
@@ -138,7 +136,7 @@ mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID i
     }
     for (auto const& renderable : overlays)
     {
-        elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
+        elements.emplace_back(mc::make_frame_shared<OverlaySceneElement>(renderable));
     }
     return elements;
 }
@@ -102,7 +102,8 @@ struct TemporaryCompositeEventFilter : public mi::CompositeEventFilter
     MACRO(application_not_responding_detector)\
     MACRO(cookie_authority)\
     MACRO(coordinate_translator) \
-    MACRO(persistent_surface_store)
+    MACRO(persistent_surface_store)\
+    MACRO(thread_scheduler)
 
 #define FOREACH_ACCESSOR(MACRO)\
     MACRO(the_buffer_stream_factory)\
@@ -131,6 +132,7 @@ struct TemporaryCompositeEventFilter : public mi::CompositeEventFilter
     MACRO(the_input_device_hub)\
     MACRO(the_application_not_responding_detector)\
     MACRO(the_persistent_surface_store)\
+    MACRO(the_thread_scheduler)\
     MACRO(the_display_configuration_observer_registrar)\
     MACRO(the_seat_observer_registrar)\
     MACRO(the_session_mediator_observer_registrar)
@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "threads"
+
+#include "default_thread_scheduler.h"
+
+#include "mir/options/configuration.h"
+#include "mir/options/option.h"
+#include "mir/log.h"
+
+namespace mt = mir::thread;
+namespace mo = mir::options;
+
+namespace
+{
+auto affinity_map_from(std::string const& spec) -> std::map<std::string, std::vector<int>>
+{
+    std::map<std::string, std::vector<int>> result;
+
+    size_t start = 0;
+    while (start < spec.size())
+    {
+        auto end = spec.find(';', start);
+        if (end == std::string::npos)
+            end = spec.size();
+
+        auto const entry = spec.substr(start, end - start);
+        auto const equals = entry.find('=');
+
+        if (equals == std::string::npos)
+            result[""] = mt::parse_cpu_list(entry);
+        else
+            result[entry.substr(0, equals)] = mt::parse_cpu_list(entry.substr(equals + 1));
+
+        start = end + 1;
+    }
+
+    return result;
+}
+
+template<typename Action>
+void apply(char const* thread, char const* what, Action const& action)
+{
+    try
+    {
+        action();
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_warning("Could not set %s for %s thread: %s", what, thread, error.what());
+    }
+}
+
+// Compositor threads come from a pool, so a thread may have been given the affinity
+// of a different output. This remembers what it had before we first changed it.
+struct CompositorThreadAffinity
+{
+    bool changed{false};
+    std::vector<int> original;
+};
+
+thread_local CompositorThreadAffinity compositor_thread_affinity;
+}
+
+mt::DefaultThreadScheduler::DefaultThreadScheduler(Settings const& settings) :
+    settings(settings)
+{
+}
+
+auto mt::DefaultThreadScheduler::settings_from(mo::Option const& options) -> Settings
+{
+    Settings settings;
+
+    if (options.is_set(mo::compositor_thread_policy_opt))
+        settings.compositor_policy =
+            parse_scheduling_policy(options.get<std::string>(mo::compositor_thread_policy_opt));
+
+    if (options.is_set(mo::compositor_cpu_affinity_opt))
+        settings.compositor_affinity =
+            affinity_map_from(options.get<std::string>(mo::compositor_cpu_affinity_opt));
+
+    settings.compositor_latency_hint = options.get<bool>(mo::compositor_latency_hint_opt);
+
+    if (options.is_set(mo::input_thread_policy_opt))
+        settings.input_policy = parse_scheduling_policy(options.get<std::string>(mo::input_thread_policy_opt));
+
+    if (options.is_set(mo::input_cpu_affinity_opt))
+        settings.input_affinity = parse_cpu_list(options.get<std::string>(mo::input_cpu_affinity_opt));
+
+    return settings;
+}
+
+void mt::DefaultThreadScheduler::compositor_thread_started(std::string const& output)
+{
+    auto const name = "compositor (" + output + ")";
+    auto const thread = name.c_str();
+
+    // Anything not configured is left as the server was started (e.g. by nice or taskset)
+    apply(thread, "scheduling policy", [this] { apply_scheduling_policy(settings.compositor_policy); });
+
+    auto affinity = settings.compositor_affinity.find(output);
+    if (affinity == settings.compositor_affinity.end())
+        affinity = settings.compositor_affinity.find("");
+
+    auto& thread_affinity = compositor_thread_affinity;
+
+    if (affinity != settings.compositor_affinity.end())
+    {
+        apply(thread, "CPU affinity",
+            [&]
+            {
+                if (!thread_affinity.changed)
+                    thread_affinity.original = current_cpu_affinity();
+
+                apply_cpu_affinity(affinity->second);
+                thread_affinity.changed = true;
+            });
+    }
+    else if (thread_affinity.changed)
+    {
+        apply(thread, "CPU affinity",
+            [&]
+            {
+                apply_cpu_affinity(thread_affinity.original);
+                thread_affinity.changed = false;
+            });
+    }
+
+    if (settings.compositor_latency_hint)
+        apply(thread, "frequency hint", [] { request_latency_sensitive_frequency(); });
+}
+
+void mt::DefaultThreadScheduler::input_thread_started()
+{
+    apply("input", "scheduling policy", [this] { apply_scheduling_policy(settings.input_policy); });
+    apply("input", "CPU affinity", [this] { apply_cpu_affinity(settings.input_affinity); });
+}
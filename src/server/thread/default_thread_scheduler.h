@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_THREAD_DEFAULT_THREAD_SCHEDULER_H_
+#define MIR_THREAD_DEFAULT_THREAD_SCHEDULER_H_
+
+#include "mir/thread_scheduler.h"
+#include "mir/thread/scheduling.h"
+
+#include <map>
+#include <memory>
+
+namespace mir
+{
+namespace options { class Option; }
+
+namespace thread
+{
+/// Applies the policies given by the --compositor-* and --input-* thread options.
+/// Failures (e.g. lacking CAP_SYS_NICE) are logged rather than fatal.
+class DefaultThreadScheduler : public ThreadScheduler
+{
+public:
+    struct Settings
+    {
+        SchedulingPolicy compositor_policy;
+        /// CPUs for compositing threads, keyed by output name ("" applies to other outputs)
+        std::map<std::string, std::vector<int>> compositor_affinity;
+        bool compositor_latency_hint{false};
+
+        SchedulingPolicy input_policy;
+        std::vector<int> input_affinity;
+    };
+
+    explicit DefaultThreadScheduler(Settings const& settings);
+
+    static auto settings_from(options::Option const& options) -> Settings;
+
+    void compositor_thread_started(std::string const& output) override;
+    void input_thread_started() override;
+
+private:
+    Settings const settings;
+};
+}
+}
+
+#endif /* MIR_THREAD_DEFAULT_THREAD_SCHEDULER_H_ */
@@ -0,0 +1,206 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/thread/scheduling.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+namespace mt = mir::thread;
+
+namespace
+{
+int parse_int(std::string const& text, std::string const& context)
+{
+    size_t used{0};
+    int result{0};
+
+    try
+    {
+        result = std::stoi(text, &used);
+    }
+    catch (std::exception const&)
+    {
+        used = 0;
+    }
+
+    if (text.empty() || used != text.size())
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Invalid number \"" + text + "\" in \"" + context + "\""));
+
+    return result;
+}
+
+// Not all C libraries we build against declare sched_setattr() or the utilization clamp fields
+struct SchedAttr
+{
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+    uint32_t sched_util_min;
+    uint32_t sched_util_max;
+};
+
+uint64_t const sched_flag_keep_policy = 0x08;
+uint64_t const sched_flag_keep_params = 0x10;
+uint64_t const sched_flag_util_clamp_min = 0x20;
+uint32_t const sched_capacity_scale = 1024;
+}
+
+auto mt::parse_scheduling_policy(std::string const& spec) -> SchedulingPolicy
+{
+    if (spec.empty())
+        return {};
+
+    auto const colon = spec.find(':');
+    if (colon == std::string::npos)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Scheduling policy \"" + spec + "\" lacks a \":<priority>\""));
+
+    auto const kind = spec.substr(0, colon);
+    auto const priority = parse_int(spec.substr(colon + 1), spec);
+
+    if (kind == "nice")
+        return {SchedulingPolicy::Kind::nice, priority};
+
+    SchedulingPolicy result{SchedulingPolicy::Kind::unchanged, priority};
+    if (kind == "fifo")
+        result.kind = SchedulingPolicy::Kind::fifo;
+    else if (kind == "rr")
+        result.kind = SchedulingPolicy::Kind::round_robin;
+    else
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Unknown scheduling policy \"" + kind + "\""));
+
+    auto const native = result.kind == SchedulingPolicy::Kind::fifo ? SCHED_FIFO : SCHED_RR;
+    if (priority < sched_get_priority_min(native) || priority > sched_get_priority_max(native))
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Real-time priority out of range in \"" + spec + "\""));
+
+    return result;
+}
+
+auto mt::parse_cpu_list(std::string const& spec) -> std::vector<int>
+{
+    std::vector<int> cpus;
+
+    if (spec.empty())
+        return cpus;
+
+    size_t start = 0;
+    while (start <= spec.size())
+    {
+        auto end = spec.find(',', start);
+        if (end == std::string::npos)
+            end = spec.size();
+
+        auto const item = spec.substr(start, end - start);
+        auto const dash = item.find('-');
+
+        auto const first = parse_int(item.substr(0, dash), spec);
+        auto const last = dash == std::string::npos ? first : parse_int(item.substr(dash + 1), spec);
+
+        if (first < 0 || last < first || last >= CPU_SETSIZE)
+            BOOST_THROW_EXCEPTION(std::invalid_argument("Invalid CPU range \"" + item + "\" in \"" + spec + "\""));
+
+        for (auto cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+
+        start = end + 1;
+    }
+
+    return cpus;
+}
+
+void mt::apply_scheduling_policy(SchedulingPolicy const& policy)
+{
+    switch (policy.kind)
+    {
+    case SchedulingPolicy::Kind::unchanged:
+        break;
+
+    case SchedulingPolicy::Kind::nice:
+        // On Linux the nice level is a per-thread attribute addressed by tid
+        if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), policy.priority) != 0)
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to set nice level"}));
+        break;
+
+    case SchedulingPolicy::Kind::fifo:
+    case SchedulingPolicy::Kind::round_robin:
+    {
+        sched_param param{};
+        param.sched_priority = policy.priority;
+        auto const native = policy.kind == SchedulingPolicy::Kind::fifo ? SCHED_FIFO : SCHED_RR;
+
+        if (auto const error = pthread_setschedparam(pthread_self(), native, &param))
+            BOOST_THROW_EXCEPTION((std::system_error{error, std::system_category(), "Failed to set real-time scheduling"}));
+        break;
+    }
+    }
+}
+
+void mt::apply_cpu_affinity(std::vector<int> const& cpus)
+{
+    if (cpus.empty())
+        return;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto const cpu : cpus)
+        CPU_SET(cpu, &set);
+
+    if (auto const error = pthread_setaffinity_np(pthread_self(), sizeof set, &set))
+        BOOST_THROW_EXCEPTION((std::system_error{error, std::system_category(), "Failed to set CPU affinity"}));
+}
+
+auto mt::current_cpu_affinity() -> std::vector<int>
+{
+    cpu_set_t set;
+    if (auto const error = pthread_getaffinity_np(pthread_self(), sizeof set, &set))
+        BOOST_THROW_EXCEPTION((std::system_error{error, std::system_category(), "Failed to query CPU affinity"}));
+
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &set))
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+void mt::request_latency_sensitive_frequency()
+{
+    SchedAttr attr{};
+    attr.size = sizeof attr;
+    attr.sched_flags = sched_flag_keep_policy | sched_flag_keep_params | sched_flag_util_clamp_min;
+    attr.sched_util_min = sched_capacity_scale;
+    attr.sched_util_max = sched_capacity_scale;
+
+    if (syscall(SYS_sched_setattr, 0, &attr, 0) != 0)
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to set utilization clamp"}));
+}
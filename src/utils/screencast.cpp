@@ -31,6 +31,12 @@
 #include <boost/program_options.hpp>
 
 #include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -243,6 +249,369 @@ MirGraphicsRegion graphics_region_for(MirBufferStream* buffer_stream)
     return region;
 }
 
+/*
+ * The --tiled container
+ *
+ * Integers are written in host (little endian) byte order.
+ *
+ *   file    := header frame* index trailer
+ *   header  := "MIRCAST\0" u32:version (1) u32:width u32:height u32:bytes_per_pixel
+ *              u32:tile_size u32:flags char[8]:pixel_format (NUL padded)
+ *   frame   := "FRME" u32:tile_count u64:timestamp u64:payload_size tile*
+ *   tile    := u16:column u16:row u32:encoded_size byte[encoded_size]
+ *   index   := "INDX" u32:count (u64:timestamp u64:offset)*
+ *   trailer := u64:index_offset "MIRCAST\0"
+ *
+ * Timestamps are nanoseconds since the start of the screencast, payload_size
+ * counts the bytes of the tiles following a frame header and offsets are
+ * from the start of the file. If bit 0 of flags is set rows are stored bottom
+ * to top.
+ *
+ * A frame is only written if something changed since the previous capture,
+ * and then only with the tiles that changed. Keyframes contain every tile:
+ * the first frame is a keyframe, as is the first frame after each keyframe
+ * interval. The index lists the keyframes, so a reader can seek to one (via
+ * the trailer) and apply the frames that follow it.
+ *
+ * Tiles are tile_size pixels square (less at the right and bottom edges). Each
+ * row of a tile is run-length encoded as a series of packets, each a control
+ * byte n followed by:
+ *   n < 128:  n+1 literal pixels
+ *   n >= 128: one pixel, repeated n-126 times
+ */
+char const container_magic[8] = {'M', 'I', 'R', 'C', 'A', 'S', 'T', '\0'};
+uint32_t const container_version = 1;
+uint32_t const tile_size = 64;
+uint32_t const flag_bottom_up = 1 << 0;
+
+struct FrameLayout
+{
+    unsigned int width;
+    unsigned int height;
+    unsigned int bytes_per_pixel;
+    bool bottom_up;
+};
+
+template<unsigned int bytes_per_pixel>
+void run_length_encode(char const* pixels, unsigned int count, std::vector<char>& out)
+{
+    auto const same = [pixels](unsigned int a, unsigned int b)
+        { return memcmp(pixels + a*bytes_per_pixel, pixels + b*bytes_per_pixel, bytes_per_pixel) == 0; };
+
+    for (unsigned int i = 0; i != count;)
+    {
+        unsigned int run = 1;
+        while (i + run != count && run != 129 && same(i, i + run))
+            ++run;
+
+        if (run > 1)
+        {
+            out.push_back(static_cast<char>(126 + run));
+            out.insert(out.end(), pixels + i*bytes_per_pixel, pixels + (i + 1)*bytes_per_pixel);
+            i += run;
+        }
+        else
+        {
+            auto const start = i;
+            while (i != count && i - start != 128 && !(i + 1 != count && same(i, i + 1)))
+                ++i;
+
+            out.push_back(static_cast<char>(i - start - 1));
+            out.insert(out.end(), pixels + start*bytes_per_pixel, pixels + i*bytes_per_pixel);
+        }
+    }
+}
+
+void run_length_encode(char const* pixels, unsigned int count, unsigned int bytes_per_pixel, std::vector<char>& out)
+{
+    switch (bytes_per_pixel)
+    {
+    case 4: run_length_encode<4>(pixels, count, out); break;
+    case 3: run_length_encode<3>(pixels, count, out); break;
+    case 2: run_length_encode<2>(pixels, count, out); break;
+    default: run_length_encode<1>(pixels, count*bytes_per_pixel, out); break;
+    }
+}
+
+template<typename Type>
+void append(std::vector<char>& out, Type const& value)
+{
+    auto const bytes = reinterpret_cast<char const*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof value);
+}
+
+// A fixed set of threads, started once, that run tasks in the order given
+class WorkerPool
+{
+public:
+    explicit WorkerPool(unsigned int size)
+    {
+        for (unsigned int i = 0; i != size; ++i)
+            threads.emplace_back([this] { run_tasks(); });
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        task_added.notify_all();
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    template<typename Task>
+    auto run(Task task) -> std::future<decltype(task())>
+    {
+        auto const job = std::make_shared<std::packaged_task<decltype(task())()>>(std::move(task));
+        auto result = job->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            tasks.push_back([job] { (*job)(); });
+        }
+        task_added.notify_one();
+
+        return result;
+    }
+
+private:
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    void run_tasks()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+
+        for (;;)
+        {
+            task_added.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+
+            auto const task = std::move(tasks.front());
+            tasks.pop_front();
+
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable task_added;
+    std::deque<std::function<void()>> tasks;
+    bool stopping{false};
+    std::vector<std::thread> threads;
+};
+
+// Writes frames in the --tiled container. Frames are captured into a small
+// ring of buffers so that the next capture can proceed while the previous one
+// is compared, encoded (split across a few worker threads) and written.
+class TiledStreamWriter
+{
+public:
+    TiledStreamWriter(std::ostream& stream, FrameLayout const& layout, std::string const& pixel_format,
+                      std::chrono::duration<double> keyframe_interval)
+        : stream(stream),
+          layout(layout),
+          line_size{layout.width*layout.bytes_per_pixel},
+          columns{(layout.width + tile_size - 1)/tile_size},
+          rows{(layout.height + tile_size - 1)/tile_size},
+          workers{std::max(1u, std::min(4u, std::thread::hardware_concurrency()))},
+          keyframe_interval{std::chrono::duration_cast<std::chrono::steady_clock::duration>(keyframe_interval)},
+          start{std::chrono::steady_clock::now()}
+    {
+        for (auto& buffer : buffers)
+            buffer.resize(line_size*layout.height);
+
+        std::vector<char> header;
+        header.insert(header.end(), std::begin(container_magic), std::end(container_magic));
+        append(header, container_version);
+        append(header, uint32_t{layout.width});
+        append(header, uint32_t{layout.height});
+        append(header, uint32_t{layout.bytes_per_pixel});
+        append(header, tile_size);
+        append(header, uint32_t{layout.bottom_up ? flag_bottom_up : 0});
+        char format[8] = {};
+        pixel_format.copy(format, sizeof format);
+        header.insert(header.end(), std::begin(format), std::end(format));
+        write(header);
+    }
+
+    ~TiledStreamWriter()
+    {
+        if (pending.valid())
+            pending.wait();
+
+        auto const index_offset = offset;
+
+        std::vector<char> index{'I', 'N', 'D', 'X'};
+        append(index, static_cast<uint32_t>(keyframes.size()));
+        for (auto const& keyframe : keyframes)
+        {
+            append(index, keyframe.first);
+            append(index, keyframe.second);
+        }
+
+        append(index, index_offset);
+        index.insert(index.end(), std::begin(container_magic), std::end(container_magic));
+        write(index);
+        stream.flush();
+    }
+
+    // The buffer into which to capture the next frame
+    char* next_frame()
+    {
+        return buffers[current].data();
+    }
+
+    // Compare, encode and write the frame captured into next_frame() in the background
+    void submit()
+    {
+        auto const now = std::chrono::steady_clock::now();
+        auto const keyframe = !previous || now - last_keyframe >= keyframe_interval;
+        if (keyframe)
+            last_keyframe = now;
+
+        auto const timestamp = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count());
+
+        // Also ensures the buffer we're about to capture into next is no longer in use
+        if (pending.valid())
+            pending.get();
+
+        auto const frame = buffers[current].data();
+        auto const reference = keyframe ? nullptr : previous;
+        pending = frame_writer.run(
+            [this, frame, reference, timestamp] { encode_and_write(frame, reference, timestamp); });
+
+        previous = frame;
+        current = (current + 1) % buffers.size();
+    }
+
+private:
+    std::ostream& stream;
+    FrameLayout const layout;
+    unsigned int const line_size;
+    unsigned int const columns;
+    unsigned int const rows;
+    unsigned int const workers;
+    std::chrono::steady_clock::duration const keyframe_interval;
+    std::chrono::steady_clock::time_point const start;
+
+    // One being captured, one being encoded and the one it is compared with
+    std::array<std::vector<char>, 3> buffers;
+    unsigned int current{0};
+    char const* previous{nullptr};
+    std::chrono::steady_clock::time_point last_keyframe;
+    std::future<void> pending;
+
+    // Only used by the pending task (or after it completes)
+    uint64_t offset{0};
+    std::vector<std::pair<uint64_t, uint64_t>> keyframes;
+
+    // Started once per writer rather than per frame. Bands are encoded on a
+    // separate pool from the frame task that waits for them, so a single
+    // band worker can't deadlock. Declared last, so that their threads are
+    // joined before anything the tasks use is destroyed.
+    WorkerPool band_encoders{workers};
+    WorkerPool frame_writer{1};
+
+    struct EncodedTiles
+    {
+        uint32_t count{0};
+        std::vector<char> data;
+    };
+
+    // Encodes the tiles in [first_row, last_row) that differ from the reference (all of them, if there's no reference)
+    EncodedTiles encode_rows(char const* frame, char const* reference, unsigned int first_row, unsigned int last_row) const
+    {
+        EncodedTiles result;
+
+        for (auto row = first_row; row != last_row; ++row)
+        {
+            auto const top = row*tile_size;
+            auto const height = std::min(tile_size, layout.height - top);
+
+            for (unsigned int column = 0; column != columns; ++column)
+            {
+                auto const left = column*tile_size*layout.bytes_per_pixel;
+                auto const width = std::min(tile_size, layout.width - column*tile_size);
+                auto const tile_line_size = width*layout.bytes_per_pixel;
+
+                auto changed = !reference;
+                for (auto y = top; !changed && y != top + height; ++y)
+                    changed = memcmp(frame + y*line_size + left, reference + y*line_size + left, tile_line_size) != 0;
+
+                if (!changed)
+                    continue;
+
+                append(result.data, static_cast<uint16_t>(column));
+                append(result.data, static_cast<uint16_t>(row));
+                auto const size_at = result.data.size();
+                append(result.data, uint32_t{0});
+
+                for (auto y = top; y != top + height; ++y)
+                    run_length_encode(frame + y*line_size + left, width, layout.bytes_per_pixel, result.data);
+
+                uint32_t const encoded_size = result.data.size() - size_at - sizeof(uint32_t);
+                memcpy(result.data.data() + size_at, &encoded_size, sizeof encoded_size);
+                ++result.count;
+            }
+        }
+
+        return result;
+    }
+
+    void encode_and_write(char const* frame, char const* reference, uint64_t timestamp)
+    {
+        std::vector<std::future<EncodedTiles>> parts;
+        auto const rows_per_worker = (rows + workers - 1)/workers;
+
+        for (unsigned int first = 0; first < rows; first += rows_per_worker)
+        {
+            auto const last = std::min(rows, first + rows_per_worker);
+            parts.push_back(band_encoders.run(
+                [=] { return encode_rows(frame, reference, first, last); }));
+        }
+
+        uint32_t tile_count = 0;
+        uint64_t payload_size = 0;
+        std::vector<EncodedTiles> encoded;
+        for (auto& part : parts)
+        {
+            encoded.push_back(part.get());
+            tile_count += encoded.back().count;
+            payload_size += encoded.back().data.size();
+        }
+
+        // Nothing changed: no need for a frame
+        if (tile_count == 0)
+            return;
+
+        if (!reference)
+            keyframes.emplace_back(timestamp, offset);
+
+        std::vector<char> header{'F', 'R', 'M', 'E'};
+        append(header, tile_count);
+        append(header, timestamp);
+        append(header, payload_size);
+        write(header);
+
+        for (auto const& part : encoded)
+            write(part.data);
+    }
+
+    void write(std::vector<char> const& data)
+    {
+        stream.write(data.data(), data.size());
+        offset += data.size();
+    }
+};
+
 class Screencast
 {
 public:
@@ -264,8 +633,31 @@ public:
         }
     }
 
+    // Stream only the tiles that change, compressed (see the --tiled container above)
+    void run_tiled(std::ostream& stream, std::chrono::duration<double> keyframe_interval)
+    {
+        TiledStreamWriter writer{stream, frame_layout(), pixel_format(), keyframe_interval};
+
+        while (running && (number_of_captures != 0))
+        {
+            auto time_point = std::chrono::steady_clock::now() + capture_period;
+
+            capture_to(writer.next_frame());
+            writer.submit();
+
+            if (number_of_captures > 0)
+                number_of_captures--;
+
+            std::this_thread::sleep_until(time_point);
+        }
+    }
+
     virtual void capture_to(std::ostream& stream) = 0;
 
+    // Capture a frame (with the layout given by frame_layout()) into memory
+    virtual void capture_to(char* frame) = 0;
+    virtual FrameLayout frame_layout() = 0;
+
 protected:
     Screencast(int number_of_captures, double capture_fps)
         : number_of_captures{number_of_captures},
@@ -312,6 +704,25 @@ public:
         mir_buffer_stream_swap_buffers_sync(buffer_stream);
     }
 
+    void capture_to(char* frame) override
+    {
+        auto addr = region.vaddr + (region.height - 1)*region.stride;
+        for (int i = 0; i < region.height; i++)
+        {
+            memcpy(frame, addr, line_size);
+            frame += line_size;
+            addr -= region.stride;
+        }
+
+        mir_buffer_stream_swap_buffers_sync(buffer_stream);
+    }
+
+    FrameLayout frame_layout() override
+    {
+        return {static_cast<unsigned int>(region.width), static_cast<unsigned int>(region.height),
+                static_cast<unsigned int>(MIR_BYTES_PER_PIXEL(region.pixel_format)), false};
+    }
+
 private:
     MirGraphicsRegion const region;
     int const line_size;
@@ -409,6 +820,20 @@ public:
         write_out_future.wait();
     }
 
+    void capture_to(char* frame) override
+    {
+        glReadPixels(0, 0, width, height, read_pixel_format, GL_UNSIGNED_BYTE, frame);
+
+        if (eglSwapBuffers(egl_display, egl_surface) != EGL_TRUE)
+            throw std::runtime_error("Failed to swap screencast surface buffers");
+    }
+
+    FrameLayout frame_layout() override
+    {
+        // glReadPixels() reads from the bottom row up
+        return {width, height, 4, true};
+    }
+
     std::string pixel_format() override
     {
         return read_pixel_format == GL_BGRA_EXT ? "BGRA" : "RGBA";
@@ -454,6 +879,8 @@ try
     bool use_std_out = false;
     bool query_params_only = false;
     int capture_interval = 1;
+    bool tiled = false;
+    double keyframe_interval = 10.0;
 
     po::options_description desc("Usage");
     desc.add_options()
@@ -479,7 +906,14 @@ try
         ("cap-interval",
             po::value<int>(&capture_interval),
             "adjusts the capture rate to <arg> display refresh intervals\n"
-            "1 -> capture at display rate\n2 -> capture at half the display rate, etc..");
+            "1 -> capture at display rate\n2 -> capture at half the display rate, etc..")
+        ("tiled",
+            po::value<bool>(&tiled)->zero_tokens(),
+            "only write the tiles that change, compressed, in a seekable container "
+            "(described in src/utils/screencast.cpp)")
+        ("keyframe-interval",
+            po::value<double>(&keyframe_interval),
+            "with --tiled, the seconds between frames that include every tile [10]");
 
     po::variables_map vm;
     try
@@ -498,6 +932,9 @@ try
 
         if (vm.count("cap-interval") && capture_interval < 1)
             throw po::error("invalid capture interval");
+
+        if (vm.count("keyframe-interval") && keyframe_interval <= 0)
+            throw po::error("invalid keyframe interval");
     }
     catch(po::error& e)
     {
@@ -573,7 +1010,7 @@ try
         ss << "/tmp/mir_screencast_" ;
         ss << screencast_config.width << "x" << screencast_config.height;
         ss << "_" << capture_fps << "Hz";
-        ss << to_file_extension(screencast->pixel_format());
+        ss << (tiled ? std::string{".mircast"} : to_file_extension(screencast->pixel_format()));
         output_filename = ss.str();
     }
 
@@ -583,20 +1020,22 @@ try
        std::cout << "Output size: " <<
            screencast_config.width << "x" << screencast_config.height << std::endl;
        std::cout << "Capture rate (Hz): " << capture_fps << std::endl;
+       std::cout << "Output format: " << (tiled ? "tiled" : "raw") << std::endl;
        std::cout << "Output to: " <<
            (use_std_out ? "standard out" : output_filename) << std::endl;
        return EXIT_SUCCESS;
     }
 
-    if (use_std_out)
-    {
-        screencast->run(std::cout);
-    }
+    std::ofstream file_stream;
+    if (!use_std_out)
+        file_stream.open(output_filename, std::ios::binary);
+
+    auto& stream = use_std_out ? std::cout : file_stream;
+
+    if (tiled)
+        screencast->run_tiled(stream, std::chrono::duration<double>{keyframe_interval});
     else
-    {
-        std::ofstream file_stream(output_filename);
-        screencast->run(file_stream);
-    }
+        screencast->run(stream);
 
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,58 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "window_management_trace_decoder.h"
+
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+
+// Renders a trace written with --window-management-trace-file as text
+int main(int argc, char const* argv[])
+try
+{
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-' && argv[1][1] != '\0'))
+    {
+        std::cerr << "Usage: " << argv[0] << " [<trace-file>]\n"
+                  << "Decodes a binary window management trace (from standard input if no file is given)\n";
+        return EXIT_FAILURE;
+    }
+
+    if (argc == 1 || argv[1] == std::string{"-"})
+    {
+        miral::trace::decode(std::cin, std::cout);
+    }
+    else
+    {
+        std::ifstream in{argv[1], std::ios::binary};
+        if (!in)
+        {
+            std::cerr << argv[0] << ": cannot open " << argv[1] << '\n';
+            return EXIT_FAILURE;
+        }
+
+        miral::trace::decode(in, std::cout);
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << argv[0] << ": " << error.what() << '\n';
+    return EXIT_FAILURE;
+}
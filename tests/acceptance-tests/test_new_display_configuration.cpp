@@ -1343,6 +1343,88 @@ MATCHER_P(IsSameModeAs, mode, "")
 }
 }
 
+TEST_F(DisplayConfigurationTest, client_receives_adaptive_sync_range)
+{
+    mtd::StubDisplayConfigurationOutput monitor{
+        mg::DisplayConfigurationOutputId{2},
+        {{{1920, 1080}, 144.0}},
+        {mir_pixel_format_abgr_8888}};
+    monitor.vrr_capable = true;
+    monitor.min_vrr_hz = 48.0;
+    monitor.max_vrr_hz = 144.0;
+
+    auto config = std::make_shared<mtd::StubDisplayConfig>(std::vector<mg::DisplayConfigurationOutput>{monitor});
+
+    apply_config_change_and_wait_for_propagation(config);
+
+    DisplayClient client{new_connection()};
+    client.connect();
+
+    auto configuration = client.get_base_config();
+
+    auto output = mir_display_config_get_output(configuration.get(), 0);
+
+    double min_hz{0}, max_hz{0};
+    mir_output_get_adaptive_sync_range(output, &min_hz, &max_hz);
+
+    EXPECT_TRUE(mir_output_is_adaptive_sync_supported(output));
+    EXPECT_FALSE(mir_output_is_adaptive_sync_enabled(output));
+    EXPECT_THAT(min_hz, Eq(48.0));
+    EXPECT_THAT(max_hz, Eq(144.0));
+
+    client.disconnect();
+}
+
+TEST_F(DisplayConfigurationTest, client_can_enable_adaptive_sync)
+{
+    mtd::StubDisplayConfigurationOutput monitor{
+        mg::DisplayConfigurationOutputId{2},
+        {{{1920, 1080}, 144.0}},
+        {mir_pixel_format_abgr_8888}};
+    monitor.vrr_capable = true;
+    monitor.min_vrr_hz = 48.0;
+    monitor.max_vrr_hz = 144.0;
+
+    auto config = std::make_shared<mtd::StubDisplayConfig>(std::vector<mg::DisplayConfigurationOutput>{monitor});
+
+    apply_config_change_and_wait_for_propagation(config);
+
+    DisplayClient client{new_connection()};
+    client.connect();
+
+    auto client_config = client.get_base_config();
+    auto output = mir_display_config_get_mutable_output(client_config.get(), 0);
+    mir_output_set_adaptive_sync(output, true);
+    ASSERT_TRUE(mir_output_is_adaptive_sync_enabled(output));
+
+    DisplayConfigMatchingContext context;
+    context.matcher = [c = client_config.get()](MirDisplayConfig* conf)
+        {
+            EXPECT_THAT(conf, mt::DisplayConfigMatches(c));
+        };
+
+    mir_connection_set_display_config_change_callback(
+        client.connection,
+        &new_display_config_matches,
+        &context);
+
+    mir_connection_preview_base_display_configuration(client.connection,
+                                                      client_config.get(), 10);
+
+    EXPECT_TRUE(context.done.wait_for(std::chrono::seconds(30)));
+
+    mir_connection_confirm_base_display_configuration(client.connection,
+                                                      client_config.get());
+
+    server.the_display()->configuration()->for_each_output(
+        [](mg::UserDisplayConfigurationOutput& output)
+        {
+            EXPECT_TRUE(output.vrr_enabled);
+        });
+
+    client.disconnect();
+}
+
 TEST_F(DisplayConfigurationTest, get_current_mode_index_invariants)
 {
     DisplayClient client{new_connection()};
@@ -43,6 +43,10 @@ public:
                  void(compositor::CompositorReport::SubCompositorId));
     MOCK_METHOD1(finished_frame,
                  void(compositor::CompositorReport::SubCompositorId));
+    MOCK_METHOD3(allocations_in_frame,
+                 void(compositor::CompositorReport::SubCompositorId, size_t, size_t));
+    MOCK_METHOD2(frames_pending,
+                 void(compositor::CompositorReport::SubCompositorId, int));
     MOCK_METHOD0(started, void());
     MOCK_METHOD0(stopped, void());
     MOCK_METHOD0(scheduled, void());
@@ -127,6 +127,15 @@ public:
                                                   uint32_t flags, void *user_data));
     MOCK_METHOD2(drmHandleEvent, int(int fd, drmEventContextPtr evctx));
 
+    MOCK_METHOD0(drmModeAtomicAlloc, drmModeAtomicReqPtr());
+    MOCK_METHOD1(drmModeAtomicFree, void(drmModeAtomicReqPtr req));
+    MOCK_METHOD4(drmModeAtomicAddProperty, int(drmModeAtomicReqPtr req, uint32_t object_id,
+                                               uint32_t property_id, uint64_t value));
+    MOCK_METHOD4(drmModeAtomicCommit, int(int fd, drmModeAtomicReqPtr req,
+                                          uint32_t flags, void *user_data));
+    MOCK_METHOD4(drmModeCreatePropertyBlob, int(int fd, void const* data, size_t size, uint32_t* id));
+    MOCK_METHOD2(drmModeDestroyPropertyBlob, int(int fd, uint32_t id));
+
     MOCK_METHOD3(drmGetCap, int(int fd, uint64_t capability, uint64_t *value));
     MOCK_METHOD3(drmSetClientCap, int(int fd, uint64_t capability, uint64_t value));
     MOCK_METHOD2(drmModeGetProperty, drmModePropertyPtr(int fd, uint32_t propertyId));
@@ -39,8 +39,7 @@ class StubIpcFactory : public frontend::ProtobufIpcFactory
 {
 public:
     StubIpcFactory(frontend::detail::DisplayServer& server) :
-        server(fake_shared(server)),
-        cache(std::make_shared<frontend::ResourceCache>())
+        server(fake_shared(server))
     {
     }
 
@@ -48,19 +47,14 @@ public:
         mir::frontend::SessionCredentials const & /*creds*/,
         std::shared_ptr<frontend::EventSinkFactory> const& /*sink_factory*/,
         std::shared_ptr<frontend::MessageSender> const& /*message_sender*/,
+        std::shared_ptr<frontend::ResourceCache> const& /*resource_cache*/,
         mir::frontend::ConnectionContext const & /*connection_context*/) override
     {
         return server;
     }
 
 private:
-    virtual std::shared_ptr<frontend::ResourceCache> resource_cache() override
-    {
-        return cache;
-    }
-
     std::shared_ptr<frontend::detail::DisplayServer> const server;
-    std::shared_ptr<frontend::ResourceCache> const cache;
 };
 
 }
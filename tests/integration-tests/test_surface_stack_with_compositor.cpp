@@ -32,6 +32,7 @@
 #include "mir/test/doubles/stub_display_buffer.h"
 #include "mir/test/doubles/stub_buffer.h"
 #include "mir/test/doubles/null_display_sync_group.h"
+#include "mir/test/doubles/null_thread_scheduler.h"
 #include "mir/test/doubles/mock_event_sink.h"
 #include "mir/test/doubles/stub_buffer_allocator.h"
 
@@ -159,6 +160,7 @@ struct SurfaceStackCompositor : public Test
 };
 
 std::chrono::milliseconds const default_delay{-1};
+auto const null_thread_scheduler = std::make_shared<mtd::NullThreadScheduler>();
 
 }
 
@@ -169,7 +171,8 @@ TEST_F(SurfaceStackCompositor, composes_on_start_if_told_to_in_constructor)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, true);
+        null_comp_report, default_delay, true,
+        null_thread_scheduler);
     mt_compositor.start();
 
     EXPECT_TRUE(stub_primary_db.has_posted_at_least(1, timeout));
@@ -183,7 +186,8 @@ TEST_F(SurfaceStackCompositor, does_not_composes_on_start_if_told_not_to_in_cons
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, default_delay, false,
+        null_thread_scheduler);
     mt_compositor.start();
 
     EXPECT_TRUE(stub_primary_db.has_posted_at_least(0, timeout));
@@ -197,7 +201,8 @@ TEST_F(SurfaceStackCompositor, swapping_a_surface_that_has_been_added_triggers_a
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, default_delay, false,
+        null_thread_scheduler);
     mt_compositor.start();
 
     stack.add_surface(stub_surface, default_params.input_mode);
@@ -222,7 +227,8 @@ TEST_F(SurfaceStackCompositor, compositor_runs_until_all_surfaces_buffers_are_co
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, default_delay, false,
+        null_thread_scheduler);
     mt_compositor.start();
 
     stack.add_surface(stub_surface, default_params.input_mode);
@@ -251,7 +257,8 @@ TEST_F(SurfaceStackCompositor, bypassed_compositor_runs_until_all_surfaces_buffe
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, default_delay, false,
+        null_thread_scheduler);
     mt_compositor.start();
 
     stack.add_surface(stub_surface, default_params.input_mode);
@@ -269,7 +276,8 @@ TEST_F(SurfaceStackCompositor, an_empty_scene_retriggers)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, default_delay, false,
+        null_thread_scheduler);
     mt_compositor.start();
 
     stack.add_surface(stub_surface, default_params.input_mode);
@@ -294,7 +302,8 @@ TEST_F(SurfaceStackCompositor, moving_a_surface_triggers_composition)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, default_delay, false,
+        null_thread_scheduler);
 
     mt_compositor.start();
     stub_surface->move_to(geom::Point{1,1});
@@ -313,7 +322,8 @@ TEST_F(SurfaceStackCompositor, removing_a_surface_triggers_composition)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, default_delay, false,
+        null_thread_scheduler);
 
     mt_compositor.start();
     stack.remove_surface(stub_surface);
@@ -332,7 +342,8 @@ TEST_F(SurfaceStackCompositor, buffer_updates_trigger_composition)
         mt::fake_shared(stack),
         mt::fake_shared(dbc_factory),
         mt::fake_shared(stub_display_listener),
-        null_comp_report, default_delay, false);
+        null_comp_report, default_delay, false,
+        null_thread_scheduler);
 
     mt_compositor.start();
     streams.front().stream->submit_buffer(stub_buffer);
@@ -89,6 +89,10 @@ public:
                 {},
                 custom_logical_size
             };
+            display_output.vrr_capable = protobuf_output.vrr_capable();
+            display_output.min_vrr_hz = protobuf_output.min_vrr_hz();
+            display_output.max_vrr_hz = protobuf_output.max_vrr_hz();
+            display_output.vrr_enabled = protobuf_output.vrr_enabled();
 
             /* Modes */
             std::vector<mg::DisplayConfigurationMode> modes;
@@ -219,6 +223,10 @@ public:
                     {},
                     custom_logical_size
                 };
+            display_output.vrr_capable = mir_output_is_adaptive_sync_supported(client_output);
+            mir_output_get_adaptive_sync_range(
+                client_output, &display_output.min_vrr_hz, &display_output.max_vrr_hz);
+            display_output.vrr_enabled = mir_output_is_adaptive_sync_enabled(client_output);
 
             /* Modes */
             std::vector<mg::DisplayConfigurationMode> modes;
@@ -17,9 +17,11 @@
  */
 
 #include "mir/test/doubles/fake_alarm_factory.h"
+#include "mir/lockable_callback.h"
 
 #include <numeric>
 #include <algorithm>
+#include <mutex>
 
 namespace mtd = mir::test::doubles;
 namespace mt = mir::time;
@@ -147,9 +149,17 @@ std::unique_ptr<mt::Alarm> mtd::FakeAlarmFactory::create_alarm(
 }
 
 std::unique_ptr<mt::Alarm> mtd::FakeAlarmFactory::create_alarm(
-    std::unique_ptr<LockableCallback> /*callback*/)
+    std::unique_ptr<LockableCallback> callback)
 {
-    throw std::logic_error{"Lockable alarm creation not implemented for fake alarms"};
+    std::shared_ptr<LockableCallback> const lockable{std::move(callback)};
+
+    // Like the real alarms, hold the callback's lock while calling it
+    return create_alarm(
+        [lockable]
+        {
+            std::lock_guard<LockableCallback> lock{*lockable};
+            (*lockable)();
+        });
 }
 
 void mtd::FakeAlarmFactory::advance_by(mt::Duration step)
@@ -35,6 +35,11 @@ namespace
 mtd::MockDRM* global_mock = nullptr;
 }
 
+/* libdrm keeps this opaque; the mock only needs something to point at */
+struct _drmModeAtomicReq
+{
+};
+
 mtd::FakeDRMResources::FakeDRMResources()
     : pipe_fds{-1, -1}
 {
@@ -299,6 +304,13 @@ mtd::MockDRM::MockDRM()
     ON_CALL(*this, drmModeObjectGetProperties(_, _, _))
         .WillByDefault(Return(&empty_object_props));
 
+    ON_CALL(*this, drmModeAtomicAlloc())
+        .WillByDefault(InvokeWithoutArgs([]() { return new drmModeAtomicReq; }));
+    ON_CALL(*this, drmModeAtomicFree(_))
+        .WillByDefault(Invoke([](drmModeAtomicReqPtr req) { delete req; }));
+    ON_CALL(*this, drmModeAtomicAddProperty(_, _, _, _))
+        .WillByDefault(Return(1));
+
     ON_CALL(*this, drmSetInterfaceVersion(_, _))
     .WillByDefault(Return(0));
 
@@ -535,6 +547,37 @@ void drmFreeVersion(drmVersionPtr version)
     return global_mock->drmFreeVersion(version);
 }
 
+drmModeAtomicReqPtr drmModeAtomicAlloc()
+{
+    return global_mock->drmModeAtomicAlloc();
+}
+
+void drmModeAtomicFree(drmModeAtomicReqPtr req)
+{
+    global_mock->drmModeAtomicFree(req);
+}
+
+int drmModeAtomicAddProperty(drmModeAtomicReqPtr req, uint32_t object_id,
+                             uint32_t property_id, uint64_t value)
+{
+    return global_mock->drmModeAtomicAddProperty(req, object_id, property_id, value);
+}
+
+int drmModeAtomicCommit(int fd, drmModeAtomicReqPtr req, uint32_t flags, void *user_data)
+{
+    return global_mock->drmModeAtomicCommit(fd, req, flags, user_data);
+}
+
+int drmModeCreatePropertyBlob(int fd, void const* data, size_t size, uint32_t* id)
+{
+    return global_mock->drmModeCreatePropertyBlob(fd, data, size, id);
+}
+
+int drmModeDestroyPropertyBlob(int fd, uint32_t id)
+{
+    return global_mock->drmModeDestroyPropertyBlob(fd, id);
+}
+
 int drmSetClientCap(int fd, uint64_t capability, uint64_t value)
 {
     return global_mock->drmSetClientCap(fd, capability, value);
@@ -184,6 +184,7 @@ class StubIpcOps : public mg::PlatformIpcOperations
          */
         auto package = std::make_shared<mg::PlatformIPCPackage>(describe_graphics_module());
         mtf::pack_stub_ipc_package(*package);
+        package->client_module = "dummy";
         return package;
     }
 
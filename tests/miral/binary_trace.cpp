@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "binary_trace_writer.h"
+#include "window_management_trace_decoder.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace testing;
+namespace mt = miral::trace;
+
+namespace
+{
+struct BinaryTrace : Test
+{
+    BinaryTrace()
+    {
+        char name[] = "/tmp/miral_trace_XXXXXX";
+        auto const fd = mkstemp(name);
+        if (fd < 0)
+            throw std::system_error(errno, std::system_category(), "Failed to create temp file");
+        close(fd);
+        filename = name;
+    }
+
+    ~BinaryTrace()
+    {
+        unlink(filename.c_str());
+    }
+
+    auto decoded() const -> std::vector<std::string>
+    {
+        std::ifstream in{filename, std::ios::binary};
+        std::stringstream out;
+        mt::decode(in, out);
+
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(out, line);)
+            lines.push_back(line);
+        return lines;
+    }
+
+    std::string filename;
+};
+}
+
+TEST_F(BinaryTrace, decodes_calls_with_their_arguments)
+{
+    {
+        miral::BinaryTraceWriter writer{filename};
+        writer.write(mt::Call::count_applications, {3});
+        writer.write(mt::Call::window_at, {mt::pack(10, 20), 0});
+        writer.write(mt::Call::end_of_transaction, {});
+    }
+
+    EXPECT_THAT(decoded(), ElementsAre(
+        HasSubstr("count_applications -> 3"),
+        HasSubstr("window_at cursor=(10, 20) -> (null)"),
+        EndsWith("====")));
+}
+
+TEST_F(BinaryTrace, windows_are_shown_by_name)
+{
+    uint64_t const window{0x1234};
+
+    {
+        miral::BinaryTraceWriter writer{filename};
+        writer.write_name(mt::Call::window_name, window, "a very long window name that does not fit in a record");
+        writer.write(mt::Call::advise_move_to, {window, mt::pack(5, 6)});
+        writer.write(mt::Call::advise_delete_window, {0x5678});
+    }
+
+    EXPECT_THAT(decoded(), ElementsAre(
+        HasSubstr("advise_move_to window_info=a very long window name that does not fi, top_left=(5, 6)"),
+        HasSubstr("advise_delete_window window_info=0x5678")));
+}
+
+TEST_F(BinaryTrace, records_from_all_threads_are_written)
+{
+    auto const threads = 4;
+    auto const calls = 1000;
+
+    {
+        miral::BinaryTraceWriter writer{filename, std::chrono::milliseconds{1}, calls};
+
+        std::vector<std::thread> workers;
+        for (auto i = 0; i != threads; ++i)
+        {
+            workers.emplace_back([&]
+                {
+                    for (auto call = 0; call != calls; ++call)
+                        writer.write(mt::Call::focus_next_application, {});
+                });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    EXPECT_THAT(decoded().size(), Eq(threads*calls));
+}
+
+TEST_F(BinaryTrace, records_that_do_not_fit_are_counted_as_dropped)
+{
+    auto const calls = 1000;
+
+    {
+        miral::BinaryTraceWriter writer{filename, std::chrono::hours{1}, 4};
+
+        for (auto call = 0; call != calls; ++call)
+            writer.write(mt::Call::focus_next_application, {});
+    }
+
+    auto written = 0;
+    auto dropped = 0;
+
+    for (auto const& line : decoded())
+    {
+        if (line.find("focus_next_application") != std::string::npos)
+            ++written;
+        else if (line.find(" records dropped]") != std::string::npos)
+            dropped += std::stoi(line.substr(line.rfind('[') + 1));
+    }
+
+    EXPECT_THAT(dropped, Gt(0));
+    EXPECT_THAT(written + dropped, Eq(calls));
+}
+
+TEST_F(BinaryTrace, decoding_something_else_throws)
+{
+    std::istringstream in{"This is not a trace file"};
+    std::ostringstream out;
+
+    EXPECT_THROW(mt::decode(in, out), std::runtime_error);
+}
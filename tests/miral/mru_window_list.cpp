@@ -191,3 +191,32 @@ TEST_F(MRUWindowList, hiding_then_showing_windows_retains_order)
     EXPECT_THAT(as_enumerated, ElementsAre(window_c, window_b, window_a));
 }
 
+
+TEST_F(MRUWindowList, enumerator_can_push_the_window_it_is_given)
+{
+    mru_list.push(window_a);
+    mru_list.push(window_b);
+    mru_list.push(window_c);
+
+    std::vector<miral::Window> as_enumerated;
+
+    mru_list.enumerate([&](miral::Window& window)
+       { as_enumerated.push_back(window); mru_list.push(window); return true; });
+
+    EXPECT_THAT(as_enumerated, ElementsAre(window_c, window_b, window_a));
+}
+
+TEST_F(MRUWindowList, enumerator_can_erase_the_window_it_is_given)
+{
+    mru_list.push(window_a);
+    mru_list.push(window_b);
+    mru_list.push(window_c);
+
+    std::vector<miral::Window> as_enumerated;
+
+    mru_list.enumerate([&](miral::Window& window)
+       { as_enumerated.push_back(window); mru_list.erase(window); return true; });
+
+    EXPECT_THAT(as_enumerated, ElementsAre(window_c, window_b, window_a));
+    EXPECT_THAT(mru_list.top(), IsNullWindow());
+}
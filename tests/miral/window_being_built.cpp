@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <mir/shell/surface_specification.h>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+// add_surface() builds the surface without holding the window management lock,
+// so other requests can arrive for a surface that isn't a window yet. Making them
+// from the build function itself lets us test that deterministically.
+struct WindowBeingBuilt : TestWindowManagerTools
+{
+    void SetUp() override
+    {
+        basic_window_manager.add_display_for_testing(display_area);
+        basic_window_manager.add_session(session);
+
+        creation_parameters.size = Size{200, 100};
+    }
+
+    template<typename Action>
+    auto add_surface_and_while_building(Action const& action) -> mir::frontend::SurfaceId
+    {
+        return basic_window_manager.add_surface(
+            session,
+            creation_parameters,
+            [&](std::shared_ptr<mir::scene::Session> const& session, mir::scene::SurfaceCreationParameters const& params)
+            {
+                auto const id = create_surface(session, params);
+                action(session->surface(id));
+                return id;
+            });
+    }
+
+    mir::scene::SurfaceCreationParameters creation_parameters;
+};
+}
+
+TEST_F(WindowBeingBuilt, requests_for_it_are_ignored)
+{
+    EXPECT_CALL(*window_manager_policy, advise_new_window(_));
+
+    add_surface_and_while_building([this](std::shared_ptr<mir::scene::Surface> const& surface)
+        {
+            mir::shell::SurfaceSpecification modifications;
+            modifications.width = Width{300};
+
+            EXPECT_NO_THROW(basic_window_manager.modify_surface(session, surface, modifications));
+            EXPECT_NO_THROW(basic_window_manager.handle_raise_surface(session, surface, 0));
+            EXPECT_NO_THROW(
+                basic_window_manager.set_surface_attribute(session, surface, mir_window_attrib_state, mir_window_state_maximized));
+        });
+}
+
+TEST_F(WindowBeingBuilt, removing_it_does_not_throw)
+{
+    add_surface_and_while_building([this](std::shared_ptr<mir::scene::Surface> const& surface)
+        {
+            EXPECT_NO_THROW(basic_window_manager.remove_surface(session, surface));
+        });
+}
+
+TEST_F(WindowBeingBuilt, is_not_added_if_its_session_is_removed)
+{
+    EXPECT_CALL(*window_manager_policy, advise_new_window(_)).Times(0);
+
+    add_surface_and_while_building([this](std::shared_ptr<mir::scene::Surface> const&)
+        {
+            basic_window_manager.remove_session(session);
+        });
+}
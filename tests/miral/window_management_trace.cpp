@@ -0,0 +1,172 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test_window_manager_tools.h"
+
+#include "binary_trace_writer.h"
+#include "window_management_binary_trace.h"
+#include "window_management_trace.h"
+#include "window_management_trace_decoder.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include <unistd.h>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+auto temporary_file() -> std::string
+{
+    char name[] = "/tmp/miral_trace_XXXXXX";
+    auto const fd = mkstemp(name);
+    if (fd < 0)
+        throw std::system_error(errno, std::system_category(), "Failed to create temp file");
+    close(fd);
+    return name;
+}
+
+// A window manager whose policy is wrapped in a WindowManagementTrace writing a binary trace
+struct TracedWindowManagement : Test
+{
+    void SetUp() override
+    {
+        basic_window_manager.add_display_for_testing(display_area);
+        basic_window_manager.add_session(session);
+    }
+
+    void TearDown() override
+    {
+        unlink(filename.c_str());
+    }
+
+    auto create_window(std::string const& name) -> Window
+    {
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.name = name;
+        creation_parameters.size = Size{200, 100};
+
+        Window window;
+        EXPECT_CALL(*policy, advise_new_window(_))
+            .WillOnce(Invoke([&](WindowInfo const& window_info) { window = window_info.window(); }));
+
+        basic_window_manager.add_surface(session, creation_parameters, &TestWindowManagerTools::create_surface);
+
+        Mock::VerifyAndClearExpectations(policy);
+        return window;
+    }
+
+    auto decoded() const -> std::vector<std::string>
+    {
+        writer->flush();
+
+        std::ifstream in{filename, std::ios::binary};
+        std::stringstream out;
+        trace::decode(in, out);
+
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(out, line);)
+            lines.push_back(line);
+        return lines;
+    }
+
+    std::string const filename{temporary_file()};
+    std::shared_ptr<BinaryTraceWriter> const writer{std::make_shared<BinaryTraceWriter>(filename)};
+
+    StubFocusController focus_controller;
+    StubDisplayLayout display_layout;
+    StubPersistentSurfaceStore persistent_surface_store;
+    StubDisplayConfigurationObserver display_configuration_observer;
+    std::shared_ptr<StubStubSession> session{std::make_shared<StubStubSession>()};
+
+    MockWindowManagerPolicy* policy{nullptr};
+    WindowManagerTools tools{nullptr};
+
+    BasicWindowManager basic_window_manager{
+        &focus_controller,
+        mir::test::fake_shared(display_layout),
+        mir::test::fake_shared(persistent_surface_store),
+        display_configuration_observer,
+        [this](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+            {
+                auto const build_policy = [this](WindowManagerTools const& tools)
+                    -> std::unique_ptr<WindowManagementPolicy>
+                    {
+                        auto policy = std::make_unique<NiceMock<MockWindowManagerPolicy>>(tools);
+                        this->policy = policy.get();
+                        this->tools = tools;
+                        return std::move(policy);
+                    };
+
+                return std::make_unique<WindowManagementTrace>(
+                    tools, build_policy, std::make_shared<WindowManagementBinaryTrace>(writer));
+            }
+    };
+};
+}
+
+TEST_F(TracedWindowManagement, records_windows_by_name)
+{
+    create_window("a window");
+
+    EXPECT_THAT(decoded(), Contains(HasSubstr("advise_new_window window_info=a window")));
+}
+
+TEST_F(TracedWindowManagement, records_calls_the_policy_makes_on_the_tools)
+{
+    auto const window = create_window("a window");
+
+    tools.count_applications();
+    tools.raise_tree(window);
+
+    auto const trace = decoded();
+    EXPECT_THAT(trace, Contains(HasSubstr("count_applications -> 1")));
+    EXPECT_THAT(trace, Contains(HasSubstr("raise_tree root=a window")));
+}
+
+TEST_F(TracedWindowManagement, records_windows_by_their_new_name_when_renamed)
+{
+    auto window = create_window("a window");
+
+    WindowSpecification modifications;
+    modifications.name() = "a renamed window";
+    tools.modify_window(window, modifications);
+    tools.raise_tree(window);
+
+    EXPECT_THAT(decoded(), Contains(HasSubstr("raise_tree root=a renamed window")));
+}
+
+TEST_F(TracedWindowManagement, records_exceptions_and_lets_them_through)
+{
+    EXPECT_CALL(*policy, advise_new_window(_))
+        .WillOnce(Throw(std::runtime_error{"policy failure"}));
+
+    mir::scene::SurfaceCreationParameters creation_parameters;
+    creation_parameters.size = Size{200, 100};
+
+    EXPECT_THROW(
+        basic_window_manager.add_surface(session, creation_parameters, &TestWindowManagerTools::create_surface),
+        std::runtime_error);
+
+    EXPECT_THAT(decoded(), Contains(HasSubstr("advise_new_window throws")));
+}
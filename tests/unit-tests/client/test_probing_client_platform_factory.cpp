@@ -19,11 +19,13 @@
 #include "mir/client/client_platform.h"
 #include "src/client/probing_client_platform_factory.h"
 #include "src/server/report/null_report_factory.h"
+#include "mir/shared_library_prober_report.h"
 
 #include "mir/test/doubles/mock_client_context.h"
 #include "mir_test_framework/executable_path.h"
 #include "mir_test_framework/stub_platform_helpers.h"
 
+#include <boost/filesystem.hpp>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <dlfcn.h>
@@ -136,6 +138,14 @@ std::vector<std::string> all_available_modules()
     return modules;
 }
 
+struct MockSharedLibraryProberReport : mir::SharedLibraryProberReport
+{
+    MOCK_METHOD1(probing_path, void(boost::filesystem::path const&));
+    MOCK_METHOD2(probing_failed, void(boost::filesystem::path const&, std::exception const&));
+    MOCK_METHOD1(loading_library, void(boost::filesystem::path const&));
+    MOCK_METHOD2(loading_failed, void(boost::filesystem::path const&, std::exception const&));
+};
+
 bool loaded(std::string const& path)
 {
     void* x = dlopen(path.c_str(), RTLD_LAZY | RTLD_NOLOAD);
@@ -332,3 +342,49 @@ TEST(ProbingClientPlatformFactory, IgnoresNonClientPlatformModules)
 
     auto platform = factory.create_client_platform(&context);
 }
+
+TEST(ProbingClientPlatformFactory, LoadsOnlyTheModuleNamedByTheServer)
+{
+    using namespace testing;
+
+    auto const fixture = dummy_fixture();
+    boost::filesystem::path const module_file{fixture.client_module_filename};
+    auto const report = std::make_shared<NiceMock<MockSharedLibraryProberReport>>();
+
+    mir::client::ProbingClientPlatformFactory factory(
+        report,
+        {},
+        {module_file.parent_path().string()}, nullptr);
+
+    NiceMock<mtd::MockClientContext> context;
+    fixture.setup_context(context);
+    ON_CALL(context, client_platform_module()).WillByDefault(Return("dummy"));
+
+    EXPECT_CALL(*report, probing_path(_)).Times(0);
+    EXPECT_CALL(*report, loading_library(_)).Times(0);
+    EXPECT_CALL(*report, loading_library(module_file)).Times(1);
+
+    EXPECT_THAT(factory.create_client_platform(&context), NotNull());
+}
+
+TEST(ProbingClientPlatformFactory, ProbesWhenTheModuleNamedByTheServerIsMissing)
+{
+    using namespace testing;
+
+    auto const fixture = dummy_fixture();
+    boost::filesystem::path const module_file{fixture.client_module_filename};
+    auto const report = std::make_shared<NiceMock<MockSharedLibraryProberReport>>();
+
+    mir::client::ProbingClientPlatformFactory factory(
+        report,
+        {},
+        {module_file.parent_path().string()}, nullptr);
+
+    NiceMock<mtd::MockClientContext> context;
+    fixture.setup_context(context);
+    ON_CALL(context, client_platform_module()).WillByDefault(Return("not-a-platform"));
+
+    EXPECT_CALL(*report, probing_path(module_file.parent_path()));
+
+    EXPECT_THAT(factory.create_client_platform(&context), NotNull());
+}
@@ -25,6 +25,8 @@
 #include "mir/geometry/rectangle.h"
 #include "mir/geometry/rectangles.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/scene/observer.h"
+#include "mir/scene/surface_observer.h"
 
 #include "mir/test/doubles/null_display.h"
 #include "mir/test/doubles/null_display_buffer_compositor_factory.h"
@@ -35,6 +37,7 @@
 #include "mir/test/doubles/stub_scene.h"
 #include "mir/test/doubles/stub_scene_element.h"
 #include "mir/test/doubles/mock_scene.h"
+#include "mir/test/doubles/stub_scene_surface.h"
 
 #include "mir/test/as_render_target.h"
 #include "mir/test/fake_shared.h"
@@ -49,6 +52,7 @@
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 namespace mf = mir::frontend;
+namespace ms = mir::scene;
 namespace mtd = mir::test::doubles;
 namespace mt = mir::test;
 namespace mrgl = mir::renderer::gl;
@@ -119,6 +123,56 @@ private:
     std::vector<geom::Rectangle> const display_regions;
 };
 
+// A surface that reports frames posted through its observers
+struct PostingSurface : mtd::StubSceneSurface
+{
+    void add_observer(std::shared_ptr<ms::SurfaceObserver> const& observer) override
+    {
+        observers.push_back(observer);
+    }
+
+    void post_frame(geom::Size const& size)
+    {
+        for (auto const& observer : observers)
+            observer->frame_posted(1, size);
+    }
+
+    std::vector<std::shared_ptr<ms::SurfaceObserver>> observers;
+};
+
+class ObservableScene : public mtd::StubScene
+{
+public:
+    void add_observer(std::shared_ptr<ms::Observer> const& observer) override
+    {
+        observers.push_back(observer);
+        observer->surface_added(&surface);
+    }
+
+    int frames_pending(mc::CompositorID) const override
+    {
+        return pending;
+    }
+
+    void change()
+    {
+        for (auto const& observer : observers)
+            observer->scene_changed();
+    }
+
+    // A surface at the origin posts a frame of the given size
+    void post_frame(geom::Size const& size)
+    {
+        surface.post_frame(size);
+    }
+
+    int pending{0};
+
+private:
+    PostingSurface surface;
+    std::vector<std::shared_ptr<ms::Observer>> observers;
+};
+
 struct MockDisplayBufferCompositor : mc::DisplayBufferCompositor
 {
     void composite(mc::SceneElementSequence&& seq)
@@ -494,8 +548,10 @@ TEST_F(CompositingScreencastTest, uses_requested_number_of_buffers)
         .WillOnce(Return(mt::fake_shared(buffers[2])))
         .WillOnce(Return(mt::fake_shared(buffers[3])));
 
+    ObservableScene scene;
+
     mc::CompositingScreencast screencast_local{
-        mt::fake_shared(stub_scene),
+        mt::fake_shared(scene),
         mt::fake_shared(stub_display),
         mt::fake_shared(mock_buffer_allocator),
         mt::fake_shared(stub_db_compositor_factory)};
@@ -508,7 +564,146 @@ TEST_F(CompositingScreencastTest, uses_requested_number_of_buffers)
     {
         auto buffer = screencast_local.capture(session_id);
         ASSERT_EQ(&buffers[i], buffer.get());
+        scene.change();
     }
 }
 
+TEST_F(CompositingScreencastTest, does_not_composite_again_if_nothing_changed)
+{
+    using namespace testing;
+
+    ObservableScene scene;
+    MockDisplayBufferCompositorFactory mock_db_compositor_factory;
+
+    EXPECT_CALL(mock_db_compositor_factory, create_compositor_mock(_));
+    EXPECT_CALL(mock_db_compositor_factory.mock_db_compositor, composite_(_))
+        .Times(1);
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
+
+    auto session_id = screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        default_num_buffers, default_mirror_mode);
+
+    auto const first = screencast_local.capture(session_id);
+    auto const second = screencast_local.capture(session_id);
+
+    EXPECT_THAT(second, Eq(first));
+}
+
+TEST_F(CompositingScreencastTest, composites_again_after_scene_changes)
+{
+    using namespace testing;
+
+    ObservableScene scene;
+    MockDisplayBufferCompositorFactory mock_db_compositor_factory;
+
+    EXPECT_CALL(mock_db_compositor_factory, create_compositor_mock(_));
+    EXPECT_CALL(mock_db_compositor_factory.mock_db_compositor, composite_(_))
+        .Times(3);
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
+
+    auto session_id = screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        default_num_buffers, default_mirror_mode);
+
+    screencast_local.capture(session_id);
+    scene.change();
+    screencast_local.capture(session_id);
+    scene.post_frame(default_size);
+    screencast_local.capture(session_id);
+}
+
+TEST_F(CompositingScreencastTest, ignores_frames_posted_outside_capture_region)
+{
+    using namespace testing;
+
+    ObservableScene scene;
+    MockDisplayBufferCompositorFactory mock_db_compositor_factory;
+    geom::Rectangle const region_away_from_origin{{100, 100}, {100, 100}};
+
+    EXPECT_CALL(mock_db_compositor_factory, create_compositor_mock(_));
+    EXPECT_CALL(mock_db_compositor_factory.mock_db_compositor, composite_(_))
+        .Times(1);
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
+
+    auto session_id = screencast_local.create_session(
+        region_away_from_origin, default_size, default_pixel_format,
+        default_num_buffers, default_mirror_mode);
+
+    screencast_local.capture(session_id);
+    scene.post_frame({50, 50});
+    screencast_local.capture(session_id);
+}
+
+TEST_F(CompositingScreencastTest, composites_again_while_frames_are_pending)
+{
+    using namespace testing;
+
+    ObservableScene scene;
+    scene.pending = 1;
+    MockDisplayBufferCompositorFactory mock_db_compositor_factory;
+
+    EXPECT_CALL(mock_db_compositor_factory, create_compositor_mock(_));
+    EXPECT_CALL(mock_db_compositor_factory.mock_db_compositor, composite_(_))
+        .Times(2);
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
+
+    auto session_id = screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        default_num_buffers, default_mirror_mode);
+
+    screencast_local.capture(session_id);
+    screencast_local.capture(session_id);
+}
+
+TEST_F(CompositingScreencastTest, does_not_composite_to_buffer_that_is_up_to_date)
+{
+    using namespace testing;
+
+    mtd::StubGLBuffer buffer1;
+    mtd::StubGLBuffer buffer2;
+    ObservableScene scene;
+    MockDisplayBufferCompositorFactory mock_db_compositor_factory;
+
+    EXPECT_CALL(mock_db_compositor_factory, create_compositor_mock(_));
+    EXPECT_CALL(mock_db_compositor_factory.mock_db_compositor, composite_(_))
+        .Times(3);
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
+
+    auto session_id = screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        0, default_mirror_mode);
+
+    screencast_local.capture(session_id, mt::fake_shared(buffer1));
+    screencast_local.capture(session_id, mt::fake_shared(buffer1));
+    screencast_local.capture(session_id, mt::fake_shared(buffer2));
+    scene.change();
+    screencast_local.capture(session_id, mt::fake_shared(buffer1));
+}
+
 
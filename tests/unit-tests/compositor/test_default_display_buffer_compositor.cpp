@@ -22,6 +22,7 @@
 #include "mir/compositor/scene.h"
 #include "mir/renderer/renderer.h"
 #include "mir/geometry/rectangle.h"
+#include "mir/graphics/overlay_planes.h"
 #include "mir/test/doubles/mock_renderer.h"
 #include "mir/test/fake_shared.h"
 #include "mir/test/gmock_fixes.h"
@@ -388,3 +389,55 @@ TEST_F(DefaultDisplayBufferCompositor, marks_occluded_scene_elements)
     compositor.composite({element0_occluded, element1_rendered, element2_occluded});
 }
 
+
+namespace
+{
+struct MockOverlayPlanesDisplayBuffer : mtd::MockDisplayBuffer, mg::OverlayPlanes
+{
+    using mtd::MockDisplayBuffer::overlay;
+    using mtd::MockDisplayBuffer::gmock_overlay;
+    MOCK_METHOD2(overlay, bool(mg::RenderableList const&, mg::RenderableList&));
+};
+}
+
+TEST_F(DefaultDisplayBufferCompositor, renders_only_what_overlay_planes_leave)
+{
+    using namespace testing;
+    NiceMock<MockOverlayPlanesDisplayBuffer> planes_display_buffer;
+    ON_CALL(planes_display_buffer, view_area())
+        .WillByDefault(Return(screen));
+
+    mg::RenderableList const remainder{big};
+
+    EXPECT_CALL(planes_display_buffer, overlay(_))
+        .Times(0);
+    EXPECT_CALL(planes_display_buffer, overlay(ContainerEq(mg::RenderableList{big, small}), _))
+        .WillOnce(DoAll(SetArgReferee<1>(remainder), Return(false)));
+    EXPECT_CALL(mock_renderer, render(ContainerEq(remainder)));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        planes_display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, skips_rendering_when_overlay_planes_take_everything)
+{
+    using namespace testing;
+    NiceMock<MockOverlayPlanesDisplayBuffer> planes_display_buffer;
+    ON_CALL(planes_display_buffer, view_area())
+        .WillByDefault(Return(screen));
+
+    EXPECT_CALL(planes_display_buffer, overlay(_, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_renderer, render(_))
+        .Times(0);
+    EXPECT_CALL(mock_renderer, suspend());
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        planes_display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+    compositor.composite(make_scene_elements({big, small}));
+}
@@ -22,6 +22,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <thread>
+
 using namespace testing;
 namespace mtd = mir::test::doubles;
 namespace mt = mir::test;
@@ -86,3 +89,42 @@ TEST_F(DroppingSchedule, queueing_same_buffer_many_times_doesnt_drop)
     ASSERT_THAT(queue, SizeIs(1));
     EXPECT_THAT(queue[0]->id(), Eq(buffers[2]->id()));
 }
+
+TEST_F(DroppingSchedule, releases_scheduled_buffer_when_destroyed)
+{
+    {
+        mc::DroppingSchedule short_lived_schedule;
+        short_lived_schedule.schedule(buffers[0]);
+        EXPECT_FALSE(buffers[0].unique());
+    }
+
+    EXPECT_TRUE(buffers[0].unique());
+}
+
+TEST_F(DroppingSchedule, concurrent_schedule_and_take_hand_over_each_buffer_at_most_once)
+{
+    int const frames{10000};
+    std::atomic<bool> done{false};
+    std::vector<std::shared_ptr<mg::Buffer>> taken;
+
+    std::thread compositor{
+        [&]
+        {
+            while (!done || schedule.num_scheduled())
+            {
+                if (schedule.num_scheduled())
+                    taken.emplace_back(schedule.next_buffer());
+            }
+        }};
+
+    for (int i = 0; i != frames; ++i)
+        schedule.schedule(buffers[i % num_buffers]);
+    done = true;
+    compositor.join();
+
+    EXPECT_THAT(taken.size(), Le(static_cast<size_t>(frames)));
+    EXPECT_FALSE(schedule.num_scheduled());
+    taken.clear();
+    for (auto const& buffer : buffers)
+        EXPECT_TRUE(buffer.unique());
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/compositor/frame_arena.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <thread>
+#include <cstdint>
+
+using namespace testing;
+namespace mc = mir::compositor;
+
+namespace
+{
+struct FrameArena : Test
+{
+    size_t const block_size{4096};
+    mc::FrameArena arena{block_size};
+};
+
+struct Counted
+{
+    Counted(int value, int& live) : value{value}, live{live} { ++live; }
+    ~Counted() { --live; }
+
+    int const value;
+    int& live;
+};
+}
+
+TEST_F(FrameArena, allocations_are_distinct_and_aligned)
+{
+    auto const a = arena.allocate(3, 1);
+    auto const b = arena.allocate(8, 8);
+    auto const c = arena.allocate(16, 16);
+
+    EXPECT_THAT(a, Ne(b));
+    EXPECT_THAT(b, Ne(c));
+    EXPECT_THAT(reinterpret_cast<uintptr_t>(b) % 8, Eq(0u));
+    EXPECT_THAT(reinterpret_cast<uintptr_t>(c) % 16, Eq(0u));
+    EXPECT_THAT(arena.bytes_allocated(), Eq(27u));
+
+    for (auto const p : {a, b, c})
+        mc::FrameArena::deallocate(p);
+}
+
+TEST_F(FrameArena, steady_state_frames_take_nothing_from_the_heap)
+{
+    for (int frame = 0; frame != 3; ++frame)
+    {
+        std::vector<void*> allocations;
+        for (int i = 0; i != 100; ++i)
+            allocations.push_back(arena.allocate(64, 8));
+
+        if (frame > 0)
+        {
+            EXPECT_THAT(arena.heap_allocations(), Eq(0u)) << "frame " << frame;
+        }
+
+        for (auto const p : allocations)
+            mc::FrameArena::deallocate(p);
+        arena.reset();
+    }
+}
+
+TEST_F(FrameArena, takes_large_allocations_from_the_heap)
+{
+    auto const p = arena.allocate(block_size * 2, 8);
+
+    EXPECT_THAT(arena.heap_allocations(), Eq(1u));
+
+    mc::FrameArena::deallocate(p);
+}
+
+TEST_F(FrameArena, objects_can_outlive_their_frame_and_arena)
+{
+    int live = 0;
+    std::shared_ptr<Counted> survivor;
+
+    {
+        mc::FrameArena short_lived{block_size};
+        mc::FrameArena::Scope const scope{short_lived};
+
+        survivor = mc::make_frame_shared<Counted>(42, live);
+        mc::make_frame_shared<Counted>(7, live);
+
+        short_lived.reset();
+        mc::make_frame_shared<Counted>(9, live);
+    }
+
+    EXPECT_THAT(survivor->value, Eq(42));
+    EXPECT_THAT(live, Eq(1));
+
+    survivor.reset();
+    EXPECT_THAT(live, Eq(0));
+}
+
+TEST_F(FrameArena, objects_can_be_released_on_other_threads)
+{
+    int live = 0;
+    mc::FrameArena::Scope const scope{arena};
+
+    auto object = mc::make_frame_shared<Counted>(1, live);
+    arena.reset();
+
+    std::thread{[object = std::move(object)]() mutable { object.reset(); }}.join();
+
+    EXPECT_THAT(live, Eq(0));
+}
+
+TEST_F(FrameArena, make_frame_shared_uses_the_arena_only_while_it_is_current)
+{
+    int live = 0;
+
+    auto const from_heap = mc::make_frame_shared<Counted>(1, live);
+    EXPECT_THAT(arena.bytes_allocated(), Eq(0u));
+
+    {
+        mc::FrameArena::Scope const scope{arena};
+        EXPECT_THAT(mc::FrameArena::current(), Eq(&arena));
+
+        auto const from_arena = mc::make_frame_shared<Counted>(2, live);
+        EXPECT_THAT(arena.bytes_allocated(), Gt(0u));
+    }
+
+    EXPECT_THAT(mc::FrameArena::current(), IsNull());
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/compositor/frame_scheduler.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std::literals::chrono_literals;
+namespace mc = mir::compositor;
+namespace geom = mir::geometry;
+
+namespace
+{
+struct FrameScheduler : Test
+{
+    FrameScheduler()
+    {
+        left = scheduler.add_output({{0, 0}, {1920, 1080}});
+        right = scheduler.add_output({{1920, 0}, {2560, 1440}});
+
+        scheduler.schedule(1);
+        scheduler.posted(scheduler.start_frame(now), now, 0ms);
+    }
+
+    mc::FrameScheduler scheduler;
+    mc::FrameScheduler::Clock::time_point const now{mc::FrameScheduler::Clock::now()};
+    size_t left;
+    size_t right;
+};
+}
+
+TEST_F(FrameScheduler, initially_composites_every_output_once)
+{
+    mc::FrameScheduler fresh;
+    fresh.add_output({{0, 0}, {1920, 1080}});
+    fresh.add_output({{1920, 0}, {2560, 1440}});
+
+    EXPECT_FALSE(fresh.has_work());
+    EXPECT_TRUE(fresh.schedule(1, geom::Rectangle{{0, 0}, {1, 1}}));
+    EXPECT_THAT(fresh.start_frame(now), ElementsAre(0, 1));
+    EXPECT_FALSE(fresh.has_work());
+}
+
+TEST_F(FrameScheduler, composites_only_outputs_that_took_damage)
+{
+    EXPECT_TRUE(scheduler.schedule(1, geom::Rectangle{{2000, 100}, {10, 10}}));
+
+    EXPECT_THAT(scheduler.start_frame(now), ElementsAre(right));
+    EXPECT_FALSE(scheduler.has_work());
+}
+
+TEST_F(FrameScheduler, damage_elsewhere_adds_no_work)
+{
+    EXPECT_FALSE(scheduler.schedule(1, geom::Rectangle{{0, 2000}, {10, 10}}));
+    EXPECT_FALSE(scheduler.has_work());
+}
+
+TEST_F(FrameScheduler, drains_each_outputs_pending_frames_separately)
+{
+    scheduler.schedule_output(left, 3);
+    scheduler.schedule_output(right, 1);
+
+    EXPECT_THAT(scheduler.start_frame(now), ElementsAre(left, right));
+    EXPECT_THAT(scheduler.start_frame(now), ElementsAre(left));
+    EXPECT_THAT(scheduler.start_frame(now), ElementsAre(left));
+    EXPECT_THAT(scheduler.start_frame(now), IsEmpty());
+}
+
+TEST_F(FrameScheduler, scheduling_fewer_frames_than_already_scheduled_adds_no_work)
+{
+    EXPECT_TRUE(scheduler.schedule(2));
+    EXPECT_FALSE(scheduler.schedule(1));
+    EXPECT_FALSE(scheduler.schedule(2, geom::Rectangle{{0, 0}, {10, 10}}));
+}
+
+TEST_F(FrameScheduler, outputs_are_not_due_until_their_delay_after_posting)
+{
+    scheduler.schedule(1);
+    auto const posted = scheduler.start_frame(now);
+    scheduler.posted({left}, now, 16ms);
+    scheduler.posted({right}, now, 6ms);
+    scheduler.schedule(1);
+
+    EXPECT_THAT(posted, ElementsAre(left, right));
+    EXPECT_THAT(scheduler.next_due(), Eq(now + 6ms));
+    EXPECT_THAT(scheduler.start_frame(now + 1ms), IsEmpty());
+    EXPECT_THAT(scheduler.start_frame(now + 7ms), ElementsAre(right));
+    EXPECT_THAT(scheduler.next_due(), Eq(now + 16ms));
+    EXPECT_THAT(scheduler.start_frame(now + 16ms), ElementsAre(left));
+}
+
+TEST_F(FrameScheduler, an_output_that_is_not_due_does_not_hold_back_the_others)
+{
+    scheduler.posted({left}, now, 100ms);
+    scheduler.schedule(1);
+
+    EXPECT_THAT(scheduler.next_due(), Eq(now));
+    EXPECT_THAT(scheduler.start_frame(now), ElementsAre(right));
+    EXPECT_TRUE(scheduler.has_work());
+}
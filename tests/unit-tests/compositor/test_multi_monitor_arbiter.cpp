@@ -619,3 +619,22 @@ TEST_F(MultiMonitorArbiter, releases_buffer_on_destruction)
     }
     EXPECT_TRUE(*buffer_released);
 }
+
+TEST_F(MultiMonitorArbiter, tracks_consumption_for_many_compositors)
+{
+    std::vector<int> comp_ids(200);
+    schedule.set_schedule({buffers[0]});
+
+    for (auto& id : comp_ids)
+    {
+        EXPECT_THAT(arbiter.compositor_acquire(&id), IsSameBufferAs(buffers[0]));
+        EXPECT_FALSE(arbiter.buffer_ready_for(&id));
+    }
+
+    schedule.set_schedule({buffers[1]});
+    for (auto& id : comp_ids)
+        EXPECT_TRUE(arbiter.buffer_ready_for(&id));
+
+    EXPECT_THAT(arbiter.compositor_acquire(&comp_ids.back()), IsSameBufferAs(buffers[1]));
+    EXPECT_FALSE(arbiter.buffer_ready_for(&comp_ids.back()));
+}
@@ -24,6 +24,7 @@
 #include "mir/compositor/scene.h"
 #include "mir/compositor/display_buffer_compositor_factory.h"
 #include "mir/scene/observer.h"
+#include "mir/scene/surface_observer.h"
 #include "mir/raii.h"
 
 #include "mir/test/current_thread_name.h"
@@ -32,9 +33,11 @@
 #include "mir/test/doubles/mock_display_buffer.h"
 #include "mir/test/doubles/mock_compositor_report.h"
 #include "mir/test/doubles/mock_scene.h"
+#include "mir/test/doubles/stub_scene_surface.h"
 #include "mir/test/doubles/stub_scene.h"
 #include "mir/test/doubles/stub_display.h"
 #include "mir/test/doubles/null_display_buffer_compositor_factory.h"
+#include "mir/test/doubles/null_thread_scheduler.h"
 
 #include <boost/throw_exception.hpp>
 
@@ -131,6 +134,12 @@ public:
         std::this_thread::yield();
     }
 
+    void add_surface(ms::Surface* surface)
+    {
+        std::lock_guard<std::mutex> lock{observer_mutex};
+        observer->surface_added(surface);
+    }
+
     void throw_on_add_observer(bool flag)
     {
         throw_on_add_observer_ = flag;
@@ -244,6 +253,14 @@ public:
         return true;
     }
 
+    unsigned int record_count_for(mg::DisplayBuffer& display_buffer)
+    {
+        std::lock_guard<std::mutex> lk{m};
+
+        auto const record = records.find(&display_buffer);
+        return record == records.end() ? 0 : record->second.first;
+    }
+
     bool check_record_count_for_each_buffer(
             unsigned int nbuffers,
             unsigned int min,
@@ -359,10 +376,17 @@ struct MockDisplayListener : mc::DisplayListener
     MOCK_METHOD1(remove_display, void(geom::Rectangle const& /*area*/));
 };
 
+struct MockThreadScheduler : mir::ThreadScheduler
+{
+    MOCK_METHOD1(compositor_thread_started, void(std::string const&));
+    MOCK_METHOD0(input_thread_started, void());
+};
+
 auto const null_report = mr::null_compositor_report();
 unsigned int const composites_per_update{1};
 auto const null_display_listener = std::make_shared<StubDisplayListener>();
 std::chrono::milliseconds const default_delay{-1};
+auto const null_thread_scheduler = std::make_shared<mtd::NullThreadScheduler>();
 
 }
 
@@ -375,7 +399,7 @@ TEST(MultiThreadedCompositor, compositing_happens_in_different_threads)
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true, null_thread_scheduler};
 
     compositor.start();
 
@@ -417,7 +441,8 @@ TEST(MultiThreadedCompositor, does_not_deadlock_itself)
         std::make_shared<ReentrantDisplayListener>(scene),
         null_report,
         default_delay,
-        true
+        true,
+        null_thread_scheduler
     };
 
     for (int i = 0; i < 1000; ++i)
@@ -442,7 +467,8 @@ TEST(MultiThreadedCompositor, reports_in_the_right_places)
                                            null_display_listener,
                                            mock_report,
                                            default_delay,
-                                           true};
+                                           true,
+                                           null_thread_scheduler};
 
     EXPECT_CALL(*mock_report, started())
         .Times(1);
@@ -486,7 +512,7 @@ TEST(MultiThreadedCompositor, composites_only_on_demand)
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true, null_thread_scheduler};
 
     // Verify we're actually starting at zero frames
     EXPECT_TRUE(db_compositor_factory->check_record_count_for_each_buffer(nbuffers, 0, 0));
@@ -547,7 +573,7 @@ TEST(MultiThreadedCompositor, schedules_enough_frames)
     auto scene = std::make_shared<StubScene>();
     auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
     mc::MultiThreadedCompositor compositor{display, scene, factory,
-                                           null_display_listener, null_report, default_delay, true};
+                                           null_display_listener, null_report, default_delay, true, null_thread_scheduler};
 
     EXPECT_TRUE(factory->check_record_count_for_each_buffer(nbuffers, 0, 0));
 
@@ -623,7 +649,7 @@ TEST(MultiThreadedCompositor, recommended_sleep_throttles_compositor_loop)
     auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
     mc::MultiThreadedCompositor compositor{display, scene, factory,
                                            null_display_listener, null_report,
-                                           recommendation, false};
+                                           recommendation, false, null_thread_scheduler};
 
     EXPECT_TRUE(factory->check_record_count_for_each_buffer(nbuffers, 0, 0));
 
@@ -671,7 +697,7 @@ TEST(MultiThreadedCompositor, when_no_initial_composite_is_needed_there_is_none)
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, false};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, false, null_thread_scheduler};
 
     // Verify we're actually starting at zero frames
     ASSERT_TRUE(db_compositor_factory->check_record_count_for_each_buffer(nbuffers, 0, 0));
@@ -694,7 +720,7 @@ TEST(MultiThreadedCompositor, when_no_initial_composite_is_needed_we_still_compo
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, false};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, false, null_thread_scheduler};
 
     compositor.start();
 
@@ -729,7 +755,7 @@ TEST(MultiThreadedCompositor, surface_update_from_render_doesnt_deadlock)
     auto display = std::make_shared<mtd::StubDisplay>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<SurfaceUpdatingDisplayBufferCompositorFactory>(scene);
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true, null_thread_scheduler};
 
     compositor.start();
 
@@ -761,7 +787,7 @@ TEST(MultiThreadedCompositor, double_start_or_stop_ignored)
         .Times(AtLeast(0))
         .WillRepeatedly(Return(mc::SceneElementSequence{}));
 
-    mc::MultiThreadedCompositor compositor{display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true, null_thread_scheduler};
 
     compositor.start();
     compositor.start();
@@ -776,7 +802,7 @@ TEST(MultiThreadedCompositor, cleans_up_after_throw_in_start)
     auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true, null_thread_scheduler};
 
     scene->throw_on_add_observer(true);
 
@@ -826,7 +852,7 @@ TEST(MultiThreadedCompositor, names_compositor_threads)
     auto display = std::make_shared<StubDisplayWithMockBuffers>(nbuffers);
     auto scene = std::make_shared<StubScene>();
     auto db_compositor_factory = std::make_shared<ThreadNameDisplayBufferCompositorFactory>();
-    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true, null_thread_scheduler};
 
     compositor.start();
 
@@ -843,6 +869,40 @@ TEST(MultiThreadedCompositor, names_compositor_threads)
         EXPECT_THAT(thread_names[i], Eq("Mir/Comp")) << "i=" << i;
 }
 
+TEST(MultiThreadedCompositor, names_compositor_threads_after_their_outputs)
+{
+    using namespace testing;
+
+    std::vector<geom::Rectangle> const outputs{
+        {{0, 0}, {640, 480}},
+        {{640, 0}, {640, 480}}};
+
+    auto display = std::make_shared<mtd::StubDisplay>(outputs);
+    auto scene = std::make_shared<StubScene>();
+    auto db_compositor_factory = std::make_shared<ThreadNameDisplayBufferCompositorFactory>();
+    auto thread_scheduler = std::make_shared<NiceMock<MockThreadScheduler>>();
+
+    EXPECT_CALL(*thread_scheduler, compositor_thread_started("VGA-1"));
+    EXPECT_CALL(*thread_scheduler, compositor_thread_started("VGA-2"));
+
+    mc::MultiThreadedCompositor compositor{
+        display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true, thread_scheduler};
+
+    compositor.start();
+
+    unsigned int const min_number_of_thread_names = 10;
+
+    while (db_compositor_factory->num_thread_names_gathered() < min_number_of_thread_names)
+        scene->emit_change_event();
+
+    compositor.stop();
+
+    auto const& thread_names = db_compositor_factory->thread_names;
+
+    for (size_t i = 0; i < thread_names.size(); ++i)
+        EXPECT_THAT(thread_names[i], AnyOf(Eq("Mir/Comp/VGA-1"), Eq("Mir/Comp/VGA-2"))) << "i=" << i;
+}
+
 TEST(MultiThreadedCompositor, registers_and_unregisters_with_scene)
 {
     using namespace testing;
@@ -855,7 +915,7 @@ TEST(MultiThreadedCompositor, registers_and_unregisters_with_scene)
     EXPECT_CALL(*mock_scene, register_compositor(_))
         .Times(nbuffers);
     mc::MultiThreadedCompositor compositor{
-        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true};
+        display, mock_scene, db_compositor_factory, null_display_listener, mock_report, default_delay, true, null_thread_scheduler};
 
     compositor.start();
 
@@ -878,7 +938,7 @@ TEST(MultiThreadedCompositor, notifies_about_display_additions_and_removals)
     auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
 
     mc::MultiThreadedCompositor compositor{
-        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
+        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true, null_thread_scheduler};
 
     EXPECT_CALL(*mock_display_listener, add_display(_)).Times(nbuffers);
 
@@ -900,7 +960,7 @@ TEST(MultiThreadedCompositor, when_compositor_thread_fails_start_reports_error)
     auto mock_report = std::make_shared<testing::NiceMock<mtd::MockCompositorReport>>();
 
     mc::MultiThreadedCompositor compositor{
-        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
+        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true, null_thread_scheduler};
 
     EXPECT_CALL(*mock_display_listener, add_display(_))
         .WillRepeatedly(Throw(std::runtime_error("Failed to add display")));
@@ -923,7 +983,7 @@ TEST(MultiThreadedCompositor, can_schedule_from_display_observer_when_adding_dis
         .WillByDefault(InvokeWithoutArgs([&]{ stub_scene->emit_change_event(); }));
 
     mc::MultiThreadedCompositor compositor{
-        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
+        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true, null_thread_scheduler};
     compositor.start();
 }
 
@@ -941,6 +1001,101 @@ TEST(MultiThreadedCompositor, can_schedule_from_display_observer_when_removing_d
         .WillByDefault(InvokeWithoutArgs([&]{ stub_scene->emit_change_event(); }));
 
     mc::MultiThreadedCompositor compositor{
-        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true};
+        display, stub_scene, db_compositor_factory, mock_display_listener, mock_report, default_delay, true, null_thread_scheduler};
     compositor.start();
 }
+
+TEST(MultiThreadedCompositor, composites_only_the_outputs_of_a_group_that_took_damage)
+{
+    using namespace testing;
+
+    struct StubDisplayWithOneGroup : mtd::NullDisplay
+    {
+        void for_each_display_sync_group(std::function<void(mg::DisplaySyncGroup&)> const& f) override
+        {
+            f(group);
+        }
+
+        mtd::StubDisplaySyncGroup group{{{{0, 0}, {640, 480}}, {{640, 0}, {640, 480}}}};
+    };
+
+    auto display = std::make_shared<StubDisplayWithOneGroup>();
+    auto scene = std::make_shared<StubScene>();
+    auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{
+        display, scene, factory, null_display_listener, null_report, default_delay, true, null_thread_scheduler};
+
+    std::vector<mg::DisplayBuffer*> buffers;
+    display->group.for_each_display_buffer([&](mg::DisplayBuffer& buffer) { buffers.push_back(&buffer); });
+    auto& left = *buffers[0];
+    auto& right = *buffers[1];
+
+    struct ObservedSurface : mtd::StubSceneSurface
+    {
+        void add_observer(std::shared_ptr<ms::SurfaceObserver> const& observer) override
+        {
+            this->observer = observer;
+        }
+
+        std::shared_ptr<ms::SurfaceObserver> observer;
+    } surface;
+
+    compositor.start();
+
+    int const max_retries = 100;
+    int retry = 0;
+    while (retry < max_retries && !factory->check_record_count_for_each_buffer(2, 1))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ++retry;
+    }
+    ASSERT_LT(retry, max_retries);
+
+    scene->add_surface(&surface);
+    ASSERT_THAT(surface.observer, NotNull());
+    surface.observer->frame_posted(1, {10, 10});
+
+    retry = 0;
+    while (retry < max_retries && factory->record_count_for(left) < 2)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ++retry;
+    }
+    ASSERT_LT(retry, max_retries);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_THAT(factory->record_count_for(right), Eq(1u));
+
+    compositor.stop();
+}
+
+TEST(MultiThreadedCompositor, stopping_is_not_delayed_by_throttling)
+{
+    using namespace testing;
+    using namespace std::chrono;
+
+    auto display = std::make_shared<mtd::StubDisplay>(1);
+    auto scene = std::make_shared<StubScene>();
+    auto factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{
+        display, scene, factory, null_display_listener, null_report, 10s, true, null_thread_scheduler};
+
+    compositor.start();
+
+    int const max_retries = 100;
+    int retry = 0;
+    while (retry < max_retries && !factory->check_record_count_for_each_buffer(1, 1))
+    {
+        std::this_thread::sleep_for(milliseconds(10));
+        ++retry;
+    }
+    ASSERT_LT(retry, max_retries);
+
+    scene->emit_change_event();
+
+    auto const start = steady_clock::now();
+    compositor.stop();
+
+    EXPECT_THAT(steady_clock::now() - start, Lt(5s));
+    EXPECT_TRUE(factory->check_record_count_for_each_buffer(1, 1, 1));
+}
@@ -24,6 +24,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <mutex>
+#include <set>
+
 namespace mt = mir::test;
 
 namespace
@@ -33,10 +36,14 @@ struct StubConnectorReport : mir::report::null::ConnectorReport
 {
     void thread_start()
     {
+        std::lock_guard<std::mutex> lock{mutex};
         thread_name = mt::current_thread_name();
+        thread_names.insert(thread_name);
     }
 
+    std::mutex mutex;
     std::string thread_name;
+    std::set<std::string> thread_names;
 };
 
 }
@@ -47,10 +54,24 @@ TEST(BasicConnector, names_ipc_threads)
 
     StubConnectorReport report;
 
-    mir::frontend::BasicConnector connector{{}, mt::fake_shared(report)};
+    mir::frontend::BasicConnector connector{{}, 1, mt::fake_shared(report)};
 
     connector.start();
     connector.stop();
 
     EXPECT_THAT(report.thread_name, Eq("Mir/IPC"));
 }
+
+TEST(BasicConnector, runs_a_pool_of_ipc_threads)
+{
+    using namespace testing;
+
+    StubConnectorReport report;
+
+    mir::frontend::BasicConnector connector{{}, 3, mt::fake_shared(report)};
+
+    connector.start();
+    connector.stop();
+
+    EXPECT_THAT(report.thread_names, ElementsAre("Mir/IPC/0", "Mir/IPC/1", "Mir/IPC/2"));
+}
@@ -129,3 +129,23 @@ TEST_F(ResourceCache, fds_are_saved)
     for(auto raw_fd : raw_fds)
         EXPECT_THAT(raw_fd, Not(RawFdIsValid()));
 }
+
+TEST(ConnectionResourceCache, unfreed_resources_are_released_with_the_cache)
+{
+    using namespace mir::test::doubles;
+    using namespace testing;
+
+    mir::protobuf::Void key;
+    auto const raw_fd = fileno(tmpfile());
+
+    {
+        mir::frontend::ResourceCache connection_cache;
+        connection_cache.save_resource(&key, std::make_shared<TestResource>());
+        connection_cache.save_fd(&key, mir::Fd(raw_fd));
+
+        EXPECT_EQ(1, TestResource::instances.load());
+    }
+
+    EXPECT_EQ(0, TestResource::instances.load());
+    EXPECT_THAT(raw_fd, Not(RawFdIsValid()));
+}
@@ -277,6 +277,45 @@ TEST(DisplayConfiguration, outputs_with_different_form_factors_compare_unequal)
     EXPECT_NE(b, a);
 }
 
+TEST(DisplayConfiguration, outputs_with_different_vrr_enablement_compare_unequal)
+{
+    mg::DisplayConfigurationOutput a = tmpl_output;
+    mg::DisplayConfigurationOutput b = tmpl_output;
+
+    a.vrr_capable = b.vrr_capable = true;
+    EXPECT_EQ(a, b);
+    b.vrr_enabled = true;
+    EXPECT_NE(a, b);
+    EXPECT_NE(b, a);
+}
+
+TEST(DisplayConfiguration, refresh_range_is_current_mode_rate_without_vrr)
+{
+    mg::DisplayConfigurationOutput out = tmpl_output;
+
+    out.current_mode_index = 0;
+    out.min_vrr_hz = 48.0;
+    out.max_vrr_hz = 144.0;
+    out.vrr_enabled = true;  // ...but not vrr_capable
+
+    EXPECT_EQ(60.0, out.min_refresh_hz());
+    EXPECT_EQ(60.0, out.max_refresh_hz());
+}
+
+TEST(DisplayConfiguration, refresh_range_is_vrr_range_when_enabled)
+{
+    mg::DisplayConfigurationOutput out = tmpl_output;
+
+    out.vrr_capable = true;
+    out.min_vrr_hz = 48.0;
+    out.max_vrr_hz = 144.0;
+    EXPECT_EQ(59.0, out.max_refresh_hz());
+
+    out.vrr_enabled = true;
+    EXPECT_EQ(48.0, out.min_refresh_hz());
+    EXPECT_EQ(144.0, out.max_refresh_hz());
+}
+
 TEST(DisplayConfiguration, output_extents_uses_current_mode)
 {
     mg::DisplayConfigurationOutput out = tmpl_output;
@@ -32,6 +32,7 @@
 #include "mir/test/fake_shared.h"
 #include "mir/test/doubles/stub_scene_surface.h"
 #include "mir/test/doubles/stub_input_scene.h"
+#include "mir/test/doubles/fake_alarm_factory.h"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -66,6 +67,31 @@ struct NamedCursorImage : public mg::CursorImage
     std::string const cursor_name;
 };
 
+struct AnimatedCursorImage : public NamedCursorImage
+{
+    AnimatedCursorImage(
+        std::initializer_list<std::string> frame_names,
+        std::chrono::milliseconds frame_delay)
+        : NamedCursorImage(*frame_names.begin()),
+          frame_delay(frame_delay)
+    {
+        for (auto name = frame_names.begin() + 1; name != frame_names.end(); ++name)
+            later_frames.push_back(std::make_unique<NamedCursorImage>(*name));
+    }
+
+    unsigned int frame_count() const override { return 1 + later_frames.size(); }
+    mg::CursorImage const& frame(unsigned int index) const override
+    {
+        if (index == 0)
+            return *this;
+        return *later_frames.at(index - 1);
+    }
+    std::chrono::milliseconds delay(unsigned int) const override { return frame_delay; }
+
+    std::chrono::milliseconds const frame_delay;
+    std::vector<std::unique_ptr<NamedCursorImage>> later_frames;
+};
+
 struct ZeroSizedCursorImage : public mg::CursorImage
 {
     void const* as_argb_8888() const override { return nullptr; }
@@ -247,6 +273,7 @@ struct TestCursorController : public testing::Test
 
     MockCursor cursor;
     std::shared_ptr<mg::CursorImage> const default_cursor_image;
+    mtd::FakeAlarmFactory alarm_factory;
 };
 
 }
@@ -258,7 +285,7 @@ TEST_F(TestCursorController, moves_cursor)
     StubScene targets({});
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     InSequence seq;
     EXPECT_CALL(cursor, move_to(geom::Point{geom::X{1.0f}, geom::Y{1.0f}}));
@@ -277,7 +304,7 @@ TEST_F(TestCursorController, updates_cursor_image_when_entering_surface)
     StubScene targets({mt::fake_shared(surface)});
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     EXPECT_CALL(cursor, move_to(_)).Times(AnyNumber());
     EXPECT_CALL(cursor, show(CursorNamed(cursor_name_1))).Times(1);
@@ -294,7 +321,7 @@ TEST_F(TestCursorController, surface_with_no_cursor_image_hides_cursor)
     StubScene targets({mt::fake_shared(surface)});
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     EXPECT_CALL(cursor, move_to(_)).Times(AnyNumber());
     EXPECT_CALL(cursor, hide()).Times(1);
@@ -311,7 +338,7 @@ TEST_F(TestCursorController, takes_cursor_image_from_topmost_surface)
     StubScene targets({mt::fake_shared(surface_1), mt::fake_shared(surface_2)});
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     EXPECT_CALL(cursor, move_to(_)).Times(AnyNumber());
     EXPECT_CALL(cursor, show(CursorNamed(cursor_name_2))).Times(1);
@@ -328,7 +355,7 @@ TEST_F(TestCursorController, restores_cursor_when_leaving_surface)
     StubScene targets({mt::fake_shared(surface)});
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     EXPECT_CALL(cursor, move_to(_)).Times(AnyNumber());
 
@@ -351,7 +378,7 @@ TEST_F(TestCursorController, change_in_cursor_request_triggers_image_update_with
     StubScene targets({mt::fake_shared(surface)});
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     EXPECT_CALL(cursor, move_to(_)).Times(AnyNumber());
     {
@@ -374,7 +401,7 @@ TEST_F(TestCursorController, change_in_scene_triggers_image_update)
     StubScene targets({});
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     EXPECT_CALL(cursor, move_to(_)).Times(AnyNumber());
     EXPECT_CALL(cursor, show(CursorNamed(cursor_name_1))).Times(1);
@@ -394,7 +421,7 @@ TEST_F(TestCursorController, cursor_image_not_reset_needlessly)
     StubScene targets({});
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     EXPECT_CALL(cursor, move_to(_)).Times(AnyNumber());
     EXPECT_CALL(cursor, show(CursorNamed(cursor_name_1))).Times(1);
@@ -416,7 +443,7 @@ TEST_F(TestCursorController, updates_cursor_image_when_surface_posts_first_frame
     EXPECT_CALL(cursor, show(CursorNamed(cursor_name_1))).Times(1);
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     Mock::VerifyAndClearExpectations(&cursor);
 
@@ -444,10 +471,79 @@ TEST_F(TestCursorController, zero_sized_image_hides_cursor)
     StubScene targets({});
 
     mi::CursorController controller(mt::fake_shared(targets),
-        mt::fake_shared(cursor), default_cursor_image);
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
 
     EXPECT_CALL(cursor, move_to(_)).Times(AnyNumber());
     EXPECT_CALL(cursor, hide()).Times(1);
 
     targets.add_surface(mt::fake_shared(surface));
 }
+
+TEST_F(TestCursorController, animated_cursor_image_shows_each_frame_after_its_delay)
+{
+    using namespace ::testing;
+    using namespace std::chrono_literals;
+
+    StubInputSurface surface{rect_0_0_1_1,
+        std::make_shared<AnimatedCursorImage>(std::initializer_list<std::string>{cursor_name_1, cursor_name_2}, 10ms)};
+    StubScene targets({});
+
+    mi::CursorController controller(mt::fake_shared(targets),
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
+
+    InSequence seq;
+    EXPECT_CALL(cursor, show(CursorNamed(cursor_name_1)));
+    EXPECT_CALL(cursor, show(CursorNamed(cursor_name_2)));
+    EXPECT_CALL(cursor, show(CursorNamed(cursor_name_1)));
+
+    targets.add_surface(mt::fake_shared(surface));
+    alarm_factory.advance_by(5ms);
+    alarm_factory.advance_by(6ms);
+    alarm_factory.advance_by(11ms);
+}
+
+TEST_F(TestCursorController, animation_stops_when_cursor_leaves_animated_surface)
+{
+    using namespace ::testing;
+    using namespace std::chrono_literals;
+
+    StubInputSurface surface{rect_0_0_1_1,
+        std::make_shared<AnimatedCursorImage>(std::initializer_list<std::string>{cursor_name_1, cursor_name_2}, 10ms)};
+    StubScene targets({mt::fake_shared(surface)});
+
+    EXPECT_CALL(cursor, move_to(_)).Times(AnyNumber());
+    EXPECT_CALL(cursor, show(CursorNamed(cursor_name_1)));
+
+    mi::CursorController controller(mt::fake_shared(targets),
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
+
+    EXPECT_CALL(cursor, show(DefaultCursorImage()));
+    controller.cursor_moved_to(1.0f, 1.0f);
+    Mock::VerifyAndClearExpectations(&cursor);
+
+    EXPECT_CALL(cursor, show(_)).Times(0);
+    alarm_factory.advance_by(11ms);
+}
+
+TEST_F(TestCursorController, animation_frames_are_shown_outside_the_controller_lock)
+{
+    using namespace ::testing;
+    using namespace std::chrono_literals;
+
+    StubInputSurface surface{rect_0_0_1_1,
+        std::make_shared<AnimatedCursorImage>(std::initializer_list<std::string>{cursor_name_1, cursor_name_2}, 10ms)};
+    StubScene targets({mt::fake_shared(surface)});
+
+    EXPECT_CALL(cursor, show(CursorNamed(cursor_name_1)));
+
+    mi::CursorController controller(mt::fake_shared(targets),
+        mt::fake_shared(cursor), default_cursor_image, mt::fake_shared(alarm_factory));
+    controller.update_cursor_image();
+    Mock::VerifyAndClearExpectations(&cursor);
+
+    // Would deadlock if the frame were shown with the lock held
+    EXPECT_CALL(cursor, show(CursorNamed(cursor_name_2)))
+        .WillOnce(InvokeWithoutArgs([&] { controller.update_cursor_image(); }));
+
+    alarm_factory.advance_by(11ms);
+}
@@ -22,6 +22,7 @@
 #include "mir/test/signal.h"
 #include "mir/test/fake_shared.h"
 #include "mir/test/doubles/mock_input_platform.h"
+#include "mir/test/doubles/null_thread_scheduler.h"
 
 #include "mir/input/platform.h"
 #include "mir/dispatch/multiplexing_dispatchable.h"
@@ -48,7 +49,9 @@ struct DefaultInputManagerTest : ::testing::Test
     md::ActionQueue platform_dispatchable;
     NiceMock<mtd::MockInputPlatform> platform;
     mir::Fd event_hub_fd{eventfd(0, EFD_CLOEXEC|EFD_NONBLOCK)};
-    mir::input::DefaultInputManager input_manager{mt::fake_shared(multiplexer), mt::fake_shared(platform)};
+    mtd::NullThreadScheduler thread_scheduler;
+    mir::input::DefaultInputManager input_manager{
+        mt::fake_shared(multiplexer), mt::fake_shared(platform), mt::fake_shared(thread_scheduler)};
     std::chrono::seconds const timeout{30};
 
     DefaultInputManagerTest()
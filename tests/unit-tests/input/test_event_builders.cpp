@@ -18,6 +18,7 @@
 
 #include "mir/events/event_builders.h"
 #include "mir/events/event_private.h" // only needed to validate motion_up/down mapping
+#include "mir_toolkit/mir_blob.h"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -36,6 +37,18 @@ struct InputEventBuilder : public Test
     std::vector<uint8_t> const cookie{};
     MirInputEventModifiers const modifiers = mir_input_event_modifier_meta;
 };
+
+std::vector<uint8_t> dnd_handle_of(MirPointerEvent const* pev)
+{
+    std::vector<uint8_t> handle;
+    if (auto const blob = pev->dnd_handle())
+    {
+        auto const data = static_cast<uint8_t const*>(mir_blob_data(blob));
+        handle.assign(data, data + mir_blob_size(blob));
+        mir_blob_release(blob);
+    }
+    return handle;
+}
 }
 
 TEST_F(InputEventBuilder, makes_valid_key_event)
@@ -130,6 +143,55 @@ TEST_F(InputEventBuilder, makes_valid_pointer_event)
     EXPECT_EQ(vscroll_value, mir_pointer_event_axis_value(pev, mir_pointer_axis_vscroll));
 }
 
+TEST_F(InputEventBuilder, cloned_pointer_event_has_same_properties_and_can_be_changed_independently)
+{
+    std::vector<uint8_t> const handle{1, 2, 3, 4};
+    auto ev = mev::make_event(device_id, timestamp, cookie, modifiers,
+        mir_pointer_action_motion, mir_pointer_button_primary, 10.0f, 20.0f, 0.0f, 0.0f, 1.0f, 2.0f);
+
+    auto clone = mev::clone_event(*ev);
+    mev::set_drag_and_drop_handle(*clone, handle);
+    mev::transform_positions(*clone, {3, 4});
+
+    auto const original_pev = mir_input_event_get_pointer_event(mir_event_get_input_event(ev.get()));
+    auto const cloned_pev = mir_input_event_get_pointer_event(mir_event_get_input_event(clone.get()));
+
+    EXPECT_THAT(mir_pointer_event_modifiers(cloned_pev), Eq(modifiers));
+    EXPECT_THAT(mir_pointer_event_action(cloned_pev), Eq(mir_pointer_action_motion));
+    EXPECT_THAT(mir_pointer_event_buttons(cloned_pev), Eq(MirPointerButtons{mir_pointer_button_primary}));
+    EXPECT_THAT(mir_pointer_event_axis_value(cloned_pev, mir_pointer_axis_relative_x), Eq(1.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(cloned_pev, mir_pointer_axis_x), Eq(7.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(cloned_pev, mir_pointer_axis_y), Eq(16.0f));
+    EXPECT_THAT(dnd_handle_of(cloned_pev), Eq(handle));
+
+    EXPECT_THAT(mir_pointer_event_axis_value(original_pev, mir_pointer_axis_x), Eq(10.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(original_pev, mir_pointer_axis_y), Eq(20.0f));
+    EXPECT_THAT(dnd_handle_of(original_pev), IsEmpty());
+}
+
+TEST_F(InputEventBuilder, when_deserialized_cloned_event_has_supplied_properties)
+{
+    std::vector<uint8_t> const handle{5, 6, 7};
+    auto ev = mev::make_event(device_id, timestamp, cookie, modifiers,
+        mir_pointer_action_button_down, mir_pointer_button_secondary, 1.5f, 2.5f, 0.0f, 0.0f, 0.0f, 0.0f);
+
+    auto clone = mev::clone_event(*ev);
+    mev::set_window_id(*clone, 42);
+    mev::set_drag_and_drop_handle(*clone, handle);
+
+    auto deserialized_event = MirEvent::deserialize(MirEvent::serialize(clone.get()));
+
+    auto const input_ev = mir_event_get_input_event(deserialized_event.get());
+    auto const pev = mir_input_event_get_pointer_event(input_ev);
+    EXPECT_THAT(mir_input_event_get_device_id(input_ev), Eq(device_id));
+    EXPECT_THAT(mir_input_event_get_event_time(input_ev), Eq(timestamp.count()));
+    EXPECT_THAT(input_ev->window_id(), Eq(42));
+    EXPECT_THAT(mir_pointer_event_action(pev), Eq(mir_pointer_action_button_down));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_x), Eq(1.5f));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_y), Eq(2.5f));
+    EXPECT_THAT(dnd_handle_of(pev), Eq(handle));
+}
+
 // The following three requirements can be removed as soon as we remove android::InputDispatcher, which is the
 // only remaining part that relies on the difference between mir_motion_action_pointer_{up,down} and
 // mir_motion_action_{up,down} and the difference between mir_motion_action_move and mir_motion_action_hover_move.
@@ -438,6 +438,20 @@ TEST_F(SurfaceInputDispatcher, touch_delivered_to_surface)
     EXPECT_TRUE(dispatcher.dispatch(*toucher.release_at({1,1})));
 }
 
+TEST_F(SurfaceInputDispatcher, touch_for_surface_at_origin_is_delivered_without_copying)
+{
+    auto surface = scene.add_surface({{0, 0}, {5, 5}});
+
+    dispatcher.start();
+
+    FakeToucher toucher;
+    auto const touch = toucher.touch_at({1, 1});
+
+    EXPECT_CALL(*surface, consume(Eq(touch.get()))).Times(1);
+
+    EXPECT_TRUE(dispatcher.dispatch(*touch));
+}
+
 TEST_F(SurfaceInputDispatcher, touch_delivered_only_to_top_surface)
 {
     auto bottom_surface = scene.add_surface({{1, 1}, {3, 3}});
@@ -0,0 +1,275 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/metrics/compositor_report.h"
+#include "src/server/report/metrics/histogram.h"
+#include "src/server/report/metrics/message_processor_report.h"
+#include "src/server/report/metrics/registry.h"
+#include "mir/test/doubles/advanceable_clock.h"
+#include "mir/thread_name.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace mtd = mir::test::doubles;
+namespace mrm = mir::report::metrics;
+using namespace testing;
+using namespace std::chrono;
+
+namespace
+{
+struct MetricsReport : Test
+{
+    std::shared_ptr<mtd::AdvanceableClock> const clock = std::make_shared<mtd::AdvanceableClock>();
+    std::shared_ptr<mrm::Registry> const registry = std::make_shared<mrm::Registry>();
+
+    std::string snapshot() const
+    {
+        std::ostringstream out;
+        registry->write_snapshot(out);
+        return out.str();
+    }
+};
+}
+
+TEST_F(MetricsReport, histogram_buckets_cover_values_contiguously)
+{
+    for (auto bucket = 1u; bucket != mrm::Histogram::bucket_count; ++bucket)
+    {
+        EXPECT_THAT(mrm::Histogram::bucket_lowest_value(bucket),
+                    Eq(mrm::Histogram::bucket_highest_value(bucket - 1) + 1));
+    }
+
+    for (std::uint64_t value : {0ull, 1ull, 31ull, 32ull, 33ull, 1000ull, 16666ull, 1ull << 35})
+    {
+        auto const bucket = mrm::Histogram::bucket_for(value);
+        EXPECT_THAT(value, Ge(mrm::Histogram::bucket_lowest_value(bucket)));
+        EXPECT_THAT(value, Le(mrm::Histogram::bucket_highest_value(bucket)));
+    }
+}
+
+TEST_F(MetricsReport, histogram_percentiles_are_within_bucket_precision)
+{
+    mrm::Histogram histogram;
+
+    for (auto value = 1u; value <= 1000; ++value)
+        histogram.record(value);
+
+    auto const snapshot = histogram.snapshot();
+
+    EXPECT_THAT(snapshot.count, Eq(1000u));
+    EXPECT_THAT(snapshot.min, Eq(1u));
+    EXPECT_THAT(snapshot.max, Eq(1000u));
+    EXPECT_THAT(snapshot.sum, Eq(500500u));
+    EXPECT_THAT(snapshot.value_at_percentile(50), AllOf(Ge(500u), Le(500u + 500u/16)));
+    EXPECT_THAT(snapshot.value_at_percentile(99), AllOf(Ge(990u), Le(1000u)));
+    EXPECT_THAT(snapshot.value_at_percentile(100), Eq(1000u));
+}
+
+TEST_F(MetricsReport, records_from_many_threads_are_all_counted)
+{
+    auto& counter = registry->counter("test.events");
+    auto& histogram = registry->histogram("test.latency_us");
+
+    std::vector<std::thread> threads;
+    for (auto i = 0; i != 8; ++i)
+    {
+        threads.emplace_back(
+            [&]
+            {
+                for (auto j = 0; j != 10000; ++j)
+                {
+                    counter.increment();
+                    histogram.record(j);
+                }
+            });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_THAT(counter.value(), Eq(80000u));
+    EXPECT_THAT(histogram.snapshot().count, Eq(80000u));
+}
+
+TEST_F(MetricsReport, compositor_report_records_frame_times)
+{
+    mrm::CompositorReport report{registry, clock};
+    void const* const display_id = nullptr;
+
+    report.started();
+    for (int frame = 0; frame != 100; ++frame)
+    {
+        report.scheduled();
+        report.began_frame(display_id);
+        clock->advance_by(milliseconds{5});
+        report.rendered_frame(display_id);
+        clock->advance_by(milliseconds{5});
+        report.finished_frame(display_id);
+    }
+
+    auto const frame_interval = registry->histogram("compositor.frame_interval_us").snapshot();
+    EXPECT_THAT(frame_interval.count, Eq(99u));
+    EXPECT_THAT(frame_interval.value_at_percentile(99), Eq(10000u));
+
+    auto const render_time = registry->histogram("compositor.render_time_us").snapshot();
+    EXPECT_THAT(render_time.count, Eq(100u));
+    EXPECT_THAT(render_time.max, Eq(5000u));
+
+    EXPECT_THAT(registry->counter("compositor.frames").value(), Eq(100u));
+    EXPECT_THAT(registry->counter("compositor.bypassed_frames").value(), Eq(0u));
+}
+
+TEST_F(MetricsReport, compositor_report_does_not_count_pauses_as_frames)
+{
+    mrm::CompositorReport report{registry, clock};
+    void const* const display_id = nullptr;
+
+    report.began_frame(display_id);
+    report.finished_frame(display_id);
+
+    report.stopped();
+    clock->advance_by(seconds{10});
+    report.started();
+
+    report.began_frame(display_id);
+    report.finished_frame(display_id);
+
+    EXPECT_THAT(registry->histogram("compositor.frame_interval_us").snapshot().count, Eq(0u));
+    EXPECT_THAT(registry->counter("compositor.bypassed_frames").value(), Eq(2u));
+}
+
+TEST_F(MetricsReport, compositor_report_does_not_share_frame_state_between_reports)
+{
+    void const* const display_id = nullptr;
+
+    for (int i = 0; i != 2; ++i)
+    {
+        mrm::CompositorReport report{registry, clock};
+
+        report.began_frame(display_id);
+        report.finished_frame(display_id);
+        clock->advance_by(seconds{10});
+    }
+
+    EXPECT_THAT(registry->histogram("compositor.frame_interval_us").snapshot().count, Eq(0u));
+}
+
+TEST_F(MetricsReport, compositor_report_times_frames_of_each_display_buffer_separately)
+{
+    mrm::CompositorReport report{registry, clock};
+    int displays[2];
+
+    for (int frame = 0; frame != 10; ++frame)
+    {
+        for (auto const& display : displays)
+        {
+            report.began_frame(&display);
+            report.finished_frame(&display);
+            clock->advance_by(milliseconds{8});
+        }
+    }
+
+    auto const frame_interval = registry->histogram("compositor.frame_interval_us").snapshot();
+    EXPECT_THAT(frame_interval.count, Eq(18u));
+    EXPECT_THAT(frame_interval.min, Eq(16000u));
+    EXPECT_THAT(frame_interval.max, Eq(16000u));
+}
+
+TEST_F(MetricsReport, compositor_report_records_buffer_queue_depth)
+{
+    mrm::CompositorReport report{registry, clock};
+    void const* const display_id = nullptr;
+
+    report.frames_pending(display_id, 0);
+    report.frames_pending(display_id, 2);
+
+    auto const depth = registry->histogram("compositor.buffer_queue_depth").snapshot();
+    EXPECT_THAT(depth.count, Eq(2u));
+    EXPECT_THAT(depth.max, Eq(2u));
+}
+
+TEST_F(MetricsReport, compositor_report_records_frame_allocations)
+{
+    mrm::CompositorReport report{registry, clock};
+    void const* const group_id = nullptr;
+
+    report.allocations_in_frame(group_id, 4096, 1);
+    report.allocations_in_frame(group_id, 2048, 0);
+    report.allocations_in_frame(group_id, 2048, 0);
+
+    auto const arena_bytes = registry->histogram("compositor.frame_arena_bytes").snapshot();
+    EXPECT_THAT(arena_bytes.count, Eq(3u));
+    EXPECT_THAT(arena_bytes.sum, Eq(8192u));
+    EXPECT_THAT(registry->counter("compositor.frame_heap_allocations").value(), Eq(1u));
+}
+
+TEST_F(MetricsReport, message_processor_report_records_busy_time_per_thread)
+{
+    mrm::MessageProcessorReport report{registry, clock};
+    void const* const mediator = &report;
+
+    auto const invoke = [&](std::string const& thread_name, int id, milliseconds duration)
+        {
+            std::thread{
+                [&]
+                {
+                    mir::set_thread_name(thread_name);
+                    report.received_invocation(mediator, id, "submit_buffer");
+                    clock->advance_by(duration);
+                    report.completed_invocation(mediator, id, true);
+                }}.join();
+        };
+
+    invoke("Mir/IPC/0", 1, milliseconds{2});
+    invoke("Mir/IPC/1", 2, milliseconds{5});
+    invoke("Mir/IPC/0", 3, milliseconds{3});
+
+    EXPECT_THAT(registry->counter("ipc.thread.Mir_IPC_0.busy_us").value(), Eq(5000u));
+    EXPECT_THAT(registry->counter("ipc.thread.Mir_IPC_0.invocations").value(), Eq(2u));
+    EXPECT_THAT(registry->counter("ipc.thread.Mir_IPC_1.busy_us").value(), Eq(5000u));
+    EXPECT_THAT(registry->counter("ipc.thread.Mir_IPC_1.invocations").value(), Eq(1u));
+    EXPECT_THAT(registry->counter("ipc.invocations").value(), Eq(3u));
+}
+
+TEST_F(MetricsReport, message_processor_report_records_request_sizes)
+{
+    mrm::MessageProcessorReport report{registry, clock};
+    void const* const mediator = &report;
+
+    report.received_invocation_size(mediator, 1, 24);
+    report.received_invocation_size(mediator, 2, 1000);
+
+    auto const request_size = registry->histogram("ipc.request_bytes").snapshot();
+    EXPECT_THAT(request_size.count, Eq(2u));
+    EXPECT_THAT(request_size.sum, Eq(1024u));
+}
+
+TEST_F(MetricsReport, snapshot_lists_every_metric)
+{
+    registry->counter("test.events").increment(3);
+    registry->histogram("test.latency_us").record(7);
+
+    auto const text = snapshot();
+
+    EXPECT_THAT(text, StartsWith("# mir-metrics 1\n"));
+    EXPECT_THAT(text, HasSubstr("counter test.events 3\n"));
+    EXPECT_THAT(text, HasSubstr("histogram test.latency_us count=1 sum=7 min=7 max=7 p50=7 p90=7 p99=7 p999=7\n"));
+    EXPECT_THAT(text, HasSubstr("bucket test.latency_us 7 1\n"));
+}
@@ -72,6 +72,7 @@ struct StubClientContext : mcl::ClientContext
     {
         memset(&graphics_module, 0, sizeof(graphics_module));
     }
+
     MirWaitHandle* platform_operation(
         MirPlatformMessage const*, MirPlatformOperationCallback, void*) override
     {
@@ -89,6 +90,11 @@ struct StubClientContext : mcl::ClientContext
     void release_buffer(mcl::MirBuffer*) override
     {
     }
+
+    std::string client_platform_module() override
+    {
+        return "mesa";
+    }
 };
 
 struct MesaClientPlatformTest : testing::Test
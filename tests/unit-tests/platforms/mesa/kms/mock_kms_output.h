@@ -38,11 +38,19 @@ namespace test
 
 struct MockKMSOutput : public graphics::mesa::KMSOutput
 {
+    MockKMSOutput()
+    {
+        ON_CALL(*this, overlay_planes())
+            .WillByDefault(testing::Return(std::vector<graphics::mesa::KMSPlane>{}));
+    }
+
     MOCK_CONST_METHOD0(id, uint32_t());
     MOCK_METHOD0(reset, void());
     MOCK_METHOD2(configure, void(geometry::Displacement, size_t));
     MOCK_CONST_METHOD0(size, geometry::Size());
     MOCK_CONST_METHOD0(max_refresh_rate, int());
+    MOCK_METHOD1(set_adaptive_sync, void(bool));
+    MOCK_CONST_METHOD0(adaptive_sync, bool());
 
     bool set_crtc(graphics::mesa::FBHandle const& fb) override
     {
@@ -59,6 +67,53 @@ struct MockKMSOutput : public graphics::mesa::KMSOutput
     MOCK_METHOD1(schedule_page_flip_thunk, bool(graphics::mesa::FBHandle const*));
     MOCK_METHOD0(wait_for_page_flip, void());
 
+    MOCK_METHOD0(overlay_planes, std::vector<graphics::mesa::KMSPlane>());
+
+    bool test_overlays(
+        graphics::mesa::FBHandle const& fb,
+        std::vector<graphics::mesa::OverlayPlacement> const& overlays) override
+    {
+        return test_overlays_thunk(&fb, overlays);
+    }
+    MOCK_METHOD2(test_overlays_thunk,
+        bool(graphics::mesa::FBHandle const*, std::vector<graphics::mesa::OverlayPlacement> const&));
+
+    bool schedule_page_flip(
+        graphics::mesa::FBHandle const& fb,
+        std::vector<graphics::mesa::OverlayPlacement> const& overlays) override
+    {
+        return schedule_page_flip_thunk(&fb, overlays);
+    }
+    MOCK_METHOD2(schedule_page_flip_thunk,
+        bool(graphics::mesa::FBHandle const*, std::vector<graphics::mesa::OverlayPlacement> const&));
+
+    bool add_page_flip_to(
+        graphics::mesa::AtomicRequest& request,
+        graphics::mesa::FBHandle const& fb,
+        std::vector<graphics::mesa::OverlayPlacement> const& overlays) override
+    {
+        return add_page_flip_to_thunk(&request, &fb, overlays);
+    }
+    MOCK_METHOD3(add_page_flip_to_thunk,
+        bool(graphics::mesa::AtomicRequest*,
+             graphics::mesa::FBHandle const*,
+             std::vector<graphics::mesa::OverlayPlacement> const&));
+
+    bool add_set_crtc_to(
+        graphics::mesa::AtomicRequest& request,
+        graphics::mesa::FBHandle const& fb) override
+    {
+        return add_set_crtc_to_thunk(&request, &fb);
+    }
+    MOCK_METHOD2(add_set_crtc_to_thunk,
+        bool(graphics::mesa::AtomicRequest*, graphics::mesa::FBHandle const*));
+
+    bool add_clear_crtc_to(graphics::mesa::AtomicRequest& request) override
+    {
+        return add_clear_crtc_to_thunk(&request);
+    }
+    MOCK_METHOD1(add_clear_crtc_to_thunk, bool(graphics::mesa::AtomicRequest*));
+
     MOCK_CONST_METHOD0(last_frame, graphics::Frame());
 
     MOCK_METHOD1(set_cursor, bool(gbm_bo*));
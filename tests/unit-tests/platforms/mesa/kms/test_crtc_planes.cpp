@@ -0,0 +1,549 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/platforms/mesa/server/kms/crtc_planes.h"
+#include "src/platforms/mesa/server/kms/atomic_request.h"
+
+#include "mir/test/doubles/mock_drm.h"
+
+#include <drm_fourcc.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <fcntl.h>
+
+#include <cstring>
+#include <map>
+#include <memory>
+
+namespace mgm = mir::graphics::mesa;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+using namespace ::testing;
+
+namespace
+{
+enum PropertyId : uint32_t
+{
+    type_prop = 1,
+    fb_id_prop, crtc_id_prop,
+    src_x_prop, src_y_prop, src_w_prop, src_h_prop,
+    crtc_x_prop, crtc_y_prop, crtc_w_prop, crtc_h_prop,
+    mutable_zpos_prop, immutable_zpos_prop,
+    active_prop, mode_id_prop, vrr_enabled_prop
+};
+
+struct FakePlane
+{
+    drmModePlane plane;
+    std::vector<uint32_t> formats;
+    std::vector<uint32_t> prop_ids;
+    std::vector<uint64_t> prop_values;
+    drmModeObjectProperties props;
+};
+
+class CrtcPlanesTest : public ::testing::Test
+{
+public:
+    CrtcPlanesTest()
+        : drm_fd{open(drm_device, 0, 0)}
+    {
+        mock_drm.reset(drm_device);
+        mock_drm.add_crtc(drm_device, crtc_ids[0], drmModeModeInfo());
+        mock_drm.add_crtc(drm_device, crtc_ids[1], drmModeModeInfo());
+        mock_drm.prepare(drm_device);
+
+        ON_CALL(mock_drm, drmModeGetPlaneResources(_))
+            .WillByDefault(InvokeWithoutArgs(
+                [this]
+                {
+                    plane_ids.clear();
+                    for (auto const& plane : planes)
+                        plane_ids.push_back(plane.first);
+
+                    memset(&plane_resources, 0, sizeof plane_resources);
+                    plane_resources.count_planes = plane_ids.size();
+                    plane_resources.planes = plane_ids.data();
+                    return &plane_resources;
+                }));
+        ON_CALL(mock_drm, drmModeGetPlane(_, _))
+            .WillByDefault(Invoke(
+                [this](int, uint32_t id) { return &planes.at(id)->plane; }));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, _, DRM_MODE_OBJECT_PLANE))
+            .WillByDefault(Invoke(
+                [this](int, uint32_t id, uint32_t) { return &planes.at(id)->props; }));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, _, DRM_MODE_OBJECT_CRTC))
+            .WillByDefault(Return(&crtc_props));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, _, DRM_MODE_OBJECT_CONNECTOR))
+            .WillByDefault(Return(&connector_props));
+        ON_CALL(mock_drm, drmModeGetProperty(_, _))
+            .WillByDefault(Invoke(
+                [this](int, uint32_t id) { return property(id); }));
+
+        crtc_props.count_props = crtc_prop_ids.size();
+        crtc_props.props = crtc_prop_ids.data();
+        crtc_props.prop_values = crtc_prop_values;
+        connector_props.count_props = 1;
+        connector_props.props = &connector_crtc_id_prop;
+        connector_props.prop_values = &connector_crtc_id;
+    }
+
+    void add_plane(uint32_t id, uint32_t possible_crtcs, uint64_t type, bool mutable_zpos = false)
+    {
+        auto fake = std::make_unique<FakePlane>();
+        memset(&fake->plane, 0, sizeof fake->plane);
+
+        fake->formats = {DRM_FORMAT_XRGB8888, DRM_FORMAT_ARGB8888};
+        fake->plane.plane_id = id;
+        fake->plane.possible_crtcs = possible_crtcs;
+        fake->plane.count_formats = fake->formats.size();
+        fake->plane.formats = fake->formats.data();
+
+        fake->prop_ids = {
+            type_prop, fb_id_prop, crtc_id_prop,
+            src_x_prop, src_y_prop, src_w_prop, src_h_prop,
+            crtc_x_prop, crtc_y_prop, crtc_w_prop, crtc_h_prop,
+            mutable_zpos ? mutable_zpos_prop : immutable_zpos_prop};
+        fake->prop_values.assign(fake->prop_ids.size(), 0);
+        fake->prop_values[0] = type;
+
+        fake->props.count_props = fake->prop_ids.size();
+        fake->props.props = fake->prop_ids.data();
+        fake->props.prop_values = fake->prop_values.data();
+
+        planes[id] = std::move(fake);
+    }
+
+    drmModePropertyPtr property(uint32_t id)
+    {
+        static std::map<uint32_t, char const*> const names{
+            {type_prop, "type"},
+            {fb_id_prop, "FB_ID"}, {crtc_id_prop, "CRTC_ID"},
+            {src_x_prop, "SRC_X"}, {src_y_prop, "SRC_Y"}, {src_w_prop, "SRC_W"}, {src_h_prop, "SRC_H"},
+            {crtc_x_prop, "CRTC_X"}, {crtc_y_prop, "CRTC_Y"}, {crtc_w_prop, "CRTC_W"}, {crtc_h_prop, "CRTC_H"},
+            {mutable_zpos_prop, "zpos"}, {immutable_zpos_prop, "zpos"},
+            {active_prop, "ACTIVE"}, {mode_id_prop, "MODE_ID"}, {vrr_enabled_prop, "VRR_ENABLED"}};
+
+        properties.push_back(std::make_unique<drmModePropertyRes>());
+        auto const prop = properties.back().get();
+        memset(prop, 0, sizeof *prop);
+
+        prop->prop_id = id;
+        strncpy(prop->name, names.at(id), sizeof prop->name);
+        if (id == mutable_zpos_prop || id == immutable_zpos_prop)
+        {
+            prop->flags = DRM_MODE_PROP_RANGE | (id == immutable_zpos_prop ? DRM_MODE_PROP_IMMUTABLE : 0);
+            prop->count_values = 2;
+            prop->values = zpos_range;
+        }
+        return prop;
+    }
+
+    mgm::KMSPlaneState const primary_state{0, 17, {{0, 0}, {640, 480}}, {{0, 0}, {640, 480}}};
+
+    NiceMock<mtd::MockDRM> mock_drm;
+    char const* const drm_device = "/dev/dri/card0";
+    int const drm_fd;
+    std::vector<uint32_t> const crtc_ids{10, 11};
+
+    std::map<uint32_t, std::unique_ptr<FakePlane>> planes;
+    std::vector<uint32_t> plane_ids;
+    drmModePlaneRes plane_resources;
+    std::vector<std::unique_ptr<drmModePropertyRes>> properties;
+    uint64_t zpos_range[2]{1, 4};
+
+    std::vector<uint32_t> crtc_prop_ids{active_prop, mode_id_prop};
+    uint64_t crtc_prop_values[3]{0, 0, 0};
+    drmModeObjectProperties crtc_props;
+    uint32_t connector_crtc_id_prop{crtc_id_prop};
+    uint64_t connector_crtc_id{0};
+    drmModeObjectProperties connector_props;
+};
+
+std::vector<uint32_t> ids_of(std::vector<mgm::KMSPlane> const& planes)
+{
+    std::vector<uint32_t> ids;
+    for (auto const& plane : planes)
+        ids.push_back(plane.id);
+    return ids;
+}
+}
+
+TEST_F(CrtcPlanesTest, uses_only_overlay_planes_dedicated_to_its_crtc)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY);
+    add_plane(33, 0x3, DRM_PLANE_TYPE_OVERLAY);
+    add_plane(34, 0x1, DRM_PLANE_TYPE_CURSOR);
+    add_plane(35, 0x2, DRM_PLANE_TYPE_OVERLAY);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    EXPECT_THAT(ids_of(crtc_planes.overlays()), ElementsAre(32u));
+}
+
+TEST_F(CrtcPlanesTest, has_no_overlays_without_atomic_modesetting)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY);
+
+    ON_CALL(mock_drm, drmSetClientCap(_, DRM_CLIENT_CAP_ATOMIC, _))
+        .WillByDefault(Return(-EINVAL));
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    EXPECT_THAT(crtc_planes.overlays(), IsEmpty());
+}
+
+TEST_F(CrtcPlanesTest, only_overlays_with_a_mutable_zpos_are_stackable)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY, true);
+    add_plane(33, 0x1, DRM_PLANE_TYPE_OVERLAY, false);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    ASSERT_THAT(ids_of(crtc_planes.overlays()), ElementsAre(32u, 33u));
+    EXPECT_TRUE(crtc_planes.overlays()[0].stackable);
+    EXPECT_FALSE(crtc_planes.overlays()[1].stackable);
+}
+
+TEST_F(CrtcPlanesTest, test_does_not_change_what_is_shown)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY, nullptr));
+
+    EXPECT_TRUE(crtc_planes.test(primary_state, {{32, 18, {{0, 0}, {64, 48}}, {{10, 10}, {64, 48}}}}));
+    EXPECT_FALSE(crtc_planes.overlays_enabled());
+}
+
+TEST_F(CrtcPlanesTest, stacks_overlays_in_the_order_given)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY, true);
+    add_plane(33, 0x1, DRM_PLANE_TYPE_OVERLAY, true);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 33, mutable_zpos_prop, zpos_range[0]));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 32, mutable_zpos_prop, zpos_range[0] + 1));
+
+    crtc_planes.commit(
+        primary_state,
+        {{33, 18, {{0, 0}, {64, 48}}, {{10, 10}, {64, 48}}},
+         {32, 19, {{0, 0}, {64, 48}}, {{20, 20}, {64, 48}}}},
+        DRM_MODE_ATOMIC_NONBLOCK,
+        nullptr);
+}
+
+TEST_F(CrtcPlanesTest, stacks_overlays_above_a_primary_with_a_fixed_zpos)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY, true);
+    add_plane(33, 0x1, DRM_PLANE_TYPE_OVERLAY, true);
+    planes[31]->prop_values.back() = 2;
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 31, immutable_zpos_prop, _))
+        .Times(0);
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 33, mutable_zpos_prop, 3));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 32, mutable_zpos_prop, 4));
+
+    crtc_planes.commit(
+        primary_state,
+        {{33, 18, {{0, 0}, {64, 48}}, {{10, 10}, {64, 48}}},
+         {32, 19, {{0, 0}, {64, 48}}, {{20, 20}, {64, 48}}}},
+        DRM_MODE_ATOMIC_NONBLOCK,
+        nullptr);
+}
+
+TEST_F(CrtcPlanesTest, puts_a_primary_with_a_mutable_zpos_beneath_the_overlays)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY, true);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY, true);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 31, mutable_zpos_prop, zpos_range[0]));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 32, mutable_zpos_prop, zpos_range[0] + 1));
+
+    crtc_planes.commit(
+        primary_state,
+        {{32, 18, {{0, 0}, {64, 48}}, {{10, 10}, {64, 48}}}},
+        DRM_MODE_ATOMIC_NONBLOCK,
+        nullptr);
+}
+
+TEST_F(CrtcPlanesTest, does_not_test_again_when_only_the_framebuffers_change)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY, nullptr))
+        .Times(1);
+
+    for (uint32_t fb = 18; fb != 22; ++fb)
+    {
+        EXPECT_TRUE(crtc_planes.test(
+            {0, fb - 1, {{0, 0}, {640, 480}}, {{0, 0}, {640, 480}}, DRM_FORMAT_XRGB8888, 2560},
+            {{32, fb, {{0, 0}, {64, 48}}, {{10, 10}, {64, 48}}, DRM_FORMAT_ARGB8888, 256}}));
+    }
+}
+
+TEST_F(CrtcPlanesTest, tests_again_when_an_overlay_moves)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+    mgm::KMSPlaneState const primary{0, 17, {{0, 0}, {640, 480}}, {{0, 0}, {640, 480}}, DRM_FORMAT_XRGB8888, 2560};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY, nullptr))
+        .Times(2);
+
+    EXPECT_TRUE(crtc_planes.test(
+        primary, {{32, 18, {{0, 0}, {64, 48}}, {{10, 10}, {64, 48}}, DRM_FORMAT_ARGB8888, 256}}));
+    EXPECT_TRUE(crtc_planes.test(
+        primary, {{32, 19, {{0, 0}, {64, 48}}, {{20, 10}, {64, 48}}, DRM_FORMAT_ARGB8888, 256}}));
+}
+
+TEST_F(CrtcPlanesTest, tests_again_after_a_commit_fails)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+    mgm::KMSPlaneState const primary{0, 17, {{0, 0}, {640, 480}}, {{0, 0}, {640, 480}}, DRM_FORMAT_XRGB8888, 2560};
+    std::vector<mgm::KMSPlaneState> const overlays{
+        {32, 18, {{0, 0}, {64, 48}}, {{10, 10}, {64, 48}}, DRM_FORMAT_ARGB8888, 256}};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_TEST_ONLY, nullptr))
+        .Times(2);
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_NONBLOCK, nullptr))
+        .WillOnce(Return(-EINVAL));
+
+    ASSERT_TRUE(crtc_planes.test(primary, overlays));
+    ASSERT_THAT(crtc_planes.commit(primary, overlays, DRM_MODE_ATOMIC_NONBLOCK, nullptr), Ne(0));
+    EXPECT_TRUE(crtc_planes.test(primary, overlays));
+}
+
+TEST_F(CrtcPlanesTest, commit_turns_off_overlays_no_longer_wanted)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    crtc_planes.commit(primary_state, {{32, 18, {{0, 0}, {64, 48}}, {{10, 10}, {64, 48}}}}, 0, nullptr);
+    ASSERT_TRUE(crtc_planes.overlays_enabled());
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 32, fb_id_prop, 0));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 32, crtc_id_prop, 0));
+
+    crtc_planes.commit(primary_state, {}, 0, nullptr);
+    EXPECT_FALSE(crtc_planes.overlays_enabled());
+}
+
+TEST_F(CrtcPlanesTest, failed_commit_leaves_overlays_as_they_were)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    ON_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .WillByDefault(Return(-EINVAL));
+
+    EXPECT_THAT(
+        crtc_planes.commit(primary_state, {{32, 18, {{0, 0}, {64, 48}}, {{10, 10}, {64, 48}}}}, 0, nullptr),
+        Ne(0));
+    EXPECT_FALSE(crtc_planes.overlays_enabled());
+}
+
+TEST_F(CrtcPlanesTest, is_atomic_only_with_atomic_modesetting)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+
+    {
+        mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+        EXPECT_TRUE(crtc_planes.atomic());
+    }
+
+    ON_CALL(mock_drm, drmSetClientCap(_, DRM_CLIENT_CAP_ATOMIC, _))
+        .WillByDefault(Return(-EINVAL));
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+    mgm::AtomicRequest request{drm_fd};
+
+    EXPECT_FALSE(crtc_planes.atomic());
+    EXPECT_FALSE(crtc_planes.add_frame(request, primary_state, {}));
+}
+
+TEST_F(CrtcPlanesTest, modeset_sets_the_mode_and_routes_the_connector_to_the_crtc)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+
+    uint32_t const connector_id{40};
+    uint32_t const mode_blob{77};
+    drmModeModeInfo mode;
+    memset(&mode, 0, sizeof mode);
+    mode.hdisplay = 640;
+    mode.vdisplay = 480;
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    EXPECT_CALL(mock_drm, drmModeCreatePropertyBlob(_, _, sizeof mode, _))
+        .WillOnce(DoAll(SetArgPointee<3>(mode_blob), Return(0)));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], mode_id_prop, mode_blob));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], active_prop, 1));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, connector_id, crtc_id_prop, crtc_ids[0]));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr));
+    EXPECT_CALL(mock_drm, drmModeDestroyPropertyBlob(_, mode_blob));
+
+    mgm::AtomicRequest request{drm_fd};
+    request.allow_modeset();
+
+    ASSERT_TRUE(crtc_planes.add_modeset(request, connector_id, mode, false));
+    ASSERT_TRUE(crtc_planes.add_frame(request, primary_state, {}));
+    EXPECT_THAT(request.commit(0, nullptr), Eq(0));
+}
+
+TEST_F(CrtcPlanesTest, modeset_turns_adaptive_sync_on_where_the_crtc_has_it)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    crtc_prop_ids.push_back(vrr_enabled_prop);
+    crtc_props.count_props = crtc_prop_ids.size();
+    crtc_props.props = crtc_prop_ids.data();
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+    ASSERT_TRUE(crtc_planes.adaptive_sync());
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], vrr_enabled_prop, 1));
+
+    mgm::AtomicRequest request{drm_fd};
+    EXPECT_TRUE(crtc_planes.add_modeset(request, 40, drmModeModeInfo(), true));
+}
+
+TEST_F(CrtcPlanesTest, modeset_leaves_adaptive_sync_alone_where_the_crtc_lacks_it)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+    EXPECT_FALSE(crtc_planes.adaptive_sync());
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], vrr_enabled_prop, _))
+        .Times(0);
+
+    mgm::AtomicRequest request{drm_fd};
+    EXPECT_TRUE(crtc_planes.add_modeset(request, 40, drmModeModeInfo(), true));
+}
+
+TEST_F(CrtcPlanesTest, cannot_modeset_without_the_crtc_properties)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    crtc_props.count_props = 0;
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+    mgm::AtomicRequest request{drm_fd};
+
+    EXPECT_CALL(mock_drm, drmModeCreatePropertyBlob(_, _, _, _))
+        .Times(0);
+
+    EXPECT_FALSE(crtc_planes.add_modeset(request, 40, drmModeModeInfo(), false));
+}
+
+TEST_F(CrtcPlanesTest, disable_turns_off_the_crtc_and_its_planes_and_unroutes_the_connector)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(32, 0x1, DRM_PLANE_TYPE_OVERLAY);
+
+    uint32_t const connector_id{40};
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], active_prop, 0));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], mode_id_prop, 0));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, connector_id, crtc_id_prop, 0));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 31, crtc_id_prop, 0));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 32, crtc_id_prop, 0));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_ALLOW_MODESET | DRM_MODE_ATOMIC_TEST_ONLY, nullptr));
+
+    mgm::AtomicRequest request{drm_fd};
+    request.allow_modeset();
+
+    ASSERT_TRUE(crtc_planes.add_disable(request, connector_id));
+    EXPECT_TRUE(request.test());
+}
+
+TEST_F(CrtcPlanesTest, cannot_disable_without_the_crtc_properties)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    crtc_props.count_props = 0;
+
+    mgm::CrtcPlanes crtc_planes{drm_fd, crtc_ids[0]};
+    mgm::AtomicRequest request{drm_fd};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(0);
+
+    EXPECT_FALSE(crtc_planes.add_disable(request, 40));
+}
+
+TEST_F(CrtcPlanesTest, frames_of_several_crtcs_share_one_commit)
+{
+    add_plane(31, 0x1, DRM_PLANE_TYPE_PRIMARY);
+    add_plane(41, 0x2, DRM_PLANE_TYPE_PRIMARY);
+
+    mgm::CrtcPlanes first{drm_fd, crtc_ids[0]};
+    mgm::CrtcPlanes second{drm_fd, crtc_ids[1]};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 31, crtc_id_prop, crtc_ids[0]));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, 41, crtc_id_prop, crtc_ids[1]));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .Times(1);
+
+    mgm::AtomicRequest request{drm_fd};
+    ASSERT_TRUE(first.add_frame(request, primary_state, {}));
+    ASSERT_TRUE(second.add_frame(request, primary_state, {}));
+    request.commit(DRM_MODE_ATOMIC_NONBLOCK, nullptr);
+}
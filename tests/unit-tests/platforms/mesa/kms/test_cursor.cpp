@@ -806,3 +806,92 @@ TEST_F(MesaCursorTest, show_cursor_sets_cursor_with_hotspot)
     cursor.move_to(cursor_location_2);
 }
 
+
+namespace
+{
+struct FilledCursorImage : public StubCursorImage
+{
+    explicit FilledCursorImage(uint32_t colour)
+        : pixels(64*64, colour)
+    {
+    }
+
+    void const* as_argb_8888() const override
+    {
+        return pixels.data();
+    }
+
+    std::vector<uint32_t> const pixels;
+};
+}
+
+TEST_F(MesaCursorTest, reshowing_a_cached_image_sets_cursor_without_writing_to_bo)
+{
+    using namespace testing;
+
+    FilledCursorImage const arrow{0xff000000};
+    FilledCursorImage const hand{0xffffffff};
+
+    cursor.show(arrow);
+    cursor.show(hand);
+
+    Mock::VerifyAndClearExpectations(&mock_gbm);
+    output_container.verify_and_clear_expectations();
+
+    EXPECT_CALL(mock_gbm, gbm_bo_write(_, _, _)).Times(0);
+    EXPECT_CALL(mock_gbm, gbm_bo_create(_, _, _, _, _)).Times(0);
+    EXPECT_CALL(*output_container.outputs[0], set_cursor(_)).Times(2);
+
+    cursor.show(arrow);
+    cursor.show(hand);
+}
+
+TEST_F(MesaCursorTest, images_with_the_same_content_share_cached_buffers)
+{
+    using namespace testing;
+
+    cursor.show(FilledCursorImage{0xff00ff00});
+
+    Mock::VerifyAndClearExpectations(&mock_gbm);
+
+    EXPECT_CALL(mock_gbm, gbm_bo_write(_, _, _)).Times(0);
+
+    cursor.show(FilledCursorImage{0xff00ff00});
+}
+
+TEST_F(MesaCursorTest, each_new_image_is_written_once)
+{
+    using namespace testing;
+
+    EXPECT_CALL(mock_gbm, gbm_bo_write(_, _, _)).Times(2);
+
+    cursor.show(FilledCursorImage{0xff0000ff});
+    cursor.show(FilledCursorImage{0xffff0000});
+    cursor.show(FilledCursorImage{0xff0000ff});
+}
+
+TEST_F(MesaCursorTest, cached_image_is_kept_for_each_orientation)
+{
+    using namespace testing;
+
+    geom::Point const on_normal_output{10, 10};
+    geom::Point const on_rotated_output{766, 112};
+
+    FilledCursorImage const arrow{0xff000000};
+    FilledCursorImage const hand{0xffffffff};
+
+    cursor.show(arrow);
+    cursor.move_to(on_rotated_output);
+    cursor.show(hand);
+    cursor.move_to(on_normal_output);
+
+    Mock::VerifyAndClearExpectations(&mock_gbm);
+
+    // Output 2 is right-rotated: moving between outputs must not re-rotate either image
+    EXPECT_CALL(mock_gbm, gbm_bo_write(_, _, _)).Times(0);
+
+    cursor.move_to(on_rotated_output);
+    cursor.show(arrow);
+    cursor.move_to(on_normal_output);
+    cursor.show(hand);
+}
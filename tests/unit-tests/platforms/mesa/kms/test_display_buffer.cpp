@@ -20,6 +20,8 @@
 #include "mir/test/doubles/null_virtual_terminal.h"
 #include "src/platforms/mesa/server/kms/platform.h"
 #include "src/platforms/mesa/server/kms/display_buffer.h"
+#include "src/platforms/mesa/server/kms/atomic_request.h"
+#include "src/platforms/mesa/server/kms/page_flipper.h"
 #include "src/platforms/mesa/include/native_buffer.h"
 #include "src/server/report/null_report_factory.h"
 #include "mir/test/doubles/mock_egl.h"
@@ -48,6 +50,16 @@ using namespace mir::graphics;
 using namespace mir::graphics::mesa;
 using mir::report::null_display_report;
 
+namespace
+{
+struct MockPageFlipper : PageFlipper
+{
+    MOCK_METHOD3(schedule_flip, bool(uint32_t, uint32_t, uint32_t));
+    MOCK_METHOD2(schedule_flip, bool(std::vector<PageFlipTarget> const&, std::function<int(void*)> const&));
+    MOCK_METHOD1(wait_for_flip, Frame(uint32_t));
+};
+}
+
 class MesaDisplayBufferTest : public Test
 {
 public:
@@ -207,6 +219,28 @@ TEST_F(MesaDisplayBufferTest, predictive_bypass_is_throttled)
     }
 }
 
+TEST_F(MesaDisplayBufferTest, bypass_is_not_throttled_with_adaptive_sync)
+{
+    ON_CALL(*mock_kms_output, adaptive_sync())
+        .WillByDefault(Return(true));
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        {});
+
+    for (int frame = 0; frame < 5; ++frame)
+    {
+        ASSERT_TRUE(db.overlay(bypassable_list));
+        db.post();
+
+        ASSERT_EQ(0, db.recommended_sleep().count());
+    }
+}
+
 TEST_F(MesaDisplayBufferTest, frames_requiring_gl_are_not_throttled)
 {
     graphics::RenderableList non_bypassable_list{
@@ -503,3 +537,195 @@ TEST_F(MesaDisplayBufferTest, buffer_requiring_migration_is_ineligable_for_bypas
 
     EXPECT_FALSE(db.overlay(bypassable_list));
 }
+
+TEST_F(MesaDisplayBufferTest, scanout_capable_window_goes_on_an_overlay_plane)
+{
+    auto const window = std::make_shared<FakeRenderable>(geometry::Rectangle{{20, 40}, {10, 10}});
+    auto const window_buffer = std::make_shared<NiceMock<MockBuffer>>();
+    ON_CALL(*window_buffer, size())
+        .WillByDefault(Return(geometry::Size{10, 10}));
+    ON_CALL(*window_buffer, native_buffer_handle())
+        .WillByDefault(Return(std::make_shared<StubGBMNativeBuffer>(geometry::Size{10, 10})));
+    window->set_buffer(window_buffer);
+
+    ON_CALL(mock_gbm, gbm_bo_get_format(_))
+        .WillByDefault(Return(GBM_BO_FORMAT_XRGB8888));
+    ON_CALL(*mock_kms_output, overlay_planes())
+        .WillByDefault(Return(std::vector<KMSPlane>{{40, {GBM_FORMAT_XRGB8888}, true}}));
+    ON_CALL(*mock_kms_output, test_overlays_thunk(_, _))
+        .WillByDefault(Return(true));
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        {});
+
+    graphics::RenderableList remainder;
+    EXPECT_FALSE(db.overlay({fake_software_renderable, window}, remainder));
+    EXPECT_THAT(remainder, ElementsAre(fake_software_renderable));
+
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_, ElementsAre(
+        Field(&OverlayPlacement::destination, Eq(geometry::Rectangle{{8, 6}, {10, 10}})))))
+        .WillOnce(Return(true));
+
+    auto const original_count = window_buffer.use_count();
+    db.swap_buffers();
+    db.post();
+
+    // Held until the next frame replaces it on screen, like bypass buffers
+    EXPECT_EQ(original_count, window_buffer.use_count());
+}
+
+TEST_F(MesaDisplayBufferTest, overlays_rejected_by_the_hardware_are_composited)
+{
+    auto const window = std::make_shared<FakeRenderable>(geometry::Rectangle{{20, 40}, {10, 10}});
+    auto const window_buffer = std::make_shared<NiceMock<MockBuffer>>();
+    ON_CALL(*window_buffer, size())
+        .WillByDefault(Return(geometry::Size{10, 10}));
+    ON_CALL(*window_buffer, native_buffer_handle())
+        .WillByDefault(Return(std::make_shared<StubGBMNativeBuffer>(geometry::Size{10, 10})));
+    window->set_buffer(window_buffer);
+
+    ON_CALL(mock_gbm, gbm_bo_get_format(_))
+        .WillByDefault(Return(GBM_BO_FORMAT_XRGB8888));
+    ON_CALL(*mock_kms_output, overlay_planes())
+        .WillByDefault(Return(std::vector<KMSPlane>{{40, {GBM_FORMAT_XRGB8888}, true}}));
+    ON_CALL(*mock_kms_output, test_overlays_thunk(_, _))
+        .WillByDefault(Return(false));
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        {});
+
+    graphics::RenderableList const list{fake_software_renderable, window};
+    graphics::RenderableList remainder;
+    EXPECT_FALSE(db.overlay(list, remainder));
+    EXPECT_THAT(remainder, Eq(list));
+
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_, _))
+        .Times(0);
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .WillOnce(Return(true));
+
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, clones_flip_together_in_one_atomic_commit)
+{
+    auto const other_output = std::make_shared<NiceMock<MockKMSOutput>>();
+    MockPageFlipper flipper;
+
+    auto const add_flip_target =
+        [&](uint32_t crtc_id)
+        {
+            return [&flipper, crtc_id](AtomicRequest* request, FBHandle const*, std::vector<OverlayPlacement> const&)
+                {
+                    request->add_flip_target(flipper, crtc_id, crtc_id + 1);
+                    return true;
+                };
+        };
+    ON_CALL(*mock_kms_output, add_page_flip_to_thunk(_, _, _))
+        .WillByDefault(Invoke(add_flip_target(10)));
+    ON_CALL(*other_output, add_page_flip_to_thunk(_, _, _))
+        .WillByDefault(Invoke(add_flip_target(20)));
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output, other_output},
+        make_output_surface(),
+        display_area,
+        {});
+
+    EXPECT_CALL(flipper, schedule_flip(SizeIs(2), _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(0);
+    EXPECT_CALL(*other_output, schedule_page_flip_thunk(_))
+        .Times(0);
+
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, clones_flip_separately_without_atomic_modesetting)
+{
+    auto const other_output = std::make_shared<NiceMock<MockKMSOutput>>();
+
+    ON_CALL(*mock_kms_output, add_page_flip_to_thunk(_, _, _))
+        .WillByDefault(Return(true));
+    ON_CALL(*other_output, add_page_flip_to_thunk(_, _, _))
+        .WillByDefault(Return(false));
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output, other_output},
+        make_output_surface(),
+        display_area,
+        {});
+
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*other_output, schedule_page_flip_thunk(_))
+        .WillOnce(Return(true));
+
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, sets_crtcs_in_one_atomic_modeset_where_possible)
+{
+    auto const other_output = std::make_shared<NiceMock<MockKMSOutput>>();
+
+    ON_CALL(*mock_kms_output, add_set_crtc_to_thunk(_, _))
+        .WillByDefault(Return(true));
+    ON_CALL(*other_output, add_set_crtc_to_thunk(_, _))
+        .WillByDefault(Return(true));
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output, other_output},
+        make_output_surface(),
+        display_area,
+        {});
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(*mock_kms_output, set_crtc_thunk(_))
+        .Times(0);
+    EXPECT_CALL(*other_output, set_crtc_thunk(_))
+        .Times(0);
+
+    db.set_crtc();
+}
+
+TEST_F(MesaDisplayBufferTest, sets_crtcs_one_by_one_when_the_atomic_modeset_fails)
+{
+    ON_CALL(*mock_kms_output, add_set_crtc_to_thunk(_, _))
+        .WillByDefault(Return(true));
+    ON_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .WillByDefault(Return(-EINVAL));
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        {});
+
+    EXPECT_CALL(*mock_kms_output, set_crtc_thunk(_))
+        .WillOnce(Return(true));
+
+    db.set_crtc();
+}
@@ -0,0 +1,302 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/report/null_report_factory.h"
+#include "src/platforms/mesa/server/kms/dumb_display_buffer.h"
+#include "mir/test/doubles/mock_drm.h"
+#include "mock_kms_output.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <drm_fourcc.h>
+#include <system_error>
+
+using namespace testing;
+using namespace mir::graphics::mesa;
+namespace geom = mir::geometry;
+namespace mrs = mir::renderer::software;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+using mir::report::null_display_report;
+
+namespace
+{
+class MesaDumbDisplayBufferTest : public Test
+{
+public:
+    MesaDumbDisplayBufferTest()
+    {
+        if (ftruncate(fd, 2 * buffer_size) != 0)
+            throw std::system_error{errno, std::system_category(), "Failed to size fake DRM device"};
+
+        ON_CALL(mock_drm, drmIoctl(fd, DRM_IOCTL_MODE_CREATE_DUMB, _))
+            .WillByDefault(Invoke(
+                [this](int, unsigned long, void* arg)
+                {
+                    auto const params = static_cast<drm_mode_create_dumb*>(arg);
+                    params->handle = ++dumb_buffers_created;
+                    params->pitch = pitch;
+                    params->size = buffer_size;
+                    return 0;
+                }));
+        ON_CALL(mock_drm, drmIoctl(fd, DRM_IOCTL_MODE_MAP_DUMB, _))
+            .WillByDefault(Invoke(
+                [](int, unsigned long, void* arg)
+                {
+                    auto const params = static_cast<drm_mode_map_dumb*>(arg);
+                    params->offset = (params->handle - 1) * buffer_size;
+                    return 0;
+                }));
+        ON_CALL(mock_drm, drmModeAddFB2(fd, _, _, _, _, _, _, _, _))
+            .WillByDefault(Invoke(
+                [](int, uint32_t, uint32_t, uint32_t, uint32_t const handles[4],
+                   uint32_t const[4], uint32_t const[4], uint32_t* buf_id, uint32_t)
+                {
+                    *buf_id = fb_id_base + handles[0];
+                    return 0;
+                }));
+
+        ON_CALL(*mock_kms_output, drm_fd())
+            .WillByDefault(Return(fd));
+        ON_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+            .WillByDefault(Return(true));
+        ON_CALL(*mock_kms_output, set_crtc_thunk(_))
+            .WillByDefault(Return(true));
+    }
+
+    ~MesaDumbDisplayBufferTest()
+    {
+        close(fd);
+    }
+
+    std::unique_ptr<DumbDisplayBuffer> make_display_buffer(
+        std::vector<std::shared_ptr<KMSOutput>> const& outputs)
+    {
+        return std::make_unique<DumbDisplayBuffer>(
+            null_display_report(),
+            outputs,
+            size,
+            geom::Rectangle{{0, 0}, size},
+            glm::mat2{1});
+    }
+
+    std::unique_ptr<DumbDisplayBuffer> make_display_buffer()
+    {
+        return make_display_buffer({mock_kms_output});
+    }
+
+    static uint32_t constexpr width{64};
+    static uint32_t constexpr height{64};
+    /* Dumb buffer rows are typically padded, so make sure we honour the pitch */
+    static uint32_t constexpr pitch{width * 4 + 64};
+    /* ...a whole number of pages, so that both buffers can be mapped */
+    static size_t constexpr buffer_size{pitch * height};
+    static uint32_t constexpr fb_id_base{100};
+    geom::Size const size{width, height};
+
+    int const fd{memfd_create("fake-drm", MFD_CLOEXEC)};
+    uint32_t dumb_buffers_created{0};
+
+    NiceMock<mtd::MockDRM> mock_drm;
+    std::shared_ptr<NiceMock<mt::MockKMSOutput>> const mock_kms_output{
+        std::make_shared<NiceMock<mt::MockKMSOutput>>()};
+};
+
+uint32_t constexpr MesaDumbDisplayBufferTest::width;
+uint32_t constexpr MesaDumbDisplayBufferTest::height;
+uint32_t constexpr MesaDumbDisplayBufferTest::pitch;
+size_t constexpr MesaDumbDisplayBufferTest::buffer_size;
+uint32_t constexpr MesaDumbDisplayBufferTest::fb_id_base;
+
+MATCHER_P(FBWithId, id, "")
+{
+    return arg->get_drm_fb_id() == id;
+}
+}
+
+TEST_F(MesaDumbDisplayBufferTest, creates_two_xrgb_framebuffers_of_the_output_size)
+{
+    EXPECT_CALL(mock_drm, drmIoctl(_, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmIoctl(fd, DRM_IOCTL_MODE_CREATE_DUMB,
+        Truly([this](void* arg)
+        {
+            auto const params = static_cast<drm_mode_create_dumb*>(arg);
+            return params->width == width && params->height == height && params->bpp == 32;
+        })))
+        .Times(2);
+    EXPECT_CALL(mock_drm, drmModeAddFB2(fd, width, height, DRM_FORMAT_XRGB8888, _, _, _, _, _))
+        .Times(2);
+
+    make_display_buffer();
+}
+
+TEST_F(MesaDumbDisplayBufferTest, back_buffer_is_mapped_for_cpu_writes)
+{
+    auto const db = make_display_buffer();
+
+    auto const frame = db->map_back_buffer();
+
+    EXPECT_THAT(frame.size, Eq(size));
+    EXPECT_THAT(frame.stride, Eq(geom::Stride{pitch}));
+    EXPECT_THAT(frame.format, Eq(mir_pixel_format_xrgb_8888));
+
+    frame.pixels[pitch * (height - 1) + 4 * (width - 1)] = 0xa5;
+
+    unsigned char written{0};
+    auto const back_offset = buffer_size;
+    ASSERT_THAT(
+        pread(fd, &written, 1, back_offset + pitch * (height - 1) + 4 * (width - 1)),
+        Eq(1));
+    EXPECT_THAT(written, Eq(0xa5));
+}
+
+TEST_F(MesaDumbDisplayBufferTest, buffers_start_out_black)
+{
+    ASSERT_THAT(pwrite(fd, "junk", 4, 0), Eq(4));
+
+    auto const db = make_display_buffer();
+
+    char shown[4] = {1, 1, 1, 1};
+    ASSERT_THAT(pread(fd, shown, 4, 0), Eq(4));
+    EXPECT_THAT(shown, Each(Eq(0)));
+}
+
+TEST_F(MesaDumbDisplayBufferTest, set_crtc_shows_the_front_buffer)
+{
+    auto const db = make_display_buffer();
+
+    EXPECT_CALL(*mock_kms_output, set_crtc_thunk(FBWithId(fb_id_base + 1)))
+        .WillOnce(Return(true));
+
+    db->set_crtc();
+}
+
+TEST_F(MesaDumbDisplayBufferTest, post_flips_to_the_buffer_drawn_into)
+{
+    auto const db = make_display_buffer();
+
+    {
+        InSequence seq;
+        EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(FBWithId(fb_id_base + 2)))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*mock_kms_output, wait_for_page_flip());
+        EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(FBWithId(fb_id_base + 1)))
+            .WillOnce(Return(true));
+        EXPECT_CALL(*mock_kms_output, wait_for_page_flip());
+    }
+
+    auto const first = db->map_back_buffer().pixels;
+    db->swap_buffers();
+    db->post();
+
+    auto const second = db->map_back_buffer().pixels;
+    db->swap_buffers();
+    db->post();
+
+    EXPECT_THAT(second, Ne(first));
+}
+
+TEST_F(MesaDumbDisplayBufferTest, post_without_a_new_frame_shows_the_front_buffer_again)
+{
+    auto const db = make_display_buffer();
+
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(FBWithId(fb_id_base + 1)))
+        .WillOnce(Return(true));
+
+    db->post();
+}
+
+TEST_F(MesaDumbDisplayBufferTest, falls_back_to_set_crtc_when_page_flip_fails)
+{
+    auto const db = make_display_buffer();
+
+    ON_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .WillByDefault(Return(false));
+    EXPECT_CALL(*mock_kms_output, set_crtc_thunk(FBWithId(fb_id_base + 2)))
+        .WillOnce(Return(true));
+
+    db->map_back_buffer();
+    db->swap_buffers();
+    db->post();
+}
+
+TEST_F(MesaDumbDisplayBufferTest, clone_flip_completes_before_back_buffer_is_drawn_into)
+{
+    auto const other_output = std::make_shared<NiceMock<mt::MockKMSOutput>>();
+    ON_CALL(*other_output, drm_fd()).WillByDefault(Return(fd));
+    ON_CALL(*other_output, schedule_page_flip_thunk(_)).WillByDefault(Return(true));
+
+    auto const db = make_display_buffer({mock_kms_output, other_output});
+
+    db->map_back_buffer();
+    db->swap_buffers();
+
+    {
+        InSequence seq;
+        EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_));
+        EXPECT_CALL(*other_output, schedule_page_flip_thunk(_));
+    }
+    EXPECT_CALL(*mock_kms_output, wait_for_page_flip()).Times(0);
+    EXPECT_CALL(*other_output, wait_for_page_flip()).Times(0);
+
+    db->post();
+
+    Mock::VerifyAndClearExpectations(mock_kms_output.get());
+    Mock::VerifyAndClearExpectations(other_output.get());
+
+    EXPECT_CALL(*mock_kms_output, wait_for_page_flip());
+    EXPECT_CALL(*other_output, wait_for_page_flip());
+
+    db->map_back_buffer();
+}
+
+TEST_F(MesaDumbDisplayBufferTest, is_a_software_render_target)
+{
+    auto const db = make_display_buffer();
+
+    EXPECT_THAT(dynamic_cast<mrs::RenderTarget*>(db->native_display_buffer()), NotNull());
+}
+
+TEST_F(MesaDumbDisplayBufferTest, never_overlays_client_buffers)
+{
+    auto const db = make_display_buffer();
+
+    EXPECT_FALSE(db->overlay({}));
+}
+
+TEST_F(MesaDumbDisplayBufferTest, releases_framebuffers_and_dumb_buffers)
+{
+    auto db = make_display_buffer();
+
+    EXPECT_CALL(mock_drm, drmIoctl(_, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeRmFB(fd, fb_id_base + 1));
+    EXPECT_CALL(mock_drm, drmModeRmFB(fd, fb_id_base + 2));
+    EXPECT_CALL(mock_drm, drmIoctl(fd, DRM_IOCTL_MODE_DESTROY_DUMB, _))
+        .Times(2);
+
+    db.reset();
+}
+
+TEST_F(MesaDumbDisplayBufferTest, throws_if_dumb_buffers_are_unsupported)
+{
+    ON_CALL(mock_drm, drmIoctl(fd, DRM_IOCTL_MODE_CREATE_DUMB, _))
+        .WillByDefault(SetErrnoAndReturn(ENOSYS, -1));
+
+    EXPECT_THROW(make_display_buffer(), std::system_error);
+}
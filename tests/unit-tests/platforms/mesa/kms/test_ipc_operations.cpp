@@ -145,4 +145,5 @@ TEST_F(IpcOperations, gets_authentication_fd_for_connection_package)
     auto connection_package = ipc_ops.connection_ipc_package();
     ASSERT_THAT(connection_package->ipc_fds.size(), Eq(1u));
     EXPECT_THAT(connection_package->ipc_fds[0], mtd::RawFdMatcher(stub_fd));
+    EXPECT_THAT(connection_package->client_module, StrEq("mesa"));
 }
@@ -274,31 +274,27 @@ private:
 
 }
 
-TEST_F(KMSPageFlipperTest, threads_switch_worker)
+TEST_F(KMSPageFlipperTest, threads_are_released_by_their_own_flip_events)
 {
     using namespace testing;
 
-    size_t const worker_index{0};
-    size_t const other_index{1};
+    size_t const first_index{0};
+    size_t const second_index{1};
     std::vector<uint32_t> const crtc_ids{10, 11};
     std::vector<void*> user_data{nullptr, nullptr};
     std::vector<std::unique_ptr<PageFlippingFunctor>> page_flipping_functors;
     std::vector<std::thread> page_flipping_threads;
-    std::thread::id tid;
 
     EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, _, _, _, _))
         .Times(2)
-        .WillOnce(DoAll(SaveArg<4>(&user_data[worker_index]), Return(0)))
-        .WillOnce(DoAll(SaveArg<4>(&user_data[other_index]), Return(0)));
+        .WillOnce(DoAll(SaveArg<4>(&user_data[first_index]), Return(0)))
+        .WillOnce(DoAll(SaveArg<4>(&user_data[second_index]), Return(0)));
 
-    /*
-     * The first event releases the original worker, hence we expect that
-     * then the other thread will become the worker.
-     */
+    /* The events arrive in the opposite order to the flips */
     EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
         .Times(2)
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[worker_index]), Return(0)))
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[other_index]), Return(0)));
+        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[second_index]), Return(0)))
+        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[first_index]), Return(0)));
 
     /* Start the page-flipping threads */
     for (auto crtc_id : crtc_ids)
@@ -311,97 +307,100 @@ TEST_F(KMSPageFlipperTest, threads_switch_worker)
         while (page_flipping_functors.back()->page_flip_count() == 0)
             std::this_thread::sleep_for(std::chrono::milliseconds{1});
         page_flipping_functors.back()->stop();
-
-        /* Wait until the (first) thread has become the worker */
-        while (tid == std::thread::id())
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-            tid = page_flipper.debug_get_worker_tid();
-        }
     }
 
-    EXPECT_EQ(page_flipping_threads[worker_index].get_id(), tid);
-
     /* Fake a DRM event */
     mock_drm.generate_event_on(drm_device);
 
-    page_flipping_threads[worker_index].join();
+    /* The second thread's flip has completed... */
+    page_flipping_threads[second_index].join();
 
-    /* Wait for the worker to switch */
-    while (tid != page_flipping_threads[other_index].get_id())
-    {
-        std::this_thread::sleep_for(std::chrono::milliseconds{1});
-        tid = page_flipper.debug_get_worker_tid();
-    }
+    /* ...but not the first's */
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_EQ(0, page_flipping_functors[first_index]->wait_count());
 
     /* Fake another DRM event to unblock the remaining thread */
     mock_drm.generate_event_on(drm_device);
 
-    page_flipping_threads[other_index].join();
+    page_flipping_threads[first_index].join();
 }
 
-TEST_F(KMSPageFlipperTest, threads_worker_notifies_non_worker)
+#if DRM_EVENT_CONTEXT_VERSION >= 3 && defined(DRM_CAP_CRTC_IN_VBLANK_EVENT)
+namespace
+{
+
+ACTION_P2(InvokePageFlipHandler2, param, crtc_id)
+{
+    int const dont_care{0};
+    char dummy;
+
+    arg1->page_flip_handler2(dont_care, dont_care, dont_care, dont_care, crtc_id, *param);
+    ASSERT_EQ(1, read(arg0, &dummy, 1));
+}
+
+}
+
+TEST_F(KMSPageFlipperTest, flip_of_several_crtcs_completes_each_separately)
 {
     using namespace testing;
 
-    size_t const worker_index{0};
-    size_t const other_index{1};
-    std::vector<uint32_t> const crtc_ids{10, 11};
-    std::vector<void*> user_data{nullptr, nullptr};
-    std::vector<std::unique_ptr<PageFlippingFunctor>> page_flipping_functors;
-    std::vector<std::thread> page_flipping_threads;
-    std::thread::id tid;
+    std::vector<mgm::PageFlipTarget> const targets{{10, 23}, {11, 45}};
+    void* user_data{nullptr};
 
-    EXPECT_CALL(mock_drm, drmModePageFlip(drm_fd, _, _, _, _))
-        .Times(2)
-        .WillOnce(DoAll(SaveArg<4>(&user_data[worker_index]), Return(0)))
-        .WillOnce(DoAll(SaveArg<4>(&user_data[other_index]), Return(0)));
+    ON_CALL(mock_drm, drmGetCap(drm_fd, DRM_CAP_CRTC_IN_VBLANK_EVENT, _))
+        .WillByDefault(DoAll(SetArgPointee<2>(1), Return(0)));
 
-    /*
-     * The first event releases the non-worker thread, hence we expect that
-     * original worker not change.
-     */
     EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
         .Times(2)
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[other_index]), Return(0)))
-        .WillOnce(DoAll(InvokePageFlipHandler(&user_data[worker_index]), Return(0)));
+        .WillOnce(DoAll(InvokePageFlipHandler2(&user_data, targets[1].crtc_id), Return(0)))
+        .WillOnce(DoAll(InvokePageFlipHandler2(&user_data, targets[0].crtc_id), Return(0)));
 
-    /* Start the page-flipping threads */
-    for (auto crtc_id : crtc_ids)
-    {
-        auto pf = std::unique_ptr<PageFlippingFunctor>(new PageFlippingFunctor{page_flipper, crtc_id});
-        page_flipping_functors.push_back(std::move(pf));
-        page_flipping_threads.push_back(std::thread{std::ref(*page_flipping_functors.back())});
+    EXPECT_CALL(report, report_vsync(targets[0].connector_id, _));
+    EXPECT_CALL(report, report_vsync(targets[1].connector_id, _));
 
-        /* Wait for page-flip request and tell flipper to stop after this iteration */
-        while (page_flipping_functors.back()->page_flip_count() == 0)
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-        page_flipping_functors.back()->stop();
+    mgm::KMSPageFlipper flipper{drm_fd, mt::fake_shared(report)};
 
-        /* Wait until the (first) thread has become the worker */
-        while (tid == std::thread::id())
+    int commits{0};
+    EXPECT_TRUE(flipper.schedule_flip(
+        targets,
+        [&](void* event_data)
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds{1});
-            tid = page_flipper.debug_get_worker_tid();
-        }
-    }
-
-    EXPECT_EQ(page_flipping_threads[worker_index].get_id(), tid);
+            user_data = event_data;
+            ++commits;
+            return 0;
+        }));
+    EXPECT_EQ(1, commits);
 
-    /* Fake a DRM event */
+    mock_drm.generate_event_on(drm_device);
     mock_drm.generate_event_on(drm_device);
 
-    /* Wait for the non-worker thread to exit */
-    page_flipping_threads[other_index].join();
+    flipper.wait_for_flip(targets[0].crtc_id);
+    flipper.wait_for_flip(targets[1].crtc_id);
+}
+#endif
 
-    /* Check that the worker hasn't changed */
-    EXPECT_EQ(page_flipping_threads[worker_index].get_id(),
-              page_flipper.debug_get_worker_tid());
+TEST_F(KMSPageFlipperTest, flip_of_several_crtcs_needs_crtc_ids_in_flip_events)
+{
+    using namespace testing;
 
-    /* Fake another DRM event to unblock the remaining thread */
-    mock_drm.generate_event_on(drm_device);
+    std::vector<mgm::PageFlipTarget> const targets{{10, 23}, {11, 45}};
+
+    /* The default drmGetCap() reports no capabilities */
+    mgm::KMSPageFlipper flipper{drm_fd, mt::fake_shared(report)};
+
+    bool committed{false};
+    EXPECT_FALSE(flipper.schedule_flip(
+        targets,
+        [&](void*)
+        {
+            committed = true;
+            return 0;
+        }));
+    EXPECT_FALSE(committed);
 
-    page_flipping_threads[worker_index].join();
+    /* ...and nothing is left waiting for a flip */
+    flipper.wait_for_flip(targets[0].crtc_id);
+    flipper.wait_for_flip(targets[1].crtc_id);
 }
 
 namespace
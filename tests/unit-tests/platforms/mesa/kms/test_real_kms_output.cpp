@@ -18,6 +18,7 @@
 
 #include "src/platforms/mesa/server/kms/real_kms_output.h"
 #include "src/platforms/mesa/server/kms/page_flipper.h"
+#include "src/platforms/mesa/server/kms/atomic_request.h"
 #include "mir/fatal.h"
 
 #include "mir/test/fake_shared.h"
@@ -26,6 +27,8 @@
 #include "mir/test/doubles/mock_gbm.h"
 
 #include <stdexcept>
+#include <cstring>
+#include <map>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -46,6 +49,7 @@ class NullPageFlipper : public mgm::PageFlipper
 {
 public:
     bool schedule_flip(uint32_t,uint32_t,uint32_t) override { return true; }
+    bool schedule_flip(std::vector<mgm::PageFlipTarget> const&, std::function<int(void*)> const&) override { return true; }
     mg::Frame wait_for_flip(uint32_t) override { return {}; }
 };
 
@@ -53,6 +57,7 @@ class MockPageFlipper : public mgm::PageFlipper
 {
 public:
     MOCK_METHOD3(schedule_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD2(schedule_flip, bool(std::vector<mgm::PageFlipTarget> const&, std::function<int(void*)> const&));
     MOCK_METHOD1(wait_for_flip, mg::Frame(uint32_t));
 };
 
@@ -73,7 +78,7 @@ public:
             .WillByDefault(Return(gbm_bo_handle{0}));
     }
 
-    void setup_outputs_connected_crtc()
+    void setup_outputs_connected_crtc(std::vector<drmModeModeInfo> modes = {})
     {
         uint32_t const possible_crtcs_mask{0x1};
 
@@ -94,7 +99,7 @@ public:
             DRM_MODE_CONNECTOR_VGA,
             DRM_MODE_CONNECTED,
             encoder_ids[0],
-            modes_empty,
+            modes,
             possible_encoder_ids1,
             geom::Size());
 
@@ -148,6 +153,63 @@ public:
         mock_drm.prepare(drm_device);
     }
 
+    /* Gives crtc_ids[0] a primary plane, and everything atomic modesetting needs */
+    void enable_atomic_modesetting()
+    {
+        memset(&primary_plane, 0, sizeof primary_plane);
+        primary_plane.plane_id = primary_plane_id;
+        primary_plane.possible_crtcs = 0x1;
+
+        memset(&plane_resources, 0, sizeof plane_resources);
+        plane_resources.count_planes = 1;
+        plane_resources.planes = &primary_plane.plane_id;
+
+        for (auto const& prop : property_names)
+        {
+            if (prop.first == vrr_capable_prop)
+                continue;
+
+            auto const is_crtc_prop =
+                prop.first == active_prop || prop.first == mode_id_prop || prop.first == vrr_enabled_prop;
+            auto& props = is_crtc_prop ? crtc_props : plane_props;
+            props.first.push_back(prop.first);
+            props.second.push_back(prop.first == type_prop ? DRM_PLANE_TYPE_PRIMARY : 0);
+        }
+
+        ON_CALL(mock_drm, drmModeGetPlaneResources(_))
+            .WillByDefault(Return(&plane_resources));
+        ON_CALL(mock_drm, drmModeGetPlane(_, primary_plane_id))
+            .WillByDefault(Return(&primary_plane));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, _, DRM_MODE_OBJECT_PLANE))
+            .WillByDefault(InvokeWithoutArgs([this] { return object_properties(plane_props); }));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, _, DRM_MODE_OBJECT_CRTC))
+            .WillByDefault(InvokeWithoutArgs([this] { return object_properties(crtc_props); }));
+        ON_CALL(mock_drm, drmModeObjectGetProperties(_, _, DRM_MODE_OBJECT_CONNECTOR))
+            .WillByDefault(InvokeWithoutArgs([this] { return object_properties(connector_props); }));
+        ON_CALL(mock_drm, drmModeGetProperty(_, _))
+            .WillByDefault(Invoke(
+                [this](int, uint32_t id)
+                {
+                    properties.push_back(std::make_unique<drmModePropertyRes>());
+                    auto const prop = properties.back().get();
+                    memset(prop, 0, sizeof *prop);
+                    prop->prop_id = id;
+                    strncpy(prop->name, property_names.at(id), sizeof prop->name - 1);
+                    return prop;
+                }));
+    }
+
+    drmModeObjectPropertiesPtr object_properties(
+        std::pair<std::vector<uint32_t>, std::vector<uint64_t>>& props)
+    {
+        object_props.push_back(std::make_unique<drmModeObjectProperties>());
+        auto const result = object_props.back().get();
+        result->count_props = props.first.size();
+        result->props = props.first.data();
+        result->prop_values = props.second.data();
+        return result;
+    }
+
     void append_fb_id(uint32_t fb_id)
     {
         EXPECT_CALL(mock_drm, drmModeAddFB2(_,_,_,_,_,_,_,_,_))
@@ -173,8 +235,28 @@ public:
     std::vector<uint32_t> const connector_ids;
     std::vector<uint32_t> possible_encoder_ids1;
     std::vector<uint32_t> possible_encoder_ids2;
+
+    enum : uint32_t { type_prop = 1, crtc_id_prop, active_prop, mode_id_prop };
+    enum : uint32_t { vrr_enabled_prop = 14, vrr_capable_prop };
+    std::map<uint32_t, char const*> const property_names{
+        {type_prop, "type"}, {crtc_id_prop, "CRTC_ID"}, {active_prop, "ACTIVE"}, {mode_id_prop, "MODE_ID"},
+        {5, "FB_ID"}, {6, "SRC_X"}, {7, "SRC_Y"}, {8, "SRC_W"}, {9, "SRC_H"},
+        {10, "CRTC_X"}, {11, "CRTC_Y"}, {12, "CRTC_W"}, {13, "CRTC_H"},
+        {vrr_enabled_prop, "VRR_ENABLED"}, {vrr_capable_prop, "vrr_capable"}};
+    uint32_t const primary_plane_id{31};
+    drmModePlane primary_plane;
+    drmModePlaneRes plane_resources;
+    std::pair<std::vector<uint32_t>, std::vector<uint64_t>> plane_props, crtc_props;
+    std::pair<std::vector<uint32_t>, std::vector<uint64_t>> connector_props{{crtc_id_prop}, {0}};
+    std::vector<std::unique_ptr<drmModeObjectProperties>> object_props;
+    std::vector<std::unique_ptr<drmModePropertyRes>> properties;
 };
 
+MATCHER_P2(flip_target, crtc_id, connector_id, "")
+{
+    return arg.crtc_id == crtc_id && arg.connector_id == connector_id;
+}
+
 }
 
 TEST_F(RealKMSOutputTest, operations_use_existing_crtc)
@@ -260,6 +342,59 @@ TEST_F(RealKMSOutputTest, operations_use_possible_crtc)
     output.wait_for_page_flip();
 }
 
+TEST_F(RealKMSOutputTest, flip_without_overlays_is_a_plain_page_flip)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{42};
+
+    setup_outputs_connected_crtc();
+    append_fb_id(fb_id);
+
+    EXPECT_CALL(mock_page_flipper, schedule_flip(crtc_ids[0], fb_id, connector_ids[0]))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_page_flipper, schedule_flip(_, _))
+        .Times(0);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+
+    EXPECT_TRUE(output.set_crtc(*fb));
+    EXPECT_TRUE(output.schedule_page_flip(*fb, {}));
+}
+
+TEST_F(RealKMSOutputTest, flip_with_overlays_is_submitted_through_the_page_flipper)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{42};
+    drmModeModeInfo mode{};
+    mode.hdisplay = 640;
+    mode.vdisplay = 480;
+
+    setup_outputs_connected_crtc({mode});
+    append_fb_id(fb_id);
+
+    EXPECT_CALL(mock_page_flipper, schedule_flip(_, _, An<uint32_t>()))
+        .Times(0);
+    EXPECT_CALL(mock_page_flipper, schedule_flip(ElementsAre(flip_target(crtc_ids[0], connector_ids[0])), _))
+        .WillOnce(Return(true));
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+
+    EXPECT_TRUE(output.set_crtc(*fb));
+    EXPECT_TRUE(output.schedule_page_flip(*fb, {{32, fb, {64, 48}, {{10, 10}, {64, 48}}}}));
+}
+
 TEST_F(RealKMSOutputTest, set_crtc_failure_is_handled_gracefully)
 {
     mir::FatalErrorStrategy on_error{mir::fatal_error_except};
@@ -276,7 +411,7 @@ TEST_F(RealKMSOutputTest, set_crtc_failure_is_handled_gracefully)
             .Times(1)
             .WillOnce(Return(1));
 
-        EXPECT_CALL(mock_page_flipper, schedule_flip(_, _, _))
+        EXPECT_CALL(mock_page_flipper, schedule_flip(_, _, An<uint32_t>()))
             .Times(0);
 
         EXPECT_CALL(mock_page_flipper, wait_for_flip(_))
@@ -522,3 +657,214 @@ TEST_F(RealKMSOutputTest, drm_set_gamma_failure_does_not_throw)
 
     EXPECT_NO_THROW(output.set_gamma(gamma););
 }
+
+TEST_F(RealKMSOutputTest, takes_no_part_in_atomic_commits_without_atomic_modesetting)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{42};
+
+    setup_outputs_connected_crtc();
+    append_fb_id(fb_id);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(0);
+
+    mgm::AtomicRequest request{drm_fd};
+    EXPECT_FALSE(output.add_set_crtc_to(request, *fb));
+    EXPECT_FALSE(output.add_page_flip_to(request, *fb, {}));
+}
+
+TEST_F(RealKMSOutputTest, atomic_page_flip_completes_through_the_page_flipper)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{42};
+    drmModeModeInfo mode{};
+    mode.hdisplay = 640;
+    mode.vdisplay = 480;
+
+    setup_outputs_connected_crtc({mode});
+    enable_atomic_modesetting();
+    append_fb_id(fb_id);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, primary_plane_id, 5, fb_id));
+    EXPECT_CALL(mock_page_flipper, schedule_flip(ElementsAre(flip_target(crtc_ids[0], connector_ids[0])), _))
+        .WillOnce(Return(true));
+
+    mgm::AtomicRequest request{drm_fd};
+    ASSERT_TRUE(output.add_page_flip_to(request, *fb, {}));
+    EXPECT_TRUE(request.flip());
+}
+
+TEST_F(RealKMSOutputTest, atomic_set_crtc_sets_mode_and_routing)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{42};
+    drmModeModeInfo mode{};
+    mode.hdisplay = 640;
+    mode.vdisplay = 480;
+
+    setup_outputs_connected_crtc({mode});
+    enable_atomic_modesetting();
+    append_fb_id(fb_id);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], active_prop, 1));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, connector_ids[0], crtc_id_prop, crtc_ids[0]));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+        .WillOnce(Return(0));
+
+    mgm::AtomicRequest request{drm_fd};
+    request.allow_modeset();
+    ASSERT_TRUE(output.add_set_crtc_to(request, *fb));
+    EXPECT_THAT(request.commit(0, nullptr), Eq(0));
+
+    /* Only the original CRTC state being restored is left to legacy modesetting */
+    Mock::VerifyAndClearExpectations(&mock_drm);
+}
+
+TEST_F(RealKMSOutputTest, atomic_set_crtc_enables_adaptive_sync_on_a_vrr_capable_connector)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc({drmModeModeInfo()});
+    enable_atomic_modesetting();
+    connector_props.first.push_back(vrr_capable_prop);
+    connector_props.second.push_back(1);
+    append_fb_id(42);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+    output.set_adaptive_sync(true);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], vrr_enabled_prop, 1));
+
+    mgm::AtomicRequest request{drm_fd};
+    request.allow_modeset();
+    ASSERT_TRUE(output.add_set_crtc_to(request, *fb));
+    EXPECT_FALSE(output.adaptive_sync());
+    ASSERT_THAT(request.commit(0, nullptr), Eq(0));
+    EXPECT_TRUE(output.adaptive_sync());
+}
+
+TEST_F(RealKMSOutputTest, adaptive_sync_needs_a_vrr_capable_connector)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc({drmModeModeInfo()});
+    enable_atomic_modesetting();
+    append_fb_id(42);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    auto fb = output.fb_for(fake_bo);
+    output.set_adaptive_sync(true);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], vrr_enabled_prop, 0));
+
+    mgm::AtomicRequest request{drm_fd};
+    request.allow_modeset();
+    ASSERT_TRUE(output.add_set_crtc_to(request, *fb));
+    ASSERT_THAT(request.commit(0, nullptr), Eq(0));
+    EXPECT_FALSE(output.adaptive_sync());
+}
+
+TEST_F(RealKMSOutputTest, atomic_clear_crtc_turns_off_the_crtc_and_unroutes_the_connector)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc({drmModeModeInfo()});
+    enable_atomic_modesetting();
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, crtc_ids[0], active_prop, 0));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, connector_ids[0], crtc_id_prop, 0));
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(_, _, _, _, _, _, _, _))
+        .Times(0);
+
+    mgm::AtomicRequest request{drm_fd};
+    request.allow_modeset();
+    EXPECT_TRUE(output.add_clear_crtc_to(request));
+}
+
+TEST_F(RealKMSOutputTest, atomic_clear_crtc_adds_nothing_if_no_crtc_is_found)
+{
+    using namespace testing;
+
+    uint32_t const possible_crtcs_mask_empty{0x0};
+
+    mock_drm.reset(drm_device);
+
+    mock_drm.add_encoder(
+        drm_device,
+        encoder_ids[0],
+        invalid_id,
+        possible_crtcs_mask_empty);
+    mock_drm.add_connector(
+        drm_device,
+        connector_ids[0],
+        DRM_MODE_CONNECTOR_VGA,
+        DRM_MODE_CONNECTED,
+        encoder_ids[0],
+        modes_empty,
+        possible_encoder_ids1,
+        geom::Size());
+
+    mock_drm.prepare(drm_device);
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _))
+        .Times(0);
+
+    mgm::AtomicRequest request{drm_fd};
+    EXPECT_TRUE(output.add_clear_crtc_to(request));
+}
@@ -417,12 +417,123 @@ TEST_F(NestedDisplayBuffer, rejects_list_containing_buffers_with_different_size_
     EXPECT_FALSE(display_buffer->overlay(list));
 }
 
-/* Once we have synchronous MirWindow scene updates, we can probably
- * passthrough more than one renderable if needed
- */
-TEST_F(NestedDisplayBuffer, rejects_list_containing_multiple_onscreen_renderables)
+TEST_F(NestedDisplayBuffer, accepts_list_of_layers_stacked_on_a_fullscreen_renderable)
 {
-    StubNestedBuffer nested_buffer; 
+    StubNestedBuffer fullscreen_buffer;
+    StubNestedBuffer layer_buffer;
+    geom::Rectangle small_rect { {10, 10}, { 5, 5 }};
+    mg::RenderableList list = {
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(fullscreen_buffer), rectangle),
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(layer_buffer), small_rect) };
+
+    auto display_buffer = create_display_buffer(host_connection);
+    EXPECT_TRUE(display_buffer->overlay(list));
+}
+
+TEST_F(NestedDisplayBuffer, creates_a_chain_per_layer)
+{
+    NiceMock<MockHostSurface> mock_host_surface;
+    mtd::MockHostConnection mock_host_connection;
+    StubNestedBuffer fullscreen_buffer;
+    StubNestedBuffer layer_buffer;
+    geom::Rectangle small_rect { {10, 10}, { 5, 5 }};
+    mg::RenderableList list = {
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(fullscreen_buffer), rectangle),
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(layer_buffer), small_rect) };
+
+    EXPECT_CALL(mock_host_connection, create_surface(_,_,_,_,_))
+        .WillOnce(Return(mt::fake_shared(mock_host_surface)));
+    EXPECT_CALL(mock_host_connection, create_stream(_))
+        .WillOnce(InvokeWithoutArgs([] { return std::make_unique<NiceMock<MockNestedStream>>(); }));
+    EXPECT_CALL(mock_host_connection, create_chain())
+        .Times(2)
+        .WillRepeatedly(InvokeWithoutArgs([] { return std::make_unique<NiceMock<MockNestedChain>>(); }));
+    EXPECT_CALL(mock_host_surface, apply_spec(_))
+        .Times(1);
+
+    auto display_buffer = create_display_buffer(mt::fake_shared(mock_host_connection));
+    EXPECT_TRUE(display_buffer->overlay(list));
+    EXPECT_TRUE(display_buffer->overlay(list));
+}
+
+TEST_F(NestedDisplayBuffer, submits_to_chains_before_showing_them)
+{
+    NiceMock<MockHostSurface> mock_host_surface;
+    mtd::MockHostConnection mock_host_connection;
+    StubNestedBuffer fullscreen_buffer;
+    StubNestedBuffer layer_buffer;
+    geom::Rectangle small_rect { {10, 10}, { 5, 5 }};
+    mg::RenderableList list = {
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(fullscreen_buffer), rectangle),
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(layer_buffer), small_rect) };
+
+    auto mock_chain = std::make_unique<NiceMock<MockNestedChain>>();
+    auto mock_chain2 = std::make_unique<NiceMock<MockNestedChain>>();
+
+    EXPECT_CALL(mock_host_connection, create_surface(_,_,_,_,_))
+        .WillOnce(Return(mt::fake_shared(mock_host_surface)));
+    EXPECT_CALL(mock_host_connection, create_stream(_))
+        .WillOnce(InvokeWithoutArgs([] { return std::make_unique<NiceMock<MockNestedStream>>(); }));
+    EXPECT_CALL(mock_host_connection, create_chain())
+        .WillOnce(InvokeWithoutArgs([&] { return std::move(mock_chain); }))
+        .WillOnce(InvokeWithoutArgs([&] { return std::move(mock_chain2); }));
+
+    Sequence first_chain, second_chain;
+    EXPECT_CALL(*mock_chain, submit_buffer(_))
+        .InSequence(first_chain);
+    EXPECT_CALL(*mock_chain2, submit_buffer(_))
+        .InSequence(second_chain);
+    EXPECT_CALL(mock_host_surface, apply_spec(_))
+        .InSequence(first_chain, second_chain);
+
+    auto display_buffer = create_display_buffer(mt::fake_shared(mock_host_connection));
+    EXPECT_TRUE(display_buffer->overlay(list));
+}
+
+// The host doesn't apply chain submissions and surface specs atomically
+TEST_F(NestedDisplayBuffer, composites_frames_where_the_layer_layout_changes)
+{
+    NiceMock<MockHostSurface> mock_host_surface;
+    mtd::StubHostConnection host_connection(mt::fake_shared(mock_host_surface));
+    StubNestedBuffer fullscreen_buffer;
+    StubNestedBuffer layer_buffer;
+    geom::Rectangle small_rect { {10, 10}, { 5, 5 }};
+    geom::Rectangle moved_rect { {20, 10}, { 5, 5 }};
+    mg::RenderableList list = {
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(fullscreen_buffer), rectangle),
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(layer_buffer), small_rect) };
+    mg::RenderableList moved_list = {
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(fullscreen_buffer), rectangle),
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(layer_buffer), moved_rect) };
+
+    auto display_buffer = create_display_buffer(mt::fake_shared(host_connection));
+
+    EXPECT_CALL(mock_host_surface, apply_spec(_))
+        .Times(3);
+    EXPECT_TRUE(display_buffer->overlay(list));
+    fullscreen_buffer.trigger();
+    layer_buffer.trigger();
+    EXPECT_FALSE(display_buffer->overlay(moved_list));
+    display_buffer->swap_buffers();
+    EXPECT_TRUE(display_buffer->overlay(moved_list));
+}
+
+TEST_F(NestedDisplayBuffer, rejects_list_containing_layer_partly_outside_output)
+{
+    StubNestedBuffer fullscreen_buffer;
+    StubNestedBuffer layer_buffer;
+    geom::Rectangle overhanging_rect { {1020, 10}, { 50, 50 }};
+    mg::RenderableList list = {
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(fullscreen_buffer), rectangle),
+        std::make_shared<mtd::StubRenderable>(mt::fake_shared(layer_buffer), overhanging_rect) };
+
+    auto display_buffer = create_display_buffer(host_connection);
+    EXPECT_FALSE(display_buffer->overlay(list));
+}
+
+TEST_F(NestedDisplayBuffer, rejects_list_showing_the_same_buffer_twice)
+{
+    StubNestedBuffer nested_buffer;
     geom::Rectangle small_rect { {0, 0}, { 5, 5 }};
     mg::RenderableList list = {
         std::make_shared<mtd::StubRenderable>(mt::fake_shared(nested_buffer), rectangle),
@@ -0,0 +1,384 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/sw/renderer.h"
+#include "src/renderers/sw/renderer_factory.h"
+#include "src/renderers/sw/blend.h"
+#include "src/renderers/sw/sample.h"
+
+#include "mir/graphics/buffer_properties.h"
+#include "mir/test/doubles/stub_display_buffer.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/stub_renderable.h"
+#include "mir/test/doubles/stub_renderer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdlib>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+uint32_t const opaque_red   = 0xff0000ff;  // abgr_8888 pixels, as read on a little-endian machine
+uint32_t const opaque_green = 0xff00ff00;
+uint32_t const opaque_blue  = 0xffff0000;
+uint32_t const half_red     = 0x80000080;  // premultiplied
+uint32_t const cleared      = 0x00000000;
+
+struct StubSoftwareDisplayBuffer : mtd::StubDisplayBuffer, mrs::RenderTarget
+{
+    StubSoftwareDisplayBuffer(geom::Rectangle const& area, geom::Size const& frame_size,
+                              MirPixelFormat format = mir_pixel_format_abgr_8888)
+        : StubDisplayBuffer{area},
+          frame_size{frame_size},
+          format{format},
+          pixels(frame_size.width.as_int() * frame_size.height.as_int(), 0xdeadbeef)
+    {
+    }
+
+    explicit StubSoftwareDisplayBuffer(geom::Rectangle const& area)
+        : StubSoftwareDisplayBuffer{area, area.size}
+    {
+    }
+
+    mrs::WritableFrame map_back_buffer() override
+    {
+        return {reinterpret_cast<unsigned char*>(pixels.data()),
+                frame_size,
+                geom::Stride{frame_size.width.as_int() * 4},
+                format};
+    }
+
+    void swap_buffers() override { ++swaps; }
+
+    glm::mat2 transformation() const override { return transform; }
+
+    uint32_t pixel(int x, int y) const { return pixels[y * frame_size.width.as_int() + x]; }
+
+    geom::Size const frame_size;
+    MirPixelFormat const format;
+    std::vector<uint32_t> pixels;
+    glm::mat2 transform{1, 0, 0, 1};
+    int swaps{0};
+};
+
+struct ConfigurableRenderable : mtd::StubRenderable
+{
+    ConfigurableRenderable(
+        std::shared_ptr<mg::Buffer> const& buffer, geom::Rectangle const& rect, float alpha, bool shaped)
+        : StubRenderable(buffer, rect),
+          alpha_{alpha},
+          shaped_{shaped}
+    {
+    }
+
+    float alpha() const override { return alpha_; }
+    bool shaped() const override { return shaped_; }
+
+    float const alpha_;
+    bool const shaped_;
+};
+
+std::shared_ptr<mtd::StubBuffer> buffer_of(
+    geom::Size size, std::vector<uint32_t> pixels, MirPixelFormat format = mir_pixel_format_abgr_8888)
+{
+    auto const count = size.width.as_int() * size.height.as_int();
+    if (pixels.size() == 1)
+        pixels.resize(count, pixels[0]);
+
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{size, format, mg::BufferUsage::software});
+    buffer->write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels.size() * sizeof pixels[0]);
+    return buffer;
+}
+
+// Like a wl_shm buffer whose client has destroyed it
+struct UnreadableBuffer : mtd::StubBuffer
+{
+    using StubBuffer::StubBuffer;
+
+    void read(std::function<void(unsigned char const*)> const&) override {}
+};
+
+// Stands in for the GL renderer factory
+struct FallbackRendererFactory : mir::renderer::RendererFactory
+{
+    std::unique_ptr<mir::renderer::Renderer> create_renderer_for(mg::DisplayBuffer&) override
+    {
+        ++renderers_created;
+        return std::make_unique<mtd::StubRenderer>();
+    }
+
+    int renderers_created{0};
+};
+
+struct SoftwareRenderer : Test
+{
+    geom::Rectangle const area{{0, 0}, {4, 4}};
+    StubSoftwareDisplayBuffer display_buffer{area};
+
+    std::shared_ptr<mg::Renderable> opaque(geom::Rectangle const& rect, std::shared_ptr<mg::Buffer> const& buffer)
+    {
+        return std::make_shared<mtd::StubRenderable>(buffer, rect);
+    }
+
+    std::shared_ptr<mg::Renderable> opaque(geom::Rectangle const& rect, uint32_t pixel)
+    {
+        return opaque(rect, buffer_of(rect.size, {pixel}));
+    }
+};
+}
+
+TEST_F(SoftwareRenderer, throws_if_display_buffer_does_not_support_software_rendering)
+{
+    mtd::StubDisplayBuffer gl_only_display_buffer{area};
+
+    EXPECT_THROW(mrs::Renderer(gl_only_display_buffer, 1), std::logic_error);
+}
+
+TEST_F(SoftwareRenderer, factory_creates_software_renderers_for_render_targets)
+{
+    auto const fallback = std::make_shared<FallbackRendererFactory>();
+    mrs::RendererFactory factory{1, fallback};
+
+    auto const renderer = factory.create_renderer_for(display_buffer);
+
+    EXPECT_THAT(dynamic_cast<mrs::Renderer*>(renderer.get()), NotNull());
+    EXPECT_THAT(fallback->renderers_created, Eq(0));
+}
+
+TEST_F(SoftwareRenderer, factory_falls_back_for_display_buffers_that_are_not_render_targets)
+{
+    auto const fallback = std::make_shared<FallbackRendererFactory>();
+    mrs::RendererFactory factory{1, fallback};
+    mtd::StubDisplayBuffer screencast_display_buffer{area};
+
+    std::unique_ptr<mir::renderer::Renderer> renderer;
+    EXPECT_NO_THROW(renderer = factory.create_renderer_for(screencast_display_buffer));
+
+    EXPECT_THAT(renderer, NotNull());
+    EXPECT_THAT(dynamic_cast<mrs::Renderer*>(renderer.get()), IsNull());
+    EXPECT_THAT(fallback->renderers_created, Eq(1));
+}
+
+TEST_F(SoftwareRenderer, clears_the_frame_and_draws_renderables_where_they_are)
+{
+    mrs::Renderer renderer{display_buffer, 1};
+
+    renderer.render({opaque({{1, 2}, {2, 1}}, opaque_red)});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(cleared));
+    EXPECT_THAT(display_buffer.pixel(1, 2), Eq(opaque_red));
+    EXPECT_THAT(display_buffer.pixel(2, 2), Eq(opaque_red));
+    EXPECT_THAT(display_buffer.pixel(3, 2), Eq(cleared));
+    EXPECT_THAT(display_buffer.pixel(1, 3), Eq(cleared));
+    EXPECT_THAT(display_buffer.swaps, Eq(1));
+}
+
+TEST_F(SoftwareRenderer, draws_later_renderables_on_top)
+{
+    mrs::Renderer renderer{display_buffer, 1};
+
+    renderer.render({opaque(area, opaque_green), opaque({{0, 0}, {1, 1}}, opaque_blue)});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(opaque_blue));
+    EXPECT_THAT(display_buffer.pixel(1, 1), Eq(opaque_green));
+}
+
+TEST_F(SoftwareRenderer, blends_shaped_renderables_with_premultiplied_alpha)
+{
+    mrs::Renderer renderer{display_buffer, 1};
+
+    renderer.render({
+        opaque(area, opaque_green),
+        std::make_shared<ConfigurableRenderable>(buffer_of(area.size, {half_red}), area, 1.0f, true)});
+
+    EXPECT_THAT(display_buffer.pixel(2, 2), Eq(0xff007f80));
+}
+
+TEST_F(SoftwareRenderer, fades_translucent_windows_without_using_their_alpha_channel)
+{
+    mrs::Renderer renderer{display_buffer, 1};
+
+    // An RGBX client may leave garbage in its alpha channel
+    renderer.render({
+        opaque(area, opaque_green),
+        std::make_shared<ConfigurableRenderable>(buffer_of(area.size, {0x130000ff}), area, 0.5f, false)});
+
+    EXPECT_THAT(display_buffer.pixel(2, 2), Eq(0xff007f80));
+}
+
+TEST_F(SoftwareRenderer, scales_buffers_to_their_screen_position)
+{
+    mrs::Renderer renderer{display_buffer, 1};
+
+    renderer.render({opaque(area, buffer_of({2, 2}, {opaque_red, opaque_green, opaque_blue, opaque_red}))});
+
+    EXPECT_THAT(display_buffer.pixel(1, 1), Eq(opaque_red));
+    EXPECT_THAT(display_buffer.pixel(2, 1), Eq(opaque_green));
+    EXPECT_THAT(display_buffer.pixel(1, 2), Eq(opaque_blue));
+    EXPECT_THAT(display_buffer.pixel(3, 3), Eq(opaque_red));
+}
+
+TEST_F(SoftwareRenderer, clips_renderables_to_the_frame)
+{
+    mrs::Renderer renderer{display_buffer, 1};
+
+    renderer.render({opaque({{-1, -1}, {2, 2}}, buffer_of({2, 2}, {opaque_red, opaque_green, opaque_blue, opaque_green}))});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(opaque_green));
+    EXPECT_THAT(display_buffer.pixel(1, 0), Eq(cleared));
+    EXPECT_THAT(display_buffer.pixel(0, 1), Eq(cleared));
+}
+
+TEST_F(SoftwareRenderer, converts_between_pixel_formats_with_red_and_blue_swapped)
+{
+    StubSoftwareDisplayBuffer argb_display_buffer{area, area.size, mir_pixel_format_argb_8888};
+    mrs::Renderer renderer{argb_display_buffer, 1};
+
+    renderer.render({opaque(area, opaque_red)});
+
+    EXPECT_THAT(argb_display_buffer.pixel(0, 0), Eq(0xffff0000));
+}
+
+TEST_F(SoftwareRenderer, applies_the_output_transform)
+{
+    display_buffer.transform = glm::mat2{-1, 0, 0, -1};
+    mrs::Renderer renderer{display_buffer, 1};
+    renderer.set_output_transform(display_buffer.transform);
+
+    renderer.render({opaque({{0, 0}, {1, 1}}, opaque_red)});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(cleared));
+    EXPECT_THAT(display_buffer.pixel(3, 3), Eq(opaque_red));
+}
+
+TEST_F(SoftwareRenderer, letterboxes_viewports_of_a_different_aspect_ratio)
+{
+    mrs::Renderer renderer{display_buffer, 1};
+    renderer.set_viewport({{0, 0}, {4, 2}});
+
+    renderer.render({opaque({{0, 0}, {4, 2}}, opaque_red)});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(cleared));
+    EXPECT_THAT(display_buffer.pixel(0, 1), Eq(opaque_red));
+    EXPECT_THAT(display_buffer.pixel(3, 2), Eq(opaque_red));
+    EXPECT_THAT(display_buffer.pixel(3, 3), Eq(cleared));
+}
+
+TEST_F(SoftwareRenderer, leaves_out_buffers_that_cannot_be_read)
+{
+    mrs::Renderer renderer{display_buffer, 1};
+    auto const unreadable = std::make_shared<UnreadableBuffer>(
+        mg::BufferProperties{area.size, mir_pixel_format_abgr_8888, mg::BufferUsage::software});
+
+    renderer.render({opaque({{0, 0}, {1, 1}}, opaque_red), opaque(area, unreadable), opaque({{3, 3}, {1, 1}}, opaque_blue)});
+
+    EXPECT_THAT(display_buffer.pixel(0, 0), Eq(opaque_red));
+    EXPECT_THAT(display_buffer.pixel(1, 1), Eq(cleared));
+    EXPECT_THAT(display_buffer.pixel(3, 3), Eq(opaque_blue));
+    EXPECT_THAT(display_buffer.swaps, Eq(1));
+}
+
+TEST_F(SoftwareRenderer, compositing_in_bands_gives_the_same_frame)
+{
+    geom::Rectangle const big_area{{0, 0}, {13, 11}};
+    StubSoftwareDisplayBuffer one_band{big_area};
+    StubSoftwareDisplayBuffer several_bands{big_area};
+
+    std::vector<uint32_t> pattern;
+    for (auto i = 0; i != 7 * 5; ++i)
+        pattern.push_back(0x80000000 | (i * 0x010203));
+
+    mg::RenderableList const renderables{
+        opaque(big_area, opaque_green),
+        std::make_shared<ConfigurableRenderable>(buffer_of({7, 5}, pattern), geom::Rectangle{{2, 1}, {9, 8}}, 0.75f, true),
+        std::make_shared<ConfigurableRenderable>(buffer_of({3, 3}, {opaque_blue}), geom::Rectangle{{5, 5}, {3, 3}}, 0.5f, false)};
+
+    mrs::Renderer{one_band, 1}.render(renderables);
+    mrs::Renderer{several_bands, 4}.render(renderables);
+
+    EXPECT_THAT(several_bands.pixels, ContainerEq(one_band.pixels));
+}
+
+TEST(SoftwareBlend, simd_and_portable_kernels_agree)
+{
+    std::srand(1);
+    std::vector<uint32_t> src(37);
+    std::vector<uint32_t> dst(37);
+    for (auto& pixel : src)
+    {
+        // Premultiplied: no channel exceeds alpha
+        uint32_t const a = std::rand() % 256;
+        pixel = a << 24;
+        for (int c = 0; c != 3; ++c)
+            pixel |= (a ? std::rand() % (a + 1) : 0) << (8 * c);
+    }
+    for (auto& pixel : dst)
+        pixel = std::rand();
+
+    for (auto const mode : {mrs::BlendMode::copy, mrs::BlendMode::over, mrs::BlendMode::fade})
+    {
+        for (auto const alpha : {0, 1, 127, 128, 200, 254, 255})
+        {
+            auto simd = dst;
+            auto portable = dst;
+
+            mrs::blend_row(simd.data(), src.data(), src.size(), mode, alpha);
+            mrs::blend_row_generic(portable.data(), src.data(), src.size(), mode, alpha);
+
+            EXPECT_THAT(simd, ContainerEq(portable)) << "mode " << static_cast<int>(mode) << ", alpha " << alpha;
+        }
+    }
+}
+
+TEST(SoftwareSample, simd_and_portable_kernels_agree)
+{
+    int const size = 16;
+    std::srand(1);
+    std::vector<uint32_t> source(size * size);
+    for (auto& pixel : source)
+        pixel = std::rand();
+
+    auto const src = reinterpret_cast<unsigned char const*>(source.data());
+    auto const fixed = [](double pixels) { return static_cast<int32_t>(pixels * 65536); };
+
+    struct Line { mrs::SamplePosition start; mrs::SamplePosition step; size_t n; };
+    for (auto const& line : {
+            Line{{fixed(0.5), fixed(3.5)}, {fixed(0.5), 0}, 31},            // Scaled up
+            Line{{fixed(1.25), fixed(2.5)}, {fixed(0.75), fixed(0.1)}, 17},  // Sheared
+            Line{{fixed(15.9), fixed(15.5)}, {fixed(-0.8), fixed(-0.3)}, 19}, // Rotated
+            Line{{fixed(0.0), fixed(15.0)}, {fixed(3.0), 0}, 5}})            // Scaled down
+    {
+        for (auto const swap : {false, true})
+        {
+            std::vector<uint32_t> simd(line.n);
+            std::vector<uint32_t> portable(line.n);
+
+            mrs::sample_row(simd.data(), src, size * 4, line.start, line.step, line.n, swap);
+            mrs::sample_row_generic(portable.data(), src, size * 4, line.start, line.step, line.n, swap);
+
+            EXPECT_THAT(simd, ContainerEq(portable)) << line.n << " samples, swap " << swap;
+        }
+    }
+}
@@ -19,6 +19,8 @@
 #include "mir/thread_safe_list.h"
 #include "mir/test/signal.h"
 
+#include <thread>
+
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
@@ -157,3 +159,91 @@ TEST_F(ThreadSafeListTest, clears_all_elements)
 
     EXPECT_THAT(elements_seen, Eq(0));
 }
+
+TEST_F(ThreadSafeListTest, remove_waits_for_element_in_use_on_different_thread)
+{
+    using namespace testing;
+
+    list.add(element1);
+
+    mir::test::Signal element_in_use;
+    std::atomic<bool> element_released{false};
+
+    std::thread t{
+        [&]
+        {
+            list.for_each(
+                [&] (Element const&)
+                {
+                    element_in_use.raise();
+                    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+                    element_released = true;
+                });
+        }};
+
+    element_in_use.wait_for(std::chrono::seconds{3});
+    list.remove(element1);
+
+    EXPECT_TRUE(element_released);
+
+    t.join();
+}
+
+TEST_F(ThreadSafeListTest, drops_reference_to_removed_element)
+{
+    using namespace testing;
+
+    auto element = std::make_shared<Dummy>();
+    std::weak_ptr<Dummy> const weak_element = element;
+
+    list.add(element);
+    list.for_each([] (Element const&) {});
+    list.remove(element);
+    element.reset();
+
+    EXPECT_TRUE(weak_element.expired());
+}
+
+TEST_F(ThreadSafeListTest, removed_elements_are_not_seen_by_concurrent_iterations)
+{
+    using namespace testing;
+
+    std::atomic<bool> done{false};
+    std::atomic<Dummy*> last_removed{nullptr};
+    std::atomic<int> removed_elements_seen{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i != 4; ++i)
+    {
+        readers.emplace_back(
+            [&]
+            {
+                while (!done)
+                {
+                    list.for_each(
+                        [&] (Element const& element)
+                        {
+                            if (element.get() == last_removed) ++removed_elements_seen;
+                        });
+                }
+            });
+    }
+
+    list.add(element1);
+
+    // Keep the elements alive so that their addresses are not reused
+    std::vector<Element> elements;
+    for (int i = 0; i != 1000; ++i)
+    {
+        elements.push_back(std::make_shared<Dummy>());
+        list.add(elements.back());
+        list.remove(elements.back());
+        last_removed = elements.back().get();
+    }
+
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_THAT(removed_elements_seen, Eq(0));
+}
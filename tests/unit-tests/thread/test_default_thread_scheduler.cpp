@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/thread/default_thread_scheduler.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+namespace mth = mir::thread;
+using namespace testing;
+
+namespace
+{
+int nice_level()
+{
+    return getpriority(PRIO_PROCESS, syscall(SYS_gettid));
+}
+}
+
+TEST(DefaultThreadScheduler, leaves_compositor_threads_as_started_when_nothing_is_configured)
+{
+    mth::DefaultThreadScheduler scheduler{{}};
+
+    auto const process_cpus = mth::current_cpu_affinity();
+    int started_nice{0};
+    int nice_after{0};
+    std::vector<int> cpus_after;
+
+    std::thread{
+        [&]
+        {
+            // As if the server had been run under nice(1) and taskset(1)
+            setpriority(PRIO_PROCESS, syscall(SYS_gettid), nice_level() + 1);
+            started_nice = nice_level();
+            mth::apply_cpu_affinity({process_cpus.front()});
+
+            scheduler.compositor_thread_started("HDMI-A-1");
+
+            nice_after = nice_level();
+            cpus_after = mth::current_cpu_affinity();
+        }}.join();
+
+    EXPECT_THAT(nice_after, Eq(started_nice));
+    EXPECT_THAT(cpus_after, ElementsAre(process_cpus.front()));
+}
+
+TEST(DefaultThreadScheduler, gives_a_pooled_thread_back_its_cpus_for_an_output_without_affinity)
+{
+    auto const process_cpus = mth::current_cpu_affinity();
+
+    mth::DefaultThreadScheduler::Settings settings;
+    settings.compositor_affinity["DP-1"] = {process_cpus.front()};
+    mth::DefaultThreadScheduler scheduler{settings};
+
+    std::vector<int> cpus_for_dp;
+    std::vector<int> cpus_for_hdmi;
+
+    std::thread{
+        [&]
+        {
+            scheduler.compositor_thread_started("DP-1");
+            cpus_for_dp = mth::current_cpu_affinity();
+
+            scheduler.compositor_thread_started("HDMI-A-1");
+            cpus_for_hdmi = mth::current_cpu_affinity();
+        }}.join();
+
+    EXPECT_THAT(cpus_for_dp, ElementsAre(process_cpus.front()));
+    EXPECT_THAT(cpus_for_hdmi, Eq(process_cpus));
+}
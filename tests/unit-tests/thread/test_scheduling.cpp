@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/thread/scheduling.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace mth = mir::thread;
+using namespace testing;
+
+TEST(ThreadScheduling, empty_policy_leaves_thread_unchanged)
+{
+    EXPECT_THAT(mth::parse_scheduling_policy("").kind, Eq(mth::SchedulingPolicy::Kind::unchanged));
+}
+
+TEST(ThreadScheduling, parses_nice_level)
+{
+    auto const policy = mth::parse_scheduling_policy("nice:-5");
+
+    EXPECT_THAT(policy.kind, Eq(mth::SchedulingPolicy::Kind::nice));
+    EXPECT_THAT(policy.priority, Eq(-5));
+}
+
+TEST(ThreadScheduling, parses_real_time_policies)
+{
+    auto const fifo = mth::parse_scheduling_policy("fifo:10");
+    auto const rr = mth::parse_scheduling_policy("rr:2");
+
+    EXPECT_THAT(fifo.kind, Eq(mth::SchedulingPolicy::Kind::fifo));
+    EXPECT_THAT(fifo.priority, Eq(10));
+    EXPECT_THAT(rr.kind, Eq(mth::SchedulingPolicy::Kind::round_robin));
+    EXPECT_THAT(rr.priority, Eq(2));
+}
+
+TEST(ThreadScheduling, rejects_malformed_policies)
+{
+    EXPECT_THROW(mth::parse_scheduling_policy("fifo"), std::invalid_argument);
+    EXPECT_THROW(mth::parse_scheduling_policy("fifo:"), std::invalid_argument);
+    EXPECT_THROW(mth::parse_scheduling_policy("fifo:high"), std::invalid_argument);
+    EXPECT_THROW(mth::parse_scheduling_policy("deadline:1"), std::invalid_argument);
+    EXPECT_THROW(mth::parse_scheduling_policy("fifo:1000"), std::invalid_argument);
+}
+
+TEST(ThreadScheduling, parses_cpu_lists)
+{
+    EXPECT_THAT(mth::parse_cpu_list(""), IsEmpty());
+    EXPECT_THAT(mth::parse_cpu_list("3"), ElementsAre(3));
+    EXPECT_THAT(mth::parse_cpu_list("0,2-4"), ElementsAre(0, 2, 3, 4));
+}
+
+TEST(ThreadScheduling, rejects_malformed_cpu_lists)
+{
+    EXPECT_THROW(mth::parse_cpu_list("a"), std::invalid_argument);
+    EXPECT_THROW(mth::parse_cpu_list("1,"), std::invalid_argument);
+    EXPECT_THROW(mth::parse_cpu_list("3-1"), std::invalid_argument);
+    EXPECT_THROW(mth::parse_cpu_list("-1"), std::invalid_argument);
+}
+
+TEST(ThreadScheduling, unchanged_policy_and_empty_affinity_are_no_ops)
+{
+    EXPECT_NO_THROW(mth::apply_scheduling_policy({}));
+    EXPECT_NO_THROW(mth::apply_cpu_affinity({}));
+}
+
+TEST(ThreadScheduling, current_cpu_affinity_reports_the_applied_cpus)
+{
+    auto const process_cpus = mth::current_cpu_affinity();
+    ASSERT_THAT(process_cpus, Not(IsEmpty()));
+
+    std::vector<int> applied;
+    std::vector<int> restored;
+    std::thread{
+        [&]
+        {
+            mth::apply_cpu_affinity({process_cpus.front()});
+            applied = mth::current_cpu_affinity();
+            mth::apply_cpu_affinity(process_cpus);
+            restored = mth::current_cpu_affinity();
+        }}.join();
+
+    EXPECT_THAT(applied, ElementsAre(process_cpus.front()));
+    EXPECT_THAT(restored, Eq(process_cpus));
+}